@@ -521,6 +521,10 @@ namespace llvm {
     /// predicate by splitting it into a set of independent predicates.
     bool ProvingSplitPredicate;
 
+    /// The number of nested getSCEV calls creating a new SCEV, compared
+    /// against the recursion budget of createSCEV.
+    unsigned CreationDepth;
+
     /// Information about the number of loop iterations for which a loop exit's
     /// branch condition evaluates to the not-taken path.  This is a temporary
     /// pair of exact and max expressions that are eventually summarized in
@@ -1088,6 +1092,13 @@ namespace llvm {
     /// Drop memoized information computed for S.
     void forgetMemoizedResults(const SCEV *S);
 
+    /// Return the uniqued add or multiply of \p Ops, which have to be sorted
+    /// already, without trying to simplify it.
+    const SCEV *getOrCreateAddExpr(SmallVectorImpl<const SCEV *> &Ops,
+                                   SCEV::NoWrapFlags Flags);
+    const SCEV *getOrCreateMulExpr(SmallVectorImpl<const SCEV *> &Ops,
+                                   SCEV::NoWrapFlags Flags);
+
     /// Return an existing SCEV for V if there is one, otherwise return nullptr.
     const SCEV *getExistingSCEV(Value *V);
 
@@ -1197,29 +1208,37 @@ namespace llvm {
     const SCEV *getZeroExtendExpr(const SCEV *Op, Type *Ty);
     const SCEV *getSignExtendExpr(const SCEV *Op, Type *Ty);
     const SCEV *getAnyExtendExpr(const SCEV *Op, Type *Ty);
+    /// Depth counts the getAddExpr and getMulExpr calls this one is nested
+    /// in.  Deeply nested calls no longer look for simplifications.
     const SCEV *getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
-                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap);
+                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap,
+                           unsigned Depth = 0);
     const SCEV *getAddExpr(const SCEV *LHS, const SCEV *RHS,
-                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap) {
+                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap,
+                           unsigned Depth = 0) {
       SmallVector<const SCEV *, 2> Ops = {LHS, RHS};
-      return getAddExpr(Ops, Flags);
+      return getAddExpr(Ops, Flags, Depth);
     }
     const SCEV *getAddExpr(const SCEV *Op0, const SCEV *Op1, const SCEV *Op2,
-                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap) {
+                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap,
+                           unsigned Depth = 0) {
       SmallVector<const SCEV *, 3> Ops = {Op0, Op1, Op2};
-      return getAddExpr(Ops, Flags);
+      return getAddExpr(Ops, Flags, Depth);
     }
     const SCEV *getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
-                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap);
+                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap,
+                           unsigned Depth = 0);
     const SCEV *getMulExpr(const SCEV *LHS, const SCEV *RHS,
-                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap) {
+                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap,
+                           unsigned Depth = 0) {
       SmallVector<const SCEV *, 2> Ops = {LHS, RHS};
-      return getMulExpr(Ops, Flags);
+      return getMulExpr(Ops, Flags, Depth);
     }
     const SCEV *getMulExpr(const SCEV *Op0, const SCEV *Op1, const SCEV *Op2,
-                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap) {
+                           SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap,
+                           unsigned Depth = 0) {
       SmallVector<const SCEV *, 3> Ops = {Op0, Op1, Op2};
-      return getMulExpr(Ops, Flags);
+      return getMulExpr(Ops, Flags, Depth);
     }
     const SCEV *getUDivExpr(const SCEV *LHS, const SCEV *RHS);
     const SCEV *getUDivExactExpr(const SCEV *LHS, const SCEV *RHS);
@@ -1273,9 +1292,11 @@ namespace llvm {
     ///
     const SCEV *getNotSCEV(const SCEV *V);
 
-    /// Return LHS-RHS.  Minus is represented in SCEV as A+B*-1.
+    /// Return LHS-RHS.  Minus is represented in SCEV as A+B*-1.  \p Depth is
+    /// passed on to getAddExpr.
     const SCEV *getMinusSCEV(const SCEV *LHS, const SCEV *RHS,
-                             SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap);
+                             SCEV::NoWrapFlags Flags = SCEV::FlagAnyWrap,
+                             unsigned Depth = 0);
 
     /// Return a SCEV corresponding to a conversion of the input value to the
     /// specified type.  If the type must be extended, it is zero extended.
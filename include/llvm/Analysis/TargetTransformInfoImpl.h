@@ -272,6 +272,15 @@ public:
 
   unsigned getCacheLineSize() { return 0; }
 
+  Optional<unsigned> getCacheSize(TargetTransformInfo::CacheLevel Level) {
+    return None;
+  }
+
+  Optional<unsigned>
+  getCacheAssociativity(TargetTransformInfo::CacheLevel Level) {
+    return None;
+  }
+
   unsigned getPrefetchDistance() { return 0; }
 
   unsigned getMinPrefetchStride() { return 1; }
@@ -21,6 +21,7 @@
 namespace llvm {
 class Module;
 class ModulePass;
+class raw_fd_ostream;
 class raw_ostream;
 
 /// \brief Create and return a pass that writes the module to the specified
@@ -40,12 +41,21 @@ ModulePass *createBitcodeWriterPass(raw_ostream &Str,
                                     bool EmitSummaryIndex = false,
                                     bool EmitModuleHash = false);
 
+/// \brief Create and return a pass that writes the module to the specified
+/// file stream. If the file supports seeking, the bitcode is flushed to it
+/// while it is being written instead of being buffered in memory.
+ModulePass *createBitcodeWriterPass(raw_fd_ostream &Str,
+                                    bool ShouldPreserveUseListOrder = false,
+                                    bool EmitSummaryIndex = false,
+                                    bool EmitModuleHash = false);
+
 /// \brief Pass for writing a module of IR out to a bitcode file.
 ///
 /// Note that this is intended for use with the new pass manager. To construct
 /// a pass for the legacy pass manager, use the function above.
 class BitcodeWriterPass {
   raw_ostream &OS;
+  raw_fd_ostream *FDOS = nullptr;
   bool ShouldPreserveUseListOrder;
   bool EmitSummaryIndex;
   bool EmitModuleHash;
@@ -65,6 +75,13 @@ public:
       : OS(OS), ShouldPreserveUseListOrder(ShouldPreserveUseListOrder),
   EmitSummaryIndex(EmitSummaryIndex), EmitModuleHash(EmitModuleHash) {}
 
+  /// \brief Construct a bitcode writer pass around a file stream, which the
+  /// bitcode is flushed to while it is written if the file supports seeking.
+  explicit BitcodeWriterPass(raw_fd_ostream &OS,
+                             bool ShouldPreserveUseListOrder = false,
+                             bool EmitSummaryIndex = false,
+                             bool EmitModuleHash = false);
+
   /// \brief Run the bitcode writer pass, and output the module to the selected
   /// output stream.
   PreservedAnalyses run(Module &M, ModuleAnalysisManager &);
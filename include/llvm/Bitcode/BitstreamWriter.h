@@ -21,13 +21,41 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitcode/BitCodes.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 namespace llvm {
 
 class BitstreamWriter {
+  /// Out - The buffer that holds the bytes that have not been flushed yet.
   SmallVectorImpl<char> &Out;
 
+  /// FS - The file stream that Out is flushed to once it grows past
+  /// FlushThreshold bytes.  If null, the whole stream stays in Out.
+  raw_pwrite_stream *FS;
+
+  /// FlushThreshold - The number of buffered bytes that triggers a flush.
+  uint64_t FlushThreshold;
+
+  /// FSStartOffset - The offset in FS at which this stream starts.
+  uint64_t FSStartOffset;
+
+  /// FlushedBytes - The number of bytes already written to FS.
+  uint64_t FlushedBytes = 0;
+
+  /// Bytes around the non-byte-aligned placeholders registered with
+  /// PreserveBackpatchSite, kept so that they can still be patched after
+  /// they have been flushed.
+  struct BackpatchSite {
+    uint64_t ByteNo;
+    bool Saved;
+    char Bytes[5];
+    explicit BackpatchSite(uint64_t ByteNo) : ByteNo(ByteNo), Saved(false) {}
+  };
+  SmallVector<BackpatchSite, 1> BackpatchSites;
+
   /// CurBit - Always between 0 and 31 inclusive, specifies the next bit to use.
   unsigned CurBit;
 
@@ -73,17 +101,26 @@ class BitstreamWriter {
                reinterpret_cast<const char *>(&Value + 1));
   }
 
-  size_t GetBufferOffset() const { return Out.size(); }
+  uint64_t GetBufferOffset() const { return FlushedBytes + Out.size(); }
 
   size_t GetWordIndex() const {
-    size_t Offset = GetBufferOffset();
+    uint64_t Offset = GetBufferOffset();
     assert((Offset & 3) == 0 && "Not 32-bit aligned");
     return Offset / 4;
   }
 
 public:
-  explicit BitstreamWriter(SmallVectorImpl<char> &O)
-    : Out(O), CurBit(0), CurValue(0), CurCodeSize(2) {}
+  /// Create a writer that emits into \p O.  If \p FS is provided, the bytes
+  /// in \p O are written to it by FlushToFile once there are more than
+  /// \p FlushThreshold of them; backpatching then goes through pwrite.
+  explicit BitstreamWriter(SmallVectorImpl<char> &O,
+                           raw_pwrite_stream *FS = nullptr,
+                           uint64_t FlushThreshold = 0)
+      : Out(O), FS(FS), FlushThreshold(FlushThreshold),
+        FSStartOffset(FS ? FS->tell() : 0), CurBit(0), CurValue(0),
+        CurCodeSize(2) {
+    assert((!FS || O.empty()) && "Cannot flush bytes emitted by someone else");
+  }
 
   ~BitstreamWriter() {
     assert(CurBit == 0 && "Unflushed data remaining");
@@ -104,12 +141,67 @@ public:
   /// with the specified value.
   void BackpatchWord(uint64_t BitNo, unsigned NewWord) {
     using namespace llvm::support;
-    unsigned ByteNo = BitNo / 8;
-    assert((!endian::readAtBitAlignment<uint32_t, little, unaligned>(
-               &Out[ByteNo], BitNo & 7)) &&
-           "Expected to be patching over 0-value placeholders");
-    endian::writeAtBitAlignment<uint32_t, little, unaligned>(
-        &Out[ByteNo], NewWord, BitNo & 7);
+    uint64_t ByteNo = BitNo / 8;
+    if (ByteNo >= FlushedBytes) {
+      char *Ptr = &Out[ByteNo - FlushedBytes];
+      assert((!endian::readAtBitAlignment<uint32_t, little, unaligned>(
+                 Ptr, BitNo & 7)) &&
+             "Expected to be patching over 0-value placeholders");
+      endian::writeAtBitAlignment<uint32_t, little, unaligned>(Ptr, NewWord,
+                                                               BitNo & 7);
+      return;
+    }
+
+    // The placeholder has been flushed, at least in part.  Rebuild the bytes
+    // it covers and write them back.
+    char Bytes[8] = {0};
+    unsigned NumBytes = (BitNo & 7) ? 5 : 4;
+    if (BitNo & 7) {
+      auto Site = std::find_if(
+          BackpatchSites.begin(), BackpatchSites.end(),
+          [ByteNo](const BackpatchSite &S) { return S.ByteNo == ByteNo; });
+      assert(Site != BackpatchSites.end() && Site->Saved &&
+             "Unaligned placeholder flushed without PreserveBackpatchSite");
+      memcpy(Bytes, Site->Bytes, NumBytes);
+    }
+    endian::writeAtBitAlignment<uint32_t, little, unaligned>(Bytes, NewWord,
+                                                             BitNo & 7);
+    uint64_t NumFlushed = std::min<uint64_t>(NumBytes, FlushedBytes - ByteNo);
+    FS->pwrite(Bytes, NumFlushed, FSStartOffset + ByteNo);
+    if (NumFlushed < NumBytes)
+      memcpy(&Out[0], Bytes + NumFlushed, NumBytes - NumFlushed);
+  }
+
+  /// Register a 32-bit placeholder at \p BitNo that will be backpatched
+  /// later.  Only needed for placeholders that are not byte aligned and may
+  /// be flushed before they are patched.
+  void PreserveBackpatchSite(uint64_t BitNo) {
+    if (FS && (BitNo & 7))
+      BackpatchSites.emplace_back(BitNo / 8);
+  }
+
+  /// If there is a file stream and the buffer holds more than the flush
+  /// threshold, write the buffer out to the file and empty it.  Returns true
+  /// if the buffer was written out.
+  bool FlushToFile() {
+    if (!FS || Out.size() <= FlushThreshold)
+      return false;
+
+    // Save the bytes of pending placeholders before they leave the buffer;
+    // wait for a later flush if one is not complete yet.
+    for (BackpatchSite &Site : BackpatchSites) {
+      if (Site.Saved)
+        continue;
+      if (Site.ByteNo + sizeof(Site.Bytes) > GetBufferOffset())
+        return false;
+      memcpy(Site.Bytes, &Out[Site.ByteNo - FlushedBytes], sizeof(Site.Bytes));
+      Site.Saved = true;
+    }
+
+    FS->write(Out.data(), Out.size());
+    FlushedBytes += Out.size();
+    Out.clear();
+    return true;
   }
 
   void Emit(uint32_t Val, unsigned NumBits) {
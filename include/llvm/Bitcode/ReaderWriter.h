@@ -28,6 +28,7 @@ namespace llvm {
   class LLVMContext;
   class Module;
   class ModulePass;
+  class raw_fd_ostream;
   class raw_ostream;
 
   /// Offsets of the 32-bit fields of bitcode wrapper header.
@@ -96,6 +97,16 @@ namespace llvm {
                           const ModuleSummaryIndex *Index = nullptr,
                           bool GenerateHash = false);
 
+  /// Write the specified module to the specified file stream.
+  ///
+  /// Same as the raw_ostream overload, except that if \c Out supports seeking
+  /// the bitcode is flushed to it as function blocks are written, rather than
+  /// being buffered in memory until the whole module has been written.
+  void WriteBitcodeToFile(const Module *M, raw_fd_ostream &Out,
+                          bool ShouldPreserveUseListOrder = false,
+                          const ModuleSummaryIndex *Index = nullptr,
+                          bool GenerateHash = false);
+
   /// Write the specified module summary index to the given raw output stream,
   /// where it will be written in a new bitcode block. This is used when
   /// writing the combined index file for ThinLTO. When writing a subset of the
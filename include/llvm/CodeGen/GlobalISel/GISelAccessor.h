@@ -17,6 +17,8 @@
 
 namespace llvm {
 class CallLowering;
+class InstructionSelector;
+class MachineLegalizer;
 class RegisterBankInfo;
 
 /// The goal of this helper class is to gather the accessor to all
@@ -28,6 +30,12 @@ struct GISelAccessor {
   virtual ~GISelAccessor() {}
   virtual const CallLowering *getCallLowering() const { return nullptr;}
   virtual const RegisterBankInfo *getRegBankInfo() const { return nullptr;}
+  virtual const InstructionSelector *getInstructionSelector() const {
+    return nullptr;
+  }
+  virtual const MachineLegalizer *getMachineLegalizer() const {
+    return nullptr;
+  }
 };
 } // End namespace llvm;
 #endif
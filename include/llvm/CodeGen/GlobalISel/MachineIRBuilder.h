@@ -16,6 +16,7 @@
 
 #include "llvm/CodeGen/GlobalISel/Types.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/IR/DebugLoc.h"
 
@@ -115,6 +116,53 @@ public:
   MachineInstr *buildInstr(unsigned Opcode, Type *Ty, unsigned Res,
                            unsigned Op0, unsigned Op1);
 
+  /// Build and insert \p Res<def> = \p Opcode [\p Ty] \p Op0.
+  ///
+  /// \pre setBasicBlock or setMI must have been called.
+  /// \pre Ty == nullptr or isPreISelGenericOpcode(Opcode)
+  ///
+  /// \return The newly created instruction.
+  MachineInstr *buildInstr(unsigned Opcode, Type *Ty, unsigned Res,
+                           unsigned Op0);
+
+  /// Build and insert \p Res<def> = G_CONSTANT \p Ty \p Val.
+  ///
+  /// \pre setBasicBlock or setMI must have been called.
+  ///
+  /// \return The newly created instruction.
+  MachineInstr *buildConstant(Type *Ty, unsigned Res, int64_t Val);
+
+  /// Build and insert \p Res<def>, \p CarryOut<def> = G_UADDE \p Ty \p Op0,
+  /// \p Op1, \p CarryIn.
+  ///
+  /// \pre setBasicBlock or setMI must have been called.
+  ///
+  /// \return The newly created instruction.
+  MachineInstr *buildUAdde(Type *Ty, unsigned Res, unsigned CarryOut,
+                           unsigned Op0, unsigned Op1, unsigned CarryIn);
+
+  /// Build and insert `Res0<def>, ... = G_EXTRACT Ty Src, Idx0, ...`.
+  /// Each result is a register of type \p Ty, extracted from \p Src at the
+  /// corresponding bit offset in \p Indices.
+  ///
+  /// \pre setBasicBlock or setMI must have been called.
+  /// \pre Results.size() == Indices.size()
+  ///
+  /// \return The newly created instruction.
+  MachineInstr *buildExtract(Type *Ty, ArrayRef<unsigned> Results,
+                             unsigned Src, ArrayRef<uint64_t> Indices);
+
+  /// Build and insert `Res<def> = G_SEQUENCE Ty Op0, Idx0, ...`, which puts
+  /// each register in \p Ops at the corresponding bit offset in \p Indices
+  /// of the \p Ty typed result.
+  ///
+  /// \pre setBasicBlock or setMI must have been called.
+  /// \pre Ops.size() == Indices.size()
+  ///
+  /// \return The newly created instruction.
+  MachineInstr *buildSequence(Type *Ty, unsigned Res, ArrayRef<unsigned> Ops,
+                              ArrayRef<uint64_t> Indices);
+
   /// Build and insert \p Res<def> = \p Opcode \p Op0, \p Op1.
   /// I.e., instruction with a non-generic opcode.
   ///
@@ -0,0 +1,96 @@
+//== llvm/CodeGen/GlobalISel/MachineLegalizeHelper.h -------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file A pass to convert the target-illegal operations created by IR -> MIR
+/// translation into ones the target expects to be able to select. This may
+/// occur in multiple phases, for example G_ADD <2 x i8> -> G_ADD <2 x i16> ->
+/// G_ADD <4 x i16>.
+///
+/// The MachineLegalizeHelper class is where most of the work happens, and is
+/// designed to be callable from other passes that find themselves with an
+/// illegal instruction.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_GLOBALISEL_MACHINELEGALIZEHELPER_H
+#define LLVM_CODEGEN_GLOBALISEL_MACHINELEGALIZEHELPER_H
+
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+
+namespace llvm {
+// Forward declarations.
+class MachineLegalizer;
+class MachineRegisterInfo;
+class Type;
+
+class MachineLegalizeHelper {
+public:
+  enum LegalizeResult {
+    /// Instruction was already legal and no change was made to the
+    /// MachineFunction.
+    AlreadyLegal,
+
+    /// Instruction has been legalized and the MachineFunction changed.
+    Legalized,
+
+    /// Some kind of error has occurred and we could not legalize this
+    /// instruction.
+    UnableToLegalize,
+  };
+
+  MachineLegalizeHelper(MachineFunction &MF);
+
+  /// Replace \p MI by a sequence of legal instructions that can implement the
+  /// same operation, legalizing the instructions created on the way as well.
+  /// Note that this means \p MI may be deleted, so any iterator steps should
+  /// be performed before calling this function. \p Legalizer should be a
+  /// MachineLegalizer with computeTables called.
+  ///
+  /// \returns AlreadyLegal if nothing had to be done, Legalized if \p MI was
+  /// replaced by legal instructions, and UnableToLegalize if \p MI or one of
+  /// its replacements could not be legalized.
+  LegalizeResult legalizeInstr(MachineInstr &MI,
+                               const MachineLegalizer &Legalizer);
+
+  /// Apply the action the legalizer asks for \p MI once, without looking at
+  /// the instructions it creates.
+  LegalizeResult legalizeInstrStep(MachineInstr &MI,
+                                   const MachineLegalizer &Legalizer);
+
+  /// Legalize an instruction by reducing the width of the underlying scalar
+  /// type.
+  LegalizeResult narrowScalar(MachineInstr &MI, Type *NarrowTy);
+
+  /// Legalize an instruction by performing the operation on a wider scalar
+  /// type (for example i8 -> i32).
+  LegalizeResult widenScalar(MachineInstr &MI, Type *WideTy);
+
+  /// Legalize an instruction by splitting it into simpler parts, hopefully
+  /// understood by the target.
+  LegalizeResult lower(MachineInstr &MI);
+
+  /// Legalize an instruction by emitting a runtime library call instead.
+  LegalizeResult libcall(MachineInstr &MI);
+
+private:
+  /// Helper function to split a wide generic register into bitwise blocks
+  /// with the given Type (which implies the number of blocks needed). The
+  /// generic registers created are stored in VRegs, starting at bit 0 of
+  /// Reg.
+  void extractParts(unsigned Reg, Type *Ty, int NumParts,
+                    SmallVectorImpl<unsigned> &VRegs);
+
+  MachineIRBuilder MIRBuilder;
+  MachineRegisterInfo &MRI;
+};
+
+} // End namespace llvm.
+
+#endif
@@ -0,0 +1,148 @@
+//==-- llvm/CodeGen/GlobalISel/MachineLegalizer.h ----------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file Interface for Targets to specify which operations they can
+/// successfully select and how the others should be expanded most
+/// efficiently.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_GLOBALISEL_MACHINELEGALIZER_H
+#define LLVM_CODEGEN_GLOBALISEL_MACHINELEGALIZER_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/CodeGen/MachineValueType.h"
+#include "llvm/Target/TargetOpcodes.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace llvm {
+class MachineInstr;
+class MachineIRBuilder;
+class MachineRegisterInfo;
+class Type;
+
+class MachineLegalizer {
+public:
+  enum LegalizeAction : std::uint8_t {
+    /// The operation is expected to be selectable directly by the target, and
+    /// no transformation is necessary.
+    Legal,
+
+    /// The operation should be synthesized from multiple instructions acting
+    /// on a narrower scalar base-type. For example a 64-bit add might be
+    /// implemented in terms of 32-bit add-with-carry.
+    NarrowScalar,
+
+    /// The operation should be implemented in terms of a wider scalar
+    /// base-type. For example a <2 x s8> add could be implemented as a <2
+    /// x s32> add (ignoring the high bits).
+    WidenScalar,
+
+    /// The (vector) operation should be implemented by splitting it into
+    /// sub-vectors where the operation is legal. For example a <8 x s64> add
+    /// might be implemented as 4 separate <2 x s64> adds.
+    FewerElements,
+
+    /// The (vector) operation should be implemented by widening the input
+    /// vector and ignoring the lanes added by doing so. For example <2 x i8> is
+    /// rarely legal, but you might perform an <8 x i8> and then only look at
+    /// the first two results.
+    MoreElements,
+
+    /// The operation itself must be expressed in terms of simpler actions on
+    /// this target. E.g. a SREM replaced by an SDIV and subtraction.
+    Lower,
+
+    /// The operation should be implemented as a call to some kind of runtime
+    /// support library. For example this usually happens on machines that
+    /// don't support floating-point operations natively.
+    Libcall,
+
+    /// The target wants to do something special with this combination of
+    /// operand and type. A callback will be issued when it is needed.
+    Custom,
+
+    /// This operation is completely unsupported on the target. A programming
+    /// error has occurred.
+    Unsupported,
+
+    /// Sentinel value for when no action was found in the specified table.
+    NotFound,
+  };
+
+  MachineLegalizer();
+  virtual ~MachineLegalizer() {}
+
+  /// Compute any ancillary tables needed to quickly decide how an operation
+  /// should be handled. This must be called after all "set*Action" methods but
+  /// before any query is made or incorrect results may be returned.
+  void computeTables();
+
+  /// Set the action taken for \p Opcode on values of type \p Ty.
+  void setAction(unsigned Opcode, MVT Ty, LegalizeAction Action) {
+    TablesInitialized = false;
+    Actions[std::make_pair(Opcode, Ty.SimpleTy)] = Action;
+  }
+
+  /// Set the action for \p Opcode on integer types that have no explicit
+  /// entry.  By default such types are widened to the closest wider legal
+  /// integer type, or narrowed to the widest legal one if there is no wider
+  /// legal type.  Opcodes like G_BR that do not care about the type can be
+  /// made Legal for every type this way.
+  void setScalarAction(unsigned Opcode, LegalizeAction Action) {
+    assert(isPreISelGenericOpcode(Opcode) && "Generic opcode expected");
+    TablesInitialized = false;
+    DefaultActions[Opcode - FirstOp] = Action;
+  }
+
+  /// Determine what action should be taken to legalize the given generic
+  /// instruction, together with the type the instruction should be changed
+  /// to for NarrowScalar, WidenScalar, FewerElements and MoreElements.
+  ///
+  /// \returns a pair consisting of the kind of legalization that should be
+  /// performed and the destination type.
+  std::pair<LegalizeAction, MVT> getAction(unsigned Opcode, MVT Ty) const;
+  std::pair<LegalizeAction, Type *> getAction(const MachineInstr &MI) const;
+
+  bool isLegal(const MachineInstr &MI) const;
+
+  /// Called for operations marked Custom.  Rewrite \p MI through
+  /// \p MIRBuilder and return true on success.
+  virtual bool legalizeCustom(MachineInstr &MI, MachineRegisterInfo &MRI,
+                              MachineIRBuilder &MIRBuilder) const;
+
+private:
+  static const int FirstOp = TargetOpcode::PRE_ISEL_GENERIC_OPCODE_START;
+  static const int LastOp = TargetOpcode::PRE_ISEL_GENERIC_OPCODE_END;
+
+  /// Find the legal integer type closest in size to a \p SizeInBits wide
+  /// integer for \p Opcode.  Wider types are preferred over narrower ones,
+  /// unless \p Action restricts the search to one direction.
+  std::pair<LegalizeAction, MVT> findLegalScalar(unsigned Opcode,
+                                                 unsigned SizeInBits,
+                                                 LegalizeAction Action) const;
+
+  /// Explicit actions, keyed by opcode and MVT::SimpleValueType.
+  DenseMap<std::pair<unsigned, unsigned>, LegalizeAction> Actions;
+  /// Action used for integer types without an entry in Actions, or NotFound
+  /// to widen or narrow them to a legal type.
+  LegalizeAction DefaultActions[LastOp - FirstOp + 1];
+  /// For each generic opcode, the integer scalar types marked Legal, sorted
+  /// by size.  Filled in by computeTables.
+  SmallVector<MVT, 4> LegalScalars[LastOp - FirstOp + 1];
+
+  bool TablesInitialized;
+};
+
+} // End namespace llvm.
+
+#endif
@@ -30,7 +30,9 @@ class raw_pwrite_stream;
 /// factory function for the TargetMachine TMFactory. Writes OSs.size() output
 /// files to the output streams in OSs. The resulting output files if linked
 /// together are intended to be equivalent to the single output file that would
-/// have been code generated from M.
+/// have been code generated from M. If BalanceBySize is set, the partitions
+/// are balanced by their number of IR instructions, so that the threads finish
+/// at about the same time.
 ///
 /// Writes bitcode for individual partitions into output streams in BCOSs, if
 /// BCOSs is not empty.
@@ -41,7 +43,7 @@ splitCodeGen(std::unique_ptr<Module> M, ArrayRef<raw_pwrite_stream *> OSs,
              ArrayRef<llvm::raw_pwrite_stream *> BCOSs,
              const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
              TargetMachine::CodeGenFileType FT = TargetMachine::CGFT_ObjectFile,
-             bool PreserveLocals = false);
+             bool PreserveLocals = false, bool BalanceBySize = false);
 
 } // namespace llvm
 
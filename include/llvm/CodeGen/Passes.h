@@ -266,6 +266,10 @@ namespace llvm {
   /// \brief This pass implements the "patchable-function" attribute.
   extern char &PatchableFunctionID;
 
+  /// MachineOutliner - This pass replaces repeated sequences of instructions
+  /// with calls to a single outlined copy.
+  extern char &MachineOutlinerID;
+
   /// createStackProtectorPass - This pass adds stack protectors to functions.
   ///
   FunctionPass *createStackProtectorPass(const TargetMachine *TM);
@@ -18,8 +18,10 @@
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SparseMultiSet.h"
 #include "llvm/ADT/SparseSet.h"
+#include "llvm/ADT/iterator.h"
 #include "llvm/CodeGen/ScheduleDAG.h"
 #include "llvm/CodeGen/TargetSchedule.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Target/TargetRegisterInfo.h"
 #include <list>
@@ -170,11 +172,73 @@ namespace llvm {
   public:
 
     /// A list of SUnits, used in Value2SUsMap, during DAG construction.
-    /// Note: to gain speed it might be worth investigating an optimized
-    /// implementation of this data structure, such as a singly linked list
-    /// with a memory pool (SmallVector was tried but slow and SparseSet is not
-    /// applicable).
-    typedef std::list<SUnit *> SUList;
+    /// This is a singly linked list whose nodes are allocated from
+    /// SUListAllocator, and released all at once when the next region is
+    /// built (SmallVector was tried but slow and SparseSet is not applicable).
+    class SUList {
+      struct Node {
+        SUnit *SU;
+        Node *Next;
+      };
+      Node *Head = nullptr;
+      Node *Tail = nullptr;
+      unsigned Size = 0;
+
+    public:
+      class iterator
+          : public iterator_facade_base<iterator, std::forward_iterator_tag,
+                                        SUnit *> {
+        Node *N;
+
+      public:
+        explicit iterator(Node *N = nullptr) : N(N) {}
+        bool operator==(const iterator &RHS) const { return N == RHS.N; }
+        SUnit *&operator*() const { return N->SU; }
+        using iterator::iterator_facade_base::operator++;
+        iterator &operator++() {
+          N = N->Next;
+          return *this;
+        }
+      };
+
+      /// When the list has been shortened to bound the number of chain edges
+      /// added per SU, the SU that all removed SUs are ordered after.  SUs
+      /// that may depend on any of the removed SUs get a barrier edge from it
+      /// instead.
+      SUnit *Chain = nullptr;
+
+      iterator begin() const { return iterator(Head); }
+      iterator end() const { return iterator(); }
+      bool empty() const { return Size == 0; }
+      unsigned size() const { return Size; }
+      SUnit *back() const { return Tail->SU; }
+
+      void push_back(SUnit *SU, BumpPtrAllocator &Allocator) {
+        Node *N = new (Allocator.Allocate<Node>()) Node{SU, nullptr};
+        if (Tail)
+          Tail->Next = N;
+        else
+          Head = N;
+        Tail = N;
+        ++Size;
+      }
+
+      /// Remove the SUs before \p I, which come first in the list.
+      void erase_front(iterator I) {
+        while (Head && iterator(Head) != I) {
+          Head = Head->Next;
+          --Size;
+        }
+        if (!Head)
+          Tail = nullptr;
+      }
+
+      void clear() {
+        Head = Tail = nullptr;
+        Size = 0;
+        Chain = nullptr;
+      }
+    };
   protected:
     /// A map from ValueType to SUList, used during DAG construction,
     /// as a means of remembering which SUs depend on which memory
@@ -194,6 +258,8 @@ namespace llvm {
     void addChainDependencies(SUnit *SU, SUList &sus, unsigned Latency) {
       for (auto *su : sus)
         addChainDependency(SU, su, Latency);
+      if (sus.Chain)
+        sus.Chain->addPredBarrier(SU);
     }
 
     /// Add dependencies as needed from all SUs in map, to SU.
@@ -221,6 +287,9 @@ namespace llvm {
     /// For an unanalyzable memory access, this Value is used in maps.
     UndefValue *UnknownValue;
 
+    /// Storage for the nodes of the SULists of the region being built.
+    BumpPtrAllocator SUListAllocator;
+
     /// DbgValues - Remember instruction that precedes DBG_VALUE.
     /// These are generated by buildSchedGraph but persist so they can be
     /// referenced when emitting the final schedule.
@@ -446,6 +446,15 @@ public:
   /// Used for debug printing.
   uint16_t PersistentId;
 
+private:
+  /// The hash of the profile of this node while it is in the CSE map, or zero
+  /// if it has not been computed yet.
+  mutable unsigned CSEHash;
+
+  friend struct FoldingSetTrait<SDNode>;
+
+public:
+
   //===--------------------------------------------------------------------===//
   //  Accessors
   //
@@ -814,7 +823,7 @@ protected:
       : NodeType(Opc), HasDebugValue(false), SubclassData(0), NodeId(-1),
         OperandList(nullptr), ValueList(VTs.VTs), UseList(nullptr),
         NumOperands(0), NumValues(VTs.NumVTs), IROrder(Order),
-        debugLoc(std::move(dl)) {
+        debugLoc(std::move(dl)), CSEHash(0) {
     assert(debugLoc.hasTrivialDestructor() && "Expected trivial destructor");
     assert(NumValues == VTs.NumVTs &&
            "NumValues wasn't wide enough for its operands!");
@@ -824,6 +833,29 @@ protected:
   void DropOperands();
 };
 
+/// Specialize FoldingSetTrait for SDNode to remember the hash of each node in
+/// the CSE map.  Lookups then reject the other nodes of a bucket without
+/// recomputing their profile, and growing the map does not profile every node.
+template <> struct FoldingSetTrait<SDNode> : DefaultFoldingSetTrait<SDNode> {
+  static bool Equals(const SDNode &X, const FoldingSetNodeID &ID,
+                     unsigned IDHash, FoldingSetNodeID &TempID) {
+    if (X.CSEHash && X.CSEHash != IDHash)
+      return false;
+    X.Profile(TempID);
+    bool Equal = TempID == ID;
+    if (!X.CSEHash)
+      X.CSEHash = Equal ? IDHash : TempID.ComputeHash();
+    return Equal;
+  }
+  static unsigned ComputeHash(const SDNode &X, FoldingSetNodeID &TempID) {
+    if (!X.CSEHash) {
+      X.Profile(TempID);
+      X.CSEHash = TempID.ComputeHash();
+    }
+    return X.CSEHash;
+  }
+};
+
 /// Wrapper class for IR location info (IR ordering and DebugLoc) to be passed
 /// into SDNode creation functions.
 /// When an SDNode is created from the DAGBuilder, the DebugLoc is extracted
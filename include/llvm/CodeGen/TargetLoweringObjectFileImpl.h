@@ -44,6 +44,11 @@ public:
 
   ~TargetLoweringObjectFileELF() override {}
 
+  /// Emit the call graph profile into the .llvm.call-graph-profile section.
+  void emitModuleFlags(MCStreamer &Streamer,
+                       ArrayRef<Module::ModuleFlagEntry> ModuleFlags,
+                       Mangler &Mang, const TargetMachine &TM) const override;
+
   void emitPersonalityValue(MCStreamer &Streamer, const DataLayout &TM,
                             const MCSymbol *Sym) const override;
 
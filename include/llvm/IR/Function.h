@@ -66,7 +66,7 @@ private:
    * bit 3      : HasPersonalityFn
    * bits 4-13  : CallingConvention
    * bits 14    : HasGC
-   * bits 15 : [reserved]
+   * bits 15    : IsVerified
    */
 
   /// Bits from GlobalObject::GlobalObjectSubclassData.
@@ -157,13 +157,17 @@ public:
     auto ID = static_cast<unsigned>(CC);
     assert(!(ID & ~CallingConv::MaxID) && "Unsupported calling convention");
     setValueSubclassData((getSubclassDataFromValue() & 0xc00f) | (ID << 4));
+    setVerified(false);
   }
 
   /// @brief Return the attribute list for this Function.
   AttributeSet getAttributes() const { return AttributeSets; }
 
   /// @brief Set the attribute list for this Function.
-  void setAttributes(AttributeSet Attrs) { AttributeSets = Attrs; }
+  void setAttributes(AttributeSet Attrs) {
+    AttributeSets = Attrs;
+    setVerified(false);
+  }
 
   /// @brief Add function attributes to this function.
   void addFnAttr(Attribute::AttrKind N) {
@@ -195,6 +199,13 @@ public:
   /// Get the entry count for this function.
   Optional<uint64_t> getEntryCount() const;
 
+  /// Set the section prefix for this function, e.g. ".unlikely" to place it
+  /// in .text.unlikely.
+  void setSectionPrefix(StringRef Prefix);
+
+  /// Get the section prefix for this function.
+  Optional<StringRef> getSectionPrefix() const;
+
   /// @brief Return true if the function has the attribute.
   bool hasFnAttribute(Attribute::AttrKind Kind) const {
     return AttributeSets.hasFnAttribute(Kind);
@@ -573,6 +584,23 @@ public:
   Constant *getPrologueData() const;
   void setPrologueData(Constant *PrologueData);
 
+  /// \brief Check whether the verifier found this function to be valid and the
+  /// function has not been modified since.
+  ///
+  /// The flag is cleared by the IR mutation APIs: when an operand of one of its
+  /// instructions is replaced through setOperand, replaceAllUsesWith or an
+  /// operand swap, when instructions or basic blocks are inserted, removed or
+  /// moved, when instruction flags, attributes, debug locations or metadata
+  /// change, and when the function's attributes, linkage, calling convention,
+  /// personality or metadata change.  An operand assigned through its Use is
+  /// not tracked, since finding the user of a Use is not constant time; the
+  /// legacy pass managers clear the flag whenever a pass reports that it
+  /// modified the function.
+  bool isVerified() const {
+    return getSubclassDataFromValue() & (1<<15);
+  }
+  void setVerified(bool Verified) { setValueSubclassDataBit(15, Verified); }
+
   /// Print the function to an output stream with an optional
   /// AssemblyAnnotationWriter.
   void print(raw_ostream &OS, AssemblyAnnotationWriter *AAW = nullptr,
@@ -88,6 +88,11 @@ protected:
                             // the desired model?
   static const unsigned GlobalValueSubClassDataBits = 19;
 
+  /// If this is a function, drop its cached verifier result.  The verifier
+  /// checks the linkage, visibility and metadata attachments of a function
+  /// together with its body.
+  void markFunctionUnverified();
+
 private:
   // Give subclasses access to what otherwise would be wasted padding.
   // (19 + 4 + 2 + 2 + 2 + 3) == 32.
@@ -202,6 +207,7 @@ public:
     assert((!hasLocalLinkage() || V == DefaultVisibility) &&
            "local linkage requires default visibility");
     Visibility = V;
+    markFunctionUnverified();
   }
 
   /// If the value is "Thread Local", its value isn't shared by the threads.
@@ -226,7 +232,10 @@ public:
   bool hasDLLExportStorageClass() const {
     return DllStorageClass == DLLExportStorageClass;
   }
-  void setDLLStorageClass(DLLStorageClassTypes C) { DllStorageClass = C; }
+  void setDLLStorageClass(DLLStorageClassTypes C) {
+    DllStorageClass = C;
+    markFunctionUnverified();
+  }
 
   bool hasSection() const { return !getSection().empty(); }
   StringRef getSection() const;
@@ -401,6 +410,7 @@ public:
     if (isLocalLinkage(LT))
       Visibility = DefaultVisibility;
     Linkage = LT;
+    markFunctionUnverified();
   }
   LinkageTypes getLinkage() const { return LinkageTypes(Linkage); }
 
@@ -73,6 +73,10 @@ public:
   const Function *getFunction() const;
   Function *getFunction();
 
+  /// Record that the function containing this instruction, if any, has been
+  /// modified, so that a cached verifier result for it is discarded.
+  void markFunctionUnverified();
+
   /// This method unlinks 'this' from the containing basic block, but does not
   /// delete it.
   void removeFromParent();
@@ -223,7 +227,10 @@ public:
   bool extractProfMetadata(uint64_t &TrueVal, uint64_t &FalseVal);
 
   /// Set the debug location information for this instruction.
-  void setDebugLoc(DebugLoc Loc) { DbgLoc = std::move(Loc); }
+  void setDebugLoc(DebugLoc Loc) {
+    DbgLoc = std::move(Loc);
+    markFunctionUnverified();
+  }
 
   /// Return the debug location for this node as a DebugLoc.
   const DebugLoc &getDebugLoc() const { return DbgLoc; }
@@ -532,6 +539,8 @@ protected:
   void setInstructionSubclassData(unsigned short D) {
     assert((D & HasMetadataBit) == 0 && "Out of range value put into field");
     setValueSubclassData((getSubclassDataFromValue() & HasMetadataBit) | D);
+    if (Parent)
+      markFunctionUnverified();
   }
 
   unsigned getSubclassDataFromInstruction() const {
@@ -1615,7 +1615,10 @@ public:
 
   /// setAttributes - Set the parameter attributes for this call.
   ///
-  void setAttributes(const AttributeSet &Attrs) { AttributeList = Attrs; }
+  void setAttributes(const AttributeSet &Attrs) {
+    AttributeList = Attrs;
+    markFunctionUnverified();
+  }
 
   /// addAttribute - adds the attribute to the list of attributes.
   void addAttribute(unsigned i, Attribute::AttrKind Kind);
@@ -2657,6 +2660,15 @@ public:
     return getIncomingValue(Idx);
   }
 
+  /// shrinkToFit - Release the operand space that was reserved for incoming
+  /// values but is not in use.  Useful once a PHI node is complete, since
+  /// addIncoming grows the operand list geometrically.
+  void shrinkToFit();
+
+  /// getNumReservedOperands - Return the number of incoming values the operand
+  /// list has room for without growing.
+  unsigned getNumReservedOperands() const { return ReservedSpace; }
+
   /// hasConstantValue - If the specified PHI node always merges together the
   /// same value, return the value, otherwise return null.
   Value *hasConstantValue() const;
@@ -3247,6 +3259,15 @@ public:
   /// including the case_end() iterator.
   void removeCase(CaseIt i);
 
+  /// Release the operand space that was reserved for cases but is not in use.
+  /// addCase grows the operand list geometrically, so this is worth calling
+  /// once a switch built up case by case is complete.
+  void shrinkToFit();
+
+  /// Return the number of operands the operand list has room for without
+  /// growing.  Each case takes two operands.
+  unsigned getNumReservedOperands() const { return ReservedSpace; }
+
   unsigned getNumSuccessors() const { return getNumOperands()/2; }
   BasicBlock *getSuccessor(unsigned idx) const {
     assert(idx < getNumSuccessors() &&"Successor idx out of range for switch!");
@@ -3583,7 +3604,10 @@ public:
 
   /// setAttributes - Set the parameter attributes for this invoke.
   ///
-  void setAttributes(const AttributeSet &Attrs) { AttributeList = Attrs; }
+  void setAttributes(const AttributeSet &Attrs) {
+    AttributeList = Attrs;
+    markFunctionUnverified();
+  }
 
   /// addAttribute - adds the attribute to the list of attributes.
   void addAttribute(unsigned i, Attribute::AttrKind Kind);
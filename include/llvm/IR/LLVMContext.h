@@ -26,6 +26,7 @@ class Twine;
 class Instruction;
 class Module;
 class MDString;
+class SharedMDStringPool;
 class DICompositeType;
 class SMDiagnostic;
 class DiagnosticInfo;
@@ -69,6 +70,7 @@ public:
     MD_align = 17,                    // "align"
     MD_loop = 18,                     // "llvm.loop"
     MD_type = 19,                     // "type"
+    MD_section_prefix = 20,           // "section_prefix"
   };
 
   /// Known operand bundle tag IDs, which always have the same value.  All
@@ -124,6 +126,12 @@ public:
   void enableDebugTypeODRUniquing();
   void disableDebugTypeODRUniquing();
 
+  /// Unique MDStrings in \p Pool, which may be shared with other contexts,
+  /// instead of in a table owned by this context.  Must be called before the
+  /// context creates any MDString, and \p Pool must outlive the context.
+  void setSharedMDStringPool(SharedMDStringPool *Pool);
+  SharedMDStringPool *getSharedMDStringPool() const;
+
   typedef void (*InlineAsmDiagHandlerTy)(const SMDiagnostic&, void *Context,
                                          unsigned LocCookie);
 
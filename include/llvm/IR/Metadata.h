@@ -567,6 +567,7 @@ dyn_extract_or_null(Y &&MD) {
 /// MDString is always unnamed.
 class MDString : public Metadata {
   friend class StringMapEntry<MDString>;
+  friend class SharedMDStringPool;
 
   MDString(const MDString &) = delete;
   MDString &operator=(MDString &&) = delete;
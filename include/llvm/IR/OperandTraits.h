@@ -143,6 +143,7 @@ void CLASS::setOperand(unsigned i_nocapture, VALUECLASS *Val_nocapture) { \
   assert(i_nocapture < OperandTraits<CLASS>::operands(this) \
          && "setOperand() out of range!"); \
   OperandTraits<CLASS>::op_begin(this)[i_nocapture] = Val_nocapture; \
+  this->markInstructionUnverified(); \
 } \
 unsigned CLASS::getNumOperands() const { \
   return OperandTraits<CLASS>::operands(this); \
@@ -0,0 +1,61 @@
+//===- llvm/IR/SharedMDStringPool.h - MDStrings shared by contexts -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares SharedMDStringPool, a thread-safe uniquing table for
+// MDStrings that several LLVMContexts can use at the same time.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IR_SHAREDMDSTRINGPOOL_H
+#define LLVM_IR_SHAREDMDSTRINGPOOL_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Mutex.h"
+
+namespace llvm {
+
+/// \brief A thread-safe table of uniqued MDStrings.
+///
+/// Unlike types and constants, an MDString neither refers to its LLVMContext
+/// nor has a use list, so once created it is immutable and can be handed out
+/// to contexts living on different threads.  Contexts that parse the same
+/// inputs (e.g. parallel code generation or ThinLTO backends) can opt in with
+/// LLVMContext::setSharedMDStringPool() to share names and other debug info
+/// strings instead of each keeping their own copy.
+///
+/// The table is split into shards, each protected by its own lock, so that
+/// concurrent lookups of different strings rarely contend.  The pool must
+/// outlive every context that uses it.
+class SharedMDStringPool {
+  enum { NumShards = 16 };
+
+  struct Shard {
+    sys::Mutex Lock;
+    StringMap<MDString, BumpPtrAllocator> Strings;
+  };
+  Shard Shards[NumShards];
+
+  SharedMDStringPool(const SharedMDStringPool &) = delete;
+  void operator=(const SharedMDStringPool &) = delete;
+
+public:
+  SharedMDStringPool() = default;
+
+  /// \brief Return the uniqued MDString for \p Str, creating it if needed.
+  MDString *get(StringRef Str);
+
+  /// \brief Return the number of distinct strings in the pool.
+  size_t size();
+};
+
+} // end namespace llvm
+
+#endif
@@ -46,6 +46,10 @@ class User : public Value {
   allocateFixedOperandUser(size_t, unsigned, unsigned);
 
 protected:
+  /// If this is an instruction, drop the cached verifier result of the
+  /// function containing it.  Called whenever an operand is replaced.
+  void markInstructionUnverified();
+
   /// Allocate a User with an operand pointer co-allocated.
   ///
   /// This is used for subclasses which need to allocate a variable number
@@ -87,6 +91,11 @@ protected:
   /// should be called if there are no uses.
   void growHungoffUses(unsigned N, bool IsPhi = false);
 
+  /// \brief Release any reserved but unused hung off uses, so that exactly
+  /// getNumOperands() uses remain allocated.  \p OldNumReserved is the number
+  /// of uses the current allocation was made for.
+  void shrinkHungoffUses(unsigned OldNumReserved, bool IsPhi = false);
+
 public:
   ~User() override {
   }
@@ -141,6 +150,7 @@ public:
             isa<GlobalValue>((const Value*)this)) &&
            "Cannot mutate a constant with setOperand!");
     getOperandList()[i] = Val;
+    markInstructionUnverified();
   }
   const Use &getOperandUse(unsigned i) const {
     assert(i < NumUserOperands && "getOperandUse() out of range!");
@@ -49,6 +49,10 @@ bool verifyFunction(const Function &F, raw_ostream *OS = nullptr);
 /// supplied, DebugInfo verification failures won't be considered as
 /// error and instead *BrokenDebugInfo will be set to true. Debug
 /// info errors can be "recovered" from by stripping the debug info.
+///
+/// Every function is checked, whether or not Function::isVerified() is set.
+/// Only the verifier pass skips functions that have not changed since it last
+/// verified them.
 bool verifyModule(const Module &M, raw_ostream *OS = nullptr,
                   bool *BrokenDebugInfo = nullptr);
 
@@ -131,6 +131,14 @@ struct LTOCodeGenerator {
   /// Calls \a verifyMergedModuleOnce().
   bool writeMergedModules(const char *Path);
 
+  /// Write the symbol names of the functions in the call graph profile of the
+  /// merged module to the file specified by the given path, one per line and
+  /// in the order they should be laid out by the linker.  Return true on
+  /// success.
+  ///
+  /// This should be called after  optimize(), which records the profile.
+  bool writeFunctionOrderFile(const char *Path);
+
   /// Compile the merged module into a *single* output file; the path to output
   /// file is returned to the caller via argument "name". Return true on
   /// success.
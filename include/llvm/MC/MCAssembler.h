@@ -174,9 +174,10 @@ private:
   bool fragmentNeedsRelaxation(const MCRelaxableFragment *IF,
                                const MCAsmLayout &Layout) const;
 
-  /// \brief Perform one layout iteration and return true if any offsets
-  /// were adjusted.
-  bool layoutOnce(MCAsmLayout &Layout);
+  /// \brief Relax the sections until no offsets are adjusted anymore.  A
+  /// section is only laid out again when relaxation changed it, or changed a
+  /// section that the expressions of its relaxable fragments refer to.
+  void relaxSections(MCAsmLayout &Layout);
 
   /// \brief Perform one layout iteration of the given section and return true
   /// if any offsets were adjusted.
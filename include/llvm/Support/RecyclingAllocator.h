@@ -51,6 +51,14 @@ public:
   template<class SubClass>
   void Deallocate(SubClass* E) { return Base.Deallocate(Allocator, E); }
 
+  /// Reset - Release all the objects at once, without recycling them one by
+  /// one. The wrapped allocator must support Reset().
+  ///
+  void Reset() {
+    Base.clear(Allocator);
+    Allocator.Reset();
+  }
+
   void PrintStats() {
     Allocator.PrintStats();
     Base.PrintStats();
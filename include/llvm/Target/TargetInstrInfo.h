@@ -1437,6 +1437,47 @@ public:
     return None;
   }
 
+  /// Represents how an instruction should be mapped by the MachineOutliner.
+  /// \p Legal instructions are those which are safe to outline.
+  /// \p Illegal instructions are those which cannot be outlined.
+  /// \p Invisible instructions are instructions which can be outlined, but
+  /// shouldn't actually impact the outlining result, such as debug values.
+  enum MachineOutlinerInstrType { Legal, Illegal, Invisible };
+
+  /// Return true if the MachineOutliner may outline instructions from \p MF.
+  virtual bool isFunctionSafeToOutlineFrom(const MachineFunction &MF) const {
+    return false;
+  }
+
+  /// Return how the MachineOutliner should treat \p MI.
+  virtual MachineOutlinerInstrType
+  getOutliningType(const MachineInstr &MI) const {
+    return Illegal;
+  }
+
+  /// Return the number of instructions needed to call an outlined sequence.
+  virtual unsigned getOutliningCallOverhead() const { return 1; }
+
+  /// Return the number of instructions needed to return from an outlined
+  /// sequence.
+  virtual unsigned getOutliningFrameOverhead() const { return 1; }
+
+  /// Insert a call to the outlined sequence starting at \p Body before \p It
+  /// in \p MBB, and return the call instruction.
+  virtual MachineBasicBlock::iterator
+  insertOutlinedCall(MachineBasicBlock &MBB, MachineBasicBlock::iterator It,
+                     MachineBasicBlock &Body) const {
+    llvm_unreachable("Target didn't implement insertOutlinedCall!");
+  }
+
+  /// Turn \p Body, which holds a copy of an outlined sequence, into the
+  /// target of the calls inserted by insertOutlinedCall. This adds the return
+  /// at the end, and anything the unwind info needs to describe the return
+  /// address the call pushed.
+  virtual void buildOutlinedFrame(MachineBasicBlock &Body) const {
+    llvm_unreachable("Target didn't implement buildOutlinedFrame!");
+  }
+
 private:
   unsigned CallFrameSetupOpcode, CallFrameDestroyOpcode;
   unsigned CatchRetOpcode;
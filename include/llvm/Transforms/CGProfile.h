@@ -0,0 +1,32 @@
+//===- Transforms/CGProfile.h - Call graph profile ---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file provides the interface for reading the call graph profile that
+/// the cg-profile pass records in the "CG Profile" module flag.  Each entry of
+/// the flag is a node !{caller, callee, i64 count}.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_CGPROFILE_H
+#define LLVM_TRANSFORMS_CGPROFILE_H
+
+#include <vector>
+
+namespace llvm {
+class Function;
+class Module;
+
+/// Order the functions named by the call graph profile of \p M so that hot
+/// callers and callees end up next to each other, using the call-chain
+/// clustering (C3) heuristic.  Functions that are not in the profile are not
+/// included in the result.
+std::vector<const Function *> getCallGraphProfileOrder(const Module &M);
+
+} // End llvm namespace
+
+#endif
@@ -17,10 +17,13 @@
 #ifndef LLVM_TRANSFORMS_IPO_INLINERPASS_H
 #define LLVM_TRANSFORMS_IPO_INLINERPASS_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
+#include <memory>
 
 namespace llvm {
 class AssumptionCacheTracker;
+class BlockFrequencyInfo;
 class CallSite;
 class DataLayout;
 class InlineCost;
@@ -33,6 +36,7 @@ template <class PtrType, unsigned SmallSize> class SmallPtrSet;
 struct Inliner : public CallGraphSCCPass {
   explicit Inliner(char &ID);
   explicit Inliner(char &ID, bool InsertLifetime);
+  ~Inliner() override;
 
   /// getAnalysisUsage - For this class, we declare that we require and preserve
   /// the call graph.  If the derived class implements this method, it should
@@ -84,9 +88,18 @@ private:
   bool shouldBeDeferred(Function *Caller, CallSite CS, InlineCost IC,
                         int &TotalAltCost);
 
+  /// The block frequencies of the profiled functions, computed on demand and
+  /// kept up to date by InlineFunction as callees get inlined.
+  struct CallerProfile;
+  DenseMap<Function *, std::unique_ptr<CallerProfile>> CallerProfiles;
+
 protected:
   AssumptionCacheTracker *ACT;
   ProfileSummaryInfo *PSI;
+
+  /// Return the block frequencies of \p F, or null if it has no profile to
+  /// scale them with.
+  BlockFrequencyInfo *getProfileBFI(Function &F);
 };
 
 } // End llvm namespace
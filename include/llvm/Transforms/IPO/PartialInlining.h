@@ -8,7 +8,8 @@
 //===----------------------------------------------------------------------===//
 //
 // This pass performs partial inlining, typically by inlining an if statement
-// that surrounds the body of the function.
+// that surrounds the body of the function, or the hot part of a function whose
+// profile shows cold regions.
 //
 //===----------------------------------------------------------------------===//
 
@@ -19,14 +20,19 @@
 #include "llvm/IR/PassManager.h"
 
 namespace llvm {
+class ProfileSummaryInfo;
 
 /// Pass to remove unused function declarations.
 class PartialInlinerPass : public PassInfoMixin<PartialInlinerPass> {
 public:
-  PreservedAnalyses run(Module &M, ModuleAnalysisManager &);
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+
+  // Glue for old PM.
+  bool runImpl(Module &M, ProfileSummaryInfo &PSI);
 
 private:
   Function *unswitchFunction(Function *F);
+  bool outlineColdRegions(Function *F, ProfileSummaryInfo &PSI);
 };
 }
 #endif // LLVM_TRANSFORMS_IPO_PARTIALINLINING_H
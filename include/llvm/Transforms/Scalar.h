@@ -145,6 +145,13 @@ Pass *createLICMPass();
 //
 Pass *createLoopInterchangePass();
 
+//===----------------------------------------------------------------------===//
+//
+// LoopTiling - This pass tiles perfect loop nests to fit the data they touch
+// in the data cache.
+//
+FunctionPass *createLoopTilingPass();
+
 //===----------------------------------------------------------------------===//
 //
 // LoopStrengthReduce - This pass is strength reduces GEP instructions that use
@@ -474,6 +481,13 @@ FunctionPass *createFloat2IntPass();
 //
 FunctionPass *createNaryReassociatePass();
 
+//===----------------------------------------------------------------------===//
+//
+// NewGVN - Global value numbering with congruence classes, using MemorySSA to
+// number loads and memory phis.
+//
+FunctionPass *createNewGVNPass();
+
 //===----------------------------------------------------------------------===//
 //
 // LoopDistribute - Distribute loops.
@@ -483,6 +497,12 @@ FunctionPass *createNaryReassociatePass();
 // llvm.loop.distribute.enable metadata data override this default.
 FunctionPass *createLoopDistributePass(bool ProcessAllLoopsByDefault);
 
+//===----------------------------------------------------------------------===//
+//
+// LoopFuse - Fuse adjacent loops with the same trip count.
+//
+FunctionPass *createLoopFusePass();
+
 //===----------------------------------------------------------------------===//
 //
 // LoopLoadElimination - Perform loop-aware load elimination.
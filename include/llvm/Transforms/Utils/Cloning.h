@@ -46,6 +46,7 @@ class Loop;
 class LoopInfo;
 class AllocaInst;
 class AssumptionCacheTracker;
+class BlockFrequencyInfo;
 class DominatorTree;
 
 /// Return an exact copy of the specified module
@@ -176,14 +177,21 @@ void CloneAndPruneFunctionInto(Function *NewFunc, const Function *OldFunc,
 class InlineFunctionInfo {
 public:
   explicit InlineFunctionInfo(CallGraph *cg = nullptr,
-                              AssumptionCacheTracker *ACT = nullptr)
-      : CG(cg), ACT(ACT) {}
+                              AssumptionCacheTracker *ACT = nullptr,
+                              BlockFrequencyInfo *CallerBFI = nullptr,
+                              BlockFrequencyInfo *CalleeBFI = nullptr)
+      : CG(cg), ACT(ACT), CallerBFI(CallerBFI), CalleeBFI(CalleeBFI) {}
 
   /// CG - If non-null, InlineFunction will update the callgraph to reflect the
   /// changes it makes.
   CallGraph *CG;
   AssumptionCacheTracker *ACT;
 
+  /// If CallerBFI is non-null, InlineFunction gives the blocks it adds to the
+  /// caller a frequency: that of the call site, scaled by the frequency of the
+  /// original block relative to the callee entry if CalleeBFI is non-null.
+  BlockFrequencyInfo *CallerBFI, *CalleeBFI;
+
   /// StaticAllocas - InlineFunction fills this in with all static allocas that
   /// get copied into the caller.
   SmallVector<AllocaInst *, 4> StaticAllocas;
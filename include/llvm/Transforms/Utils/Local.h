@@ -311,6 +311,14 @@ void removeUnwindEdge(BasicBlock *BB);
 /// Returns true if any basic block was removed.
 bool removeUnreachableBlocks(Function &F, LazyValueInfo *LVI = nullptr);
 
+/// Release the operand space that PHI nodes and switches in \p F have reserved
+/// but no longer use, e.g. because incoming values or cases were removed.
+///
+/// This does not change the IR, but it reallocates the operand lists, so no
+/// pointers to their Uses may be held across the call.  Returns the number of
+/// operand slots that were released.
+unsigned shrinkHungoffOperandLists(Function &F);
+
 /// Combine the metadata of two instructions so that K can replace J
 ///
 /// Metadata not listed as known via KnownIDs is removed
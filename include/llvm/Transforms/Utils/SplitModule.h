@@ -34,10 +34,15 @@ class StringRef;
 ///   module.
 /// - Internal symbols defined in module-level inline asm should be visible to
 ///   each partition.
+///
+/// If BalanceBySize is true, every definition is assigned to a partition so
+/// that the partitions contain about the same number of IR instructions.
+/// Otherwise globals that are not required to stay together are placed by a
+/// hash of their name.
 void SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals = false);
+    bool PreserveLocals = false, bool BalanceBySize = false);
 
 } // End llvm namespace
 
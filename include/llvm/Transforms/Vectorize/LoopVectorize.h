@@ -97,6 +97,15 @@ struct LoopVectorizePass : public PassInfoMixin<LoopVectorizePass> {
                std::function<const LoopAccessInfo &(Loop &)> &GetLAA_);
 
   bool processLoop(Loop *L);
+
+  /// Vectorize the loop nest of \p L, whose only sub-loop is innermost,
+  /// along \p L.
+  bool processOuterLoop(Loop *L);
+
+  /// Vectorize \p L, the remainder loop left by vectorizing it, with a factor
+  /// of at most \p MaxVF chosen by the cost model. Return the factor used, or
+  /// 0 if the remainder loop is left scalar.
+  unsigned vectorizeEpilogue(Loop *L, unsigned MaxVF);
 };
 }
 
@@ -605,8 +605,14 @@ bool AAResultsWrapperPass::runOnFunction(Function &F) {
     AAR->addAAResult(WrapperPass->getResult());
   if (auto *WrapperPass = getAnalysisIfAvailable<SCEVAAWrapperPass>())
     AAR->addAAResult(WrapperPass->getResult());
-  if (auto *WrapperPass = getAnalysisIfAvailable<CFLAndersAAWrapperPass>())
+  if (auto *WrapperPass = getAnalysisIfAvailable<CFLAndersAAWrapperPass>()) {
+    // The results are computed again whenever a pass did not preserve them,
+    // which is the only hint the legacy pass manager gives that F may have
+    // changed. CFL-Anders caches what it knows about F across functions, so
+    // drop that, along with the callers built from it.
+    WrapperPass->getResult().evict(&F);
     AAR->addAAResult(WrapperPass->getResult());
+  }
   if (auto *WrapperPass = getAnalysisIfAvailable<CFLSteensAAWrapperPass>())
     AAR->addAAResult(WrapperPass->getResult());
 
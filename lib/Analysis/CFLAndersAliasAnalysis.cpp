@@ -16,6 +16,17 @@
 // precise analysis result. The precision of this analysis is roughly the same
 // as that of an one level context-sensitive Andersen's algorithm.
 //
+// The assignments, loads and stores of the CFLGraph of a function become the
+// copy, load and store constraints of a points-to problem over abstract memory
+// objects: the allocas and allocation calls of the function, the globals, the
+// memory reachable from each argument, and a single object for memory the
+// function knows nothing about. Interprocedural aliasing is handled bottom-up:
+// each function gets an AliasSummary from its solution, which is cached and
+// instantiated at the call sites of its callers.
+//
+// Solving a function is given a budget; functions that exceed it are answered
+// with MayAlias, and their calls are treated as opaque in their callers.
+//
 //===----------------------------------------------------------------------===//
 
 // N.B. AliasAnalysis as a whole is phrased as a FunctionPass at the moment, and
@@ -26,19 +37,622 @@
 
 #include "llvm/Analysis/CFLAndersAliasAnalysis.h"
 #include "CFLGraph.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SparseBitVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 using namespace llvm::cflaa;
 
 #define DEBUG_TYPE "cfl-anders-aa"
 
-CFLAndersAAResult::CFLAndersAAResult() = default;
+STATISTIC(NumFunctionsSolved, "Number of functions solved by CFL-Anders");
+STATISTIC(NumFunctionsOverBudget,
+          "Number of functions CFL-Anders gave up on for their size");
+
+static cl::opt<unsigned> MaxSolverWork(
+    "cfl-anders-max-work", cl::init(200000), cl::Hidden,
+    cl::desc("Maximum number of propagation steps CFL-Anders spends on a "
+             "function before giving up on it"));
+
+/// The number of levels of memory below each argument and return value that
+/// summaries describe. Memory further down is treated as unknown.
+static const unsigned MaxInterfaceLevel = 3;
+
+namespace {
+/// The kinds of abstract memory objects pointers are resolved to.
+enum class ObjectKind : uint8_t {
+  /// Memory allocated by the function: an alloca or an allocation call.
+  Local,
+  /// A global value.
+  Global,
+  /// Memory the caller reaches through an argument, at some level.
+  Caller,
+  /// Memory the function knows nothing about.
+  Unknown
+};
+
+/// The points-to problem of a function. Each node is a pointer value, or the
+/// contents of an abstract object, and holds the set of objects it may point
+/// to.
+class ConstraintSolver {
+  struct Node {
+    SparseBitVector<> PointsTo;
+    /// The objects of PointsTo whose loads and stores are wired up already.
+    SparseBitVector<> Wired;
+    /// Nodes whose points-to set includes this one's.
+    SmallVector<unsigned, 4> Copies;
+    /// Nodes loaded from and stored to memory this node points to.
+    SmallVector<unsigned, 2> Loads;
+    SmallVector<unsigned, 2> Stores;
+  };
+
+  struct Object {
+    ObjectKind Kind;
+    /// The node of what the object holds.
+    unsigned Contents;
+  };
+
+  std::vector<Node> Nodes;
+  std::vector<Object> Objects;
+  DenseSet<std::pair<unsigned, unsigned>> CopyEdges;
+  DenseMap<unsigned, unsigned> DerefNodes;
+  SmallVector<unsigned, 32> Worklist;
+  BitVector InWorklist;
+  unsigned Work = 0;
+
+  void push(unsigned N) {
+    if (N >= InWorklist.size())
+      InWorklist.resize(std::max<size_t>(Nodes.size(), 2 * N));
+    if (!InWorklist.test(N)) {
+      InWorklist.set(N);
+      Worklist.push_back(N);
+    }
+  }
+
+public:
+  unsigned createNode() {
+    Nodes.emplace_back();
+    return Nodes.size() - 1;
+  }
+
+  unsigned createObject(ObjectKind Kind) {
+    Objects.push_back(Object{Kind, createNode()});
+    return Objects.size() - 1;
+  }
+
+  ObjectKind getKind(unsigned O) const { return Objects[O].Kind; }
+  unsigned getNumObjects() const { return Objects.size(); }
+  unsigned getContents(unsigned O) const { return Objects[O].Contents; }
+  const SparseBitVector<> &getPointsTo(unsigned N) const {
+    return Nodes[N].PointsTo;
+  }
+
+  void addPointsTo(unsigned N, unsigned O) {
+    if (Nodes[N].PointsTo.test_and_set(O))
+      push(N);
+  }
+
+  void addCopy(unsigned From, unsigned To) {
+    if (From == To || !CopyEdges.insert(std::make_pair(From, To)).second)
+      return;
+    Nodes[From].Copies.push_back(To);
+    if (Nodes[To].PointsTo |= Nodes[From].PointsTo)
+      push(To);
+  }
+
+  void addLoad(unsigned Ptr, unsigned Dest) {
+    Nodes[Ptr].Loads.push_back(Dest);
+    for (unsigned O : Nodes[Ptr].Wired)
+      addCopy(Objects[O].Contents, Dest);
+  }
+
+  void addStore(unsigned Ptr, unsigned Src) {
+    Nodes[Ptr].Stores.push_back(Src);
+    for (unsigned O : Nodes[Ptr].Wired)
+      addCopy(Src, Objects[O].Contents);
+  }
+
+  /// Return a node for the memory \p Level dereferences below \p N, which is
+  /// both loaded from and stored to through the level above.
+  unsigned getDerefNode(unsigned N, unsigned Level) {
+    for (; Level; --Level) {
+      auto It = DerefNodes.find(N);
+      if (It != DerefNodes.end()) {
+        N = It->second;
+        continue;
+      }
+      unsigned Deref = createNode();
+      DerefNodes[N] = Deref;
+      addLoad(N, Deref);
+      addStore(N, Deref);
+      N = Deref;
+    }
+    return N;
+  }
+
+  /// Propagate points-to sets to a fixed point. Return false if this takes
+  /// more than the budget.
+  bool solve() {
+    while (!Worklist.empty()) {
+      unsigned N = Worklist.pop_back_val();
+      InWorklist.reset(N);
+      if (++Work > MaxSolverWork)
+        return false;
+
+      SparseBitVector<> New = Nodes[N].PointsTo;
+      New.intersectWithComplement(Nodes[N].Wired);
+      Nodes[N].Wired |= New;
+      for (unsigned O : New) {
+        unsigned Contents = Objects[O].Contents;
+        for (unsigned I = 0; I != Nodes[N].Loads.size(); ++I)
+          addCopy(Contents, Nodes[N].Loads[I]);
+        for (unsigned I = 0; I != Nodes[N].Stores.size(); ++I)
+          addCopy(Nodes[N].Stores[I], Contents);
+        Work += Nodes[N].Loads.size() + Nodes[N].Stores.size();
+      }
+
+      for (unsigned I = 0; I != Nodes[N].Copies.size(); ++I) {
+        unsigned Succ = Nodes[N].Copies[I];
+        if (Nodes[Succ].PointsTo |= Nodes[N].PointsTo)
+          push(Succ);
+      }
+    }
+    return true;
+  }
+
+  /// Add to \p Set the objects reachable through memory from them.
+  void closeOverContents(SparseBitVector<> &Set) const {
+    SmallVector<unsigned, 16> Pending;
+    for (unsigned O : Set)
+      Pending.push_back(O);
+    while (!Pending.empty()) {
+      unsigned O = Pending.pop_back_val();
+      for (unsigned Pointee : Nodes[Objects[O].Contents].PointsTo)
+        if (Set.test_and_set(Pointee))
+          Pending.push_back(Pointee);
+    }
+  }
+};
+} // end anonymous namespace
+
+/// Information we have about a function and would like to keep around.
+class CFLAndersAAResult::FunctionInfo {
+  /// The objects each pointer value of the function may point to.
+  DenseMap<const Value *, SparseBitVector<>> PointsTo;
+  /// The objects that may be memory the caller or unknown code can reach,
+  /// and so may be accessed through pointers the function knows nothing about.
+  SparseBitVector<> External;
+  /// The objects standing for memory the function knows nothing about.
+  SparseBitVector<> Opaque;
+  /// The objects of globals.
+  SparseBitVector<> Globals;
+  AliasSummary Summary;
+  /// Whether the function was solved within the budget.
+  bool Solved = false;
+
+public:
+  FunctionInfo(Function &Fn, CFLAndersAAResult &Analysis,
+               const TargetLibraryInfo &TLI);
+
+  const AliasSummary *getAliasSummary() const {
+    return Solved ? &Summary : nullptr;
+  }
+
+  AliasResult alias(const Value *A, const Value *B) const;
+};
+
+/// Returns true if a call to \p Fn uses its summary rather than being treated
+/// as opaque by CFLGraphBuilder.
+static bool hasUsableSummary(ImmutableCallSite CS,
+                             CFLAndersAAResult &Analysis) {
+  auto *Fn = const_cast<Function *>(CS.getCalledFunction());
+  return Fn && Fn->hasExactDefinition() && !Fn->isVarArg() &&
+         CS.arg_size() <= MaxSupportedArgsInSummary &&
+         Analysis.getAliasSummary(*Fn);
+}
+
+/// Returns true if \p Ty is an aggregate or vector type a pointer may be
+/// packed in, out of the sight of CFLGraph.
+static bool mayHidePointers(Type *Ty) {
+  return Ty->isAggregateType() || Ty->isVectorTy();
+}
+
+CFLAndersAAResult::FunctionInfo::FunctionInfo(Function &Fn,
+                                              CFLAndersAAResult &Analysis,
+                                              const TargetLibraryInfo &TLI) {
+  CFLGraphBuilder<CFLAndersAAResult> GraphBuilder(Analysis, TLI, Fn);
+  const CFLGraph &Graph = GraphBuilder.getCFLGraph();
+  ConstraintSolver Solver;
+
+  DenseMap<const Value *, unsigned> ValueNodes;
+  auto GetNode = [&](const Value *V) {
+    auto Ins = ValueNodes.insert(std::make_pair(V, 0u));
+    if (Ins.second)
+      Ins.first->second = Solver.createNode();
+    return Ins.first->second;
+  };
+
+  unsigned Unknown = Solver.createObject(ObjectKind::Unknown);
+  Solver.addPointsTo(Solver.getContents(Unknown), Unknown);
+  auto CreateObject = [&](ObjectKind Kind, bool HoldsUnknown) {
+    unsigned O = Solver.createObject(Kind);
+    if (HoldsUnknown)
+      Solver.addPointsTo(Solver.getContents(O), Unknown);
+    return O;
+  };
+
+  // Each pointer argument points to a chain of objects of the caller's, one
+  // for each level of memory below it that summaries describe.
+  SmallVector<SmallVector<unsigned, MaxInterfaceLevel>, 8> CallerObjects(
+      Fn.arg_size());
+  for (Argument &Arg : Fn.args()) {
+    if (!Arg.getType()->isPointerTy())
+      continue;
+    auto &Chain = CallerObjects[Arg.getArgNo()];
+    for (unsigned Level = 0; Level != MaxInterfaceLevel; ++Level)
+      Chain.push_back(CreateObject(ObjectKind::Caller,
+                                   Level + 1 == MaxInterfaceLevel));
+    for (unsigned Level = 0; Level + 1 != MaxInterfaceLevel; ++Level)
+      Solver.addPointsTo(Solver.getContents(Chain[Level]), Chain[Level + 1]);
+  }
+
+  // Seed the points-to sets and turn the edges of the graph into constraints.
+  SmallVector<unsigned, 16> EscapeRoots;
+  for (Value *V : Graph.nodes()) {
+    unsigned N = GetNode(V);
+    AliasAttrs Attr = Graph.attrFor(V);
+    if (isa<GlobalValue>(V))
+      Solver.addPointsTo(N, CreateObject(ObjectKind::Global, true));
+    else if (auto *Arg = dyn_cast<Argument>(V)) {
+      if (Arg->getType()->isPointerTy())
+        Solver.addPointsTo(N, CallerObjects[Arg->getArgNo()][0]);
+    } else if (isa<AllocaInst>(V) || isMallocLikeFn(V, &TLI) ||
+               isCallocLikeFn(V, &TLI))
+      Solver.addPointsTo(N, CreateObject(ObjectKind::Local, false));
+    else if (isNoAliasCall(V))
+      Solver.addPointsTo(N, CreateObject(ObjectKind::Local, true));
+    if (hasUnknownAttr(Attr))
+      Solver.addPointsTo(N, Unknown);
+    if (hasEscapedAttr(Attr))
+      EscapeRoots.push_back(N);
+
+    for (const auto &Edge : Graph.edgesFor(V)) {
+      if (Edge.Reversed)
+        continue;
+      unsigned Other = GetNode(Edge.Other);
+      switch (Edge.Type) {
+      case EdgeType::Assign:
+        Solver.addCopy(N, Other);
+        break;
+      case EdgeType::Dereference:
+        Solver.addStore(N, Other);
+        break;
+      case EdgeType::Reference:
+        Solver.addLoad(Other, N);
+        break;
+      }
+    }
+  }
+
+  for (const auto &Relation : GraphBuilder.getInstantiatedRelations()) {
+    unsigned From = Solver.getDerefNode(GetNode(Relation.From.Val),
+                                        Relation.From.DerefLevel);
+    unsigned To =
+        Solver.getDerefNode(GetNode(Relation.To.Val), Relation.To.DerefLevel);
+    Solver.addCopy(From, To);
+    Solver.addCopy(To, From);
+  }
+
+  // The caller attributes of arguments are modelled by their objects.
+  for (const auto &IPAttr : GraphBuilder.getInstantiatedAttrs()) {
+    AliasAttrs Attr = IPAttr.Attr;
+    bool IsUnknown = hasUnknownAttr(Attr) || isGlobalOrArgAttr(Attr);
+    if (!IsUnknown && !hasEscapedAttr(Attr))
+      continue;
+    unsigned N = Solver.getDerefNode(GetNode(IPAttr.IValue.Val),
+                                     IPAttr.IValue.DerefLevel);
+    if (IsUnknown)
+      Solver.addPointsTo(N, Unknown);
+    if (hasEscapedAttr(Attr))
+      EscapeRoots.push_back(N);
+  }
+
+  // CFLGraph does not follow pointers through aggregates and vectors, nor
+  // through memory read as something else than a pointer: treat those as
+  // escaping. Pointers coming out of them, and out of opaque calls that only
+  // read memory, are unknown.
+  for (Instruction &I : instructions(Fn)) {
+    if (auto *LI = dyn_cast<LoadInst>(&I)) {
+      if (!LI->getType()->isPointerTy())
+        EscapeRoots.push_back(
+            Solver.getDerefNode(GetNode(LI->getPointerOperand()), 1));
+    } else if (isa<AtomicCmpXchgInst>(I) || isa<AtomicRMWInst>(I)) {
+      EscapeRoots.push_back(Solver.getDerefNode(
+          GetNode(I.getOperand(0)), 1));
+    } else if ((isa<ExtractValueInst>(I) || isa<ExtractElementInst>(I)) &&
+               I.getType()->isPointerTy()) {
+      Solver.addPointsTo(GetNode(&I), Unknown);
+    } else if (auto CS = CallSite(&I)) {
+      if (!I.getType()->isPointerTy() || !CS.onlyReadsMemory() ||
+          isNoAliasCall(&I) || hasUsableSummary(CS, Analysis))
+        continue;
+      for (unsigned ArgNo = 0, E = CS.arg_size(); ArgNo != E; ++ArgNo) {
+        Value *Arg = CS.getArgument(ArgNo);
+        if (!Arg->getType()->isPointerTy())
+          continue;
+        unsigned N = GetNode(Arg);
+        if (!CS.doesNotCapture(ArgNo))
+          EscapeRoots.push_back(N);
+        EscapeRoots.push_back(Solver.getDerefNode(N, 1));
+      }
+    }
+    if (mayHidePointers(I.getType()))
+      for (Value *Op : I.operands())
+        if (Op->getType()->isPointerTy())
+          EscapeRoots.push_back(GetNode(Op));
+  }
+
+  // Solve, then let unknown code write to the local objects that escape, and
+  // solve again until no more of them escape.
+  SparseBitVector<> EscapedToUnknown, Escaped, Callers;
+  for (unsigned O = 0, E = Solver.getNumObjects(); O != E; ++O)
+    if (Solver.getKind(O) == ObjectKind::Caller)
+      Callers.set(O);
+  SparseBitVector<> HoldsUnknown;
+  while (true) {
+    if (!Solver.solve()) {
+      DEBUG(dbgs() << "CFLAndersAA: over budget on " << Fn.getName() << '\n');
+      ++NumFunctionsOverBudget;
+      return;
+    }
+
+    EscapedToUnknown.clear();
+    for (unsigned N : EscapeRoots)
+      EscapedToUnknown |= Solver.getPointsTo(N);
+    for (unsigned O = 0, E = Solver.getNumObjects(); O != E; ++O)
+      if (Solver.getKind(O) == ObjectKind::Global ||
+          Solver.getKind(O) == ObjectKind::Unknown)
+        EscapedToUnknown |= Solver.getPointsTo(Solver.getContents(O));
+    Solver.closeOverContents(EscapedToUnknown);
+
+    Escaped = EscapedToUnknown;
+    Escaped |= Callers;
+    for (Value *RetVal : GraphBuilder.getReturnValues())
+      Escaped |= Solver.getPointsTo(GetNode(RetVal));
+    Solver.closeOverContents(Escaped);
+
+    bool Changed = false;
+    for (unsigned O : Escaped)
+      if (Solver.getKind(O) == ObjectKind::Local &&
+          HoldsUnknown.test_and_set(O)) {
+        Solver.addPointsTo(Solver.getContents(O), Unknown);
+        Changed = true;
+      }
+    if (!Changed)
+      break;
+  }
+  ++NumFunctionsSolved;
+  Solved = true;
+
+  for (unsigned O = 0, E = Solver.getNumObjects(); O != E; ++O) {
+    switch (Solver.getKind(O)) {
+    case ObjectKind::Local:
+      if (Escaped.test(O))
+        External.set(O);
+      break;
+    case ObjectKind::Global:
+      Globals.set(O);
+      External.set(O);
+      break;
+    case ObjectKind::Caller:
+    case ObjectKind::Unknown:
+      Opaque.set(O);
+      External.set(O);
+      break;
+    }
+  }
+  for (const auto &Mapping : ValueNodes)
+    if (!Solver.getPointsTo(Mapping.second).empty())
+      PointsTo[Mapping.first] = Solver.getPointsTo(Mapping.second);
+
+  // Historically, an arbitrary upper-bound of 50 args was selected. We may want
+  // to remove this if it doesn't really matter in practice.
+  if (Fn.arg_size() > MaxSupportedArgsInSummary)
+    return;
+
+  // Describe the memory below the arguments and the return value, level by
+  // level. Interface values that may hold the same object are related to the
+  // first one found holding it. Objects the caller does not know of make
+  // their holders unknown to it.
+  DenseMap<unsigned, InterfaceValue> Holders;
+  DenseSet<std::pair<unsigned, unsigned>> RelatedLevels;
+  auto AddInterfaceValue = [&](unsigned Index, SparseBitVector<> Level) {
+    for (unsigned DerefLevel = 0;
+         DerefLevel != MaxInterfaceLevel && !Level.empty(); ++DerefLevel) {
+      InterfaceValue IValue{Index, DerefLevel};
+      bool IsUnknown = false, IsEscaped = false;
+      SparseBitVector<> Below;
+      for (unsigned O : Level) {
+        IsUnknown |= Solver.getKind(O) != ObjectKind::Caller;
+        IsEscaped |= EscapedToUnknown.test(O);
+        Below |= Solver.getPointsTo(Solver.getContents(O));
+
+        auto Ins = Holders.insert(std::make_pair(O, IValue));
+        InterfaceValue Holder = Ins.first->second;
+        if (Holder == IValue)
+          continue;
+        unsigned From = Index * MaxInterfaceLevel + DerefLevel;
+        unsigned To = Holder.Index * MaxInterfaceLevel + Holder.DerefLevel;
+        if (RelatedLevels.insert(std::make_pair(From, To)).second)
+          Summary.RetParamRelations.push_back(ExternalRelation{IValue, Holder});
+      }
+      AliasAttrs Attr = getAttrNone();
+      if (IsUnknown)
+        Attr |= getAttrUnknown();
+      if (IsEscaped)
+        Attr |= getAttrEscaped();
+      if (Attr.any())
+        Summary.RetParamAttributes.push_back(ExternalAttribute{IValue, Attr});
+      Level = std::move(Below);
+    }
+  };
+
+  for (Argument &Arg : Fn.args())
+    if (Arg.getType()->isPointerTy())
+      AddInterfaceValue(Arg.getArgNo() + 1,
+                        Solver.getPointsTo(GetNode(&Arg)));
+  SparseBitVector<> Returned;
+  for (Value *RetVal : GraphBuilder.getReturnValues())
+    Returned |= Solver.getPointsTo(GetNode(RetVal));
+  AddInterfaceValue(0, std::move(Returned));
+}
+
+AliasResult CFLAndersAAResult::FunctionInfo::alias(const Value *A,
+                                                   const Value *B) const {
+  if (!Solved)
+    return MayAlias;
+  auto ItA = PointsTo.find(A);
+  auto ItB = PointsTo.find(B);
+  if (ItA == PointsTo.end() || ItB == PointsTo.end())
+    return MayAlias;
+
+  // Pointers to a common object may alias. Otherwise, a pointer to memory the
+  // function knows nothing about may alias any memory the outside world may
+  // reach, and two globals may be aliases of each other. Local objects that
+  // do not escape are fully modelled.
+  const SparseBitVector<> &SetA = ItA->second;
+  const SparseBitVector<> &SetB = ItB->second;
+  if (SetA.intersects(SetB))
+    return MayAlias;
+  if ((SetA.intersects(Opaque) && SetB.intersects(External)) ||
+      (SetB.intersects(Opaque) && SetA.intersects(External)))
+    return MayAlias;
+  if (SetA.intersects(Globals) && SetB.intersects(Globals))
+    return MayAlias;
+  return NoAlias;
+}
+
+CFLAndersAAResult::CFLAndersAAResult(const TargetLibraryInfo &TLI)
+    : AAResultBase(), TLI(TLI) {}
+CFLAndersAAResult::CFLAndersAAResult(CFLAndersAAResult &&Arg)
+    : AAResultBase(std::move(Arg)), TLI(Arg.TLI) {}
+CFLAndersAAResult::~CFLAndersAAResult() {}
+
+bool CFLAndersAAResult::invalidate(Function &, const PreservedAnalyses &PA) {
+  return !PA.preserved(CFLAndersAA::ID());
+}
+
+/// Try to go from a Value* to a Function*. Never returns nullptr.
+static Optional<Function *> parentFunctionOfValue(const Value *Val) {
+  if (auto *Inst = dyn_cast<Instruction>(Val))
+    return const_cast<Function *>(Inst->getParent()->getParent());
+  if (auto *Arg = dyn_cast<Argument>(Val))
+    return const_cast<Function *>(Arg->getParent());
+  return None;
+}
+
+CFLAndersAAResult::FunctionInfo CFLAndersAAResult::buildInfoFrom(Function *Fn) {
+  BuildStack.push_back(Fn);
+  FunctionInfo Info(*Fn, *this, TLI);
+  BuildStack.pop_back();
+  return Info;
+}
+
+void CFLAndersAAResult::scan(Function *Fn) {
+  auto InsertPair = Cache.insert(std::make_pair(Fn, Optional<FunctionInfo>()));
+  (void)InsertPair;
+  assert(InsertPair.second &&
+         "Trying to scan a function that has already been cached");
+
+  // Note that we can't do Cache[Fn] = buildInfoFrom(Fn) here: the function call
+  // may get evaluated after operator[], potentially triggering a DenseMap
+  // resize and invalidating the reference returned by operator[]
+  auto FunInfo = buildInfoFrom(Fn);
+  Cache[Fn] = std::move(FunInfo);
+
+  Handles.push_front(FunctionHandle(Fn, this));
+}
+
+void CFLAndersAAResult::evict(Function *Fn) {
+  // A function being built has nothing to drop yet; its callers will be built
+  // from its summary when it is done.
+  auto It = Cache.find(Fn);
+  if (It == Cache.end() || !It->second.hasValue())
+    return;
+  Cache.erase(It);
+
+  auto DepIt = Dependents.find(Fn);
+  if (DepIt == Dependents.end())
+    return;
+  SmallPtrSet<Function *, 4> Callers = std::move(DepIt->second);
+  Dependents.erase(DepIt);
+  for (Function *Caller : Callers)
+    evict(Caller);
+}
+
+/// Ensures that the given function is available in the cache, and returns the
+/// entry.
+const Optional<CFLAndersAAResult::FunctionInfo> &
+CFLAndersAAResult::ensureCached(Function *Fn) {
+  auto Iter = Cache.find(Fn);
+  if (Iter == Cache.end()) {
+    scan(Fn);
+    Iter = Cache.find(Fn);
+    assert(Iter != Cache.end());
+    assert(Iter->second.hasValue());
+  }
+  return Iter->second;
+}
+
+const AliasSummary *CFLAndersAAResult::getAliasSummary(Function &Fn) {
+  // Remember who used the summary, so that they are evicted with it.
+  if (!BuildStack.empty())
+    Dependents[&Fn].insert(BuildStack.back());
+
+  auto &FunInfo = ensureCached(&Fn);
+  if (FunInfo.hasValue())
+    return FunInfo->getAliasSummary();
+  return nullptr;
+}
+
+AliasResult CFLAndersAAResult::query(const MemoryLocation &LocA,
+                                     const MemoryLocation &LocB) {
+  auto *ValA = LocA.Ptr;
+  auto *ValB = LocB.Ptr;
+
+  if (!ValA->getType()->isPointerTy() || !ValB->getType()->isPointerTy())
+    return NoAlias;
+
+  auto MaybeFnA = parentFunctionOfValue(ValA);
+  auto MaybeFnB = parentFunctionOfValue(ValB);
+  if (!MaybeFnA.hasValue() && !MaybeFnB.hasValue()) {
+    // The only times this is known to happen are when globals + InlineAsm are
+    // involved
+    DEBUG(dbgs()
+          << "CFLAndersAA: could not extract parent function information.\n");
+    return MayAlias;
+  }
+  Function *Fn = MaybeFnA.hasValue() ? *MaybeFnA : *MaybeFnB;
+  if (MaybeFnA.hasValue() && MaybeFnB.hasValue() && *MaybeFnA != *MaybeFnB)
+    return MayAlias;
+
+  auto &MaybeInfo = ensureCached(Fn);
+  assert(MaybeInfo.hasValue());
+  return MaybeInfo->alias(ValA, ValB);
+}
 
 char CFLAndersAA::PassID;
 
 CFLAndersAAResult CFLAndersAA::run(Function &F, AnalysisManager<Function> &AM) {
-  return CFLAndersAAResult();
+  return CFLAndersAAResult(AM.getResult<TargetLibraryAnalysis>(F));
 }
 
 char CFLAndersAAWrapperPass::ID = 0;
@@ -53,8 +667,12 @@ CFLAndersAAWrapperPass::CFLAndersAAWrapperPass() : ImmutablePass(ID) {
   initializeCFLAndersAAWrapperPassPass(*PassRegistry::getPassRegistry());
 }
 
-void CFLAndersAAWrapperPass::initializePass() {}
+void CFLAndersAAWrapperPass::initializePass() {
+  auto &TLIWP = getAnalysis<TargetLibraryInfoWrapperPass>();
+  Result.reset(new CFLAndersAAResult(TLIWP.getTLI()));
+}
 
 void CFLAndersAAWrapperPass::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesAll();
+  AU.addRequired<TargetLibraryInfoWrapperPass>();
 }
@@ -56,6 +56,10 @@ class CFLGraph {
   struct Edge {
     EdgeType Type;
     Node Other;
+    /// Every edge is kept at both of its ends. This is set on the copy kept
+    /// at the node the edge was added to, with the weight flipped, so that
+    /// analyses that care about the direction of the flow can recover it.
+    bool Reversed;
   };
 
   typedef std::vector<Edge> EdgeList;
@@ -121,8 +125,8 @@ public:
     auto *ToInfo = getNode(To);
     assert(ToInfo != nullptr);
 
-    FromInfo->Edges.push_back(Edge{Type, To});
-    ToInfo->Edges.push_back(Edge{flipWeight(Type), From});
+    FromInfo->Edges.push_back(Edge{Type, To, false});
+    ToInfo->Edges.push_back(Edge{flipWeight(Type), From, true});
   }
 
   AliasAttrs attrFor(Node N) const {
@@ -410,17 +414,23 @@ template <typename CFLAA> class CFLGraphBuilder {
       // readonly or readnone), and that the result could alias just about
       // anything, too (unless the result is marked noalias).
       if (!CS.onlyReadsMemory())
-        for (Value *V : CS.args()) {
+        for (unsigned ArgNo = 0, E = CS.arg_size(); ArgNo != E; ++ArgNo) {
+          Value *V = CS.getArgument(ArgNo);
           if (V->getType()->isPointerTy()) {
-            // The argument itself escapes.
-            addNodeWithAttr(V, getAttrEscaped());
+            // The argument itself escapes, unless the callee promises not to
+            // capture it; what it points to may be copied elsewhere though.
+            AliasAttrs PointeeAttr = getAttrUnknown();
+            if (CS.doesNotCapture(ArgNo))
+              PointeeAttr |= getAttrEscaped();
+            else
+              addNodeWithAttr(V, getAttrEscaped());
             // The fate of argument memory is unknown. Note that since
             // AliasAttrs
             // is transitive with respect to dereference, we only need to
             // specify
             // it for the first-level memory.
             InstantiatedAttrs.push_back(
-                InstantiatedAttr{InstantiatedValue{V, 1}, getAttrUnknown()});
+                InstantiatedAttr{InstantiatedValue{V, 1}, PointeeAttr});
           }
         }
 
@@ -126,6 +126,11 @@ bool CGPassManager::RunPassOnSCC(Pass *P, CallGraphSCC &CurSCC,
       TimeRegion PassTimer(getPassTimer(CGSP));
       Changed = CGSP->runOnSCC(CurSCC);
     }
+
+    if (Changed)
+      for (CallGraphNode *CGN : CurSCC)
+        if (Function *F = CGN->getFunction())
+          F->setVerified(false);
     
     // After the CGSCCPass is done, when assertions are enabled, use
     // RefreshCallGraph to verify that the callgraph was correctly updated.
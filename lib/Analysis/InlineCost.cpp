@@ -18,6 +18,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
 #include "llvm/Analysis/CodeMetrics.h"
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/InstructionSimplify.h"
@@ -31,6 +32,7 @@
 #include "llvm/IR/InstVisitor.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Operator.h"
+#include "llvm/Support/BranchProbability.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -66,6 +68,20 @@ static cl::opt<int> ColdThreshold(
     "inlinecold-threshold", cl::Hidden, cl::init(225),
     cl::desc("Threshold for inlining functions with cold attribute"));
 
+static cl::opt<int>
+    HotCallSiteThreshold("hot-callsite-threshold", cl::Hidden, cl::init(3000),
+                         cl::ZeroOrMore,
+                         cl::desc("Threshold for inlining hot callsites"));
+
+static cl::opt<int> ColdCallSiteThreshold(
+    "inline-cold-callsite-threshold", cl::Hidden, cl::init(45),
+    cl::desc("Threshold for inlining cold callsites"));
+
+static cl::opt<unsigned> ColdCallSiteRelFreq(
+    "cold-callsite-rel-freq", cl::Hidden, cl::init(2), cl::ZeroOrMore,
+    cl::desc("Maximum block frequency of a callsite, as a percentage of the "
+             "entry frequency of its caller, for the callsite to be cold"));
+
 namespace {
 
 class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
@@ -81,6 +97,9 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
   /// Profile summary information.
   ProfileSummaryInfo *PSI;
 
+  /// The profiled block frequencies of the caller, if any.
+  BlockFrequencyInfo *CallerBFI;
+
   // The called function.
   Function &F;
 
@@ -158,6 +177,10 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
   /// analysis.
   void updateThreshold(CallSite CS, Function &Callee);
 
+  /// Scale Threshold by how often the callsite runs, according to the
+  /// profile of the caller.
+  void updateThresholdForCallSiteProfile(CallSite CS, Function &Caller);
+
   /// Return true if size growth is allowed when inlining the callee at CS.
   bool allowSizeGrowth(CallSite CS);
 
@@ -204,9 +227,10 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
 
 public:
   CallAnalyzer(const TargetTransformInfo &TTI, AssumptionCacheTracker *ACT,
-               ProfileSummaryInfo *PSI, Function &Callee, int Threshold,
-               CallSite CSArg)
-      : TTI(TTI), ACT(ACT), PSI(PSI), F(Callee), CandidateCS(CSArg),
+               ProfileSummaryInfo *PSI, BlockFrequencyInfo *CallerBFI,
+               Function &Callee, int Threshold, CallSite CSArg)
+      : TTI(TTI), ACT(ACT), PSI(PSI), CallerBFI(CallerBFI), F(Callee),
+        CandidateCS(CSArg),
         Threshold(Threshold), Cost(0), IsCallerRecursive(false),
         IsRecursiveCall(false), ExposesReturnsTwice(false),
         HasDynamicAlloca(false), ContainsNoDuplicateCall(false),
@@ -650,11 +674,66 @@ void CallAnalyzer::updateThreshold(CallSite CS, Function &Callee) {
       ColdCallee && ColdThreshold < Threshold)
     Threshold = ColdThreshold;
 
+  updateThresholdForCallSiteProfile(CS, *Caller);
+
   // Finally, take the target-specific inlining threshold multiplier into
   // account.
   Threshold *= TTI.getInliningThresholdMultiplier();
 }
 
+void CallAnalyzer::updateThresholdForCallSiteProfile(CallSite CS,
+                                                     Function &Caller) {
+  if (!CallerBFI)
+    return;
+  BasicBlock *CallSiteBB = CS.getInstruction()->getParent();
+  Optional<uint64_t> Count = CallerBFI->getBlockProfileCount(CallSiteBB);
+  if (!Count)
+    return;
+
+  uint64_t EntryFreq = CallerBFI->getEntryFreq();
+  uint64_t CallSiteFreq = CallerBFI->getBlockFreq(CallSiteBB).getFrequency();
+  // Known blocks have a frequency of at least one. A block created after the
+  // frequencies were computed, and not given one since, is left alone.
+  if (!EntryFreq || !CallSiteFreq)
+    return;
+
+  // Like the cold callee threshold, an explicit -inline-threshold overrides
+  // the callsite thresholds that are not given explicitly as well.
+  bool ExplicitThreshold = DefaultInlineThreshold.getNumOccurrences() > 0;
+
+  // A callsite that rarely runs when its caller does is not worth the code
+  // growth, whatever the callee.
+  if (PSI->isColdCount(*Count) ||
+      CallSiteFreq <
+          BranchProbability(ColdCallSiteRelFreq, 100).scale(EntryFreq)) {
+    if (!ExplicitThreshold || ColdCallSiteThreshold.getNumOccurrences() > 0)
+      Threshold = std::min<int>(Threshold, ColdCallSiteThreshold);
+    return;
+  }
+  if (Caller.optForMinSize() ||
+      (ExplicitThreshold && HotCallSiteThreshold.getNumOccurrences() == 0))
+    return;
+
+  // A callsite that is hot across the program gets the hot callsite
+  // threshold. Otherwise, one that runs more often than its caller, in a loop,
+  // gets a bonus in proportion to how much more often.
+  if (PSI->isHotCount(*Count)) {
+    Threshold = std::max<int>(Threshold, HotCallSiteThreshold);
+    return;
+  }
+  if (CallSiteFreq <= EntryFreq || Threshold <= 0 ||
+      Threshold >= HotCallSiteThreshold)
+    return;
+  uint64_t Ratio = CallSiteFreq / EntryFreq;
+  uint64_t Scaled = HotCallSiteThreshold;
+  if (Ratio < uint64_t(HotCallSiteThreshold))
+    Scaled = Threshold * Ratio +
+             BranchProbability::getBranchProbability(CallSiteFreq % EntryFreq,
+                                                     EntryFreq)
+                 .scale(Threshold);
+  Threshold = std::min<uint64_t>(Scaled, HotCallSiteThreshold);
+}
+
 bool CallAnalyzer::visitCmpInst(CmpInst &I) {
   Value *LHS = I.getOperand(0), *RHS = I.getOperand(1);
   // First try to handle simplified comparisons.
@@ -950,8 +1029,8 @@ bool CallAnalyzer::visitCallSite(CallSite CS) {
   // during devirtualization and so we want to give it a hefty bonus for
   // inlining, but cap that bonus in the event that inlining wouldn't pan
   // out. Pretend to inline the function, with a custom threshold.
-  CallAnalyzer CA(TTI, ACT, PSI, *F, InlineConstants::IndirectCallThreshold,
-                  CS);
+  CallAnalyzer CA(TTI, ACT, PSI, nullptr, *F,
+                  InlineConstants::IndirectCallThreshold, CS);
   if (CA.analyzeCall(CS)) {
     // We were able to inline the indirect call! Subtract the cost from the
     // threshold to get the bonus we want to apply, but don't go below zero.
@@ -1440,9 +1519,10 @@ static bool functionsHaveCompatibleAttributes(Function *Caller,
 InlineCost llvm::getInlineCost(CallSite CS, int DefaultThreshold,
                                TargetTransformInfo &CalleeTTI,
                                AssumptionCacheTracker *ACT,
-                               ProfileSummaryInfo *PSI) {
+                               ProfileSummaryInfo *PSI,
+                               BlockFrequencyInfo *CallerBFI) {
   return getInlineCost(CS, CS.getCalledFunction(), DefaultThreshold, CalleeTTI,
-                       ACT, PSI);
+                       ACT, PSI, CallerBFI);
 }
 
 int llvm::computeThresholdFromOptLevels(unsigned OptLevel,
@@ -1462,7 +1542,8 @@ InlineCost llvm::getInlineCost(CallSite CS, Function *Callee,
                                int DefaultThreshold,
                                TargetTransformInfo &CalleeTTI,
                                AssumptionCacheTracker *ACT,
-                               ProfileSummaryInfo *PSI) {
+                               ProfileSummaryInfo *PSI,
+                               BlockFrequencyInfo *CallerBFI) {
 
   // Cannot inline indirect calls.
   if (!Callee)
@@ -1496,7 +1577,8 @@ InlineCost llvm::getInlineCost(CallSite CS, Function *Callee,
   DEBUG(llvm::dbgs() << "      Analyzing call of " << Callee->getName()
                      << "...\n");
 
-  CallAnalyzer CA(CalleeTTI, ACT, PSI, *Callee, DefaultThreshold, CS);
+  CallAnalyzer CA(CalleeTTI, ACT, PSI, CallerBFI, *Callee, DefaultThreshold,
+                  CS);
   bool ShouldInline = CA.analyzeCall(CS);
 
   DEBUG(CA.dump());
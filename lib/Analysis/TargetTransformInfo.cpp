@@ -237,6 +237,16 @@ unsigned TargetTransformInfo::getCacheLineSize() const {
   return TTIImpl->getCacheLineSize();
 }
 
+Optional<unsigned>
+TargetTransformInfo::getCacheSize(CacheLevel Level) const {
+  return TTIImpl->getCacheSize(Level);
+}
+
+Optional<unsigned>
+TargetTransformInfo::getCacheAssociativity(CacheLevel Level) const {
+  return TTIImpl->getCacheAssociativity(Level);
+}
+
 unsigned TargetTransformInfo::getPrefetchDistance() const {
   return TTIImpl->getPrefetchDistance();
 }
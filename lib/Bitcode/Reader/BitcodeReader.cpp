@@ -36,6 +36,7 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <deque>
 #include <utility>
@@ -47,11 +48,40 @@ static cl::opt<bool> PrintSummaryGUIDs(
     cl::desc(
         "Print the global id for each value when reading the module summary"));
 
+static cl::opt<unsigned> BitcodeDecodeThreads(
+    "bitcode-decode-threads", cl::init(0), cl::Hidden,
+    cl::desc("Number of threads decoding function blocks ahead of their "
+             "materialization when the whole module is read (0 = none)"));
+
 namespace {
 enum {
   SWITCH_INST_MAGIC = 0x4B5 // May 2012 => 1205 => Hex
 };
 
+/// The records of a FUNCTION_BLOCK, read from the bitstream without creating
+/// any IR.  Nested blocks are not decoded; only their position is kept so
+/// that parseFunctionBody can parse them in place.  Decoding does not touch
+/// the value or metadata lists, so it can run on another thread while the
+/// reader materializes earlier functions.
+struct DecodedFunctionBlock {
+  struct Entry {
+    /// The entry as returned by advance(), except that the ID of a record is
+    /// its record code rather than its abbreviation ID.
+    BitstreamEntry E;
+    /// For a nested block, the bit just after its block ID.
+    uint64_t BitNo;
+    /// For a record, its operands in Ops.
+    unsigned OpsBegin, OpsEnd;
+  };
+  std::vector<Entry> Entries;
+  std::vector<uint64_t> Ops;
+  /// Set if the block is malformed.  Such a block is parsed again from the
+  /// stream so that the usual diagnostics are reported.
+  bool Failed = false;
+
+  void decode(BitstreamReader &Reader, uint64_t BitNo);
+};
+
 class BitcodeReaderValueList {
   std::vector<WeakVH> ValuePtrs;
 
@@ -276,6 +306,14 @@ class BitcodeReader : public GVMaterializer {
 
   bool StripDebugInfo = false;
 
+  /// True if the bitcode is read from a DataStreamer, which cannot be read
+  /// from more than one thread.
+  bool IsStreamed = false;
+
+  /// The decoded body of the next function to be materialized, if it was
+  /// decoded ahead of time by materializeWithDecodeThreads.
+  std::pair<Function *, DecodedFunctionBlock *> PredecodedBody;
+
   /// Functions that need to be matched with subprograms when upgrading old
   /// metadata.
   SmallDenseMap<Function *, DISubprogram *, 16> FunctionsWithSPs;
@@ -436,7 +474,9 @@ private:
   std::error_code rememberAndSkipFunctionBody();
   /// Save the positions of the Metadata blocks and skip parsing the blocks.
   std::error_code rememberAndSkipMetadata();
-  std::error_code parseFunctionBody(Function *F);
+  std::error_code parseFunctionBody(Function *F,
+                                    DecodedFunctionBlock *Decoded = nullptr);
+  std::error_code materializeWithDecodeThreads(unsigned NumThreads);
   std::error_code globalCleanup();
   std::error_code resolveGlobalAndIndirectSymbolInits();
   std::error_code parseMetadata(bool ModuleLevel = false);
@@ -4278,8 +4318,49 @@ static std::error_code typeCheckLoadStoreInst(Type *ValType, Type *PtrType) {
 }
 
 /// Lazily parse the specified function body block.
-std::error_code BitcodeReader::parseFunctionBody(Function *F) {
-  if (Stream.EnterSubBlock(bitc::FUNCTION_BLOCK_ID))
+void DecodedFunctionBlock::decode(BitstreamReader &Reader, uint64_t BitNo) {
+  BitstreamCursor Cursor(Reader);
+  Cursor.JumpToBit(BitNo);
+  if (Cursor.EnterSubBlock(bitc::FUNCTION_BLOCK_ID)) {
+    Failed = true;
+    return;
+  }
+
+  SmallVector<uint64_t, 64> Record;
+  while (1) {
+    BitstreamEntry Entry = Cursor.advance();
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      Failed = true;
+      return;
+    case BitstreamEntry::EndBlock:
+      Entries.push_back({Entry, 0, 0, 0});
+      return;
+    case BitstreamEntry::SubBlock:
+      Entries.push_back({Entry, Cursor.GetCurrentBitNo(), 0, 0});
+      if (Cursor.SkipBlock()) {
+        Failed = true;
+        return;
+      }
+      continue;
+    case BitstreamEntry::Record:
+      break;
+    }
+
+    Record.clear();
+    unsigned Code = Cursor.readRecord(Entry.ID, Record);
+    unsigned OpsBegin = Ops.size();
+    Ops.insert(Ops.end(), Record.begin(), Record.end());
+    Entries.push_back(
+        {BitstreamEntry::getRecord(Code), 0, OpsBegin, (unsigned)Ops.size()});
+  }
+}
+
+/// Parse the function block that Stream is positioned at, or replay the
+/// records in \p Decoded if the block was decoded ahead of time.
+std::error_code
+BitcodeReader::parseFunctionBody(Function *F, DecodedFunctionBlock *Decoded) {
+  if (!Decoded && Stream.EnterSubBlock(bitc::FUNCTION_BLOCK_ID))
     return error("Invalid record");
 
   // Unexpected unresolved metadata when parsing function.
@@ -4312,8 +4393,18 @@ std::error_code BitcodeReader::parseFunctionBody(Function *F) {
 
   // Read all the records.
   SmallVector<uint64_t, 64> Record;
+  const DecodedFunctionBlock::Entry *DecodedEntry = nullptr;
+  if (Decoded)
+    DecodedEntry = Decoded->Entries.data();
   while (1) {
-    BitstreamEntry Entry = Stream.advance();
+    BitstreamEntry Entry;
+    if (Decoded) {
+      Entry = DecodedEntry->E;
+      if (Entry.Kind == BitstreamEntry::SubBlock)
+        Stream.JumpToBit(DecodedEntry->BitNo);
+      ++DecodedEntry;
+    } else
+      Entry = Stream.advance();
 
     switch (Entry.Kind) {
     case BitstreamEntry::Error:
@@ -4359,7 +4450,13 @@ std::error_code BitcodeReader::parseFunctionBody(Function *F) {
     // Read a record.
     Record.clear();
     Instruction *I = nullptr;
-    unsigned BitCode = Stream.readRecord(Entry.ID, Record);
+    unsigned BitCode;
+    if (Decoded) {
+      BitCode = Entry.ID;
+      Record.append(Decoded->Ops.begin() + DecodedEntry[-1].OpsBegin,
+                    Decoded->Ops.begin() + DecodedEntry[-1].OpsEnd);
+    } else
+      BitCode = Stream.readRecord(Entry.ID, Record);
     switch (BitCode) {
     default: // Default behavior: reject
       return error("Invalid value");
@@ -5605,10 +5702,16 @@ std::error_code BitcodeReader::materialize(GlobalValue *GV) {
   if (std::error_code EC = materializeMetadata())
     return EC;
 
+  // Use the body decoded by materializeWithDecodeThreads if there is one.
+  DecodedFunctionBlock *Decoded = nullptr;
+  if (PredecodedBody.first == F && !PredecodedBody.second->Failed)
+    Decoded = PredecodedBody.second;
+  PredecodedBody = std::make_pair(nullptr, nullptr);
+
   // Move the bit stream to the saved position of the deferred function body.
   Stream.JumpToBit(DFII->second);
 
-  if (std::error_code EC = parseFunctionBody(F))
+  if (std::error_code EC = parseFunctionBody(F, Decoded))
     return EC;
   F->setIsMaterializable(false);
 
@@ -5651,9 +5754,14 @@ std::error_code BitcodeReader::materializeModule() {
 
   // Iterate over the module, deserializing any functions that are still on
   // disk.
-  for (Function &F : *TheModule) {
-    if (std::error_code EC = materialize(&F))
+  if (BitcodeDecodeThreads && !IsStreamed) {
+    if (std::error_code EC = materializeWithDecodeThreads(BitcodeDecodeThreads))
       return EC;
+  } else {
+    for (Function &F : *TheModule) {
+      if (std::error_code EC = materialize(&F))
+        return EC;
+    }
   }
   // At this point, if there are any function bodies, parse the rest of
   // the bits in the module past the last function block we have recorded
@@ -5699,6 +5807,64 @@ std::error_code BitcodeReader::materializeModule() {
   return std::error_code();
 }
 
+/// Materialize every function in the module, decoding the function blocks on
+/// \p NumThreads worker threads ahead of the function being materialized.
+///
+/// Only the bitstream decoding runs in parallel.  Building the IR stays on
+/// this thread: it resolves operands through the shared value and metadata
+/// lists, and adds uses to constants and globals whose use lists are not
+/// thread-safe.
+std::error_code
+BitcodeReader::materializeWithDecodeThreads(unsigned NumThreads) {
+  // Functions whose body has not been found yet are located by scanning the
+  // stream, which moves the reader's cursor, so leave those to materialize.
+  std::vector<std::pair<Function *, uint64_t>> Bodies;
+  for (Function &F : *TheModule) {
+    if (!F.isMaterializable())
+      continue;
+    auto DFII = DeferredFunctionInfo.find(&F);
+    if (DFII != DeferredFunctionInfo.end() && DFII->second)
+      Bodies.push_back(std::make_pair(&F, DFII->second));
+  }
+
+  // Keep a bounded number of decoded blocks alive at any time.
+  std::vector<std::unique_ptr<DecodedFunctionBlock>> Blocks(Bodies.size());
+  std::vector<std::shared_future<ThreadPool::VoidTy>> Pending(Bodies.size());
+  const size_t Window = 4 * NumThreads;
+  ThreadPool Pool(NumThreads);
+  BitstreamReader &Reader = *StreamFile;
+  auto Submit = [&](size_t I) {
+    Blocks[I] = llvm::make_unique<DecodedFunctionBlock>();
+    DecodedFunctionBlock *Block = Blocks[I].get();
+    uint64_t BitNo = Bodies[I].second;
+    Pending[I] = Pool.async([Block, &Reader, BitNo] {
+      Block->decode(Reader, BitNo);
+    });
+  };
+  for (size_t I = 0, E = std::min(Window, Bodies.size()); I != E; ++I)
+    Submit(I);
+
+  std::error_code EC;
+  size_t NextBody = 0;
+  for (Function &F : *TheModule) {
+    if (NextBody < Bodies.size() && Bodies[NextBody].first == &F) {
+      Pending[NextBody].wait();
+      PredecodedBody = std::make_pair(&F, Blocks[NextBody].get());
+      EC = materialize(&F);
+      PredecodedBody = std::make_pair(nullptr, nullptr);
+      Blocks[NextBody].reset();
+      if (NextBody + Window < Bodies.size())
+        Submit(NextBody + Window);
+      ++NextBody;
+    } else
+      EC = materialize(&F);
+    if (EC)
+      break;
+  }
+  // The pool's destructor waits for any block still being decoded.
+  return EC;
+}
+
 std::vector<StructType *> BitcodeReader::getIdentifiedStructTypes() const {
   return IdentifiedStructTypes;
 }
@@ -5738,6 +5904,7 @@ BitcodeReader::initLazyStream(std::unique_ptr<DataStreamer> Streamer) {
   StreamingMemoryObject &Bytes = *OwnedBytes;
   StreamFile = llvm::make_unique<BitstreamReader>(std::move(OwnedBytes));
   Stream.init(&*StreamFile);
+  IsStreamed = true;
 
   unsigned char buf[16];
   if (Bytes.readBytes(buf, 16, 0) != 16)
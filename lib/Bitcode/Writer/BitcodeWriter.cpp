@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "ValueEnumerator.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
@@ -28,6 +29,7 @@
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/UseListOrder.h"
 #include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Program.h"
@@ -37,6 +39,15 @@
 #include <map>
 using namespace llvm;
 
+#define DEBUG_TYPE "bitcode-writer"
+
+STATISTIC(NumFlushes, "Number of times bitcode was flushed to the output file");
+
+static cl::opt<unsigned>
+    FlushThreshold("bitcode-flush-threshold", cl::Hidden, cl::init(512),
+                   cl::desc("The amount of bitcode (in MB) to buffer before "
+                            "flushing it to a seekable output file."));
+
 namespace {
 /// These are manifest constants used by the bitcode writer. They do not need to
 /// be kept in sync with the reader, but need to be consistent within this file.
@@ -81,9 +92,11 @@ protected:
 
 public:
   /// Constructs a BitcodeWriter object, and initializes a BitstreamRecord,
-  /// writing to the provided \p Buffer.
-  BitcodeWriter(SmallVectorImpl<char> &Buffer)
-      : Buffer(Buffer), Stream(Buffer) {}
+  /// writing to the provided \p Buffer.  If \p FS is provided, the contents
+  /// of \p Buffer are periodically flushed to it.
+  BitcodeWriter(SmallVectorImpl<char> &Buffer, raw_pwrite_stream *FS = nullptr)
+      : Buffer(Buffer),
+        Stream(Buffer, FS, uint64_t(FlushThreshold) * 1024 * 1024) {}
 
   virtual ~BitcodeWriter() = default;
 
@@ -124,9 +137,12 @@ public:
   /// writing to the provided \p Buffer.
   ModuleBitcodeWriter(const Module *M, SmallVectorImpl<char> &Buffer,
                       bool ShouldPreserveUseListOrder,
-                      const ModuleSummaryIndex *Index, bool GenerateHash)
-      : BitcodeWriter(Buffer), M(*M), VE(*M, ShouldPreserveUseListOrder),
+                      const ModuleSummaryIndex *Index, bool GenerateHash,
+                      raw_pwrite_stream *FS = nullptr)
+      : BitcodeWriter(Buffer, FS), M(*M), VE(*M, ShouldPreserveUseListOrder),
         Index(Index), GenerateHash(GenerateHash) {
+    assert((!FS || !GenerateHash) &&
+           "The module hash is computed over the buffered bitcode");
     // Save the start bit of the actual bitcode, in case there is space
     // saved at the start for the darwin header above. The reader stream
     // will start at the bitcode, and we need the offset of the VST
@@ -1046,6 +1062,7 @@ void BitcodeWriter::writeValueSymbolTableForwardDecl() {
   // patched when the real VST is written. We can simply subtract the 32-bit
   // fixed size from the current bit number to get the location to backpatch.
   VSTOffsetPlaceholder = Stream.GetCurrentBitNo() - 32;
+  Stream.PreserveBackpatchSite(VSTOffsetPlaceholder);
 }
 
 enum StringEncoding { SE_Char6, SE_Fixed7, SE_Fixed8 };
@@ -3614,6 +3631,8 @@ void ModuleBitcodeWriter::writeModule() {
 
   // Emit metadata.
   writeModuleMetadata();
+  if (Stream.FlushToFile())
+    ++NumFlushes;
 
   // Emit module-level use-lists.
   if (VE.shouldPreserveUseListOrder())
@@ -3624,8 +3643,11 @@ void ModuleBitcodeWriter::writeModule() {
   // Emit function bodies.
   DenseMap<const Function *, uint64_t> FunctionToBitcodeIndex;
   for (Module::const_iterator F = M.begin(), E = M.end(); F != E; ++F)
-    if (!F->isDeclaration())
+    if (!F->isDeclaration()) {
       writeFunction(*F, FunctionToBitcodeIndex);
+      if (Stream.FlushToFile())
+        ++NumFlushes;
+    }
 
   // Need to write after the above call to WriteFunction which populates
   // the summary information in the index.
@@ -3745,6 +3767,31 @@ void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out,
   Out.write((char*)&Buffer.front(), Buffer.size());
 }
 
+void llvm::WriteBitcodeToFile(const Module *M, raw_fd_ostream &Out,
+                              bool ShouldPreserveUseListOrder,
+                              const ModuleSummaryIndex *Index,
+                              bool GenerateHash) {
+  // The darwin wrapper header records the size of the bitcode and the module
+  // hash is computed over it, so both need the whole file in memory.
+  Triple TT(M->getTargetTriple());
+  if (!Out.supportsSeeking() || GenerateHash || TT.isOSDarwin() ||
+      TT.isOSBinFormatMachO())
+    return WriteBitcodeToFile(M, static_cast<raw_ostream &>(Out),
+                              ShouldPreserveUseListOrder, Index, GenerateHash);
+
+  SmallVector<char, 0> Buffer;
+  Buffer.reserve(256*1024);
+
+  // Emit the module, flushing the buffer to "Out" as it fills up.
+  ModuleBitcodeWriter ModuleWriter(M, Buffer, ShouldPreserveUseListOrder, Index,
+                                   GenerateHash, &Out);
+  ModuleWriter.write();
+
+  // Write the remainder of the bitstream to "Out".
+  if (!Buffer.empty())
+    Out.write((char*)&Buffer.front(), Buffer.size());
+}
+
 void IndexBitcodeWriter::writeIndex() {
   Stream.EnterSubblock(bitc::MODULE_BLOCK_ID, 3);
 
@@ -17,33 +17,46 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
+BitcodeWriterPass::BitcodeWriterPass(raw_fd_ostream &OS,
+                                     bool ShouldPreserveUseListOrder,
+                                     bool EmitSummaryIndex, bool EmitModuleHash)
+    : OS(OS), FDOS(&OS), ShouldPreserveUseListOrder(ShouldPreserveUseListOrder),
+      EmitSummaryIndex(EmitSummaryIndex), EmitModuleHash(EmitModuleHash) {}
+
 PreservedAnalyses BitcodeWriterPass::run(Module &M, ModuleAnalysisManager &) {
   std::unique_ptr<ModuleSummaryIndex> Index;
   if (EmitSummaryIndex)
     Index = ModuleSummaryIndexBuilder(&M).takeIndex();
-  WriteBitcodeToFile(&M, OS, ShouldPreserveUseListOrder, Index.get(),
-                     EmitModuleHash);
+  if (FDOS)
+    WriteBitcodeToFile(&M, *FDOS, ShouldPreserveUseListOrder, Index.get(),
+                       EmitModuleHash);
+  else
+    WriteBitcodeToFile(&M, OS, ShouldPreserveUseListOrder, Index.get(),
+                       EmitModuleHash);
   return PreservedAnalyses::all();
 }
 
 namespace {
   class WriteBitcodePass : public ModulePass {
     raw_ostream &OS; // raw_ostream to print on
+    raw_fd_ostream *FDOS; // OS as a file stream, if it is one
     bool ShouldPreserveUseListOrder;
     bool EmitSummaryIndex;
     bool EmitModuleHash;
 
   public:
     static char ID; // Pass identification, replacement for typeid
-    WriteBitcodePass() : ModulePass(ID), OS(dbgs()) {
+    WriteBitcodePass() : ModulePass(ID), OS(dbgs()), FDOS(nullptr) {
       initializeWriteBitcodePassPass(*PassRegistry::getPassRegistry());
     }
 
-    explicit WriteBitcodePass(raw_ostream &o, bool ShouldPreserveUseListOrder,
+    explicit WriteBitcodePass(raw_ostream &o, raw_fd_ostream *FDOS,
+                              bool ShouldPreserveUseListOrder,
                               bool EmitSummaryIndex, bool EmitModuleHash)
-        : ModulePass(ID), OS(o),
+        : ModulePass(ID), OS(o), FDOS(FDOS),
           ShouldPreserveUseListOrder(ShouldPreserveUseListOrder),
           EmitSummaryIndex(EmitSummaryIndex), EmitModuleHash(EmitModuleHash) {
       initializeWriteBitcodePassPass(*PassRegistry::getPassRegistry());
@@ -56,8 +69,12 @@ namespace {
           EmitSummaryIndex
               ? &(getAnalysis<ModuleSummaryIndexWrapperPass>().getIndex())
               : nullptr;
-      WriteBitcodeToFile(&M, OS, ShouldPreserveUseListOrder, Index,
-                         EmitModuleHash);
+      if (FDOS)
+        WriteBitcodeToFile(&M, *FDOS, ShouldPreserveUseListOrder, Index,
+                           EmitModuleHash);
+      else
+        WriteBitcodeToFile(&M, OS, ShouldPreserveUseListOrder, Index,
+                           EmitModuleHash);
       return false;
     }
     void getAnalysisUsage(AnalysisUsage &AU) const override {
@@ -78,6 +95,14 @@ INITIALIZE_PASS_END(WriteBitcodePass, "write-bitcode", "Write Bitcode", false,
 ModulePass *llvm::createBitcodeWriterPass(raw_ostream &Str,
                                           bool ShouldPreserveUseListOrder,
                                           bool EmitSummaryIndex, bool EmitModuleHash) {
-  return new WriteBitcodePass(Str, ShouldPreserveUseListOrder,
+  return new WriteBitcodePass(Str, nullptr, ShouldPreserveUseListOrder,
+                              EmitSummaryIndex, EmitModuleHash);
+}
+
+ModulePass *llvm::createBitcodeWriterPass(raw_fd_ostream &Str,
+                                          bool ShouldPreserveUseListOrder,
+                                          bool EmitSummaryIndex,
+                                          bool EmitModuleHash) {
+  return new WriteBitcodePass(Str, &Str, ShouldPreserveUseListOrder,
                               EmitSummaryIndex, EmitModuleHash);
 }
@@ -47,6 +47,10 @@ public:
   bool hasBeenUsed() const { return HasBeenUsed; }
 
   void resetUsedFlag() { HasBeenUsed = false; }
+
+  /// Record that the type being built references addresses, without querying
+  /// for a particular one.
+  void setUsedFlag() { HasBeenUsed = true; }
 };
 }
 #endif
@@ -2490,7 +2490,7 @@ void AsmPrinter::EmitBasicBlockStart(const MachineBasicBlock &MBB) const {
 
     // MBBs can have their address taken as part of CodeGen without having
     // their corresponding BB's address taken in IR
-    if (BB->hasAddressTaken())
+    if (BB && BB->hasAddressTaken())
       for (MCSymbol *Sym : MMI->getAddrLabelSymbolToEmit(BB))
         OutStreamer->EmitLabel(Sym);
   }
@@ -2507,9 +2507,13 @@ void AsmPrinter::EmitBasicBlockStart(const MachineBasicBlock &MBB) const {
     emitBasicBlockLoopComments(MBB, LI, *this);
   }
 
-  // Print the main label for the block.
-  if (MBB.pred_empty() ||
-      (isBlockOnlyReachableByFallthrough(&MBB) && !MBB.isEHFuncletEntry())) {
+  // Print the main label for the block. Blocks created by CodeGen with their
+  // address taken, such as the MachineOutliner's outlined sequences, have no
+  // IR block and are referenced through this label.
+  bool HasCodeGenAddress = MBB.hasAddressTaken() && !MBB.getBasicBlock();
+  if (!HasCodeGenAddress &&
+      (MBB.pred_empty() ||
+       (isBlockOnlyReachableByFallthrough(&MBB) && !MBB.isEHFuncletEntry()))) {
     if (isVerbose()) {
       // NOTE: Want this comment at start of line, don't emit with AddComment.
       OutStreamer->emitRawComment(" BB#" + Twine(MBB.getNumber()) + ":", false);
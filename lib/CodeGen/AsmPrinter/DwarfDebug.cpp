@@ -1876,6 +1876,17 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
   if (!TypeUnitsUnderConstruction.empty() && AddrPool.hasBeenUsed())
     return;
 
+  // Don't build a type unit that we already know will be thrown away. A type
+  // unit depending on this type would have to be thrown away as well.
+  if (TypesInCompileUnits.count(CTy)) {
+    if (!TypeUnitsUnderConstruction.empty()) {
+      AddrPool.setUsedFlag();
+      return;
+    }
+    CU.constructTypeDIE(RefDie, cast<DICompositeType>(CTy));
+    return;
+  }
+
   auto Ins = TypeSignatures.insert(std::make_pair(CTy, 0));
   if (!Ins.second) {
     CU.addDIETypeSignature(RefDie, Ins.first->second);
@@ -1922,6 +1933,7 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
       // the type that used an address.
       for (const auto &TU : TypeUnitsToAdd)
         TypeSignatures.erase(TU.second);
+      TypesInCompileUnits.insert(CTy);
 
       // Construct this type in the CU directly.
       // This is inefficient because all the dependent types will be rebuilt
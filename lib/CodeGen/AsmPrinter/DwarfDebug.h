@@ -238,6 +238,11 @@ class DwarfDebug : public DebugHandlerBase {
   /// used to keep track of which types we have emitted type units for.
   DenseMap<const MDNode *, uint64_t> TypeSignatures;
 
+  /// Types that were found to reference the address pool while being built
+  /// in a type unit. They are built directly in their compile unit without
+  /// trying a type unit again.
+  DenseSet<const MDNode *> TypesInCompileUnits;
+
   SmallVector<
       std::pair<std::unique_ptr<DwarfTypeUnit>, const DICompositeType *>, 1>
       TypeUnitsUnderConstruction;
@@ -0,0 +1,67 @@
+//===- llvm/CodeGen/GlobalISel/InstructionSelector.cpp -----------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the InstructionSelector class.
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+
+#define DEBUG_TYPE "instructionselector"
+
+using namespace llvm;
+
+InstructionSelector::InstructionSelector() {}
+
+bool InstructionSelector::constrainSelectedInstRegOperands(
+    MachineInstr &I, const TargetInstrInfo &TII, const TargetRegisterInfo &TRI,
+    const RegisterBankInfo &RBI) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  for (unsigned OpI = 0, OpE = I.getNumExplicitOperands(); OpI != OpE; ++OpI) {
+    MachineOperand &MO = I.getOperand(OpI);
+    if (!MO.isReg())
+      continue;
+    DEBUG(dbgs() << "Converting operand: " << MO << '\n');
+
+    unsigned Reg = MO.getReg();
+    // Physical registers are already constrained by the instruction that
+    // selected them.
+    if (TargetRegisterInfo::isPhysicalRegister(Reg))
+      continue;
+
+    const TargetRegisterClass *RC = TII.getRegClass(I.getDesc(), OpI, &TRI, MF);
+    if (!RC)
+      return false;
+
+    // A vreg that already has a class only needs to be constrained.
+    if (MRI.getRegClassOrNull(Reg)) {
+      if (!MRI.constrainRegClass(Reg, RC))
+        return false;
+      continue;
+    }
+
+    // A generic vreg must live in the bank of the class we give it.
+    const RegisterBank *RB = MRI.getRegBankOrNull(Reg);
+    if (!RB || RB != &RBI.getRegBankFromRegClass(*RC)) {
+      DEBUG(dbgs() << "Register bank does not match " << TRI.getRegClassName(RC)
+                   << '\n');
+      return false;
+    }
+    MRI.setRegClass(Reg, RC);
+  }
+  return true;
+}
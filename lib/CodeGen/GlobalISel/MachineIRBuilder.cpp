@@ -87,11 +87,65 @@ MachineInstr *MachineIRBuilder::buildInstr(unsigned Opcode, Type *Ty,
 
 MachineInstr *MachineIRBuilder::buildInstr(unsigned Opcode, unsigned Res,
                                            unsigned Op0) {
-  MachineInstr *NewMI = buildInstr(Opcode, nullptr);
+  return buildInstr(Opcode, nullptr, Res, Op0);
+}
+
+MachineInstr *MachineIRBuilder::buildInstr(unsigned Opcode, Type *Ty,
+                                           unsigned Res, unsigned Op0) {
+  MachineInstr *NewMI = buildInstr(Opcode, Ty);
   MachineInstrBuilder(getMF(), NewMI).addReg(Res, RegState::Define).addReg(Op0);
   return NewMI;
 }
 
+MachineInstr *MachineIRBuilder::buildConstant(Type *Ty, unsigned Res,
+                                              int64_t Val) {
+  MachineInstr *NewMI = buildInstr(TargetOpcode::G_CONSTANT, Ty);
+  MachineInstrBuilder(getMF(), NewMI).addReg(Res, RegState::Define).addImm(Val);
+  return NewMI;
+}
+
+MachineInstr *MachineIRBuilder::buildUAdde(Type *Ty, unsigned Res,
+                                           unsigned CarryOut, unsigned Op0,
+                                           unsigned Op1, unsigned CarryIn) {
+  MachineInstr *NewMI = buildInstr(TargetOpcode::G_UADDE, Ty);
+  MachineInstrBuilder(getMF(), NewMI)
+      .addReg(Res, RegState::Define)
+      .addReg(CarryOut, RegState::Define)
+      .addReg(Op0)
+      .addReg(Op1)
+      .addReg(CarryIn);
+  return NewMI;
+}
+
+MachineInstr *MachineIRBuilder::buildExtract(Type *Ty,
+                                             ArrayRef<unsigned> Results,
+                                             unsigned Src,
+                                             ArrayRef<uint64_t> Indices) {
+  assert(Results.size() == Indices.size() && "inconsistent number of regs");
+  MachineInstr *NewMI = buildInstr(TargetOpcode::G_EXTRACT, Ty);
+  MachineInstrBuilder MIB(getMF(), NewMI);
+  for (unsigned Res : Results)
+    MIB.addReg(Res, RegState::Define);
+  MIB.addReg(Src);
+  for (uint64_t Idx : Indices)
+    MIB.addImm(Idx);
+  return NewMI;
+}
+
+MachineInstr *MachineIRBuilder::buildSequence(Type *Ty, unsigned Res,
+                                              ArrayRef<unsigned> Ops,
+                                              ArrayRef<uint64_t> Indices) {
+  assert(Ops.size() == Indices.size() && "incompatible args");
+  MachineInstr *NewMI = buildInstr(TargetOpcode::G_SEQUENCE, Ty);
+  MachineInstrBuilder MIB(getMF(), NewMI);
+  MIB.addReg(Res, RegState::Define);
+  for (unsigned i = 0; i < Ops.size(); ++i) {
+    MIB.addReg(Ops[i]);
+    MIB.addImm(Indices[i]);
+  }
+  return NewMI;
+}
+
 MachineInstr *MachineIRBuilder::buildInstr(unsigned Opcode) {
   return buildInstr(Opcode, nullptr);
 }
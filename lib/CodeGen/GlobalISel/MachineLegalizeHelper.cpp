@@ -0,0 +1,189 @@
+//===-- llvm/CodeGen/GlobalISel/MachineLegalizeHelper.cpp -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the MachineLegalizeHelper class to legalize
+/// individual instructions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/MachineLegalizeHelper.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/CodeGen/GlobalISel/MachineLegalizer.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "legalize-mir"
+
+using namespace llvm;
+
+MachineLegalizeHelper::MachineLegalizeHelper(MachineFunction &MF)
+  : MRI(MF.getRegInfo()) {
+  MIRBuilder.setMF(MF);
+}
+
+MachineLegalizeHelper::LegalizeResult
+MachineLegalizeHelper::legalizeInstr(MachineInstr &MI,
+                                     const MachineLegalizer &Legalizer) {
+  SmallVector<MachineInstr *, 4> WorkList;
+  WorkList.push_back(&MI);
+
+  bool Changed = false;
+  while (!WorkList.empty()) {
+    MachineInstr &CurMI = *WorkList.pop_back_val();
+    MachineBasicBlock &MBB = *CurMI.getParent();
+
+    // The replacement instructions are inserted around CurMI, so remember
+    // its neighbours to find them afterwards.
+    MachineInstr *Prev = CurMI.getPrevNode();
+    MachineInstr *Next = CurMI.getNextNode();
+
+    LegalizeResult Res = legalizeInstrStep(CurMI, Legalizer);
+    if (Res == UnableToLegalize) {
+      DEBUG(dbgs() << "Cannot legalize: " << CurMI);
+      return UnableToLegalize;
+    }
+    if (Res == AlreadyLegal)
+      continue;
+
+    Changed = true;
+    auto Begin = Prev ? std::next(Prev->getIterator()) : MBB.instr_begin();
+    auto End = Next ? Next->getIterator() : MBB.instr_end();
+    for (MachineInstr &NewMI : make_range(Begin, End))
+      if (isPreISelGenericOpcode(NewMI.getOpcode()))
+        WorkList.push_back(&NewMI);
+  }
+  return Changed ? Legalized : AlreadyLegal;
+}
+
+MachineLegalizeHelper::LegalizeResult
+MachineLegalizeHelper::legalizeInstrStep(MachineInstr &MI,
+                                         const MachineLegalizer &Legalizer) {
+  auto Action = Legalizer.getAction(MI);
+  switch (Action.first) {
+  case MachineLegalizer::Legal:
+    return AlreadyLegal;
+  case MachineLegalizer::NarrowScalar:
+    return narrowScalar(MI, Action.second);
+  case MachineLegalizer::WidenScalar:
+    return widenScalar(MI, Action.second);
+  case MachineLegalizer::Lower:
+    return lower(MI);
+  case MachineLegalizer::Libcall:
+    return libcall(MI);
+  case MachineLegalizer::Custom:
+    MIRBuilder.setInstr(MI, /* Before */ true);
+    return Legalizer.legalizeCustom(MI, MRI, MIRBuilder) ? Legalized
+                                                         : UnableToLegalize;
+  default:
+    return UnableToLegalize;
+  }
+}
+
+void MachineLegalizeHelper::extractParts(unsigned Reg, Type *Ty, int NumParts,
+                                         SmallVectorImpl<unsigned> &VRegs) {
+  assert(VRegs.empty() && "Expected an empty list of parts");
+  unsigned Size = Ty->getPrimitiveSizeInBits();
+  SmallVector<uint64_t, 4> Indexes;
+  for (int i = 0; i < NumParts; ++i) {
+    VRegs.push_back(MRI.createGenericVirtualRegister(Size));
+    Indexes.push_back(i * Size);
+  }
+  MIRBuilder.buildExtract(Ty, VRegs, Reg, Indexes);
+}
+
+MachineLegalizeHelper::LegalizeResult
+MachineLegalizeHelper::narrowScalar(MachineInstr &MI, Type *NarrowTy) {
+  unsigned Opcode = MI.getOpcode();
+  if (Opcode != TargetOpcode::G_ADD && Opcode != TargetOpcode::G_OR)
+    return UnableToLegalize;
+
+  // Expand in terms of carry-setting/consuming G_UADDE instructions for
+  // G_ADD, and of independent narrow G_ORs otherwise.
+  unsigned Size = MI.getType()->getPrimitiveSizeInBits();
+  unsigned NarrowSize = NarrowTy->getPrimitiveSizeInBits();
+  if (!NarrowSize || Size % NarrowSize)
+    return UnableToLegalize;
+  int NumParts = Size / NarrowSize;
+
+  MIRBuilder.setInstr(MI, /* Before */ true);
+
+  SmallVector<unsigned, 2> Src1Regs, Src2Regs, DstRegs;
+  SmallVector<uint64_t, 2> Indexes;
+  extractParts(MI.getOperand(1).getReg(), NarrowTy, NumParts, Src1Regs);
+  extractParts(MI.getOperand(2).getReg(), NarrowTy, NumParts, Src2Regs);
+
+  unsigned CarryIn = 0;
+  Type *CarryTy = Type::getInt1Ty(NarrowTy->getContext());
+  if (Opcode == TargetOpcode::G_ADD) {
+    CarryIn = MRI.createGenericVirtualRegister(1);
+    MIRBuilder.buildConstant(CarryTy, CarryIn, 0);
+  }
+
+  for (int i = 0; i < NumParts; ++i) {
+    unsigned DstReg = MRI.createGenericVirtualRegister(NarrowSize);
+    if (Opcode == TargetOpcode::G_ADD) {
+      unsigned CarryOut = MRI.createGenericVirtualRegister(1);
+      MIRBuilder.buildUAdde(NarrowTy, DstReg, CarryOut, Src1Regs[i],
+                            Src2Regs[i], CarryIn);
+      CarryIn = CarryOut;
+    } else
+      MIRBuilder.buildInstr(Opcode, NarrowTy, DstReg, Src1Regs[i],
+                            Src2Regs[i]);
+
+    DstRegs.push_back(DstReg);
+    Indexes.push_back(i * NarrowSize);
+  }
+  MIRBuilder.buildSequence(MI.getType(), MI.getOperand(0).getReg(), DstRegs,
+                           Indexes);
+  MI.eraseFromParent();
+  return Legalized;
+}
+
+MachineLegalizeHelper::LegalizeResult
+MachineLegalizeHelper::widenScalar(MachineInstr &MI, Type *WideTy) {
+  unsigned Opcode = MI.getOpcode();
+  if (Opcode != TargetOpcode::G_ADD && Opcode != TargetOpcode::G_OR)
+    return UnableToLegalize;
+
+  // Perform operation at larger width (any extension is fine here, high bits
+  // don't affect the result) and then truncate the result back to the
+  // original type.
+  unsigned WideSize = WideTy->getPrimitiveSizeInBits();
+  MIRBuilder.setInstr(MI, /* Before */ true);
+
+  unsigned Src1Ext = MRI.createGenericVirtualRegister(WideSize);
+  unsigned Src2Ext = MRI.createGenericVirtualRegister(WideSize);
+  MIRBuilder.buildInstr(TargetOpcode::G_ANYEXT, WideTy, Src1Ext,
+                        MI.getOperand(1).getReg());
+  MIRBuilder.buildInstr(TargetOpcode::G_ANYEXT, WideTy, Src2Ext,
+                        MI.getOperand(2).getReg());
+
+  unsigned DstExt = MRI.createGenericVirtualRegister(WideSize);
+  MIRBuilder.buildInstr(Opcode, WideTy, DstExt, Src1Ext, Src2Ext);
+
+  MIRBuilder.buildInstr(TargetOpcode::G_TRUNC, MI.getType(),
+                        MI.getOperand(0).getReg(), DstExt);
+  MI.eraseFromParent();
+  return Legalized;
+}
+
+MachineLegalizeHelper::LegalizeResult
+MachineLegalizeHelper::lower(MachineInstr &MI) {
+  // None of the generic opcodes has a generic expansion yet.
+  return UnableToLegalize;
+}
+
+MachineLegalizeHelper::LegalizeResult
+MachineLegalizeHelper::libcall(MachineInstr &MI) {
+  // None of the generic opcodes maps onto a runtime library call yet.
+  return UnableToLegalize;
+}
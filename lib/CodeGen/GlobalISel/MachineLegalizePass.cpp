@@ -0,0 +1,74 @@
+//===-- llvm/CodeGen/GlobalISel/MachineLegalizePass.cpp -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the MachineLegalizePass class, which runs the
+/// MachineLegalizeHelper on every generic instruction of a function.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/MachineLegalizePass.h"
+#include "llvm/CodeGen/GlobalISel/MachineLegalizeHelper.h"
+#include "llvm/CodeGen/GlobalISel/MachineLegalizer.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+
+#define DEBUG_TYPE "legalize-mir"
+
+using namespace llvm;
+
+char MachineLegalizePass::ID = 0;
+INITIALIZE_PASS(MachineLegalizePass, DEBUG_TYPE,
+                "Legalize the Machine IR of a function", false,
+                false);
+
+MachineLegalizePass::MachineLegalizePass() : MachineFunctionPass(ID) {
+  initializeMachineLegalizePassPass(*PassRegistry::getPassRegistry());
+}
+
+bool MachineLegalizePass::runOnMachineFunction(MachineFunction &MF) {
+  DEBUG(dbgs() << "Legalize Machine IR for: " << MF.getName() << '\n');
+  MachineLegalizeHelper Helper(MF);
+  const MachineLegalizer *Legalizer = MF.getSubtarget().getMachineLegalizer();
+  assert(Legalizer && "Cannot work without MachineLegalizer");
+
+  // The helper legalizes the instructions it creates as well, so a single
+  // walk over the function is enough.
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF) {
+    for (auto MI = MBB.begin(), NextMI = MI; MI != MBB.end(); MI = NextMI) {
+      // Get the next Instruction before we try to legalize, because there's
+      // a good chance MI will be deleted.
+      NextMI = std::next(MI);
+      if (!isPreISelGenericOpcode(MI->getOpcode()))
+        continue;
+
+      unsigned Opcode = MI->getOpcode();
+      Type *Ty = MI->getType();
+      auto Res = Helper.legalizeInstr(*MI, *Legalizer);
+      if (Res == MachineLegalizeHelper::UnableToLegalize) {
+        // Report the error and keep going, so that every unsupported
+        // operation of the function gets reported.
+        std::string ErrStorage;
+        raw_string_ostream Err(ErrStorage);
+        Err << "unable to legalize instruction: "
+            << MF.getSubtarget().getInstrInfo()->getName(Opcode) << ' ' << *Ty
+            << " in function " << MF.getName();
+        MF.getFunction()->getContext().emitError(Err.str());
+        continue;
+      }
+      Changed |= Res == MachineLegalizeHelper::Legalized;
+    }
+  }
+  return Changed;
+}
@@ -0,0 +1,130 @@
+//===---- lib/CodeGen/GlobalISel/MachineLegalizer.cpp - Legalizer info -----==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implement an interface to specify and query how an illegal operation on a
+// given type should be expanded.
+//
+// Issues to be resolved:
+//   + Make it fast.
+//   + Support weird types like i3, <7 x i3>, ...
+//   + Operations with more than one type (ICMP, CMPXCHG, intrinsics, ...)
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/MachineLegalizer.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/ValueTypes.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Type.h"
+#include <algorithm>
+
+using namespace llvm;
+
+MachineLegalizer::MachineLegalizer() : TablesInitialized(false) {
+  std::fill(std::begin(DefaultActions), std::end(DefaultActions), NotFound);
+  // A branch does not care about the type of its target.
+  DefaultActions[TargetOpcode::G_BR - FirstOp] = Legal;
+}
+
+void MachineLegalizer::computeTables() {
+  for (auto &Legal : LegalScalars)
+    Legal.clear();
+
+  for (auto &Entry : Actions) {
+    MVT Ty = (MVT::SimpleValueType)Entry.first.second;
+    if (Entry.second == Legal && Ty.isScalarInteger())
+      LegalScalars[Entry.first.first - FirstOp].push_back(Ty);
+  }
+
+  for (auto &Legal : LegalScalars)
+    std::sort(Legal.begin(), Legal.end(), [](MVT LHS, MVT RHS) {
+      return LHS.getSizeInBits() < RHS.getSizeInBits();
+    });
+
+  TablesInitialized = true;
+}
+
+std::pair<MachineLegalizer::LegalizeAction, MVT>
+MachineLegalizer::findLegalScalar(unsigned Opcode, unsigned SizeInBits,
+                                  LegalizeAction Action) const {
+  const SmallVectorImpl<MVT> &Legal = LegalScalars[Opcode - FirstOp];
+
+  if (Action != NarrowScalar)
+    for (MVT Ty : Legal)
+      if (Ty.getSizeInBits() > SizeInBits)
+        return std::make_pair(WidenScalar, Ty);
+
+  if (Action != WidenScalar)
+    for (MVT Ty : reverse(Legal))
+      if (Ty.getSizeInBits() < SizeInBits)
+        return std::make_pair(NarrowScalar, Ty);
+
+  return std::make_pair(Unsupported, MVT(MVT::INVALID_SIMPLE_VALUE_TYPE));
+}
+
+std::pair<MachineLegalizer::LegalizeAction, MVT>
+MachineLegalizer::getAction(unsigned Opcode, MVT Ty) const {
+  assert(TablesInitialized && "Tables must be initialized");
+  assert(isPreISelGenericOpcode(Opcode) && "Generic opcode expected");
+
+  LegalizeAction Action = DefaultActions[Opcode - FirstOp];
+  auto ActionIt = Actions.find(std::make_pair(Opcode, Ty.SimpleTy));
+  if (ActionIt != Actions.end())
+    Action = ActionIt->second;
+
+  // Integer types without an explicit action, or explicitly marked as needing
+  // a change of size, are moved to the closest legal integer type.
+  if ((Action == NotFound || Action == WidenScalar ||
+       Action == NarrowScalar) &&
+      Ty.isScalarInteger())
+    return findLegalScalar(Opcode, Ty.getSizeInBits(), Action);
+
+  return std::make_pair(Action, Ty);
+}
+
+std::pair<MachineLegalizer::LegalizeAction, Type *>
+MachineLegalizer::getAction(const MachineInstr &MI) const {
+  unsigned Opcode = MI.getOpcode();
+  Type *Ty = MI.getType();
+  assert(Ty && "Generic instruction must have a type");
+
+  std::pair<LegalizeAction, MVT> Action;
+  MVT VT = MVT::getVT(Ty, /*HandleUnknown=*/true);
+  if (Ty->isIntegerTy() && VT.SimpleTy == MVT::INVALID_SIMPLE_VALUE_TYPE) {
+    // An integer without a simple value type, like i17, can only be legalized
+    // by changing its size.
+    LegalizeAction Default = DefaultActions[Opcode - FirstOp];
+    if (Default == Legal)
+      return std::make_pair(Legal, Ty);
+    Action = findLegalScalar(Opcode, Ty->getIntegerBitWidth(), Default);
+  } else
+    Action = getAction(Opcode, VT);
+
+  switch (Action.first) {
+  case NarrowScalar:
+  case WidenScalar:
+  case FewerElements:
+  case MoreElements:
+    return std::make_pair(Action.first,
+                          EVT(Action.second).getTypeForEVT(Ty->getContext()));
+  default:
+    return std::make_pair(Action.first, Ty);
+  }
+}
+
+bool MachineLegalizer::isLegal(const MachineInstr &MI) const {
+  return getAction(MI).first == Legal;
+}
+
+bool MachineLegalizer::legalizeCustom(MachineInstr &MI,
+                                      MachineRegisterInfo &MRI,
+                                      MachineIRBuilder &MIRBuilder) const {
+  return false;
+}
@@ -0,0 +1,397 @@
+//===---- MachineOutliner.cpp - Outline instructions -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Replaces repeated sequences of instructions with calls to a single copy of
+/// the sequence.
+///
+/// The outliner maps every instruction of a function to an integer, so that
+/// identical instructions get the same integer, and builds a suffix tree over
+/// the resulting string. Each internal node of the tree is a sequence that
+/// appears more than once. Sequences are outlined greedily, most beneficial
+/// first, as long as outlining them saves instructions according to the
+/// target's call and return overhead.
+///
+/// The outlined copy is placed in a block at the end of the function and is
+/// reached with a call and a return. The block has its address taken, so it
+/// survives until the AsmPrinter, which emits its label for the calls to
+/// refer to. The target decides which instructions may be moved into such a
+/// block through TargetInstrInfo, typically rejecting anything that touches
+/// the stack pointer or the control flow, and adds whatever unwind info the
+/// pushed return address needs.
+///
+/// The codegen pipeline runs one function at a time and frees each
+/// MachineFunction before the next one is built, so sequences are only
+/// shared within a function. Hot blocks are never outlined from so that they
+/// don't pay for the extra call. With profile data, hot means a hot count
+/// according to ProfileSummaryInfo; without, blocks estimated to run more
+/// often than the function entry, such as loop bodies, are treated as hot.
+///
+/// The suffix tree is represented by a suffix array and its longest common
+/// prefix array. The LCP intervals of the suffix array are exactly the
+/// internal nodes of the suffix tree, and are cheaper to build and walk.
+///
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+#include <algorithm>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "machine-outliner"
+
+STATISTIC(NumOutlinedSequences, "Number of sequences outlined");
+STATISTIC(NumOutlinedCalls, "Number of outlined sequences replaced by calls");
+STATISTIC(NumInstrsSaved, "Number of instructions saved by outlining");
+
+namespace {
+
+/// An occurrence of a repeated sequence in the instruction string.
+struct Candidate {
+  /// Length of the sequence.
+  unsigned Length;
+  /// Start indices of the occurrences, sorted.
+  std::vector<unsigned> Starts;
+  /// Number of instructions saved by outlining every occurrence.
+  int Benefit;
+};
+
+class MachineOutliner : public MachineFunctionPass {
+  const TargetInstrInfo *TII;
+  const TargetRegisterInfo *TRI;
+
+  /// The function as a string of integers. Identical legal instructions map to
+  /// the same integer; illegal instructions and block ends map to integers
+  /// that appear only once.
+  std::vector<unsigned> Str;
+  /// The instruction for each element of Str, or nullptr for block ends.
+  std::vector<MachineInstr *> InstrList;
+
+  void mapFunction(MachineFunction &MF, const MachineBlockFrequencyInfo &MBFI,
+                   ProfileSummaryInfo &PSI);
+  void findCandidates(std::vector<Candidate> &Candidates) const;
+  int getBenefit(unsigned Length, unsigned Occurrences) const;
+  void outline(MachineFunction &MF, const Candidate &C);
+
+public:
+  static char ID;
+
+  MachineOutliner() : MachineFunctionPass(ID) {
+    initializeMachineOutlinerPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().set(
+        MachineFunctionProperties::Property::AllVRegsAllocated);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+};
+
+} // end anonymous namespace
+
+char MachineOutliner::ID = 0;
+char &llvm::MachineOutlinerID = MachineOutliner::ID;
+
+INITIALIZE_PASS_BEGIN(MachineOutliner, "machine-outliner",
+                      "Machine Function Outliner", false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(MachineOutliner, "machine-outliner",
+                    "Machine Function Outliner", false, false)
+
+/// Return true if \p MBB runs too often for outlining from it to pay off.
+static bool isHotBlock(const MachineBasicBlock &MBB,
+                       const MachineBlockFrequencyInfo &MBFI,
+                       ProfileSummaryInfo &PSI) {
+  if (Optional<uint64_t> Count = MBFI.getBlockProfileCount(&MBB))
+    return PSI.isHotCount(*Count);
+  return MBFI.getBlockFreq(&MBB).getFrequency() > MBFI.getEntryFreq();
+}
+
+void MachineOutliner::mapFunction(MachineFunction &MF,
+                                  const MachineBlockFrequencyInfo &MBFI,
+                                  ProfileSummaryInfo &PSI) {
+  DenseMap<MachineInstr *, unsigned, MachineInstrExpressionTrait> InstrIDs;
+  // Legal instructions get IDs counting up from zero, the unique separators
+  // count down from the top so the two never meet.
+  unsigned NextLegalID = 0;
+  unsigned NextIllegalID = ~0u;
+
+  Str.clear();
+  InstrList.clear();
+
+  for (MachineBasicBlock &MBB : MF) {
+    bool IsHot = isHotBlock(MBB, MBFI, PSI);
+    for (MachineInstr &MI : MBB) {
+      TargetInstrInfo::MachineOutlinerInstrType Type =
+          IsHot || MI.isBundled() ? TargetInstrInfo::Illegal
+                                  : TII->getOutliningType(MI);
+      if (Type == TargetInstrInfo::Invisible)
+        continue;
+
+      unsigned ID;
+      if (Type == TargetInstrInfo::Legal) {
+        auto Inserted = InstrIDs.insert(std::make_pair(&MI, NextLegalID));
+        if (Inserted.second)
+          ++NextLegalID;
+        ID = Inserted.first->second;
+      } else {
+        ID = NextIllegalID--;
+      }
+      Str.push_back(ID);
+      InstrList.push_back(&MI);
+    }
+
+    // Sequences never cross block boundaries.
+    Str.push_back(NextIllegalID--);
+    InstrList.push_back(nullptr);
+  }
+}
+
+int MachineOutliner::getBenefit(unsigned Length, unsigned Occurrences) const {
+  int NotOutlined = Length * Occurrences;
+  int Outlined = Occurrences * TII->getOutliningCallOverhead() + Length +
+                 TII->getOutliningFrameOverhead();
+  return NotOutlined - Outlined;
+}
+
+void MachineOutliner::findCandidates(std::vector<Candidate> &Candidates) const {
+  unsigned N = Str.size();
+
+  // Build the suffix array by prefix doubling.
+  std::vector<unsigned> SA(N), Rank(N), Tmp(N);
+  for (unsigned i = 0; i != N; ++i) {
+    SA[i] = i;
+    Rank[i] = Str[i];
+  }
+  for (unsigned K = 1;; K <<= 1) {
+    auto Less = [&](unsigned A, unsigned B) {
+      if (Rank[A] != Rank[B])
+        return Rank[A] < Rank[B];
+      // Running off the end of the string sorts first.
+      int64_t RA = A + K < N ? (int64_t)Rank[A + K] : -1;
+      int64_t RB = B + K < N ? (int64_t)Rank[B + K] : -1;
+      return RA < RB;
+    };
+    std::sort(SA.begin(), SA.end(), Less);
+    Tmp[SA[0]] = 0;
+    for (unsigned i = 1; i != N; ++i)
+      Tmp[SA[i]] = Tmp[SA[i - 1]] + Less(SA[i - 1], SA[i]);
+    Rank.swap(Tmp);
+    if (Rank[SA[N - 1]] == N - 1)
+      break;
+  }
+
+  // LCP[i] is the length of the common prefix of suffixes SA[i-1] and SA[i].
+  std::vector<unsigned> LCP(N, 0);
+  for (unsigned i = 0, H = 0; i != N; ++i) {
+    if (Rank[i] == 0) {
+      H = 0;
+      continue;
+    }
+    unsigned j = SA[Rank[i] - 1];
+    while (i + H < N && j + H < N && Str[i + H] == Str[j + H])
+      ++H;
+    LCP[Rank[i]] = H;
+    if (H)
+      --H;
+  }
+
+  // Every LCP interval [Left, Right] with value L is an internal node of the
+  // suffix tree: the sequence of length L starting at each of SA[Left..Right].
+  struct Interval {
+    unsigned Length;
+    unsigned Left;
+  };
+  SmallVector<Interval, 32> Stack;
+  Stack.push_back({0, 0});
+  for (unsigned i = 1; i <= N; ++i) {
+    unsigned L = i < N ? LCP[i] : 0;
+    unsigned Left = i - 1;
+    while (L < Stack.back().Length) {
+      Interval Node = Stack.pop_back_val();
+      Left = Node.Left;
+
+      if (Node.Length < 2)
+        continue;
+      std::vector<unsigned> Starts(SA.begin() + Node.Left, SA.begin() + i);
+      std::sort(Starts.begin(), Starts.end());
+      // Drop overlapping occurrences.
+      std::vector<unsigned> Disjoint;
+      for (unsigned Start : Starts)
+        if (Disjoint.empty() || Disjoint.back() + Node.Length <= Start)
+          Disjoint.push_back(Start);
+
+      int Benefit = getBenefit(Node.Length, Disjoint.size());
+      if (Disjoint.size() >= 2 && Benefit > 0)
+        Candidates.push_back({Node.Length, std::move(Disjoint), Benefit});
+    }
+    if (L > Stack.back().Length)
+      Stack.push_back({L, Left});
+  }
+
+  std::stable_sort(Candidates.begin(), Candidates.end(),
+                   [](const Candidate &A, const Candidate &B) {
+                     return A.Benefit > B.Benefit;
+                   });
+}
+
+/// Collect the registers read before being written in [Begin, End], and all
+/// registers written, so that the call to the outlined sequence can carry
+/// them as implicit operands.
+static void collectRegisters(MachineBasicBlock::iterator Begin,
+                             MachineBasicBlock::iterator End,
+                             const TargetRegisterInfo &TRI,
+                             SmallVectorImpl<std::pair<unsigned, bool>> &Uses,
+                             SmallVectorImpl<unsigned> &Defs) {
+  SmallSet<unsigned, 16> DefinedUnits;
+  SmallSet<unsigned, 16> Seen;
+  for (MachineInstr &MI : make_range(Begin, std::next(End))) {
+    if (MI.isDebugValue())
+      continue;
+    for (const MachineOperand &MO : MI.operands()) {
+      if (!MO.isReg() || !MO.getReg() || !MO.readsReg())
+        continue;
+      bool Defined = true;
+      for (MCRegUnitIterator Units(MO.getReg(), &TRI); Units.isValid(); ++Units)
+        Defined &= DefinedUnits.count(*Units);
+      if (!Defined && Seen.insert(MO.getReg()).second)
+        Uses.push_back(std::make_pair(MO.getReg(), MO.isUndef()));
+    }
+    for (const MachineOperand &MO : MI.operands()) {
+      if (MO.isRegMask() || !MO.isReg() || !MO.isDef() || !MO.getReg())
+        continue;
+      for (MCRegUnitIterator Units(MO.getReg(), &TRI); Units.isValid(); ++Units)
+        DefinedUnits.insert(*Units);
+      if (std::find(Defs.begin(), Defs.end(), MO.getReg()) == Defs.end())
+        Defs.push_back(MO.getReg());
+    }
+  }
+}
+
+void MachineOutliner::outline(MachineFunction &MF, const Candidate &C) {
+  // Create the outlined copy from the first occurrence. The block is only
+  // reached through the calls, so it has no predecessors; taking its address
+  // keeps it alive and makes the AsmPrinter emit its label.
+  MachineBasicBlock *Body = MF.CreateMachineBasicBlock();
+  MF.push_back(Body);
+  Body->setHasAddressTaken();
+  MachineBasicBlock::iterator First = InstrList[C.Starts[0]];
+  MachineBasicBlock::iterator Last = InstrList[C.Starts[0] + C.Length - 1];
+  for (MachineInstr &MI : make_range(First, std::next(Last))) {
+    if (MI.isDebugValue())
+      continue;
+    MachineInstr *NewMI = MF.CloneMachineInstr(&MI);
+    NewMI->clearKillInfo();
+    Body->push_back(NewMI);
+  }
+
+  SmallVector<std::pair<unsigned, bool>, 8> BodyUses;
+  SmallVector<unsigned, 8> BodyDefs;
+  collectRegisters(First, Last, *TRI, BodyUses, BodyDefs);
+  for (auto &Use : BodyUses)
+    Body->addLiveIn(Use.first);
+  Body->sortUniqueLiveIns();
+
+  TII->buildOutlinedFrame(*Body);
+
+  // Replace every occurrence with a call.
+  for (unsigned Start : C.Starts) {
+    MachineBasicBlock::iterator First = InstrList[Start];
+    MachineBasicBlock::iterator Last = InstrList[Start + C.Length - 1];
+    MachineBasicBlock &MBB = *First->getParent();
+
+    SmallVector<std::pair<unsigned, bool>, 8> Uses;
+    SmallVector<unsigned, 8> Defs;
+    collectRegisters(First, Last, *TRI, Uses, Defs);
+
+    MachineBasicBlock::iterator Call =
+        TII->insertOutlinedCall(MBB, First, *Body);
+    MachineInstrBuilder MIB(MF, *Call);
+    for (auto &Use : Uses)
+      MIB.addReg(Use.first,
+                 RegState::Implicit | (Use.second ? RegState::Undef : 0));
+    for (unsigned Def : Defs)
+      MIB.addReg(Def, RegState::ImplicitDefine);
+
+    MBB.erase(First, std::next(Last));
+    ++NumOutlinedCalls;
+  }
+
+  ++NumOutlinedSequences;
+  NumInstrsSaved += C.Benefit;
+}
+
+bool MachineOutliner::runOnMachineFunction(MachineFunction &MF) {
+  TII = MF.getSubtarget().getInstrInfo();
+  TRI = MF.getSubtarget().getRegisterInfo();
+  if (skipFunction(*MF.getFunction()) || MF.empty() ||
+      !TII->isFunctionSafeToOutlineFrom(MF))
+    return false;
+
+  // The outlined sequences are appended to the function, so the last block
+  // must not fall through.
+  MachineBasicBlock &LastMBB = MF.back();
+  if (LastMBB.empty() || !LastMBB.back().isBarrier())
+    return false;
+
+  Module &M = *const_cast<Module *>(MF.getFunction()->getParent());
+  mapFunction(MF, getAnalysis<MachineBlockFrequencyInfo>(),
+              *getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI(M));
+
+  std::vector<Candidate> Candidates;
+  findCandidates(Candidates);
+
+  // Outline the most beneficial candidates first, dropping the occurrences
+  // that overlap with something already outlined.
+  std::vector<bool> Used(Str.size(), false);
+  bool Changed = false;
+  for (Candidate &C : Candidates) {
+    std::vector<unsigned> Starts;
+    for (unsigned Start : C.Starts)
+      if (std::none_of(Used.begin() + Start, Used.begin() + Start + C.Length,
+                       [](bool U) { return U; }))
+        Starts.push_back(Start);
+    int Benefit = getBenefit(C.Length, Starts.size());
+    if (Starts.size() < 2 || Benefit <= 0)
+      continue;
+
+    for (unsigned Start : Starts)
+      std::fill(Used.begin() + Start, Used.begin() + Start + C.Length, true);
+
+    DEBUG(dbgs() << "Outlining " << Starts.size() << " occurrences of "
+                 << C.Length << " instructions in " << MF.getName()
+                 << ", saving " << Benefit << '\n');
+    C.Starts = std::move(Starts);
+    C.Benefit = Benefit;
+    outline(MF, C);
+    Changed = true;
+  }
+
+  return Changed;
+}
@@ -133,6 +133,20 @@ MachineRegisterInfo::createGenericVirtualRegister(unsigned Size) {
   return Reg;
 }
 
+void MachineRegisterInfo::clearVirtRegSizes() {
+#ifndef NDEBUG
+  // Every generic virtual register must have been given a class by now.
+  for (unsigned VRegIndex = 0; VRegIndex < getNumVirtRegs(); ++VRegIndex) {
+    unsigned Reg = TargetRegisterInfo::index2VirtReg(VRegIndex);
+    if (!getSize(Reg))
+      continue;
+    assert(getRegClassOrNull(Reg) &&
+           "Generic virtual register was not constrained by selection");
+  }
+#endif
+  getVRegToSize().clear();
+}
+
 /// clearVirtRegs - Remove all virtual registers (after physreg assignment).
 void MachineRegisterInfo::clearVirtRegs() {
 #ifndef NDEBUG
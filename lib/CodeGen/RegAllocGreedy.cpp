@@ -55,6 +55,11 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumWorkUnits,    "Number of split and eviction work units spent");
+STATISTIC(NumBudgetExhausted,
+          "Number of functions that exhausted the allocation work budget");
+STATISTIC(NumBudgetSpills,
+          "Number of live ranges spilled without splitting to stay in budget");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -95,6 +100,20 @@ static cl::opt<bool> EnableDeferredSpilling(
              "variable because of other evicted variables."),
     cl::init(false));
 
+static cl::opt<unsigned> FunctionWorkBudget(
+    "regalloc-work-budget", cl::Hidden,
+    cl::desc("Work units per instruction the greedy allocator may spend "
+             "splitting and evicting in a function before falling back to "
+             "spilling (0 = unlimited)"),
+    cl::init(0));
+
+static cl::opt<unsigned> LiveRangeWorkBudget(
+    "regalloc-live-range-work-budget", cl::Hidden,
+    cl::desc("Work units the greedy allocator may spend splitting and "
+             "evicting a single original live range and its split products "
+             "before spilling them (0 = unlimited)"),
+    cl::init(0));
+
 // FIXME: Find a good default for this flag and remove the flag.
 static cl::opt<unsigned>
 CSRFirstTimeCost("regalloc-csr-first-time-cost",
@@ -136,6 +155,13 @@ class RAGreedy : public MachineFunctionPass,
   PQueue Queue;
   unsigned NextCascade;
 
+  // Compile time budget. Splitting and eviction are charged work units
+  // roughly proportional to the number of blocks and live ranges they visit.
+  // Once the function or an original live range runs out of budget, its
+  // spillable ranges are spilled instead of split or allowed to evict.
+  uint64_t WorkBudget;
+  uint64_t WorkSpent;
+
   // Live ranges pass through a number of stages as we try to allocate them.
   // Some of the stages may also create new live ranges:
   //
@@ -204,7 +230,11 @@ class RAGreedy : public MachineFunctionPass,
     // Cascade - Eviction loop prevention. See canEvictInterference().
     unsigned Cascade;
 
-    RegInfo() : Stage(RS_New), Cascade(0) {}
+    // Work - Work units spent on this live range and its split products.
+    // Only maintained for original virtual registers.
+    unsigned Work;
+
+    RegInfo() : Stage(RS_New), Cascade(0), Work(0) {}
   };
 
   IndexedMap<RegInfo, VirtReg2IndexFunctor> ExtraRegInfo;
@@ -228,6 +258,33 @@ class RAGreedy : public MachineFunctionPass,
     }
   }
 
+  /// Charge \p Units of splitting or eviction work to \p VirtReg and the
+  /// current function.
+  void chargeWork(const LiveInterval &VirtReg, unsigned Units) {
+    NumWorkUnits += Units;
+    bool WasExhausted = WorkBudget && WorkSpent > WorkBudget;
+    WorkSpent += Units;
+    if (WorkBudget && !WasExhausted && WorkSpent > WorkBudget) {
+      ++NumBudgetExhausted;
+      DEBUG(dbgs() << "Work budget of " << WorkBudget
+                   << " exhausted, spilling instead of splitting.\n");
+    }
+    unsigned Orig = VRM->getOriginal(VirtReg.reg);
+    ExtraRegInfo.grow(Orig);
+    RegInfo &Info = ExtraRegInfo[Orig];
+    Info.Work = std::min<uint64_t>(uint64_t(Info.Work) + Units, ~0u);
+  }
+
+  /// Return true if no more splitting or eviction work should be spent on
+  /// \p VirtReg.
+  bool isOverBudget(const LiveInterval &VirtReg) const {
+    if (WorkBudget && WorkSpent > WorkBudget)
+      return true;
+    unsigned Orig = VRM->getOriginal(VirtReg.reg);
+    return LiveRangeWorkBudget && ExtraRegInfo.inBounds(Orig) &&
+           ExtraRegInfo[Orig].Work > LiveRangeWorkBudget;
+  }
+
   /// Cost of evicting interference.
   struct EvictionCost {
     unsigned BrokenHints; ///< Total number of broken hints.
@@ -825,6 +882,8 @@ void RAGreedy::evictInterference(LiveInterval &VirtReg, unsigned PhysReg,
     Intfs.append(IVR.begin(), IVR.end());
   }
 
+  chargeWork(VirtReg, Intfs.size());
+
   // Evict them second. This will invalidate the queries.
   for (unsigned i = 0, e = Intfs.size(); i != e; ++i) {
     LiveInterval *Intf = Intfs[i];
@@ -1435,6 +1494,7 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
       continue;
     }
     growRegion(Cand);
+    chargeWork(VirtReg, SA->getUseBlocks().size() + Cand.ActiveBlocks.size());
 
     SpillPlacer->finish();
 
@@ -1959,6 +2019,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   if (LIS->intervalIsInOneMBB(VirtReg)) {
     NamedRegionTimer T("Local Splitting", TimerGroupName, TimePassesIsEnabled);
     SA->analyze(&VirtReg);
+    chargeWork(VirtReg, SA->getUseSlots().size());
     unsigned PhysReg = tryLocalSplit(VirtReg, Order, NewVRegs);
     if (PhysReg || !NewVRegs.empty())
       return PhysReg;
@@ -1968,6 +2029,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   NamedRegionTimer T("Global Splitting", TimerGroupName, TimePassesIsEnabled);
 
   SA->analyze(&VirtReg);
+  chargeWork(VirtReg, SA->getNumLiveBlocks());
 
   // FIXME: SplitAnalysis may repair broken live ranges coming from the
   // coalescer. That may cause the range to become allocatable which means that
@@ -2502,10 +2564,14 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
   DEBUG(dbgs() << StageName[Stage]
                << " Cascade " << ExtraRegInfo[VirtReg.reg].Cascade << '\n');
 
+  // Past the work budget, spillable ranges go straight to the spiller.
+  bool SpillNow = Stage < RS_Done && VirtReg.isSpillable() &&
+                  isOverBudget(VirtReg);
+
   // Try to evict a less worthy live range, but only for ranges from the primary
   // queue. The RS_Split ranges already failed to do this, and they should not
   // get a second chance until they have been split.
-  if (Stage != RS_Split)
+  if (Stage != RS_Split && !SpillNow)
     if (unsigned PhysReg =
             tryEvict(VirtReg, Order, NewVRegs, CostPerUseLimit)) {
       unsigned Hint = MRI->getSimpleHint(VirtReg.reg);
@@ -2524,7 +2590,7 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
   // The first time we see a live range, don't try to split or spill.
   // Wait until the second time, when all smaller ranges have been allocated.
   // This gives a better picture of the interference to split around.
-  if (Stage < RS_Split) {
+  if (Stage < RS_Split && !SpillNow) {
     setStage(VirtReg, RS_Split);
     DEBUG(dbgs() << "wait for second round\n");
     NewVRegs.push_back(VirtReg.reg);
@@ -2537,10 +2603,14 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
     return tryLastChanceRecoloring(VirtReg, Order, NewVRegs, FixedRegisters,
                                    Depth);
 
-  // Try splitting VirtReg or interferences.
-  unsigned PhysReg = trySplit(VirtReg, Order, NewVRegs);
-  if (PhysReg || !NewVRegs.empty())
-    return PhysReg;
+  if (SpillNow) {
+    ++NumBudgetSpills;
+  } else {
+    // Try splitting VirtReg or interferences.
+    unsigned PhysReg = trySplit(VirtReg, Order, NewVRegs);
+    if (PhysReg || !NewVRegs.empty())
+      return PhysReg;
+  }
 
   // Finally spill VirtReg itself.
   if (EnableDeferredSpilling && getStage(VirtReg) < RS_Memory) {
@@ -2606,6 +2676,14 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   ExtraRegInfo.clear();
   ExtraRegInfo.resize(MRI->getNumVirtRegs());
   NextCascade = 1;
+  WorkSpent = 0;
+  WorkBudget = 0;
+  if (FunctionWorkBudget) {
+    uint64_t NumInstrs = 0;
+    for (const MachineBasicBlock &MBB : mf)
+      NumInstrs += MBB.size();
+    WorkBudget = std::max<uint64_t>(NumInstrs, 1) * FunctionWorkBudget;
+  }
   IntfCache.init(MF, Matrix->getLiveUnions(), Indexes, LIS, TRI);
   GlobalCand.resize(32);  // This will grow as needed.
   SetOfBrokenHints.clear();
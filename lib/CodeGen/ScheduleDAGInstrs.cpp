@@ -66,6 +66,15 @@ static cl::opt<unsigned> ReductionSize(
     cl::desc("A huge scheduling region will have maps reduced by this many "
              "nodes at a time. Defaults to HugeRegion / 2."));
 
+// When the stores mapped to a single Value grow beyond this many, the older
+// half of them is chained together so that every new SU gets a bounded number
+// of chain edges. Unlike the reduction of huge regions, this only orders stores
+// that share an underlying object. Loads are never ordered among themselves.
+static cl::opt<unsigned> MaxFanIn("dag-maps-max-fan-in", cl::Hidden,
+    cl::init(64), cl::desc("The maximum number of chain edges added from the "
+                           "stores mapped to one Value to a new SU (0 = no "
+                           "limit)."));
+
 static unsigned getReductionSize() {
   // Always reduce a huge region with half of the elements, except
   // when user sets this number explicitly.
@@ -731,20 +740,35 @@ class ScheduleDAGInstrs::Value2SUsMap : public MapVector<ValueType, SUList> {
 
   /// 1 for loads, 0 for stores. (see comment in SUList)
   unsigned TrueMemOrderLatency;
+
+  /// Whether this map holds stores, whose lists are limited to MaxFanIn SUs.
+  bool IsStoreMap;
+
+  /// Allocator for the nodes of the SULists.
+  BumpPtrAllocator &Allocator;
+
+  /// Chain the oldest half of sus behind its newest SU.
+  void reduceList(SUList &sus);
 public:
 
-  Value2SUsMap(unsigned lat = 0) : NumNodes(0), TrueMemOrderLatency(lat) {}
+  Value2SUsMap(BumpPtrAllocator &Allocator, bool IsStoreMap, unsigned lat = 0)
+      : NumNodes(0), TrueMemOrderLatency(lat), IsStoreMap(IsStoreMap),
+        Allocator(Allocator) {}
 
   /// To keep NumNodes up to date, insert() is used instead of
   /// this operator w/ push_back().
   ValueType &operator[](const SUList &Key) {
     llvm_unreachable("Don't use. Use insert() instead."); };
 
-  /// Add SU to the SUList of V. If Map grows huge, reduce its size
-  /// by calling reduce().
+  /// Add SU to the SUList of V. If the list of a stores map grows beyond
+  /// MaxFanIn, reduce its size by calling reduceList(). The lists of loads
+  /// are left alone, since chaining them would order loads among themselves.
   void inline insert(SUnit *SU, ValueType V) {
-    MapVector::operator[](V).push_back(SU);
+    SUList &sus = MapVector::operator[](V);
+    sus.push_back(SU, Allocator);
     NumNodes++;
+    if (MaxFanIn && IsStoreMap && sus.size() > MaxFanIn)
+      reduceList(sus);
   }
 
   /// Clears the list of SUs mapped to V.
@@ -780,6 +804,26 @@ public:
   void dump();
 };
 
+void ScheduleDAGInstrs::Value2SUsMap::reduceList(SUList &sus) {
+  // The list holds the SUs from the bottom of the region upwards, so the
+  // oldest half is below the rest. Its newest SU becomes the chain that the
+  // others, and the previous chain, are ordered after.
+  unsigned N = sus.size() / 2;
+  SUList::iterator I = sus.begin();
+  SmallVector<SUnit *, 32> Removed;
+  for (unsigned i = 0; i != N; ++i)
+    Removed.push_back(*I++);
+  SUnit *NewChain = Removed.back();
+  Removed.pop_back();
+  for (SUnit *SU : Removed)
+    SU->addPredBarrier(NewChain);
+  if (sus.Chain)
+    sus.Chain->addPredBarrier(NewChain);
+  sus.Chain = NewChain;
+  sus.erase_front(I);
+  NumNodes -= N;
+}
+
 void ScheduleDAGInstrs::addChainDependencies(SUnit *SU,
                                              Value2SUsMap &Val2SUsMap) {
   for (auto &I : Val2SUsMap)
@@ -803,6 +847,8 @@ void ScheduleDAGInstrs::addBarrierChain(Value2SUsMap &map) {
     SUList &sus = I.second;
     for (auto *SU : sus)
       SU->addPredBarrier(BarrierChain);
+    if (sus.Chain)
+      sus.Chain->addPredBarrier(BarrierChain);
   }
   map.clear();
 }
@@ -828,13 +874,18 @@ void ScheduleDAGInstrs::insertBarrierChain(Value2SUsMap &map) {
       SUItr++;
 
     // Remove all SUs that are now successors of BarrierChain.
-    if (SUItr != sus.begin())
-      sus.erase(sus.begin(), SUItr);
+    sus.erase_front(SUItr);
+
+    // The chain of the list is below all SUs in it.
+    if (sus.Chain && sus.Chain->NodeNum > BarrierChain->NodeNum) {
+      sus.Chain->addPredBarrier(BarrierChain);
+      sus.Chain = nullptr;
+    }
   }
 
   // Remove all entries with empty su lists.
   map.remove_if([&](std::pair<ValueType, SUList> &mapEntry) {
-      return (mapEntry.second.empty()); });
+      return (mapEntry.second.empty() && !mapEntry.second.Chain); });
 
   // Recompute the size of the map (NumNodes).
   map.reComputeSize();
@@ -874,7 +925,9 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
   // on it, stores and loads kept separately. Two SUs are trivially
   // non-aliasing if they both depend on only identified Values and do
   // not share any common Value.
-  Value2SUsMap Stores, Loads(1 /*TrueMemOrderLatency*/);
+  SUListAllocator.Reset();
+  Value2SUsMap Stores(SUListAllocator, /*IsStoreMap=*/true),
+      Loads(SUListAllocator, /*IsStoreMap=*/false, 1 /*TrueMemOrderLatency*/);
 
   // Certain memory accesses are known to not alias any SU in Stores
   // or Loads, and have therefore their own 'NonAlias'
@@ -883,7 +936,9 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
   // accesses always have a proper memory operand modelling, and are
   // therefore never unanalyzable, but this is conservatively not
   // done.
-  Value2SUsMap NonAliasStores, NonAliasLoads(1 /*TrueMemOrderLatency*/);
+  Value2SUsMap NonAliasStores(SUListAllocator, /*IsStoreMap=*/true),
+      NonAliasLoads(SUListAllocator, /*IsStoreMap=*/false,
+                    1 /*TrueMemOrderLatency*/);
 
   // Remove any stale debug info; sometimes BuildSchedGraph is called again
   // without emitting the info from the previous call.
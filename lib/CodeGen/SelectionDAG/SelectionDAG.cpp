@@ -772,6 +772,8 @@ bool SelectionDAG::RemoveNodeFromCSEMaps(SDNode *N) {
     assert(N->getOpcode() != ISD::DELETED_NODE && "DELETED_NODE in CSEMap!");
     assert(N->getOpcode() != ISD::EntryToken && "EntryToken in CSEMap!");
     Erased = CSEMap.RemoveNode(N);
+    // The node is about to change, forget the hash of its old profile.
+    N->CSEHash = 0;
     break;
   }
 #ifndef NDEBUG
@@ -988,7 +990,15 @@ SDNode *SelectionDAG::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
 }
 
 void SelectionDAG::clear() {
-  allnodes_clear();
+  // Every node, operand list and debug value of the DAG is released at once
+  // below, so drop the nodes without deallocating them one by one.
+  assert(&*AllNodes.begin() == &EntryNode);
+  AllNodes.remove(AllNodes.begin());
+  AllNodes.clearAndLeakNodesUnsafely();
+  NodeAllocator.Reset();
+#ifndef NDEBUG
+  NextPersistentId = 0;
+#endif
   OperandRecycler.clear(OperandAllocator);
   OperandAllocator.Reset();
   CSEMap.clear();
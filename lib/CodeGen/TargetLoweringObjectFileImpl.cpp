@@ -61,6 +61,42 @@ MCSymbol *TargetLoweringObjectFileELF::getCFIPersonalitySymbol(
   report_fatal_error("We do not support this DWARF encoding yet!");
 }
 
+void TargetLoweringObjectFileELF::emitModuleFlags(
+    MCStreamer &Streamer, ArrayRef<Module::ModuleFlagEntry> ModuleFlags,
+    Mangler &Mang, const TargetMachine &TM) const {
+  MDNode *CGProfile = nullptr;
+  for (const auto &MFE : ModuleFlags) {
+    StringRef Key = MFE.Key->getString();
+    if (Key == "CG Profile")
+      CGProfile = cast<MDNode>(MFE.Val);
+  }
+
+  if (!CGProfile)
+    return;
+
+  // Each entry is the null-terminated symbol names of the caller and the
+  // callee, followed by the 64-bit count of the calls.  Names rather than
+  // relocations keep the section valid when the linker drops either side.
+  MCSection *Sec = getContext().getELFSection(".llvm.call-graph-profile",
+                                              ELF::SHT_PROGBITS,
+                                              ELF::SHF_EXCLUDE);
+  Streamer.SwitchSection(Sec);
+  for (const MDOperand &Op : CGProfile->operands()) {
+    MDNode *Edge = cast<MDNode>(Op);
+    auto *From = mdconst::dyn_extract_or_null<GlobalValue>(Edge->getOperand(0));
+    auto *To = mdconst::dyn_extract_or_null<GlobalValue>(Edge->getOperand(1));
+    if (!From || !To)
+      continue;
+    for (const GlobalValue *GV : {From, To}) {
+      SmallString<64> Name = TM.getSymbol(GV, Mang)->getName();
+      Name.push_back('\0');
+      Streamer.EmitBytes(Name);
+    }
+    Streamer.EmitIntValue(
+        mdconst::extract<ConstantInt>(Edge->getOperand(2))->getZExtValue(), 8);
+  }
+}
+
 void TargetLoweringObjectFileELF::emitPersonalityValue(
     MCStreamer &Streamer, const DataLayout &DL, const MCSymbol *Sym) const {
   SmallString<64> NameData("DW.ref.");
@@ -293,8 +329,12 @@ selectELFSectionForGlobal(MCContext &Ctx, const GlobalValue *GV,
   } else {
     Name = getSectionPrefixForGlobal(Kind);
   }
-  // FIXME: Extend the section prefix to include hotness catagories such as .hot
-  //  or .unlikely for functions.
+
+  // Functions can ask for a section with a hotness suffix, e.g. .text.unlikely
+  // for the cold regions split out of their callers.
+  if (const Function *F = dyn_cast<Function>(GV))
+    if (Optional<StringRef> Prefix = F->getSectionPrefix())
+      Name += *Prefix;
 
   if (EmitUniqueSection && UniqueSectionNames) {
     Name.push_back('.');
@@ -125,6 +125,11 @@ static cl::opt<CFLAAType> UseCFLAA(
                           "Enable both variants of CFL-AA"),
                clEnumValEnd));
 
+static cl::opt<bool> EnableMachineOutliner(
+    "enable-machine-outliner", cl::init(false), cl::Hidden,
+    cl::desc("Replace repeated instruction sequences with calls to a single "
+             "outlined copy"));
+
 cl::opt<bool> UseIPRA("enable-ipra", cl::init(false), cl::Hidden,
                       cl::desc("Enable interprocedural register allocation "
                                "to reduce load/store at procedure calls."));
@@ -660,6 +665,9 @@ void TargetPassConfig::addMachinePasses() {
   addPass(&StackMapLivenessID, false);
   addPass(&LiveDebugValuesID, false);
 
+  if (EnableMachineOutliner && getOptLevel() != CodeGenOpt::None)
+    addPass(&MachineOutlinerID);
+
   addPass(&PatchableFunctionID, false);
 
   AddingMachinePasses = false;
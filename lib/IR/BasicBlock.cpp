@@ -86,8 +86,12 @@ BasicBlock::~BasicBlock() {
 }
 
 void BasicBlock::setParent(Function *parent) {
+  if (Parent)
+    Parent->setVerified(false);
   // Set Parent=parent, updating instruction symtab entries as appropriate.
   InstList.setSymTabObject(&Parent, parent);
+  if (parent)
+    parent->setVerified(false);
 }
 
 void BasicBlock::removeFromParent() {
@@ -101,6 +105,7 @@ iplist<BasicBlock>::iterator BasicBlock::eraseFromParent() {
 /// Unlink this basic block from its current function and
 /// insert it into the function that MovePos lives in, right before MovePos.
 void BasicBlock::moveBefore(BasicBlock *MovePos) {
+  getParent()->setVerified(false);
   MovePos->getParent()->getBasicBlockList().splice(
       MovePos->getIterator(), getParent()->getBasicBlockList(), getIterator());
 }
@@ -108,6 +113,7 @@ void BasicBlock::moveBefore(BasicBlock *MovePos) {
 /// Unlink this basic block from its current function and
 /// insert it into the function that MovePos lives in, right after MovePos.
 void BasicBlock::moveAfter(BasicBlock *MovePos) {
+  getParent()->setVerified(false);
   MovePos->getParent()->getBasicBlockList().splice(
       ++MovePos->getIterator(), getParent()->getBasicBlockList(),
       getIterator());
@@ -422,6 +422,7 @@ const std::string &Function::getGC() const {
 void Function::setGC(std::string Str) {
   setValueSubclassDataBit(14, !Str.empty());
   getContext().setGC(*this, std::move(Str));
+  setVerified(false);
 }
 
 void Function::clearGC() {
@@ -429,6 +430,7 @@ void Function::clearGC() {
     return;
   getContext().deleteGC(*this);
   setValueSubclassDataBit(14, false);
+  setVerified(false);
 }
 
 /// Copy all additional attributes (those not needed to create a Function) from
@@ -1169,6 +1171,7 @@ Constant *Function::getPersonalityFn() const {
 void Function::setPersonalityFn(Constant *Fn) {
   setHungoffOperand<0>(Fn);
   setValueSubclassDataBit(3, Fn != nullptr);
+  setVerified(false);
 }
 
 Constant *Function::getPrefixData() const {
@@ -1179,6 +1182,7 @@ Constant *Function::getPrefixData() const {
 void Function::setPrefixData(Constant *PrefixData) {
   setHungoffOperand<1>(PrefixData);
   setValueSubclassDataBit(1, PrefixData != nullptr);
+  setVerified(false);
 }
 
 Constant *Function::getPrologueData() const {
@@ -1189,6 +1193,7 @@ Constant *Function::getPrologueData() const {
 void Function::setPrologueData(Constant *PrologueData) {
   setHungoffOperand<2>(PrologueData);
   setValueSubclassDataBit(2, PrologueData != nullptr);
+  setVerified(false);
 }
 
 void Function::allocHungoffUselist() {
@@ -1240,3 +1245,20 @@ Optional<uint64_t> Function::getEntryCount() const {
       }
   return None;
 }
+
+void Function::setSectionPrefix(StringRef Prefix) {
+  MDBuilder MDB(getContext());
+  setMetadata(LLVMContext::MD_section_prefix,
+              MDB.createFunctionSectionPrefix(Prefix));
+}
+
+Optional<StringRef> Function::getSectionPrefix() const {
+  if (MDNode *MD = getMetadata(LLVMContext::MD_section_prefix)) {
+    assert(cast<MDString>(MD->getOperand(0))
+               ->getString()
+               .equals("function_section_prefix") &&
+           "Metadata not match");
+    return cast<MDString>(MD->getOperand(1))->getString();
+  }
+  return None;
+}
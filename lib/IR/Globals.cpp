@@ -37,6 +37,11 @@ std::error_code GlobalValue::materialize() {
   return getParent()->materialize(this);
 }
 
+void GlobalValue::markFunctionUnverified() {
+  if (auto *F = dyn_cast<Function>(this))
+    F->setVerified(false);
+}
+
 /// Override destroyConstantImpl to make sure it doesn't get called on
 /// GlobalValue's because they shouldn't be treated like other constants.
 void GlobalValue::destroyConstantImpl() {
@@ -51,7 +51,15 @@ Instruction::~Instruction() {
 
 
 void Instruction::setParent(BasicBlock *P) {
+  markFunctionUnverified();
   Parent = P;
+  markFunctionUnverified();
+}
+
+void Instruction::markFunctionUnverified() {
+  if (Parent)
+    if (Function *F = Parent->getParent())
+      F->setVerified(false);
 }
 
 const Module *Instruction::getModule() const {
@@ -92,20 +100,25 @@ void Instruction::insertAfter(Instruction *InsertPos) {
 /// Unlink this instruction from its current basic block and insert it into the
 /// basic block that MovePos lives in, right before MovePos.
 void Instruction::moveBefore(Instruction *MovePos) {
+  // Moving within a block does not go through setParent.
+  markFunctionUnverified();
   MovePos->getParent()->getInstList().splice(
       MovePos->getIterator(), getParent()->getInstList(), getIterator());
 }
 
 void Instruction::setHasNoUnsignedWrap(bool b) {
   cast<OverflowingBinaryOperator>(this)->setHasNoUnsignedWrap(b);
+  markFunctionUnverified();
 }
 
 void Instruction::setHasNoSignedWrap(bool b) {
   cast<OverflowingBinaryOperator>(this)->setHasNoSignedWrap(b);
+  markFunctionUnverified();
 }
 
 void Instruction::setIsExact(bool b) {
   cast<PossiblyExactOperator>(this)->setIsExact(b);
+  markFunctionUnverified();
 }
 
 bool Instruction::hasNoUnsignedWrap() const {
@@ -126,6 +139,7 @@ bool Instruction::isExact() const {
 void Instruction::setHasUnsafeAlgebra(bool B) {
   assert(isa<FPMathOperator>(this) && "setting fast-math flag on invalid op");
   cast<FPMathOperator>(this)->setHasUnsafeAlgebra(B);
+  markFunctionUnverified();
 }
 
 /// Set or clear the NoNaNs flag on this instruction, which must be an operator
@@ -133,6 +147,7 @@ void Instruction::setHasUnsafeAlgebra(bool B) {
 void Instruction::setHasNoNaNs(bool B) {
   assert(isa<FPMathOperator>(this) && "setting fast-math flag on invalid op");
   cast<FPMathOperator>(this)->setHasNoNaNs(B);
+  markFunctionUnverified();
 }
 
 /// Set or clear the no-infs flag on this instruction, which must be an operator
@@ -140,6 +155,7 @@ void Instruction::setHasNoNaNs(bool B) {
 void Instruction::setHasNoInfs(bool B) {
   assert(isa<FPMathOperator>(this) && "setting fast-math flag on invalid op");
   cast<FPMathOperator>(this)->setHasNoInfs(B);
+  markFunctionUnverified();
 }
 
 /// Set or clear the no-signed-zeros flag on this instruction, which must be an
@@ -148,6 +164,7 @@ void Instruction::setHasNoInfs(bool B) {
 void Instruction::setHasNoSignedZeros(bool B) {
   assert(isa<FPMathOperator>(this) && "setting fast-math flag on invalid op");
   cast<FPMathOperator>(this)->setHasNoSignedZeros(B);
+  markFunctionUnverified();
 }
 
 /// Set or clear the allow-reciprocal flag on this instruction, which must be an
@@ -156,6 +173,7 @@ void Instruction::setHasNoSignedZeros(bool B) {
 void Instruction::setHasAllowReciprocal(bool B) {
   assert(isa<FPMathOperator>(this) && "setting fast-math flag on invalid op");
   cast<FPMathOperator>(this)->setHasAllowReciprocal(B);
+  markFunctionUnverified();
 }
 
 /// Convenience function for setting all the fast-math flags on this
@@ -164,11 +182,13 @@ void Instruction::setHasAllowReciprocal(bool B) {
 void Instruction::setFastMathFlags(FastMathFlags FMF) {
   assert(isa<FPMathOperator>(this) && "setting fast-math flag on invalid op");
   cast<FPMathOperator>(this)->setFastMathFlags(FMF);
+  markFunctionUnverified();
 }
 
 void Instruction::copyFastMathFlags(FastMathFlags FMF) {
   assert(isa<FPMathOperator>(this) && "copying fast-math flag on invalid op");
   cast<FPMathOperator>(this)->copyFastMathFlags(FMF);
+  markFunctionUnverified();
 }
 
 /// Determine whether the unsafe-algebra flag is set.
@@ -137,6 +137,11 @@ void PHINode::growOperands() {
   growHungoffUses(ReservedSpace, /* IsPhi */ true);
 }
 
+void PHINode::shrinkToFit() {
+  shrinkHungoffUses(ReservedSpace, /* IsPhi */ true);
+  ReservedSpace = getNumOperands();
+}
+
 /// hasConstantValue - If the specified PHI node always merges together the same
 /// value, return the value, otherwise return null.
 Value *PHINode::hasConstantValue() const {
@@ -1180,6 +1185,7 @@ void BranchInst::swapSuccessors() {
   assert(isConditional() &&
          "Cannot swap successors of an unconditional branch");
   Op<-1>().swap(Op<-2>());
+  markFunctionUnverified();
 
   // Update profile metadata if present and it matches our structural
   // expectations.
@@ -2272,6 +2278,7 @@ bool BinaryOperator::swapOperands() {
   if (!isCommutative())
     return true; // Can't commute operands
   Op<0>().swap(Op<1>());
+  markFunctionUnverified();
   return false;
 }
 
@@ -3754,6 +3761,11 @@ void SwitchInst::growOperands() {
   growHungoffUses(ReservedSpace);
 }
 
+void SwitchInst::shrinkToFit() {
+  shrinkHungoffUses(ReservedSpace);
+  ReservedSpace = getNumOperands();
+}
+
 
 BasicBlock *SwitchInst::getSuccessorV(unsigned idx) const {
   return getSuccessor(idx);
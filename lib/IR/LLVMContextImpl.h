@@ -1058,6 +1058,8 @@ public:
   FoldingSet<AttributeSetNode> AttrsSetNodes;
 
   StringMap<MDString, BumpPtrAllocator> MDStringCache;
+  /// If set, MDStrings are uniqued here instead of in MDStringCache.
+  SharedMDStringPool *SharedMDStrings = nullptr;
   DenseMap<Value *, ValueAsMetadata *> ValuesAsMetadata;
   DenseMap<Metadata *, MetadataAsValue *> MetadataAsValues;
 
@@ -1527,8 +1527,10 @@ bool FPPassManager::runOnFunction(Function &F) {
     }
 
     Changed |= LocalChanged;
-    if (LocalChanged)
+    if (LocalChanged) {
+      F.setVerified(false);
       dumpPassInfo(FP, MODIFICATION_MSG, ON_FUNCTION_MSG, F.getName());
+    }
     dumpPreservedSet(FP);
     dumpUsedSet(FP);
 
@@ -1604,9 +1606,14 @@ MPPassManager::runOnModule(Module &M) {
     }
 
     Changed |= LocalChanged;
-    if (LocalChanged)
+    if (LocalChanged) {
+      // Nested pass managers already tracked which functions they changed.
+      if (!MP->getAsPMDataManager())
+        for (Function &F : M)
+          F.setVerified(false);
       dumpPassInfo(MP, MODIFICATION_MSG, ON_MODULE_MSG,
                    M.getModuleIdentifier());
+    }
     dumpPreservedSet(MP);
     dumpUsedSet(MP);
 
@@ -23,6 +23,7 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/SharedMDStringPool.h"
 #include "llvm/IR/ValueHandle.h"
 
 using namespace llvm;
@@ -415,6 +416,9 @@ void ValueAsMetadata::handleRAUW(Value *From, Value *To) {
 //
 
 MDString *MDString::get(LLVMContext &Context, StringRef Str) {
+  if (SharedMDStringPool *Pool = Context.pImpl->SharedMDStrings)
+    return Pool->get(Str);
+
   auto &Store = Context.pImpl->MDStringCache;
   auto I = Store.emplace_second(Str);
   auto &MapEntry = I.first->getValue();
@@ -429,6 +433,26 @@ StringRef MDString::getString() const {
   return Entry->first();
 }
 
+MDString *SharedMDStringPool::get(StringRef Str) {
+  Shard &S = Shards[hash_value(Str) % NumShards];
+  sys::ScopedLock Guard(S.Lock);
+  auto I = S.Strings.emplace_second(Str);
+  auto &MapEntry = I.first->getValue();
+  if (!I.second)
+    return &MapEntry;
+  MapEntry.Entry = &*I.first;
+  return &MapEntry;
+}
+
+size_t SharedMDStringPool::size() {
+  size_t Size = 0;
+  for (Shard &S : Shards) {
+    sys::ScopedLock Guard(S.Lock);
+    Size += S.Strings.size();
+  }
+  return Size;
+}
+
 //===----------------------------------------------------------------------===//
 // MDNode implementation.
 //
@@ -1179,6 +1203,7 @@ void Instruction::dropUnknownNonDebugMetadata(ArrayRef<unsigned> KnownIDs) {
   if (!hasMetadataHashEntry())
     return; // Nothing to remove!
 
+  markFunctionUnverified();
   auto &InstructionMetadata = getContext().pImpl->InstructionMetadata;
 
   if (KnownSet.empty()) {
@@ -1204,6 +1229,8 @@ void Instruction::setMetadata(unsigned KindID, MDNode *Node) {
   if (!Node && !hasMetadata())
     return;
 
+  markFunctionUnverified();
+
   // Handle 'dbg' as a special case since it is not stored in the hash table.
   if (KindID == LLVMContext::MD_dbg) {
     DbgLoc = DebugLoc(Node);
@@ -1331,6 +1358,7 @@ void GlobalObject::getMetadata(StringRef Kind,
 }
 
 void GlobalObject::addMetadata(unsigned KindID, MDNode &MD) {
+  markFunctionUnverified();
   if (!hasMetadata())
     setHasMetadataHashEntry(true);
 
@@ -1346,6 +1374,7 @@ void GlobalObject::eraseMetadata(unsigned KindID) {
   if (!hasMetadata())
     return;
 
+  markFunctionUnverified();
   auto &Store = getContext().pImpl->GlobalObjectMetadata[this];
   Store.erase(KindID);
   if (Store.empty())
@@ -1365,6 +1394,7 @@ void GlobalObject::getAllMetadata(
 void GlobalObject::clearMetadata() {
   if (!hasMetadata())
     return;
+  markFunctionUnverified();
   getContext().pImpl->GlobalObjectMetadata.erase(this);
   setHasMetadataHashEntry(false);
 }
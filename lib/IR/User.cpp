@@ -10,6 +10,7 @@
 #include "llvm/IR/User.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/GlobalValue.h"
+#include "llvm/IR/Instruction.h"
 #include "llvm/IR/Operator.h"
 
 namespace llvm {
@@ -21,6 +22,11 @@ class BasicBlock;
 
 void User::anchor() {}
 
+void User::markInstructionUnverified() {
+  if (auto *I = dyn_cast<Instruction>(this))
+    I->markFunctionUnverified();
+}
+
 void User::replaceUsesOfWith(Value *From, Value *To) {
   if (From == To) return;   // Duh what?
 
@@ -88,6 +94,31 @@ void User::growHungoffUses(unsigned NewNumUses, bool IsPhi) {
 }
 
 
+void User::shrinkHungoffUses(unsigned OldNumReserved, bool IsPhi) {
+  assert(HasHungOffUses && "realloc must have hung off uses");
+
+  unsigned NumUses = getNumOperands();
+  assert(OldNumReserved >= NumUses && "more uses than were reserved");
+  if (OldNumReserved == NumUses)
+    return;
+
+  Use *OldOps = getOperandList();
+  allocHungoffUses(NumUses, IsPhi);
+  Use *NewOps = getOperandList();
+
+  std::copy(OldOps, OldOps + NumUses, NewOps);
+
+  // The BB pointers of a Phi follow the reserved space, not the used space.
+  if (IsPhi) {
+    auto *OldPtr = reinterpret_cast<char *>(OldOps + OldNumReserved) +
+                   sizeof(Use::UserRef);
+    auto *NewPtr =
+        reinterpret_cast<char *>(NewOps + NumUses) + sizeof(Use::UserRef);
+    std::copy(OldPtr, OldPtr + (NumUses * sizeof(BasicBlock *)), NewPtr);
+  }
+  Use::zap(OldOps, OldOps + OldNumReserved, true);
+}
+
 // This is a private struct used by `User` to track the co-allocated descriptor
 // section.
 struct DescriptorInfo {
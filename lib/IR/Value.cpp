@@ -382,13 +382,16 @@ void Value::replaceAllUsesWith(Value *New) {
 
   while (!use_empty()) {
     Use &U = *UseList;
+    User *Usr = U.getUser();
     // Must handle Constants specially, we cannot call replaceUsesOfWith on a
     // constant because they are uniqued.
-    if (auto *C = dyn_cast<Constant>(U.getUser())) {
+    if (auto *C = dyn_cast<Constant>(Usr)) {
       if (!isa<GlobalValue>(C)) {
         C->handleOperandChange(this, New);
         continue;
       }
+    } else if (auto *I = dyn_cast<Instruction>(Usr)) {
+      I->markFunctionUnverified();
     }
 
     U.set(New);
@@ -415,6 +418,8 @@ void Value::replaceUsesOutsideBlock(Value *New, BasicBlock *BB) {
     auto *Usr = dyn_cast<Instruction>(U.getUser());
     if (Usr && Usr->getParent() == BB)
       continue;
+    if (Usr)
+      Usr->markFunctionUnverified();
     U.set(New);
   }
 }
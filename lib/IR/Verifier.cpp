@@ -82,6 +82,11 @@ using namespace llvm;
 
 static cl::opt<bool> VerifyDebugInfo("verify-debug-info", cl::init(true));
 
+static cl::opt<bool> VerifyAllFunctions(
+    "verify-all-functions", cl::init(false), cl::Hidden,
+    cl::desc("Make the verifier pass re-check functions that have not been "
+             "modified since they were last verified"));
+
 namespace {
 struct VerifierSupport {
   raw_ostream *OS;
@@ -232,6 +237,14 @@ class Verifier : public InstVisitor<Verifier>, VerifierSupport {
   /// already.
   bool SawFrameEscape;
 
+  /// \brief Whether we've seen a call to @llvm.localrecover in this function.
+  bool SawFrameRecover;
+
+  /// \brief Whether the function verified last may be skipped the next time,
+  /// provided it is not modified in between.  Functions that feed the
+  /// module-level llvm.localescape checks are always re-verified.
+  bool LastFunctionCacheable;
+
   /// Stores the count of how many objects were passed to llvm.localescape for a
   /// given function and the largest index passed to llvm.localrecover.
   DenseMap<Function *, std::pair<unsigned, unsigned>> FrameEscapeInfo;
@@ -265,12 +278,16 @@ class Verifier : public InstVisitor<Verifier>, VerifierSupport {
 public:
   explicit Verifier(raw_ostream *OS, bool ShouldTreatBrokenDebugInfoAsError)
       : VerifierSupport(OS), Context(nullptr), LandingPadResultTy(nullptr),
-        SawFrameEscape(false) {
+        SawFrameEscape(false), SawFrameRecover(false),
+        LastFunctionCacheable(false) {
     TreatBrokenDebugInfoAsError = ShouldTreatBrokenDebugInfoAsError;
   }
 
   bool hasBrokenDebugInfo() const { return BrokenDebugInfo; }
 
+  /// \brief Whether the result of the last verify(Function) may be cached.
+  bool isLastFunctionCacheable() const { return LastFunctionCacheable; }
+
   bool verify(const Function &F) {
     updateModule(F.getParent());
     Context = &M->getContext();
@@ -301,9 +318,11 @@ public:
     // FIXME: We strip const here because the inst visitor strips const.
     visit(const_cast<Function &>(F));
     verifySiblingFuncletUnwinds();
+    LastFunctionCacheable = !SawFrameEscape && !SawFrameRecover;
     InstsInThisBlock.clear();
     LandingPadResultTy = nullptr;
     SawFrameEscape = false;
+    SawFrameRecover = false;
     SiblingFuncletInfo.clear();
 
     return !Broken;
@@ -3911,6 +3930,7 @@ void Verifier::visitIntrinsicCallSite(Intrinsic::ID ID, CallSite CS) {
     auto &Entry = FrameEscapeInfo[Fn];
     Entry.second = unsigned(
         std::max(uint64_t(Entry.second), IdxArg->getLimitedValue(~0U) + 1));
+    SawFrameRecover = true;
     break;
   }
 
@@ -4329,8 +4349,17 @@ struct VerifierLegacyPass : public FunctionPass {
   }
 
   bool runOnFunction(Function &F) override {
-    if (!V.verify(F) && FatalErrors)
-      report_fatal_error("Broken function found, compilation aborted!");
+    // Functions that passed verification are only re-checked once the IR
+    // mutation APIs or the pass managers have recorded a change to them.
+    if (F.isVerified() && !VerifyAllFunctions)
+      return false;
+
+    if (!V.verify(F)) {
+      if (FatalErrors)
+        report_fatal_error("Broken function found, compilation aborted!");
+    } else if (!V.hasBrokenDebugInfo() && V.isLastFunctionCacheable()) {
+      F.setVerified(true);
+    }
 
     return false;
   }
@@ -4354,6 +4383,8 @@ struct VerifierLegacyPass : public FunctionPass {
       M.getContext().diagnose(DiagInvalid);
       if (!StripDebugInfo(M))
         report_fatal_error("Failed to strip malformed debug info");
+      for (Function &F : M)
+        F.setVerified(false);
     }
     return false;
   }
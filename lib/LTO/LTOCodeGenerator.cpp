@@ -54,6 +54,7 @@
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Target/TargetRegisterInfo.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
+#include "llvm/Transforms/CGProfile.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
@@ -89,6 +90,13 @@ cl::opt<bool> LTOStripInvalidDebugInfo(
     cl::init(false),
 #endif
     cl::Hidden);
+
+// Code generation time roughly follows the size of a partition, and the
+// slowest partition determines when all of them are done.
+cl::opt<bool> LTOBalancePartitions(
+    "lto-balance-partitions",
+    cl::desc("Balance parallel code generation partitions by their size"),
+    cl::init(false), cl::Hidden);
 }
 
 LTOCodeGenerator::LTOCodeGenerator(LLVMContext &Context)
@@ -234,6 +242,39 @@ bool LTOCodeGenerator::writeMergedModules(const char *Path) {
   return true;
 }
 
+bool LTOCodeGenerator::writeFunctionOrderFile(const char *Path) {
+  if (!determineTarget())
+    return false;
+
+  std::error_code EC;
+  tool_output_file Out(Path, EC, sys::fs::F_Text);
+  if (EC) {
+    std::string ErrMsg = "could not open function order file for writing: ";
+    ErrMsg += Path;
+    emitError(ErrMsg);
+    return false;
+  }
+
+  Mangler Mang;
+  for (const Function *F : getCallGraphProfileOrder(*MergedModule)) {
+    SmallString<64> Name;
+    TargetMach->getNameWithPrefix(Name, F, Mang);
+    Out.os() << Name << '\n';
+  }
+  Out.os().close();
+
+  if (Out.os().has_error()) {
+    std::string ErrMsg = "could not write function order file: ";
+    ErrMsg += Path;
+    emitError(ErrMsg);
+    Out.os().clear_error();
+    return false;
+  }
+
+  Out.keep();
+  return true;
+}
+
 bool LTOCodeGenerator::compileOptimizedToFile(const char **Name) {
   // make unique temp output file to put generated code
   SmallString<128> Filename;
@@ -579,7 +620,8 @@ bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out) {
   // MergedModule.
   MergedModule = splitCodeGen(std::move(MergedModule), Out, {},
                               [&]() { return createTargetMachine(); }, FileType,
-                              ShouldRestoreGlobalsLinkage);
+                              ShouldRestoreGlobalsLinkage,
+                              LTOBalancePartitions);
 
   // If statistics were requested, print them out after codegen.
   if (llvm::AreStatisticsEnabled())
@@ -8,6 +8,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/MC/MCAssembler.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Twine.h"
@@ -659,8 +662,7 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
   }
 
   // Layout until everything fits.
-  while (layoutOnce(Layout))
-    continue;
+  relaxSections(Layout);
 
   DEBUG_WITH_TYPE("mc-dump", {
       llvm::errs() << "assembler backend - post-relaxation\n--\n";
@@ -896,17 +898,104 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   return false;
 }
 
-bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
-  ++stats::RelaxationSteps;
+/// Add the sections of the symbols that \p E refers to to \p Sections.
+/// Return false if they cannot be determined.
+static bool collectReferencedSections(const MCExpr &E,
+                                      SmallPtrSetImpl<MCSection *> &Sections) {
+  switch (E.getKind()) {
+  case MCExpr::Target:
+    return false;
+  case MCExpr::Constant:
+    return true;
+  case MCExpr::Unary:
+    return collectReferencedSections(*cast<MCUnaryExpr>(E).getSubExpr(),
+                                     Sections);
+  case MCExpr::Binary: {
+    const MCBinaryExpr &BE = cast<MCBinaryExpr>(E);
+    return collectReferencedSections(*BE.getLHS(), Sections) &&
+           collectReferencedSections(*BE.getRHS(), Sections);
+  }
+  case MCExpr::SymbolRef: {
+    const MCSymbol &Sym = cast<MCSymbolRefExpr>(E).getSymbol();
+    if (Sym.isVariable())
+      return collectReferencedSections(*Sym.getVariableValue(false), Sections);
+    if (Sym.isInSection(false))
+      Sections.insert(&Sym.getSection(false));
+    return true;
+  }
+  }
+  llvm_unreachable("Invalid assembly expression kind!");
+}
 
-  bool WasRelaxed = false;
-  for (iterator it = begin(), ie = end(); it != ie; ++it) {
-    MCSection &Sec = *it;
-    while (layoutSectionOnce(Layout, Sec))
-      WasRelaxed = true;
+void MCAssembler::relaxSections(MCAsmLayout &Layout) {
+  // Find the sections with fragments that may need relaxing, and the sections
+  // whose layout the relaxation of these fragments depends on.  Sections
+  // without such fragments never need to be laid out again.
+  SetVector<MCSection *> Worklist;
+  DenseMap<MCSection *, SmallVector<MCSection *, 2>> Users;
+  SmallVector<MCSection *, 4> UsersOfAll;
+  for (MCSection &Sec : *this) {
+    SmallPtrSet<MCSection *, 4> Referenced;
+    bool Relaxable = false, Known = true;
+    for (MCFragment &F : Sec) {
+      switch (F.getKind()) {
+      default:
+        continue;
+      case MCFragment::FT_Relaxable:
+        for (const MCFixup &Fixup : cast<MCRelaxableFragment>(F).getFixups())
+          Known &= collectReferencedSections(*Fixup.getValue(), Referenced);
+        break;
+      case MCFragment::FT_Dwarf:
+        Known &= collectReferencedSections(
+            cast<MCDwarfLineAddrFragment>(F).getAddrDelta(), Referenced);
+        break;
+      case MCFragment::FT_DwarfFrame:
+        Known &= collectReferencedSections(
+            cast<MCDwarfCallFrameFragment>(F).getAddrDelta(), Referenced);
+        break;
+      case MCFragment::FT_LEB:
+        Known &= collectReferencedSections(cast<MCLEBFragment>(F).getValue(),
+                                           Referenced);
+        break;
+      case MCFragment::FT_CVInlineLines:
+      case MCFragment::FT_CVDefRange:
+        Known = false;
+        break;
+      }
+      Relaxable = true;
+    }
+    if (!Relaxable)
+      continue;
+    Worklist.insert(&Sec);
+    if (!Known) {
+      UsersOfAll.push_back(&Sec);
+      continue;
+    }
+    for (MCSection *Ref : Referenced)
+      if (Ref != &Sec)
+        Users[Ref].push_back(&Sec);
   }
 
-  return WasRelaxed;
+  // Relax each section until it is stable, and revisit the sections that
+  // depend on it whenever it changed.
+  while (!Worklist.empty()) {
+    ++stats::RelaxationSteps;
+    MCSection *Sec = *Worklist.begin();
+    Worklist.remove(Sec);
+
+    bool WasRelaxed = false;
+    while (layoutSectionOnce(Layout, *Sec))
+      WasRelaxed = true;
+    if (!WasRelaxed)
+      continue;
+
+    auto It = Users.find(Sec);
+    if (It != Users.end())
+      Worklist.insert(It->second.begin(), It->second.end());
+    for (MCSection *User : UsersOfAll)
+      if (User != Sec)
+        Worklist.insert(User);
+  }
 }
 
 void MCAssembler::finishLayout(MCAsmLayout &Layout) {
@@ -0,0 +1,202 @@
+//===- AArch64InstructionSelector.cpp ----------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the InstructionSelector class for
+/// AArch64.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "AArch64InstructionSelector.h"
+#include "AArch64InstrInfo.h"
+#include "AArch64RegisterBankInfo.h"
+#include "AArch64RegisterInfo.h"
+#include "AArch64Subtarget.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "aarch64-isel"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+AArch64InstructionSelector::AArch64InstructionSelector(
+    const AArch64Subtarget &STI, const AArch64RegisterBankInfo &RBI)
+    : InstructionSelector(), TII(*STI.getInstrInfo()),
+      TRI(*STI.getRegisterInfo()), RBI(RBI) {}
+
+/// Return the register class of a \p Size bits wide value living in the
+/// \p RB register bank, or nullptr if there is none.
+static const TargetRegisterClass *getRegClassForSize(unsigned Size,
+                                                     const RegisterBank &RB) {
+  if (RB.getID() == AArch64::GPRRegBankID) {
+    if (Size <= 32)
+      return &AArch64::GPR32RegClass;
+    if (Size == 64)
+      return &AArch64::GPR64RegClass;
+    return nullptr;
+  }
+
+  if (RB.getID() == AArch64::FPRRegBankID) {
+    switch (Size) {
+    case 32:
+      return &AArch64::FPR32RegClass;
+    case 64:
+      return &AArch64::FPR64RegClass;
+    case 128:
+      return &AArch64::FPR128RegClass;
+    }
+  }
+  return nullptr;
+}
+
+/// Give the generic virtual register \p Reg the register class matching its
+/// size and register bank.
+static bool constrainGenericReg(unsigned Reg, MachineRegisterInfo &MRI,
+                                const TargetRegisterInfo &TRI,
+                                const RegisterBankInfo &RBI) {
+  if (TargetRegisterInfo::isPhysicalRegister(Reg) || MRI.getRegClassOrNull(Reg))
+    return true;
+
+  const RegisterBank *RB = RBI.getRegBank(Reg, MRI, TRI);
+  if (!RB)
+    return false;
+  const TargetRegisterClass *RC = getRegClassForSize(MRI.getSize(Reg), *RB);
+  if (!RC) {
+    DEBUG(dbgs() << "No register class for a " << MRI.getSize(Reg)
+                 << "-bit value in the " << RB->getName() << " bank\n");
+    return false;
+  }
+  MRI.setRegClass(Reg, RC);
+  return true;
+}
+
+/// Select the AArch64 opcode for the generic binary operation \p GenericOpc,
+/// performed on \p OpSize bits wide general purpose registers.
+/// \returns \p GenericOpc if the combination is unsupported.
+static unsigned selectBinaryOp(unsigned GenericOpc, unsigned OpSize) {
+  switch (OpSize) {
+  case 32:
+    switch (GenericOpc) {
+    case TargetOpcode::G_ADD:
+      return AArch64::ADDWrr;
+    case TargetOpcode::G_OR:
+      return AArch64::ORRWrr;
+    }
+    break;
+  case 64:
+    switch (GenericOpc) {
+    case TargetOpcode::G_ADD:
+      return AArch64::ADDXrr;
+    case TargetOpcode::G_OR:
+      return AArch64::ORRXrr;
+    }
+    break;
+  }
+  return GenericOpc;
+}
+
+bool AArch64InstructionSelector::select(MachineInstr &I) const {
+  assert(I.getParent() && "Instruction should be in a basic block!");
+  assert(I.getParent()->getParent() && "Instruction should be in a function!");
+
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  // Target instructions only need their generic operands, created by the
+  // call lowering for instance, to be given a register class.
+  if (!isPreISelGenericOpcode(I.getOpcode())) {
+    for (const MachineOperand &MO : I.operands())
+      if (MO.isReg() && MO.getReg() &&
+          !constrainGenericReg(MO.getReg(), MRI, TRI, RBI))
+        return false;
+    return true;
+  }
+
+  Type *Ty = I.getType();
+  assert(Ty && "Generic instruction without a type");
+  const unsigned Opcode = I.getOpcode();
+
+  switch (Opcode) {
+  case TargetOpcode::G_BR:
+    I.setType(nullptr);
+    I.setDesc(TII.get(AArch64::B));
+    return true;
+
+  case TargetOpcode::G_ADD:
+  case TargetOpcode::G_OR: {
+    const unsigned DefReg = I.getOperand(0).getReg();
+    const RegisterBank *RB = RBI.getRegBank(DefReg, MRI, TRI);
+    if (!RB || RB->getID() != AArch64::GPRRegBankID) {
+      DEBUG(dbgs() << "Generic binop should be on GPR\n");
+      return false;
+    }
+
+    const unsigned NewOpc = selectBinaryOp(Opcode, MRI.getSize(DefReg));
+    if (NewOpc == Opcode)
+      return false;
+
+    I.setType(nullptr);
+    I.setDesc(TII.get(NewOpc));
+    return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_CONSTANT: {
+    const unsigned DefReg = I.getOperand(0).getReg();
+    const unsigned DefSize = MRI.getSize(DefReg);
+    if (DefSize > 64)
+      return false;
+
+    I.setType(nullptr);
+    I.setDesc(TII.get(DefSize == 64 ? AArch64::MOVi64imm : AArch64::MOVi32imm));
+    return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_ANYEXT:
+  case TargetOpcode::G_TRUNC: {
+    const unsigned DefReg = I.getOperand(0).getReg();
+    const unsigned SrcReg = I.getOperand(1).getReg();
+    const unsigned DefSize = MRI.getSize(DefReg);
+    const unsigned SrcSize = MRI.getSize(SrcReg);
+
+    if (Opcode == TargetOpcode::G_ANYEXT && DefSize == 64 && SrcSize <= 32) {
+      // The high bits are undefined, so just put the 32-bit register in the
+      // low half of the 64-bit one.
+      BuildMI(MBB, I, I.getDebugLoc(), TII.get(AArch64::SUBREG_TO_REG), DefReg)
+          .addImm(0)
+          .addReg(SrcReg)
+          .addImm(AArch64::sub_32);
+      I.eraseFromParent();
+      return constrainGenericReg(DefReg, MRI, TRI, RBI) &&
+             constrainGenericReg(SrcReg, MRI, TRI, RBI);
+    }
+
+    // Everything else is a (sub-register) copy between general purpose
+    // registers.
+    I.setType(nullptr);
+    I.setDesc(TII.get(TargetOpcode::COPY));
+    if (Opcode == TargetOpcode::G_TRUNC && SrcSize == 64 && DefSize <= 32)
+      I.getOperand(1).setSubReg(AArch64::sub_32);
+    return constrainGenericReg(DefReg, MRI, TRI, RBI) &&
+           constrainGenericReg(SrcReg, MRI, TRI, RBI);
+  }
+
+  default:
+    return false;
+  }
+}
@@ -0,0 +1,46 @@
+//===- AArch64MachineLegalizer.cpp -------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the MachineLegalizer class for
+/// AArch64.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "AArch64MachineLegalizer.h"
+#include "llvm/CodeGen/ValueTypes.h"
+#include "llvm/Target/TargetOpcodes.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+AArch64MachineLegalizer::AArch64MachineLegalizer() {
+  // Binary operations are selected on 32 and 64-bit general purpose
+  // registers.  Narrower integers are widened to i32.  Wider ones would be
+  // narrowed into a chain of G_EXTRACT, G_UADDE and G_SEQUENCE, which the
+  // selector cannot handle yet, so they are unsupported.
+  for (auto BinOp : {TargetOpcode::G_ADD, TargetOpcode::G_OR}) {
+    for (MVT Ty : {MVT::i32, MVT::i64})
+      setAction(BinOp, Ty, Legal);
+    setScalarAction(BinOp, WidenScalar);
+  }
+
+  // The extensions, truncations and constants created by the legalization of
+  // the binary operations.
+  for (MVT Ty : {MVT::i32, MVT::i64})
+    setAction(TargetOpcode::G_ANYEXT, Ty, Legal);
+  for (MVT Ty : {MVT::i1, MVT::i8, MVT::i16, MVT::i32})
+    setAction(TargetOpcode::G_TRUNC, Ty, Legal);
+  for (MVT Ty : {MVT::i1, MVT::i32, MVT::i64})
+    setAction(TargetOpcode::G_CONSTANT, Ty, Legal);
+
+  computeTables();
+}
@@ -113,6 +113,37 @@ const RegisterBank &AArch64RegisterBankInfo::getRegBankFromRegClass(
   }
 }
 
+RegisterBankInfo::InstructionMapping
+AArch64RegisterBankInfo::getInstrMapping(const MachineInstr &MI) const {
+  switch (MI.getOpcode()) {
+  case TargetOpcode::G_ANYEXT:
+  case TargetOpcode::G_TRUNC:
+  case TargetOpcode::G_CONSTANT: {
+    // The generic code cannot guess a bank for the narrow side of an
+    // extension or a truncation, since no register class holds such values.
+    // Keep everything on GPR, where the instruction selector expects them.
+    const MachineFunction &MF = *MI.getParent()->getParent();
+    const TargetSubtargetInfo &STI = MF.getSubtarget();
+    const TargetRegisterInfo &TRI = *STI.getRegisterInfo();
+    const MachineRegisterInfo &MRI = MF.getRegInfo();
+
+    InstructionMapping Mapping(DefaultMappingID, /*Cost*/ 1,
+                               MI.getNumOperands());
+    for (unsigned Idx = 0, End = MI.getNumOperands(); Idx != End; ++Idx) {
+      const MachineOperand &MO = MI.getOperand(Idx);
+      if (!MO.isReg() || !MO.getReg())
+        continue;
+      Mapping.setOperandMapping(Idx, getSizeInBits(MO.getReg(), MRI, TRI),
+                                getRegBank(AArch64::GPRRegBankID));
+    }
+    return Mapping;
+  }
+  default:
+    break;
+  }
+  return RegisterBankInfo::getInstrMapping(MI);
+}
+
 RegisterBankInfo::InstructionMappings
 AArch64RegisterBankInfo::getInstrAlternativeMappings(
     const MachineInstr &MI) const {
@@ -60,6 +60,11 @@ public:
   const RegisterBank &
   getRegBankFromRegClass(const TargetRegisterClass &RC) const override;
 
+  /// Get the default mapping for \p MI.
+  /// Integer extensions, truncations and constants live in GPRs, whatever
+  /// the size of their operands.
+  InstructionMapping getInstrMapping(const MachineInstr &MI) const override;
+
   /// Get the alternative mappings for \p MI.
   /// Alternative in the sense different from getInstrMapping.
   InstructionMappings
@@ -7337,6 +7337,91 @@ X86InstrInfo::getSerializableDirectMachineOperandTargetFlags() const {
   return makeArrayRef(TargetFlags);
 }
 
+bool X86InstrInfo::isFunctionSafeToOutlineFrom(
+    const MachineFunction &MF) const {
+  const Function *Fn = MF.getFunction();
+  // Calling an outlined sequence pushes the return address below the stack
+  // pointer, which would clobber the red zone of a leaf function.
+  if (Subtarget.is64Bit() && !Subtarget.isTargetWin64() &&
+      !Fn->hasFnAttribute(Attribute::NoRedZone) &&
+      !MF.getFrameInfo()->adjustsStack())
+    return false;
+
+  if (MF.getMMI().hasEHFunclets())
+    return false;
+
+  // The unwind info of an outlined sequence has to describe the return
+  // address pushed by the call, see buildOutlinedFrame.
+  if (MF.getMMI().hasDebugInfo() || Fn->needsUnwindTableEntry()) {
+    // Windows unwind info only describes the prologue and the epilogue.
+    if (MF.getTarget().getMCAsmInfo()->usesWindowsCFI())
+      return false;
+    // Code placed before a shrink-wrapped prologue runs with another CFA.
+    if (MF.getFrameInfo()->getSavePoint())
+      return false;
+    // Without a frame pointer, the CFA is only the same at every call if the
+    // stack pointer doesn't move between the prologue and the epilogue.
+    const X86FrameLowering *TFI = Subtarget.getFrameLowering();
+    if (!TFI->hasFP(MF) && !TFI->hasReservedCallFrame(MF))
+      return false;
+  }
+  return true;
+}
+
+X86InstrInfo::MachineOutlinerInstrType
+X86InstrInfo::getOutliningType(const MachineInstr &MI) const {
+  if (MI.isDebugValue())
+    return Invisible;
+
+  // Anything affecting the control flow or the layout of the function stays.
+  if (MI.isTerminator() || MI.isCall() || MI.isReturn() || MI.isPosition() ||
+      MI.isInlineAsm() || MI.isKill() || MI.isImplicitDef() ||
+      MI.hasUnmodeledSideEffects())
+    return Illegal;
+
+  for (const MachineOperand &MO : MI.operands()) {
+    // The outlined sequence runs with the return address pushed, so anything
+    // relative to the stack pointer would be off by one slot.
+    if (MO.isReg() && MO.getReg() && RI.regsOverlap(MO.getReg(), X86::RSP))
+      return Illegal;
+    if (MO.isMBB() || MO.isFI() || MO.isRegMask() || MO.isMCSymbol() ||
+        MO.isTargetIndex())
+      return Illegal;
+  }
+
+  return Legal;
+}
+
+MachineBasicBlock::iterator
+X86InstrInfo::insertOutlinedCall(MachineBasicBlock &MBB,
+                                 MachineBasicBlock::iterator It,
+                                 MachineBasicBlock &Body) const {
+  unsigned CallOpc = Subtarget.is64Bit() ? X86::CALL64pcrel32 : X86::CALLpcrel32;
+  return BuildMI(MBB, It, It->getDebugLoc(), get(CallOpc)).addMBB(&Body);
+}
+
+void X86InstrInfo::buildOutlinedFrame(MachineBasicBlock &Body) const {
+  MachineFunction &MF = *Body.getParent();
+  const X86FrameLowering *TFI = Subtarget.getFrameLowering();
+
+  // With a frame pointer the CFA doesn't depend on the stack pointer, and the
+  // unwinder sees the outlined sequence as part of the function that called
+  // it. Without one, the CFA is a slot further from the stack pointer than
+  // after the prologue. The block is placed after the epilogue, which leaves
+  // the CFA rule alone, so only the offset needs to be redefined.
+  if ((MF.getMMI().hasDebugInfo() ||
+       MF.getFunction()->needsUnwindTableEntry()) &&
+      !TFI->hasFP(MF)) {
+    int64_t CFAOffset =
+        MF.getFrameInfo()->getStackSize() + 2 * RI.getSlotSize();
+    TFI->BuildCFI(Body, Body.begin(), DebugLoc(),
+                  MCCFIInstruction::createDefCfaOffset(nullptr, -CFAOffset));
+  }
+
+  unsigned RetOpc = Subtarget.is64Bit() ? X86::RETQ : X86::RETL;
+  BuildMI(Body, Body.end(), DebugLoc(), get(RetOpc));
+}
+
 namespace {
   /// Create Global Base Reg pass. This initializes the PIC
   /// global base register for x86-32.
@@ -529,6 +529,17 @@ public:
   ArrayRef<std::pair<unsigned, const char *>>
   getSerializableDirectMachineOperandTargetFlags() const override;
 
+  bool isFunctionSafeToOutlineFrom(const MachineFunction &MF) const override;
+
+  MachineOutlinerInstrType
+  getOutliningType(const MachineInstr &MI) const override;
+
+  MachineBasicBlock::iterator
+  insertOutlinedCall(MachineBasicBlock &MBB, MachineBasicBlock::iterator It,
+                     MachineBasicBlock &Body) const override;
+
+  void buildOutlinedFrame(MachineBasicBlock &Body) const override;
+
 protected:
   /// Commutes the operands in the given instruction by changing the operands
   /// order and/or changing the instruction's opcode and/or the immediate value
@@ -67,6 +67,33 @@ unsigned X86TTIImpl::getRegisterBitWidth(bool Vector) {
   return 32;
 }
 
+unsigned X86TTIImpl::getCacheLineSize() {
+  // Every x86 processor since the Pentium 4 has 64 byte cache lines.
+  return 64;
+}
+
+Optional<unsigned>
+X86TTIImpl::getCacheSize(TargetTransformInfo::CacheLevel Level) {
+  // The data caches of the Intel cores from Nehalem to Skylake.
+  switch (Level) {
+  case TargetTransformInfo::CacheLevel::L1D:
+    return 32 * 1024;
+  case TargetTransformInfo::CacheLevel::L2D:
+    return 256 * 1024;
+  }
+  llvm_unreachable("Unknown TargetTransformInfo::CacheLevel");
+}
+
+Optional<unsigned>
+X86TTIImpl::getCacheAssociativity(TargetTransformInfo::CacheLevel Level) {
+  switch (Level) {
+  case TargetTransformInfo::CacheLevel::L1D:
+  case TargetTransformInfo::CacheLevel::L2D:
+    return 8;
+  }
+  llvm_unreachable("Unknown TargetTransformInfo::CacheLevel");
+}
+
 unsigned X86TTIImpl::getMaxInterleaveFactor(unsigned VF) {
   // If the loop will not be vectorized, don't interleave the loop.
   // Let regular unroll to unroll the loop, which saves the overflow
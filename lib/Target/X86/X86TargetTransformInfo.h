@@ -61,6 +61,10 @@ public:
 
   unsigned getNumberOfRegisters(bool Vector);
   unsigned getRegisterBitWidth(bool Vector);
+  unsigned getCacheLineSize();
+  Optional<unsigned> getCacheSize(TargetTransformInfo::CacheLevel Level);
+  Optional<unsigned>
+  getCacheAssociativity(TargetTransformInfo::CacheLevel Level);
   unsigned getMaxInterleaveFactor(unsigned VF);
   int getArithmeticInstrCost(
       unsigned Opcode, Type *Ty,
@@ -0,0 +1,228 @@
+//===- HotColdSplitting.cpp - Move cold code out of hot functions ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass uses the profile to find single-entry regions of blocks that are
+// cold, and extracts each of them into a separate function marked cold. The
+// extracted functions get the .unlikely section prefix, so the code generator
+// places them in .text.unlikely and hot functions are no longer padded with
+// rarely executed error paths.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/Utils/CodeExtractor.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "hotcoldsplit"
+
+STATISTIC(NumColdRegionsOutlined, "Number of cold regions outlined");
+
+static cl::opt<unsigned> MinSplitSize(
+    "hotcoldsplit-threshold", cl::init(3), cl::Hidden,
+    cl::desc("Minimum number of instructions in a cold region for it to be "
+             "split out of its function"));
+
+namespace {
+class HotColdSplitting : public ModulePass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  HotColdSplitting() : ModulePass(ID) {
+    initializeHotColdSplittingPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+  }
+
+private:
+  bool splitColdRegions(Function &F, ProfileSummaryInfo &PSI);
+};
+} // end anonymous namespace
+
+char HotColdSplitting::ID = 0;
+INITIALIZE_PASS_BEGIN(HotColdSplitting, "hotcoldsplit",
+                      "Hot Cold Splitting", false, false)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_END(HotColdSplitting, "hotcoldsplit",
+                    "Hot Cold Splitting", false, false)
+
+ModulePass *llvm::createHotColdSplittingPass() {
+  return new HotColdSplitting();
+}
+
+/// Return true if \p BB may be moved to another function.
+static bool mayExtractBlock(const BasicBlock &BB) {
+  if (BB.isEHPad() || BB.hasAddressTaken())
+    return false;
+  for (const Instruction &I : BB) {
+    if (isa<AllocaInst>(I) || isa<InvokeInst>(I))
+      return false;
+    if (auto CS = ImmutableCallSite(&I))
+      if (CS.hasFnAttr(Attribute::ReturnsTwice))
+        return false;
+  }
+  return true;
+}
+
+/// Grow the cold region headed by \p Header: the cold blocks it dominates
+/// that are only entered through other blocks of the region.
+static SetVector<BasicBlock *>
+findColdRegion(BasicBlock *Header, DominatorTree &DT,
+               const SmallPtrSetImpl<BasicBlock *> &ColdBlocks) {
+  SetVector<BasicBlock *> Region;
+  SmallVector<DomTreeNode *, 8> Worklist;
+  Worklist.push_back(DT.getNode(Header));
+  while (!Worklist.empty()) {
+    DomTreeNode *Node = Worklist.pop_back_val();
+    BasicBlock *BB = Node->getBlock();
+    if (!ColdBlocks.count(BB) || !mayExtractBlock(*BB))
+      continue;
+    Region.insert(BB);
+    Worklist.append(Node->begin(), Node->end());
+  }
+
+  // Drop blocks that can be entered from outside the region, and whatever
+  // they dominate, until the header is the only entry.
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (BasicBlock *BB : Region) {
+      if (BB == Header)
+        continue;
+      bool EnteredFromOutside = false;
+      for (BasicBlock *Pred : predecessors(BB))
+        EnteredFromOutside |= !Region.count(Pred);
+      if (!EnteredFromOutside)
+        continue;
+      Region.remove_if([&](BasicBlock *Other) {
+        return DT.dominates(BB, Other);
+      });
+      Changed = true;
+      break;
+    }
+  }
+  return Region;
+}
+
+bool HotColdSplitting::splitColdRegions(Function &F,
+                                        ProfileSummaryInfo &PSI) {
+  // Find the cold blocks before changing anything, since extraction
+  // invalidates the block frequencies.
+  BlockFrequencyInfo &BFI =
+      getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+  SmallPtrSet<BasicBlock *, 16> ColdBlocks;
+  SmallVector<std::pair<BasicBlock *, uint64_t>, 16> Headers;
+  ReversePostOrderTraversal<Function *> RPOT(&F);
+  for (BasicBlock *BB : RPOT) {
+    Optional<uint64_t> Count = BFI.getBlockProfileCount(BB);
+    if (!Count || !PSI.isColdCount(*Count))
+      continue;
+    ColdBlocks.insert(BB);
+    // Only blocks entered from hot code can head a region.
+    bool HasHotPred = false;
+    for (BasicBlock *Pred : predecessors(BB))
+      HasHotPred |= !ColdBlocks.count(Pred);
+    if (HasHotPred && BB != &F.getEntryBlock())
+      Headers.push_back(std::make_pair(BB, *Count));
+  }
+
+  bool Changed = false;
+  DominatorTree DT(F);
+  for (auto &Entry : Headers) {
+    BasicBlock *Header = Entry.first;
+    // The header may already have been moved out as part of another region.
+    if (Header->getParent() != &F)
+      continue;
+
+    SetVector<BasicBlock *> Region = findColdRegion(Header, DT, ColdBlocks);
+    unsigned Size = 0;
+    for (BasicBlock *BB : Region)
+      Size += BB->size();
+    if (Region.empty() || Size < MinSplitSize)
+      continue;
+
+    CodeExtractor CE(Region.getArrayRef(), &DT);
+    if (!CE.isEligible())
+      continue;
+    Function *Outlined = CE.extractCodeRegion();
+    if (!Outlined)
+      continue;
+
+    DEBUG(dbgs() << "Outlined cold region of " << Size << " instructions from "
+                 << F.getName() << " into " << Outlined->getName() << '\n');
+    Outlined->addFnAttr(Attribute::Cold);
+    Outlined->addFnAttr(Attribute::NoInline);
+    Outlined->setEntryCount(Entry.second);
+    Outlined->setSectionPrefix(".unlikely");
+    // Keep the attributes the code generator needs to compile the region the
+    // same way as the rest of its original function.
+    if (F.hasUWTable())
+      Outlined->setHasUWTable();
+    for (Attribute::AttrKind Kind :
+         {Attribute::MinSize, Attribute::OptimizeForSize, Attribute::NoRedZone,
+          Attribute::NoImplicitFloat, Attribute::SafeStack,
+          Attribute::SanitizeAddress, Attribute::SanitizeMemory,
+          Attribute::SanitizeThread, Attribute::StackProtect,
+          Attribute::StackProtectReq, Attribute::StackProtectStrong})
+      if (F.hasFnAttribute(Kind))
+        Outlined->addFnAttr(Kind);
+    AttributeSet FnAttrs = F.getAttributes().getFnAttributes();
+    for (unsigned I = 0, E = FnAttrs.getNumSlots(); I != E; ++I)
+      for (const Attribute &A : make_range(FnAttrs.begin(I), FnAttrs.end(I)))
+        if (A.isStringAttribute())
+          Outlined->addFnAttr(A.getKindAsString(), A.getValueAsString());
+
+    ++NumColdRegionsOutlined;
+    Changed = true;
+    DT.recalculate(F);
+  }
+  return Changed;
+}
+
+bool HotColdSplitting::runOnModule(Module &M) {
+  if (skipModule(M))
+    return false;
+
+  ProfileSummaryInfo &PSI =
+      *getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI(M);
+
+  // Extraction adds functions to the module, collect the candidates first.
+  SmallVector<Function *, 16> Candidates;
+  for (Function &F : M) {
+    if (F.isDeclaration() || !F.getEntryCount() ||
+        F.hasFnAttribute(Attribute::Cold) ||
+        F.hasFnAttribute(Attribute::OptimizeNone) ||
+        F.hasFnAttribute(Attribute::Naked) || PSI.isColdFunction(&F))
+      continue;
+    Candidates.push_back(&F);
+  }
+
+  bool Changed = false;
+  for (Function *F : Candidates)
+    Changed |= splitColdRegions(*F, PSI);
+  return Changed;
+}
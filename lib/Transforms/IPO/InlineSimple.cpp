@@ -61,7 +61,8 @@ public:
   InlineCost getInlineCost(CallSite CS) override {
     Function *Callee = CS.getCalledFunction();
     TargetTransformInfo &TTI = TTIWP->getTTI(*Callee);
-    return llvm::getInlineCost(CS, DefaultThreshold, TTI, ACT, PSI);
+    return llvm::getInlineCost(CS, DefaultThreshold, TTI, ACT, PSI,
+                               getProfileBFI(*CS.getCaller()));
   }
 
   bool runOnSCC(CallGraphSCC &SCC) override;
@@ -18,13 +18,18 @@
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/BlockFrequencyInfoImpl.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/InlineCost.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/ProfileSummaryInfo.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
@@ -52,6 +57,29 @@ Inliner::Inliner(char &ID) : CallGraphSCCPass(ID), InsertLifetime(true) {}
 Inliner::Inliner(char &ID, bool InsertLifetime)
     : CallGraphSCCPass(ID), InsertLifetime(InsertLifetime) {}
 
+/// The analyses BFI is computed from. Only BFI itself is kept up to date after
+/// inlining, the others are not used afterwards.
+struct Inliner::CallerProfile {
+  DominatorTree DT;
+  LoopInfo LI;
+  BranchProbabilityInfo BPI;
+  BlockFrequencyInfo BFI;
+
+  explicit CallerProfile(Function &F)
+      : DT(F), LI(DT), BPI(F, LI), BFI(F, BPI, LI) {}
+};
+
+Inliner::~Inliner() {}
+
+BlockFrequencyInfo *Inliner::getProfileBFI(Function &F) {
+  if (!F.getEntryCount())
+    return nullptr;
+  std::unique_ptr<CallerProfile> &Profile = CallerProfiles[&F];
+  if (!Profile)
+    Profile.reset(new CallerProfile(F));
+  return &Profile->BFI;
+}
+
 /// For this class, we declare that we require and preserve the call graph.
 /// If the derived class implements this method, it should
 /// always explicitly call the implementation here.
@@ -378,6 +406,8 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
   ACT = &getAnalysis<AssumptionCacheTracker>();
   PSI = getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI(CG.getModule());
   auto &TLI = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
+  // The functions may have changed since the last SCC was visited.
+  CallerProfiles.clear();
 
   SmallPtrSet<Function*, 8> SCCFunctions;
   DEBUG(dbgs() << "Inliner visiting SCC:");
@@ -494,6 +524,12 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
           continue;
         }
 
+        // Have InlineFunction update the block frequencies of the caller
+        // rather than computing them again for its next call site.
+        InlineInfo.CallerBFI = getProfileBFI(*Caller);
+        InlineInfo.CalleeBFI =
+            InlineInfo.CallerBFI ? getProfileBFI(*Callee) : nullptr;
+
         // Attempt to inline the function.
         if (!InlineCallIfPossible(*this, CS, InlineInfo, InlinedArrayAllocas,
                                   InlineHistoryID, InsertLifetime)) {
@@ -541,6 +577,7 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
         CalleeNode->removeAllCalledFunctions();
         
         // Removing the node for callee from the call graph and delete it.
+        CallerProfiles.erase(Callee);
         delete CG.removeFunctionFromModule(CalleeNode);
         ++NumDeleted;
       }
@@ -562,6 +599,7 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
     }
   } while (LocalChange);
 
+  CallerProfiles.clear();
   return Changed;
 }
 
@@ -10,15 +10,33 @@
 // This pass performs partial inlining, typically by inlining an if statement
 // that surrounds the body of the function.
 //
+// Functions with a profile are also partially inlined when only some regions
+// of them are cold: the cold regions are extracted into functions of their
+// own, and the rest, which is small enough, is inlined into every caller.
+//
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/IPO/PartialInlining.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/BlockFrequencyInfoImpl.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/IR/CallSite.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/BranchProbability.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/CodeExtractor.h"
@@ -27,6 +45,23 @@ using namespace llvm;
 #define DEBUG_TYPE "partialinlining"
 
 STATISTIC(NumPartialInlined, "Number of functions partially inlined");
+STATISTIC(NumColdRegionsOutlined,
+          "Number of cold regions outlined for partial inlining");
+
+static cl::opt<unsigned> ColdRegionRelFreq(
+    "partial-inlining-cold-rel-freq", cl::init(5), cl::Hidden,
+    cl::desc("Maximum frequency of a block, as a percentage of the entry "
+             "frequency of its function, for it to be outlined as cold"));
+
+static cl::opt<unsigned> MinColdRegionSize(
+    "partial-inlining-min-cold-size", cl::init(3), cl::Hidden,
+    cl::desc("Minimum number of instructions in the cold regions of a "
+             "function for it to be partially inlined"));
+
+static cl::opt<unsigned> MaxHotSize(
+    "partial-inlining-max-hot-size", cl::init(40), cl::Hidden,
+    cl::desc("Maximum number of instructions left in a function once its "
+             "cold regions are outlined for it to be partially inlined"));
 
 namespace {
 struct PartialInlinerLegacyPass : public ModulePass {
@@ -35,12 +70,16 @@ struct PartialInlinerLegacyPass : public ModulePass {
     initializePartialInlinerLegacyPassPass(*PassRegistry::getPassRegistry());
   }
 
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+  }
+
   bool runOnModule(Module &M) override {
     if (skipModule(M))
       return false;
-    ModuleAnalysisManager DummyMAM;
-    auto PA = Impl.run(M, DummyMAM);
-    return !PA.areAllPreserved();
+    ProfileSummaryInfo *PSI =
+        getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI(M);
+    return Impl.runImpl(M, *PSI);
   }
 
 private:
@@ -49,8 +88,11 @@ private:
 }
 
 char PartialInlinerLegacyPass::ID = 0;
-INITIALIZE_PASS(PartialInlinerLegacyPass, "partial-inliner", "Partial Inliner",
-                false, false)
+INITIALIZE_PASS_BEGIN(PartialInlinerLegacyPass, "partial-inliner",
+                      "Partial Inliner", false, false)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(PartialInlinerLegacyPass, "partial-inliner",
+                    "Partial Inliner", false, false)
 
 ModulePass *llvm::createPartialInliningPass() {
   return new PartialInlinerLegacyPass();
@@ -152,7 +194,140 @@ Function *PartialInlinerPass::unswitchFunction(Function *F) {
   return extractedFunction;
 }
 
-PreservedAnalyses PartialInlinerPass::run(Module &M, ModuleAnalysisManager &) {
+/// Return true if \p BB may be moved into an outlined cold region.
+static bool mayOutlineBlock(const BasicBlock &BB) {
+  if (BB.isEHPad() || BB.hasAddressTaken() ||
+      isa<ReturnInst>(BB.getTerminator()) || isa<ResumeInst>(BB.getTerminator()))
+    return false;
+  for (const Instruction &I : BB) {
+    if (isa<AllocaInst>(I) || isa<InvokeInst>(I))
+      return false;
+    if (auto CS = ImmutableCallSite(&I))
+      if (CS.hasFnAttr(Attribute::ReturnsTwice))
+        return false;
+  }
+  return true;
+}
+
+/// Return the number of instructions in \p BB, not counting debug info.
+static unsigned getBlockSize(const BasicBlock &BB) {
+  unsigned Size = 0;
+  for (const Instruction &I : BB)
+    if (!isa<DbgInfoIntrinsic>(I))
+      ++Size;
+  return Size;
+}
+
+bool PartialInlinerPass::outlineColdRegions(Function *F,
+                                            ProfileSummaryInfo &PSI) {
+  if (!F->getEntryCount() || F->hasFnAttribute(Attribute::NoInline) ||
+      F->hasFnAttribute(Attribute::OptimizeNone))
+    return false;
+  bool HasCallers = false;
+  for (User *U : F->users())
+    HasCallers |= isa<CallInst>(U) || isa<InvokeInst>(U);
+  if (!HasCallers)
+    return false;
+
+  DominatorTree DT(*F);
+  LoopInfo LI(DT);
+  BranchProbabilityInfo BPI(*F, LI);
+  BlockFrequencyInfo BFI(*F, BPI, LI);
+  uint64_t ColdFreq =
+      BranchProbability(ColdRegionRelFreq, 100).scale(BFI.getEntryFreq());
+  SmallPtrSet<BasicBlock *, 16> ColdBlocks;
+  for (BasicBlock &BB : *F) {
+    Optional<uint64_t> Count = BFI.getBlockProfileCount(&BB);
+    if (&BB != &F->getEntryBlock() && mayOutlineBlock(BB) &&
+        (BFI.getBlockFreq(&BB).getFrequency() < ColdFreq ||
+         (Count && PSI.isColdCount(*Count))))
+      ColdBlocks.insert(&BB);
+  }
+
+  // A cold region is headed by a cold block entered from hot code, and holds
+  // the cold blocks the header dominates. Give up on regions that can be
+  // entered other than through their header.
+  SmallVector<SetVector<BasicBlock *>, 4> Regions;
+  unsigned Size = 0, ColdSize = 0;
+  ReversePostOrderTraversal<Function *> RPOT(F);
+  for (BasicBlock *BB : RPOT) {
+    Size += getBlockSize(*BB);
+    if (!ColdBlocks.count(BB))
+      continue;
+    bool EnteredFromHotCode = false;
+    for (BasicBlock *Pred : predecessors(BB))
+      EnteredFromHotCode |= !ColdBlocks.count(Pred);
+    if (!EnteredFromHotCode)
+      continue;
+
+    SetVector<BasicBlock *> Region;
+    SmallVector<DomTreeNode *, 8> Worklist(1, DT.getNode(BB));
+    while (!Worklist.empty()) {
+      DomTreeNode *Node = Worklist.pop_back_val();
+      if (!ColdBlocks.count(Node->getBlock()))
+        continue;
+      Region.insert(Node->getBlock());
+      Worklist.append(Node->begin(), Node->end());
+    }
+    bool SingleEntry = true;
+    for (BasicBlock *RegionBB : Region)
+      if (RegionBB != BB)
+        for (BasicBlock *Pred : predecessors(RegionBB))
+          SingleEntry &= Region.count(Pred) != 0;
+    if (!SingleEntry)
+      continue;
+    for (BasicBlock *RegionBB : Region)
+      ColdSize += getBlockSize(*RegionBB);
+    Regions.push_back(std::move(Region));
+  }
+
+  // Each region leaves a call and a branch on its result behind.
+  if (Regions.empty() || ColdSize < MinColdRegionSize ||
+      Size - ColdSize + 2 * Regions.size() > MaxHotSize)
+    return false;
+
+  // Outline the cold regions from a copy of the function, and inline what is
+  // left into the callers.
+  ValueToValueMapTy VMap;
+  Function *DuplicateFunction = CloneFunction(F, VMap);
+  DuplicateFunction->setLinkage(GlobalValue::InternalLinkage);
+  DominatorTree DuplicateDT(*DuplicateFunction);
+  for (SetVector<BasicBlock *> &Region : Regions) {
+    SmallVector<BasicBlock *, 8> Blocks;
+    for (BasicBlock *BB : Region)
+      Blocks.push_back(cast<BasicBlock>(VMap[BB]));
+    CodeExtractor CE(Blocks, &DuplicateDT);
+    if (!CE.isEligible())
+      continue;
+    Function *Outlined = CE.extractCodeRegion();
+    if (!Outlined)
+      continue;
+    Outlined->addFnAttr(Attribute::Cold);
+    if (Optional<uint64_t> Count = BFI.getBlockProfileCount(Region[0]))
+      Outlined->setEntryCount(*Count);
+    DEBUG(dbgs() << "Outlined cold region of " << F->getName() << " into "
+                 << Outlined->getName() << '\n');
+    ++NumColdRegionsOutlined;
+    DuplicateDT.recalculate(*DuplicateFunction);
+  }
+
+  F->replaceAllUsesWith(DuplicateFunction);
+  InlineFunctionInfo IFI;
+  std::vector<User *> Users(DuplicateFunction->user_begin(),
+                            DuplicateFunction->user_end());
+  for (User *User : Users)
+    if (CallInst *CI = dyn_cast<CallInst>(User))
+      InlineFunction(CI, IFI);
+    else if (InvokeInst *II = dyn_cast<InvokeInst>(User))
+      InlineFunction(II, IFI);
+  DuplicateFunction->replaceAllUsesWith(F);
+  DuplicateFunction->eraseFromParent();
+
+  ++NumPartialInlined;
+  return true;
+}
+
+bool PartialInlinerPass::runImpl(Module &M, ProfileSummaryInfo &PSI) {
   std::vector<Function*> worklist;
   worklist.reserve(M.size());
   for (Function &F : M)
@@ -179,11 +354,18 @@ PreservedAnalyses PartialInlinerPass::run(Module &M, ModuleAnalysisManager &) {
     if (Function* newFunc = unswitchFunction(currFunc)) {
       worklist.push_back(newFunc);
       changed = true;
+    } else if (outlineColdRegions(currFunc, PSI)) {
+      changed = true;
     }
     
   }
 
-  if (changed)
+  return changed;
+}
+
+PreservedAnalyses PartialInlinerPass::run(Module &M,
+                                          ModuleAnalysisManager &AM) {
+  if (runImpl(M, AM.getResult<ProfileSummaryAnalysis>(M)))
     return PreservedAnalyses::none();
   return PreservedAnalyses::all();
 }
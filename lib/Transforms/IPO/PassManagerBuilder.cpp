@@ -102,6 +102,18 @@ static cl::opt<bool> EnableLoopInterchange(
     "enable-loopinterchange", cl::init(false), cl::Hidden,
     cl::desc("Enable the new, experimental LoopInterchange Pass"));
 
+static cl::opt<bool> EnableLoopTiling(
+    "enable-loop-tiling", cl::init(false), cl::Hidden,
+    cl::desc("Enable the new, experimental LoopTiling Pass"));
+
+static cl::opt<bool> EnableLoopFusion(
+    "enable-loop-fusion", cl::init(false), cl::Hidden,
+    cl::desc("Enable the new, experimental LoopFuse Pass"));
+
+static cl::opt<bool> EnableNewGVN(
+    "enable-newgvn", cl::init(false), cl::Hidden,
+    cl::desc("Run the new, experimental NewGVN Pass instead of GVN"));
+
 static cl::opt<bool> EnableNonLTOGlobalsModRef(
     "enable-non-lto-gmr", cl::init(true), cl::Hidden,
     cl::desc(
@@ -121,6 +133,15 @@ static cl::opt<std::string> RunPGOInstrUse(
     cl::desc("Enable use phase of PGO instrumentation and specify the path "
              "of profile data file"));
 
+static cl::opt<bool> EnableHotColdSplit(
+    "hot-cold-split", cl::init(false), cl::Hidden,
+    cl::desc("Enable profile-guided splitting of cold code into separate "
+             "functions"));
+
+static cl::opt<bool> EnableCallGraphProfile(
+    "enable-call-graph-profile", cl::init(false), cl::Hidden,
+    cl::desc("Record the profile counts of call edges for function ordering"));
+
 static cl::opt<bool> UseLoopVersioningLICM(
     "enable-loop-versioning-licm", cl::init(false), cl::Hidden,
     cl::desc("Enable the experimental Loop Versioning LICM pass"));
@@ -269,6 +290,8 @@ void PassManagerBuilder::addFunctionSimplificationPasses(
     MPM.add(createLoopInterchangePass()); // Interchange loops
     MPM.add(createCFGSimplificationPass());
   }
+  if (EnableLoopTiling)
+    MPM.add(createLoopTilingPass());            // Tile loop nests
   if (!DisableUnrollLoops)
     MPM.add(createSimpleLoopUnrollPass());    // Unroll small loops
   addExtensionsToPM(EP_LoopOptimizerEnd, MPM);
@@ -276,7 +299,9 @@ void PassManagerBuilder::addFunctionSimplificationPasses(
   if (OptLevel > 1) {
     if (EnableMLSM)
       MPM.add(createMergedLoadStoreMotionPass()); // Merge ld/st in diamonds
-    MPM.add(createGVNPass(DisableGVNLoadPRE));  // Remove redundancies
+    // Remove redundancies
+    MPM.add(EnableNewGVN ? createNewGVNPass()
+                         : createGVNPass(DisableGVNLoadPRE));
   }
   MPM.add(createMemCpyOptPass());             // Remove memcpy / form memset
   MPM.add(createSCCPPass());                  // Constant prop with SCCP
@@ -483,6 +508,11 @@ void PassManagerBuilder::populateModulePassManager(
   // on the rotated form. Disable header duplication at -Oz.
   MPM.add(createLoopRotatePass(SizeLevel == 2 ? 0 : -1));
 
+  // Fuse adjacent loops over the same iteration space, so that the values the
+  // first loop stores are reused by the second one while still in cache.
+  if (EnableLoopFusion)
+    MPM.add(createLoopFusePass());
+
   // Distribute loops to allow partial vectorization.  I.e. isolate dependences
   // into separate loop that would otherwise inhibit vectorization.  This is
   // currently only performed for loops marked with the metadata
@@ -580,6 +610,16 @@ void PassManagerBuilder::populateModulePassManager(
   if (MergeFunctions)
     MPM.add(createMergeFunctionsPass());
 
+  // Split cold code out once inlining is done, unless the split functions
+  // would be seen again by the inliner in the LTO link.
+  if (EnableHotColdSplit && !PrepareForLTO && !PrepareForThinLTO)
+    MPM.add(createHotColdSplittingPass());
+
+  // Record the call graph profile for the code generator last, so that it
+  // describes the functions that are actually emitted.
+  if (EnableCallGraphProfile && !PrepareForLTO && !PrepareForThinLTO)
+    MPM.add(createCGProfilePass());
+
   addExtensionsToPM(EP_OptimizerLast, MPM);
 }
 
@@ -677,7 +717,9 @@ void PassManagerBuilder::addLTOOptimizationPasses(legacy::PassManagerBase &PM) {
   PM.add(createLICMPass());                 // Hoist loop invariants.
   if (EnableMLSM)
     PM.add(createMergedLoadStoreMotionPass()); // Merge ld/st in diamonds.
-  PM.add(createGVNPass(DisableGVNLoadPRE)); // Remove redundancies.
+  // Remove redundancies.
+  PM.add(EnableNewGVN ? createNewGVNPass()
+                      : createGVNPass(DisableGVNLoadPRE));
   PM.add(createMemCpyOptPass());            // Remove dead memcpys.
 
   // Nuke dead stores.
@@ -739,6 +781,12 @@ void PassManagerBuilder::addLateLTOOptimizationPasses(
   // currently it damages debug info.
   if (MergeFunctions)
     PM.add(createMergeFunctionsPass());
+
+  if (EnableHotColdSplit)
+    PM.add(createHotColdSplittingPass());
+
+  if (EnableCallGraphProfile)
+    PM.add(createCGProfilePass());
 }
 
 void PassManagerBuilder::populateThinLTOPassManager(
@@ -0,0 +1,256 @@
+//===-- CGProfile.cpp - Record the call graph profile ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass collects the profile count of every call edge of the module, from
+// the block frequencies of direct call sites and the value profile of indirect
+// ones, and records them in the "CG Profile" module flag.  The code generator
+// emits the flag into the object file, where the linker (or the LTO code
+// generator, through getCallGraphProfileOrder) can use it to place hot callers
+// and callees close together.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/CGProfile.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Transforms/Instrumentation.h"
+#include <algorithm>
+#include <memory>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "cg-profile"
+
+STATISTIC(NumCGProfileEdges, "Number of call graph profile edges recorded");
+
+static cl::opt<unsigned> MaxIndirectTargets(
+    "cg-profile-max-indirect-targets", cl::init(4), cl::Hidden,
+    cl::desc("Maximum number of value profiled targets of an indirect call to "
+             "record in the call graph profile"));
+
+static cl::opt<unsigned> MaxClusterSize(
+    "cg-profile-max-cluster-size", cl::init(1024), cl::Hidden,
+    cl::desc("Maximum number of instructions in a cluster of functions formed "
+             "when ordering functions by the call graph profile"));
+
+namespace {
+class CGProfile : public ModulePass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  CGProfile() : ModulePass(ID) {
+    initializeCGProfilePass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+    AU.setPreservesAll();
+  }
+};
+} // end anonymous namespace
+
+char CGProfile::ID = 0;
+INITIALIZE_PASS_BEGIN(CGProfile, "cg-profile", "Call Graph Profile", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_END(CGProfile, "cg-profile", "Call Graph Profile", false,
+                    false)
+
+ModulePass *llvm::createCGProfilePass() { return new CGProfile(); }
+
+bool CGProfile::runOnModule(Module &M) {
+  // The profile is recorded once, before the module is handed to the code
+  // generator; a module coming back from a previous compile keeps its flag.
+  if (skipModule(M) || M.getModuleFlag("CG Profile"))
+    return false;
+
+  MapVector<std::pair<Function *, Function *>, uint64_t> Counts;
+  auto UpdateCounts = [&](Function *From, Function *To, uint64_t Count) {
+    if (Count && To && !To->isIntrinsic())
+      Counts[std::make_pair(From, To)] += Count;
+  };
+
+  std::unique_ptr<InstrProfSymtab> Symtab;
+  std::unique_ptr<InstrProfValueData[]> ValueData(
+      new InstrProfValueData[MaxIndirectTargets]);
+  for (Function &F : M) {
+    if (F.isDeclaration() || !F.getEntryCount())
+      continue;
+    BlockFrequencyInfo &BFI =
+        getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    for (BasicBlock &BB : F) {
+      Optional<uint64_t> BBCount = BFI.getBlockProfileCount(&BB);
+      if (!BBCount)
+        continue;
+      for (Instruction &I : BB) {
+        CallSite CS(&I);
+        if (!CS)
+          continue;
+        if (auto *Callee = dyn_cast<Function>(
+                CS.getCalledValue()->stripPointerCasts())) {
+          UpdateCounts(&F, Callee, *BBCount);
+          continue;
+        }
+
+        // Indirect call: credit the targets from the value profile.
+        uint32_t NumVals;
+        uint64_t TotalCount;
+        if (!getValueProfDataFromInst(I, IPVK_IndirectCallTarget,
+                                      MaxIndirectTargets, ValueData.get(),
+                                      NumVals, TotalCount))
+          continue;
+        if (!Symtab) {
+          Symtab.reset(new InstrProfSymtab());
+          Symtab->create(M);
+        }
+        for (uint32_t J = 0; J != NumVals; ++J)
+          UpdateCounts(&F, Symtab->getFunction(ValueData[J].Value),
+                       ValueData[J].Count);
+      }
+    }
+  }
+
+  if (Counts.empty())
+    return false;
+
+  LLVMContext &Context = M.getContext();
+  SmallVector<Metadata *, 16> Nodes;
+  for (const auto &Edge : Counts) {
+    Metadata *Vals[] = {
+        ValueAsMetadata::get(Edge.first.first),
+        ValueAsMetadata::get(Edge.first.second),
+        ConstantAsMetadata::get(
+            ConstantInt::get(Type::getInt64Ty(Context), Edge.second))};
+    Nodes.push_back(MDNode::get(Context, Vals));
+  }
+  NumCGProfileEdges += Nodes.size();
+  M.addModuleFlag(Module::Append, "CG Profile", MDNode::get(Context, Nodes));
+  return true;
+}
+
+namespace {
+/// A sequence of functions that should be laid out contiguously.
+struct Cluster {
+  SmallVector<const Function *, 4> Functions;
+  uint64_t Samples = 0;
+  uint64_t Size = 0;
+
+  double getDensity() const {
+    return double(Samples) / std::max<uint64_t>(Size, 1);
+  }
+};
+} // end anonymous namespace
+
+std::vector<const Function *> llvm::getCallGraphProfileOrder(const Module &M) {
+  std::vector<const Function *> Order;
+  auto *CGProfile = dyn_cast_or_null<MDNode>(M.getModuleFlag("CG Profile"));
+  if (!CGProfile)
+    return Order;
+
+  // For every function with a body in the profile, find its heaviest caller
+  // and the total count of the calls made to it.
+  DenseMap<const Function *, unsigned> ClusterOf;
+  std::vector<Cluster> Clusters;
+  DenseMap<const Function *, std::pair<const Function *, uint64_t>> HotCaller;
+  auto GetCluster = [&](const Function *F) {
+    auto Ins = ClusterOf.insert(std::make_pair(F, Clusters.size()));
+    if (Ins.second) {
+      Clusters.emplace_back();
+      Cluster &C = Clusters.back();
+      C.Functions.push_back(F);
+      for (const BasicBlock &BB : *F)
+        C.Size += BB.size();
+      if (Optional<uint64_t> EntryCount = F->getEntryCount())
+        C.Samples = *EntryCount;
+    }
+    return Ins.first->second;
+  };
+
+  DenseMap<const Function *, uint64_t> IncomingCount;
+  for (const MDOperand &Op : CGProfile->operands()) {
+    auto *Edge = cast<MDNode>(Op);
+    // Functions deleted after the profile was recorded leave a null operand.
+    auto *From = mdconst::dyn_extract_or_null<Function>(Edge->getOperand(0));
+    auto *To = mdconst::dyn_extract_or_null<Function>(Edge->getOperand(1));
+    if (!From || !To || From->isDeclaration() || To->isDeclaration())
+      continue;
+    uint64_t Count =
+        mdconst::extract<ConstantInt>(Edge->getOperand(2))->getZExtValue();
+    GetCluster(From);
+    GetCluster(To);
+    IncomingCount[To] += Count;
+    if (From == To)
+      continue;
+    auto &Caller = HotCaller[To];
+    if (!Caller.first || Count > Caller.second)
+      Caller = std::make_pair(From, Count);
+  }
+
+  // Functions without an entry count are weighted by their incoming calls.
+  for (Cluster &C : Clusters)
+    if (!C.Samples)
+      C.Samples = IncomingCount.lookup(C.Functions.front());
+
+  // Visit the functions from the hottest, and append each one's cluster to
+  // the cluster of its heaviest caller while the result stays small.
+  std::vector<const Function *> Funcs;
+  for (const Cluster &C : Clusters)
+    Funcs.push_back(C.Functions.front());
+  std::stable_sort(Funcs.begin(), Funcs.end(),
+                   [&](const Function *A, const Function *B) {
+                     return Clusters[ClusterOf[A]].Samples >
+                            Clusters[ClusterOf[B]].Samples;
+                   });
+  for (const Function *F : Funcs) {
+    auto It = HotCaller.find(F);
+    if (It == HotCaller.end())
+      continue;
+    unsigned CalleeIdx = ClusterOf[F];
+    unsigned CallerIdx = ClusterOf[It->second.first];
+    Cluster &Callee = Clusters[CalleeIdx];
+    Cluster &Caller = Clusters[CallerIdx];
+    // Only merge F while it still heads its own cluster.
+    if (CalleeIdx == CallerIdx || Callee.Functions.front() != F ||
+        Caller.Size + Callee.Size > MaxClusterSize)
+      continue;
+    for (const Function *G : Callee.Functions)
+      ClusterOf[G] = CallerIdx;
+    Caller.Functions.append(Callee.Functions.begin(), Callee.Functions.end());
+    Caller.Samples += Callee.Samples;
+    Caller.Size += Callee.Size;
+    Callee.Functions.clear();
+  }
+
+  // Lay out the clusters from the densest.
+  std::vector<const Cluster *> Sorted;
+  for (const Cluster &C : Clusters)
+    if (!C.Functions.empty())
+      Sorted.push_back(&C);
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const Cluster *A, const Cluster *B) {
+                     return A->getDensity() > B->getDensity();
+                   });
+  for (const Cluster *C : Sorted)
+    Order.insert(Order.end(), C->Functions.begin(), C->Functions.end());
+  DEBUG(dbgs() << "Ordered " << Order.size() << " functions in "
+               << Sorted.size() << " clusters\n");
+  return Order;
+}
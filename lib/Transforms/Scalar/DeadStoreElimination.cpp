@@ -8,15 +8,14 @@
 //===----------------------------------------------------------------------===//
 //
 // This file implements a trivial dead store elimination that only considers
-// basic-block local redundant stores.
-//
-// FIXME: This should eventually be extended to be a post-dominator tree
-// traversal.  Doing so would be pretty trivial.
+// basic-block local redundant stores.  Optionally, stores that are overwritten
+// in a post-dominating block are found by walking the MemorySSA def-use chains.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Scalar/DeadStoreElimination.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/Statistic.h"
@@ -25,8 +24,10 @@
 #include "llvm/Analysis/GlobalsModRef.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Dominators.h"
@@ -40,6 +41,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
 #include <map>
 using namespace llvm;
 
@@ -49,12 +51,22 @@ STATISTIC(NumRedundantStores, "Number of redundant stores deleted");
 STATISTIC(NumFastStores, "Number of stores deleted");
 STATISTIC(NumFastOther , "Number of other instrs removed");
 STATISTIC(NumCompletePartials, "Number of stores dead by later partials");
+STATISTIC(NumCrossBlockStores, "Number of stores deleted across blocks");
 
 static cl::opt<bool>
 EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
   cl::init(true), cl::Hidden,
   cl::desc("Enable partial-overwrite tracking in DSE"));
 
+static cl::opt<bool>
+EnableMemorySSADSE("enable-dse-memoryssa", cl::init(false), cl::Hidden,
+  cl::desc("Use MemorySSA to eliminate stores overwritten in other blocks"));
+
+static cl::opt<unsigned>
+MemorySSAScanLimit("dse-memoryssa-scan-limit", cl::init(100), cl::Hidden,
+  cl::desc("The maximum number of memory accesses DSE visits to prove a "
+           "store dead across blocks"));
+
 
 //===----------------------------------------------------------------------===//
 // Helper functions
@@ -67,7 +79,8 @@ EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
 static void
 deleteDeadInstruction(Instruction *I, BasicBlock::iterator *BBI,
                       MemoryDependenceResults &MD, const TargetLibraryInfo &TLI,
-                      SmallSetVector<Value *, 16> *ValueSet = nullptr) {
+                      SmallSetVector<Value *, 16> *ValueSet = nullptr,
+                      MemorySSA *MSSA = nullptr) {
   SmallVector<Instruction*, 32> NowDeadInsts;
 
   NowDeadInsts.push_back(I);
@@ -86,6 +99,9 @@ deleteDeadInstruction(Instruction *I, BasicBlock::iterator *BBI,
     // MemDep, which needs to know the operands and needs it to be in the
     // function.
     MD.removeInstruction(DeadInst);
+    if (MSSA)
+      if (MemoryAccess *MA = MSSA->getMemoryAccess(DeadInst))
+        MSSA->removeMemoryAccess(MA);
 
     for (unsigned op = 0, e = DeadInst->getNumOperands(); op != e; ++op) {
       Value *Op = DeadInst->getOperand(op);
@@ -1020,8 +1036,164 @@ static bool eliminateDeadStores(BasicBlock &BB, AliasAnalysis *AA,
   return MadeChange;
 }
 
+/// Return true if \p I may keep execution from reaching the instructions after
+/// it: it may unwind, or it is a call that may never return.
+static bool mayEndExecution(const Instruction &I) {
+  if (I.mayThrow())
+    return true;
+  ImmutableCallSite CS(&I);
+  return CS && (!isa<IntrinsicInst>(I) || CS.doesNotReturn());
+}
+
+/// Return true if execution may leave the function, or never get past some
+/// instruction, on a path from \p SI to \p Later.  \p MayEndExecution holds
+/// the blocks that contain such an instruction.
+static bool mayEndExecutionBetween(
+    StoreInst *SI, StoreInst *Later,
+    const SmallPtrSetImpl<BasicBlock *> &MayEndExecution) {
+  BasicBlock *BB = SI->getParent(), *LaterBB = Later->getParent();
+  if (BB == LaterBB)
+    return any_of(make_range(std::next(SI->getIterator()), Later->getIterator()),
+                  mayEndExecution);
+  if (any_of(make_range(std::next(SI->getIterator()), BB->end()),
+             mayEndExecution) ||
+      any_of(make_range(LaterBB->begin(), Later->getIterator()),
+             mayEndExecution))
+    return true;
+
+  // LaterBB post-dominates BB, so every path from BB goes through it.
+  SmallVector<BasicBlock *, 16> Worklist(succ_begin(BB), succ_end(BB));
+  SmallPtrSet<BasicBlock *, 16> Visited;
+  while (!Worklist.empty()) {
+    BasicBlock *Cur = Worklist.pop_back_val();
+    if (Cur == LaterBB || !Visited.insert(Cur).second)
+      continue;
+    if (Visited.size() > MemorySSAScanLimit || MayEndExecution.count(Cur))
+      return true;
+    Worklist.append(succ_begin(Cur), succ_end(Cur));
+  }
+  return false;
+}
+
+/// Return true if the store \p SI is overwritten on every path to the exit of
+/// the function before its location may be read.  Starting from the MemoryDef
+/// of the store, visit the accesses that use it, stopping at stores that
+/// completely overwrite the location from a post-dominating block.
+static bool
+isOverwrittenOnAllPaths(StoreInst *SI, MemorySSA &MSSA, AliasAnalysis &AA,
+                        PostDominatorTree &PDT, const TargetLibraryInfo &TLI,
+                        const SmallPtrSetImpl<BasicBlock *> &InCycle,
+                        const SmallPtrSetImpl<BasicBlock *> &MayEndExecution) {
+  const DataLayout &DL = SI->getModule()->getDataLayout();
+  MemoryLocation Loc = MemoryLocation::get(SI);
+  BasicBlock *BB = SI->getParent();
+
+  // If the function unwinds or never returns before the location is
+  // overwritten, the stored value stays visible unless the location is a local
+  // object that does not escape.
+  const Value *UO = GetUnderlyingObject(Loc.Ptr, DL);
+  bool VisibleOutside = !(isa<AllocaInst>(UO) || isAllocLikeFn(UO, &TLI)) ||
+                        PointerMayBeCaptured(UO, true, true);
+
+  SmallVector<MemoryAccess *, 16> Worklist;
+  SmallPtrSet<MemoryAccess *, 16> Visited;
+  bool FoundKiller = false;
+  auto PushUsers = [&](MemoryAccess *MA) {
+    for (User *U : MA->users())
+      if (Visited.insert(cast<MemoryAccess>(U)).second)
+        Worklist.push_back(cast<MemoryAccess>(U));
+  };
+  PushUsers(MSSA.getMemoryAccess(SI));
+
+  while (!Worklist.empty()) {
+    if (Visited.size() > MemorySSAScanLimit)
+      return false;
+    MemoryAccess *MA = Worklist.pop_back_val();
+    if (isa<MemoryPhi>(MA)) {
+      PushUsers(MA);
+      continue;
+    }
+
+    Instruction *I = cast<MemoryUseOrDef>(MA)->getMemoryInst();
+    if (auto *Later = dyn_cast<StoreInst>(I)) {
+      BasicBlock *LaterBB = Later->getParent();
+      int64_t EarlierOff = 0, LaterOff = 0;
+      InstOverlapIntervalsTy IOL;
+      if (!InCycle.count(LaterBB) &&
+          (LaterBB == BB || PDT.dominates(LaterBB, BB)) &&
+          isOverwrite(getLocForWrite(Later, AA), Loc, DL, TLI, EarlierOff,
+                      LaterOff, Later, IOL) == OverwriteComplete) {
+        // Instructions that do not access memory have no MemoryAccess, so
+        // the walk does not see them.
+        if (VisibleOutside &&
+            mayEndExecutionBetween(SI, Later, MayEndExecution))
+          return false;
+        FoundKiller = true;
+        continue;
+      }
+    }
+
+    // Anything that may read the location, or leave the function before it
+    // is overwritten, keeps the store alive.
+    if ((AA.getModRefInfo(I, Loc) & MRI_Ref) || I->mayThrow())
+      return false;
+    if (isa<MemoryDef>(MA))
+      PushUsers(MA);
+  }
+  return FoundKiller;
+}
+
+/// Delete the stores that are overwritten in a post-dominating block before
+/// being read.
+static bool eliminateCrossBlockDeadStores(Function &F, AliasAnalysis *AA,
+                                          MemoryDependenceResults *MD,
+                                          DominatorTree *DT,
+                                          PostDominatorTree *PDT,
+                                          const TargetLibraryInfo *TLI) {
+  // A store in a cycle may be executed again with a different address before
+  // the overwriting store, which the alias queries below cannot express.
+  SmallPtrSet<BasicBlock *, 16> InCycle;
+  for (scc_iterator<Function *> I = scc_begin(&F); !I.isAtEnd(); ++I)
+    if (I.hasLoop())
+      InCycle.insert(I->begin(), I->end());
+
+  SmallPtrSet<BasicBlock *, 16> MayEndExecution;
+  for (BasicBlock &BB : F)
+    if (any_of(BB, mayEndExecution))
+      MayEndExecution.insert(&BB);
+
+  // Blocks that cannot reach the exit of the function have no post-dominator
+  // tree node, and are trivially post-dominated by everything.
+  SmallVector<StoreInst *, 16> Stores;
+  for (BasicBlock &BB : F)
+    if (DT->isReachableFromEntry(&BB) && PDT->getNode(&BB) &&
+        !InCycle.count(&BB))
+      for (Instruction &I : BB)
+        if (auto *SI = dyn_cast<StoreInst>(&I))
+          if (SI->isSimple())
+            Stores.push_back(SI);
+  if (Stores.empty())
+    return false;
+
+  MemorySSA MSSA(F, AA, DT);
+  bool MadeChange = false;
+  for (StoreInst *SI : Stores) {
+    if (!isOverwrittenOnAllPaths(SI, MSSA, *AA, *PDT, *TLI, InCycle,
+                                 MayEndExecution))
+      continue;
+    DEBUG(dbgs() << "DSE: Remove Store Overwritten In Another Block:\n  DEAD: "
+                 << *SI << '\n');
+    BasicBlock::iterator BBI(SI);
+    deleteDeadInstruction(SI, &BBI, *MD, *TLI, nullptr, &MSSA);
+    ++NumCrossBlockStores;
+    MadeChange = true;
+  }
+  return MadeChange;
+}
+
 static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
                                 MemoryDependenceResults *MD, DominatorTree *DT,
+                                PostDominatorTree *PDT,
                                 const TargetLibraryInfo *TLI) {
   bool MadeChange = false;
   for (BasicBlock &BB : F)
@@ -1029,6 +1201,8 @@ static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
     // cycles that will confuse alias analysis.
     if (DT->isReachableFromEntry(&BB))
       MadeChange |= eliminateDeadStores(BB, AA, MD, DT, TLI);
+  if (PDT)
+    MadeChange |= eliminateCrossBlockDeadStores(F, AA, MD, DT, PDT, TLI);
   return MadeChange;
 }
 
@@ -1040,8 +1214,11 @@ PreservedAnalyses DSEPass::run(Function &F, FunctionAnalysisManager &AM) {
   DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
   MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   const TargetLibraryInfo *TLI = &AM.getResult<TargetLibraryAnalysis>(F);
+  PostDominatorTree *PDT = EnableMemorySSADSE
+                               ? &AM.getResult<PostDominatorTreeAnalysis>(F)
+                               : nullptr;
 
-  if (!eliminateDeadStores(F, AA, MD, DT, TLI))
+  if (!eliminateDeadStores(F, AA, MD, DT, PDT, TLI))
     return PreservedAnalyses::all();
   PreservedAnalyses PA;
   PA.preserve<DominatorTreeAnalysis>();
@@ -1067,8 +1244,12 @@ public:
         &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     const TargetLibraryInfo *TLI =
         &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
+    PostDominatorTree *PDT =
+        EnableMemorySSADSE
+            ? &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree()
+            : nullptr;
 
-    return eliminateDeadStores(F, AA, MD, DT, TLI);
+    return eliminateDeadStores(F, AA, MD, DT, PDT, TLI);
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
@@ -1077,6 +1258,8 @@ public:
     AU.addRequired<AAResultsWrapperPass>();
     AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
+    if (EnableMemorySSADSE)
+      AU.addRequired<PostDominatorTreeWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
     AU.addPreserved<MemoryDependenceWrapperPass>();
@@ -1092,6 +1275,7 @@ INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_END(DSELegacyPass, "dse", "Dead Store Elimination", false,
                     false)
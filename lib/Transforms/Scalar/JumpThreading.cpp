@@ -251,6 +251,11 @@ bool JumpThreadingPass::runImpl(Function &F, TargetLibraryInfo *TLI_,
     EverChanged |= Changed;
   } while (Changed);
 
+  // Threading edges removes incoming values from PHI nodes and cases from
+  // switches; release the operand space they leave behind.
+  if (EverChanged)
+    shrinkHungoffOperandLists(F);
+
   LoopHeaders.clear();
   return EverChanged;
 }
@@ -0,0 +1,418 @@
+//===- LoopFuse.cpp - Loop Fusion Pass ------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Loop Fusion Pass.  It merges adjacent innermost
+// loops that run the same number of iterations into a single loop, so that
+// arrays produced by the first loop are consumed by the second one while they
+// are still in the cache.
+//
+// Two loops are fused when:
+//  * the exit of the first loop falls straight through to the preheader of the
+//    second, so the loops are control-flow equivalent and nothing runs
+//    between them,
+//  * ScalarEvolution proves their backedge-taken counts equal,
+//  * no value computed by the first loop is used by the second one,
+//  * no memory dependence from the first loop to the second one goes
+//    backwards, i.e. from a later iteration of the first loop to an earlier
+//    iteration of the second one, and
+//  * the fused loop does not keep more values live than the target has
+//    registers.
+//
+// The fused loop keeps the header of the first loop, the body of the first
+// loop runs first in every iteration and the latch of the second loop becomes
+// its latch.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "loop-fusion"
+
+STATISTIC(NumLoopsFused, "Number of loops fused");
+
+namespace {
+class LoopFuse : public FunctionPass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  LoopFuse() : FunctionPass(ID) {
+    initializeLoopFusePass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequired<DependenceAnalysisWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
+    AU.addRequiredID(LoopSimplifyID);
+    AU.addRequiredID(LCSSAID);
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addPreserved<ScalarEvolutionWrapperPass>();
+  }
+
+private:
+  Loop *getFusionCandidate(Loop *L1);
+  bool haveNoBackwardDependences(Loop *L1, Loop *L2);
+  bool isForwardDependence(Instruction *Src, Loop *L1, Instruction *Dst,
+                           Loop *L2);
+  bool exceedsRegisterPressure(Loop *L1, Loop *L2);
+  void fuseLoops(Loop *L1, Loop *L2);
+
+  Function *F;
+  DominatorTree *DT;
+  LoopInfo *LI;
+  ScalarEvolution *SE;
+  DependenceInfo *DI;
+  const TargetTransformInfo *TTI;
+};
+} // end anonymous namespace
+
+char LoopFuse::ID = 0;
+INITIALIZE_PASS_BEGIN(LoopFuse, "loop-fusion", "Fuse adjacent loops", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(LCSSAWrapperPass)
+INITIALIZE_PASS_END(LoopFuse, "loop-fusion", "Fuse adjacent loops", false,
+                    false)
+
+FunctionPass *llvm::createLoopFusePass() { return new LoopFuse(); }
+
+/// Return true if \p BB holds nothing but PHIs and an unconditional branch.
+static bool isEmptyBlock(BasicBlock *BB) {
+  auto *BI = dyn_cast<BranchInst>(BB->getTerminator());
+  return BI && BI->isUnconditional() && &*BB->getFirstInsertionPt() == BI;
+}
+
+/// Return true if \p L has the shape fusion expects: an innermost loop in
+/// simplified form whose latch is its only exiting block.
+static bool isFusibleLoop(Loop *L) {
+  if (!L->empty() || !L->isLoopSimplifyForm())
+    return false;
+  BasicBlock *Latch = L->getLoopLatch();
+  if (L->getExitingBlock() != Latch || !L->getExitBlock())
+    return false;
+  auto *BI = dyn_cast<BranchInst>(Latch->getTerminator());
+  return BI && BI->isConditional();
+}
+
+/// Return the loop that follows \p L1 immediately and can be fused with it,
+/// or null.
+Loop *LoopFuse::getFusionCandidate(Loop *L1) {
+  if (!isFusibleLoop(L1))
+    return nullptr;
+
+  // The exit of L1 must fall through to the preheader of the next loop,
+  // possibly being that preheader itself.
+  BasicBlock *Exit = L1->getExitBlock();
+  if (!isEmptyBlock(Exit))
+    return nullptr;
+  BasicBlock *Preheader = Exit;
+  BasicBlock *Succ = Exit->getSingleSuccessor();
+  if (!LI->isLoopHeader(Succ)) {
+    if (!isEmptyBlock(Succ) || isa<PHINode>(Succ->front()) ||
+        !Succ->getSinglePredecessor())
+      return nullptr;
+    Preheader = Succ;
+    Succ = Succ->getSingleSuccessor();
+  }
+  Loop *L2 = LI->getLoopFor(Succ);
+  if (!L2 || L2->getHeader() != Succ || L2->getLoopPreheader() != Preheader ||
+      L2->getParentLoop() != L1->getParentLoop() || !isFusibleLoop(L2))
+    return nullptr;
+
+  // Both loops have to run the same number of iterations.
+  const SCEV *BTC1 = SE->getBackedgeTakenCount(L1);
+  const SCEV *BTC2 = SE->getBackedgeTakenCount(L2);
+  if (isa<SCEVCouldNotCompute>(BTC1) || isa<SCEVCouldNotCompute>(BTC2) ||
+      BTC1->getType() != BTC2->getType() ||
+      !SE->getMinusSCEV(BTC1, BTC2)->isZero()) {
+    DEBUG(dbgs() << "LF: Trip counts of " << L1->getHeader()->getName()
+                 << " and " << L2->getHeader()->getName()
+                 << " are not known to be equal\n");
+    return nullptr;
+  }
+
+  // The values L2 is fed with from outside must be available before L1; in
+  // particular L2 may not use the values computed by L1, which in LCSSA form
+  // are the PHIs of its exit block.
+  BasicBlock *Preheader1 = L1->getLoopPreheader();
+  for (Instruction &I : *L2->getHeader()) {
+    auto *PN = dyn_cast<PHINode>(&I);
+    if (!PN)
+      break;
+    auto *Init = dyn_cast<Instruction>(PN->getIncomingValueForBlock(Preheader));
+    if (Init && !DT->dominates(Init, Preheader1->getTerminator()))
+      return nullptr;
+  }
+  for (Instruction &I : *Exit) {
+    auto *PN = dyn_cast<PHINode>(&I);
+    if (!PN)
+      break;
+    for (User *U : PN->users())
+      if (L2->contains(cast<Instruction>(U)))
+        return nullptr;
+  }
+  return L2;
+}
+
+/// Return the pointer accessed by the load or store \p I.
+static Value *getPointerOperand(Instruction *I) {
+  if (auto *LD = dyn_cast<LoadInst>(I))
+    return LD->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+/// Return the type of the value loaded or stored by \p I.
+static Type *getAccessType(Instruction *I) {
+  if (auto *ST = dyn_cast<StoreInst>(I))
+    return ST->getValueOperand()->getType();
+  return I->getType();
+}
+
+/// Return true if every instance of \p Src in \p L1 that touches memory also
+/// touched by \p Dst in \p L2 runs in an iteration no later than the instance
+/// of \p Dst, so that the fused loop still runs it first.
+bool LoopFuse::isForwardDependence(Instruction *Src, Loop *L1, Instruction *Dst,
+                                   Loop *L2) {
+  auto *SrcAR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(getPointerOperand(Src)));
+  auto *DstAR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(getPointerOperand(Dst)));
+  if (!SrcAR || !DstAR || SrcAR->getLoop() != L1 || DstAR->getLoop() != L2 ||
+      !SrcAR->isAffine() || !DstAR->isAffine() ||
+      SrcAR->getType() != DstAR->getType())
+    return false;
+  auto *Step = dyn_cast<SCEVConstant>(SrcAR->getStepRecurrence(*SE));
+  if (!Step || Step != DstAR->getStepRecurrence(*SE) || Step->isZero())
+    return false;
+
+  // With equal strides, the access of Src in iteration I' overlaps the access
+  // of Dst in iteration I only if I' - I = (DstStart - SrcStart) / Step. It is
+  // fine for that to be zero or negative, as long as the stride steps over a
+  // whole access.
+  const DataLayout &DL = F->getParent()->getDataLayout();
+  const APInt &StepVal = Step->getAPInt();
+  uint64_t MaxSize = std::max(DL.getTypeStoreSize(getAccessType(Src)),
+                              DL.getTypeStoreSize(getAccessType(Dst)));
+  if (StepVal.abs().ult(MaxSize))
+    return false;
+  const SCEV *Dist = SE->getMinusSCEV(DstAR->getStart(), SrcAR->getStart());
+  return StepVal.isNegative() ? SE->isKnownNonNegative(Dist)
+                              : SE->isKnownNonPositive(Dist);
+}
+
+/// Return true if fusing \p L1 and \p L2 preserves every memory dependence
+/// between them.
+bool LoopFuse::haveNoBackwardDependences(Loop *L1, Loop *L2) {
+  SmallVector<Instruction *, 16> MemInsts1, MemInsts2;
+  for (Loop *L : {L1, L2})
+    for (BasicBlock *BB : L->blocks())
+      for (Instruction &I : *BB) {
+        if (!I.mayReadOrWriteMemory())
+          continue;
+        // Only simple loads and stores can be reordered with the other loop.
+        auto *LD = dyn_cast<LoadInst>(&I);
+        auto *ST = dyn_cast<StoreInst>(&I);
+        if ((!LD || !LD->isSimple()) && (!ST || !ST->isSimple()))
+          return false;
+        (L == L1 ? MemInsts1 : MemInsts2).push_back(&I);
+      }
+
+  for (Instruction *Src : MemInsts1)
+    for (Instruction *Dst : MemInsts2) {
+      if (isa<LoadInst>(Src) && isa<LoadInst>(Dst))
+        continue;
+      if (!DI->depends(Src, Dst, true))
+        continue;
+      if (!isForwardDependence(Src, L1, Dst, L2)) {
+        DEBUG(dbgs() << "LF: Fusion-preventing dependence from " << *Src
+                     << " to " << *Dst << "\n");
+        return false;
+      }
+    }
+  return true;
+}
+
+/// Return true if the fused loop would keep more values live across its body
+/// than there are registers: the recurrences of both loops and the
+/// loop-invariant values their bodies use.
+bool LoopFuse::exceedsRegisterPressure(Loop *L1, Loop *L2) {
+  SmallPtrSet<Value *, 32> Live;
+  for (Loop *L : {L1, L2})
+    for (BasicBlock *BB : L->blocks())
+      for (Instruction &I : *BB) {
+        if (isa<PHINode>(I) && BB == L->getHeader())
+          Live.insert(&I);
+        for (Value *Op : I.operands())
+          if (isa<Argument>(Op) ||
+              (isa<Instruction>(Op) && !L->contains(cast<Instruction>(Op))))
+            Live.insert(Op);
+      }
+
+  unsigned NumScalar = 0, NumVector = 0;
+  for (Value *V : Live) {
+    Type *Ty = V->getType();
+    if (Ty->isVectorTy() || Ty->isFloatingPointTy())
+      ++NumVector;
+    else
+      ++NumScalar;
+  }
+  DEBUG(dbgs() << "LF: Fused loop keeps " << NumScalar << " scalar and "
+               << NumVector << " vector values live\n");
+  return NumScalar > TTI->getNumberOfRegisters(false) ||
+         NumVector > TTI->getNumberOfRegisters(true);
+}
+
+void LoopFuse::fuseLoops(Loop *L1, Loop *L2) {
+  BasicBlock *Preheader1 = L1->getLoopPreheader();
+  BasicBlock *Header1 = L1->getHeader();
+  BasicBlock *Latch1 = L1->getLoopLatch();
+  BasicBlock *Exit1 = L1->getExitBlock();
+  BasicBlock *Preheader2 = L2->getLoopPreheader();
+  BasicBlock *Header2 = L2->getHeader();
+  BasicBlock *Latch2 = L2->getLoopLatch();
+  BasicBlock *Exit2 = L2->getExitBlock();
+
+  SE->forgetLoop(L1);
+  SE->forgetLoop(L2);
+
+  // Run the body of L2 after the one of L1 in every iteration, and branch back
+  // to the header of L1 from the latch of L2.
+  auto *LatchBr1 = cast<BranchInst>(Latch1->getTerminator());
+  Value *Cond1 = LatchBr1->getCondition();
+  BranchInst::Create(Header2, LatchBr1);
+  LatchBr1->eraseFromParent();
+  RecursivelyDeleteTriviallyDeadInstructions(Cond1);
+  Latch2->getTerminator()->replaceUsesOfWith(Header2, Header1);
+
+  // The recurrences of L1 now come around from the latch of L2, and the ones
+  // of L2 start in the preheader of L1.
+  SmallVector<PHINode *, 8> Header2PHIs;
+  for (Instruction &I : *Header2) {
+    auto *PN = dyn_cast<PHINode>(&I);
+    if (!PN)
+      break;
+    Header2PHIs.push_back(PN);
+  }
+  for (Instruction &I : *Header1) {
+    auto *PN = dyn_cast<PHINode>(&I);
+    if (!PN)
+      break;
+    PN->setIncomingBlock(PN->getBasicBlockIndex(Latch1), Latch2);
+  }
+  for (PHINode *PN : Header2PHIs) {
+    PN->moveBefore(Header1->getFirstNonPHI());
+    PN->setIncomingBlock(PN->getBasicBlockIndex(Preheader2), Preheader1);
+  }
+
+  // The values of L1 used after the loops now leave the fused loop through the
+  // exit of L2.
+  while (auto *PN = dyn_cast<PHINode>(&Exit1->front())) {
+    Value *V = PN->getIncomingValueForBlock(Latch1);
+    auto *I = dyn_cast<Instruction>(V);
+    if (I && L1->contains(I)) {
+      PHINode *NewPN = PHINode::Create(V->getType(), 1, PN->getName(),
+                                       &Exit2->front());
+      NewPN->addIncoming(V, Latch2);
+      V = NewPN;
+    }
+    PN->replaceAllUsesWith(V);
+    PN->eraseFromParent();
+  }
+
+  // Nothing branches to the blocks between the loops anymore.
+  LI->removeBlock(Exit1);
+  DeleteDeadBlock(Exit1);
+  if (Preheader2 != Exit1) {
+    LI->removeBlock(Preheader2);
+    DeleteDeadBlock(Preheader2);
+  }
+
+  // Move the blocks of L2 into L1 and drop L2 from the loop forest. The
+  // enclosing loops already contain the blocks.
+  for (BasicBlock *BB : L2->blocks()) {
+    L1->addBlockEntry(BB);
+    LI->changeLoopFor(BB, L1);
+  }
+  if (Loop *Parent = L2->getParentLoop()) {
+    for (Loop::iterator I = Parent->begin();; ++I)
+      if (*I == L2) {
+        Parent->removeChildLoop(I);
+        break;
+      }
+  } else {
+    for (LoopInfo::iterator I = LI->begin();; ++I)
+      if (*I == L2) {
+        LI->removeLoop(I);
+        break;
+      }
+  }
+  delete L2;
+
+  DT->recalculate(*F);
+  ++NumLoopsFused;
+}
+
+bool LoopFuse::runOnFunction(Function &Fn) {
+  if (skipFunction(Fn))
+    return false;
+
+  F = &Fn;
+  DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+  LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+  DI = &getAnalysis<DependenceAnalysisWrapperPass>().getDI();
+  TTI = &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(Fn);
+
+  // Fusing changes the loop forest, look for candidates again after every
+  // fusion. A fused loop may be fused with the next one in turn.
+  bool Changed = false;
+  bool Fused = true;
+  while (Fused) {
+    Fused = false;
+    SmallVector<Loop *, 8> Worklist(LI->begin(), LI->end());
+    while (!Worklist.empty() && !Fused) {
+      Loop *L1 = Worklist.pop_back_val();
+      Worklist.append(L1->begin(), L1->end());
+      Loop *L2 = getFusionCandidate(L1);
+      if (!L2 || !haveNoBackwardDependences(L1, L2) ||
+          exceedsRegisterPressure(L1, L2))
+        continue;
+
+      DEBUG(dbgs() << "LF: Fusing " << L1->getHeader()->getName() << " and "
+                   << L2->getHeader()->getName() << " in " << Fn.getName()
+                   << "\n");
+      fuseLoops(L1, L2);
+      Changed = Fused = true;
+    }
+  }
+  return Changed;
+}
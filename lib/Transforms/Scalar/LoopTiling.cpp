@@ -0,0 +1,598 @@
+//===- LoopTiling.cpp - Loop Tiling Pass ----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Loop Tiling Pass.  It blocks perfect loop nests
+// (matrix multiplication, transposition, stencils and convolutions) for the
+// data cache: every loop of the nest but the outermost one is strip-mined
+// into tiles, and the loops walking over the tiles are interchanged outside
+// of the whole nest.  For the nest
+//
+//   for (i = 0; i < N; ++i)
+//     for (j = 0; j < M; ++j)
+//       B[j][i] = A[i][j];
+//
+// the pass produces
+//
+//   for (jj = 0; jj < M; jj += T)
+//     for (i = 0; i < N; ++i)
+//       for (j = jj; j < min(jj + T, M); ++j)
+//         B[j][i] = A[i][j];
+//
+// so that the T cache lines of B touched by one iteration of the i loop are
+// still in the cache when the next iteration touches them again.
+//
+// The tile size T is chosen so that the data a tile touches fits in the level
+// 1 data cache that TargetTransformInfo describes.  Tiling is legal when the
+// dependences of the nest, as computed by DependenceAnalysis, are fully
+// permutable, i.e. none of them points backwards in one loop and forwards in
+// another.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "loop-tiling"
+
+STATISTIC(NumNestsTiled, "Number of loop nests tiled");
+STATISTIC(NumLoopsTiled, "Number of loops strip-mined into tiles");
+
+static cl::opt<unsigned> TileSizeOpt(
+    "loop-tile-size", cl::init(0), cl::Hidden,
+    cl::desc("Number of iterations in a tile of each tiled loop (0 to derive "
+             "it from the data cache size of the target)"));
+
+namespace {
+/// A loop of the nest that gets strip-mined: its induction variable runs from
+/// Start to End (exclusive) in steps of one.
+struct TiledLoop {
+  Loop *L;
+  PHINode *IV;
+  Instruction *IVNext;
+  const SCEV *Start;
+  const SCEV *End;
+};
+
+class LoopTiling : public FunctionPass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  LoopTiling() : FunctionPass(ID) {
+    initializeLoopTilingPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequired<DependenceAnalysisWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
+    AU.addRequiredID(LoopSimplifyID);
+    AU.addRequiredID(LCSSAID);
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addPreserved<ScalarEvolutionWrapperPass>();
+  }
+
+private:
+  bool visitLoop(Loop *L);
+  bool getPerfectNest(Loop *Outer, SmallVectorImpl<Loop *> &Nest);
+  bool analyzeTiledLoop(Loop *L, Loop *Outer, TiledLoop &TL);
+  bool isFullyPermutable(Loop *Outer, ArrayRef<Instruction *> MemInsts);
+  bool hasReuseAcrossOuterLoop(Loop *Outer, ArrayRef<TiledLoop> Tiled,
+                               ArrayRef<Instruction *> MemInsts);
+  unsigned getTileSize(ArrayRef<TiledLoop> Tiled,
+                       ArrayRef<Instruction *> MemInsts);
+  void tileNest(Loop *Outer, ArrayRef<TiledLoop> Tiled, unsigned TileSize);
+
+  Function *F;
+  DominatorTree *DT;
+  LoopInfo *LI;
+  ScalarEvolution *SE;
+  DependenceInfo *DI;
+  const TargetTransformInfo *TTI;
+};
+} // end anonymous namespace
+
+char LoopTiling::ID = 0;
+INITIALIZE_PASS_BEGIN(LoopTiling, "loop-tiling", "Tile loop nests", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(LCSSAWrapperPass)
+INITIALIZE_PASS_END(LoopTiling, "loop-tiling", "Tile loop nests", false,
+                    false)
+
+FunctionPass *llvm::createLoopTilingPass() { return new LoopTiling(); }
+
+/// Return true if \p L is in simplified form, leaves through its latch only
+/// and computes nothing that is used after it.
+static bool hasTileableShape(Loop *L) {
+  if (!L->isLoopSimplifyForm())
+    return false;
+  BasicBlock *Latch = L->getLoopLatch();
+  BasicBlock *Exit = L->getExitBlock();
+  if (L->getExitingBlock() != Latch || !Exit || isa<PHINode>(Exit->front()))
+    return false;
+  auto *BI = dyn_cast<BranchInst>(Latch->getTerminator());
+  return BI && BI->isConditional();
+}
+
+/// Collect in \p Nest the perfect loop nest rooted at \p Outer, from the
+/// outermost loop to the innermost one.  Apart from the inner loop, the body
+/// of every loop may only compute values without side effects and branch
+/// unconditionally to the inner loop, so that running it again for every
+/// tile does not change the result.
+bool LoopTiling::getPerfectNest(Loop *Outer, SmallVectorImpl<Loop *> &Nest) {
+  for (Loop *L = Outer;; L = *L->begin()) {
+    if (!hasTileableShape(L))
+      return false;
+    Nest.push_back(L);
+    if (L->empty())
+      return Nest.size() > 1;
+    if (std::next(L->begin()) != L->end())
+      return false;
+
+    Loop *Inner = *L->begin();
+    for (BasicBlock *BB : L->blocks()) {
+      if (Inner->contains(BB))
+        continue;
+      auto *BI = dyn_cast<BranchInst>(BB->getTerminator());
+      if (BB != L->getLoopLatch() && (!BI || !BI->isUnconditional()))
+        return false;
+      for (Instruction &I : *BB)
+        if (I.mayReadOrWriteMemory() || I.mayHaveSideEffects())
+          return false;
+    }
+  }
+}
+
+/// Fill in \p TL for the loop \p L of the nest rooted at \p Outer.  Return
+/// false if \p L cannot be strip-mined: it must have a single induction
+/// variable counting up by one, between non-negative bounds that do not change
+/// in the nest.
+bool LoopTiling::analyzeTiledLoop(Loop *L, Loop *Outer, TiledLoop &TL) {
+  BasicBlock *Header = L->getHeader();
+  auto *IV = dyn_cast<PHINode>(&Header->front());
+  if (!IV || isa<PHINode>(IV->getNextNode()) || !IV->getType()->isIntegerTy())
+    return false;
+  auto *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(IV));
+  if (!AR || AR->getLoop() != L || !AR->isAffine() ||
+      !AR->getStepRecurrence(*SE)->isOne())
+    return false;
+  auto *IVNext =
+      dyn_cast<Instruction>(IV->getIncomingValueForBlock(L->getLoopLatch()));
+  if (!IVNext || !L->contains(IVNext))
+    return false;
+
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC) || BTC->getType() != IV->getType())
+    return false;
+  const SCEV *Start = AR->getStart();
+  const SCEV *End = SE->getAddExpr(Start, BTC, SE->getOne(IV->getType()));
+  // The tile bounds are compared as signed values: the induction variable may
+  // not go past the largest signed value.
+  if (!SE->isKnownNonNegative(Start) ||
+      (!SE->isKnownNonNegative(End) && !AR->getNoWrapFlags(SCEV::FlagNSW)) ||
+      !SE->isLoopInvariant(Start, Outer) ||
+      !SE->isLoopInvariant(End, Outer) || !isSafeToExpand(Start, *SE) ||
+      !isSafeToExpand(End, *SE))
+    return false;
+
+  TL.L = L;
+  TL.IV = IV;
+  TL.IVNext = IVNext;
+  TL.Start = Start;
+  TL.End = End;
+  return true;
+}
+
+/// Return true if no dependence between \p MemInsts goes forwards in one loop
+/// of the nest rooted at \p Outer and backwards in another, so that the loops
+/// of the nest can be run in any order and tiled.
+bool LoopTiling::isFullyPermutable(Loop *Outer,
+                                   ArrayRef<Instruction *> MemInsts) {
+  unsigned OuterLevels = Outer->getLoopDepth() - 1;
+  for (unsigned I = 0, E = MemInsts.size(); I != E; ++I)
+    for (unsigned J = I; J != E; ++J) {
+      Instruction *Src = MemInsts[I];
+      Instruction *Dst = MemInsts[J];
+      if (isa<LoadInst>(Src) && isa<LoadInst>(Dst))
+        continue;
+      auto D = DI->depends(Src, Dst, true);
+      if (!D)
+        continue;
+      if (D->isConfused())
+        return false;
+
+      // A dependence carried by a loop around the nest is not affected.
+      bool Carried = false;
+      for (unsigned Level = 1; Level <= OuterLevels && !Carried; ++Level) {
+        unsigned Dir = D->getDirection(Level);
+        if (Dir == Dependence::DVEntry::LT || Dir == Dependence::DVEntry::GT)
+          Carried = true;
+        else if (Dir != Dependence::DVEntry::EQ)
+          return false;
+      }
+      if (Carried)
+        continue;
+
+      // The dependence may be reported from Dst to Src, so all directions
+      // may as well point backwards.  It only gets in the way if it can point
+      // forwards in one loop and backwards in another.
+      SmallVector<unsigned, 4> LTLevels, GTLevels;
+      for (unsigned Level = OuterLevels + 1; Level <= D->getLevels(); ++Level) {
+        unsigned Dir = D->getDirection(Level);
+        if (Dir & Dependence::DVEntry::LT)
+          LTLevels.push_back(Level);
+        if (Dir & Dependence::DVEntry::GT)
+          GTLevels.push_back(Level);
+      }
+      if (!LTLevels.empty() && !GTLevels.empty() &&
+          (LTLevels.size() > 1 || LTLevels != GTLevels)) {
+        DEBUG(dbgs() << "LT: Tiling-preventing dependence from " << *Src
+                     << " to " << *Dst << "\n");
+        return false;
+      }
+    }
+  return true;
+}
+
+/// Return the pointer accessed by the load or store \p I.
+static Value *getPointerOperand(Instruction *I) {
+  if (auto *LD = dyn_cast<LoadInst>(I))
+    return LD->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+/// Return the type of the value loaded or stored by \p I.
+static Type *getAccessType(Instruction *I) {
+  if (auto *ST = dyn_cast<StoreInst>(I))
+    return ST->getValueOperand()->getType();
+  return I->getType();
+}
+
+/// Return the distance between the addresses \p S takes in consecutive
+/// iterations of \p L, zero if it does not change in \p L, or null if it is
+/// not an affine function of the induction variable of \p L.
+static const SCEV *getStride(const SCEV *S, const Loop *L,
+                             ScalarEvolution &SE) {
+  while (auto *AR = dyn_cast<SCEVAddRecExpr>(S)) {
+    if (AR->getLoop() == L)
+      return AR->isAffine() ? AR->getStepRecurrence(SE) : nullptr;
+    S = AR->getStart();
+  }
+  if (!SE.isLoopInvariant(S, L))
+    return nullptr;
+  return SE.getZero(SE.getEffectiveSCEVType(S->getType()));
+}
+
+/// Return true if tiling pays off: some access touches the same cache line
+/// in consecutive iterations of \p Outer, but walks through memory in a tiled
+/// loop, so that without tiling the line is evicted before it is reused.
+bool LoopTiling::hasReuseAcrossOuterLoop(Loop *Outer,
+                                         ArrayRef<TiledLoop> Tiled,
+                                         ArrayRef<Instruction *> MemInsts) {
+  uint64_t LineSize = TTI->getCacheLineSize();
+  for (Instruction *I : MemInsts) {
+    const SCEV *Ptr = SE->getSCEV(getPointerOperand(I));
+    auto *OuterStride =
+        dyn_cast_or_null<SCEVConstant>(getStride(Ptr, Outer, *SE));
+    if (!OuterStride ||
+        (!OuterStride->isZero() &&
+         OuterStride->getAPInt().abs().uge(LineSize)))
+      continue;
+    for (const TiledLoop &TL : Tiled) {
+      const SCEV *Stride = getStride(Ptr, TL.L, *SE);
+      if (!Stride || !Stride->isZero())
+        return true;
+    }
+  }
+  return false;
+}
+
+/// Return the number of iterations of each loop of \p Tiled in a tile, such
+/// that the data \p MemInsts touch in one tile fits in the level 1 data
+/// cache, or 0 if the target does not describe its cache.
+unsigned LoopTiling::getTileSize(ArrayRef<TiledLoop> Tiled,
+                                 ArrayRef<Instruction *> MemInsts) {
+  if (TileSizeOpt.getNumOccurrences() > 0)
+    return TileSizeOpt;
+
+  Optional<unsigned> CacheSize =
+      TTI->getCacheSize(TargetTransformInfo::CacheLevel::L1D);
+  if (!CacheSize)
+    return 0;
+  // Leave one way of the cache to the conflict misses between the tiles of
+  // different arrays.
+  uint64_t Budget = *CacheSize;
+  Optional<unsigned> Assoc =
+      TTI->getCacheAssociativity(TargetTransformInfo::CacheLevel::L1D);
+  if (Assoc && *Assoc > 1)
+    Budget = Budget / *Assoc * (*Assoc - 1);
+
+  // An access that varies in D of the tiled loops touches TileSize ^ D
+  // locations in a tile.  Each of them costs a whole cache line unless the
+  // access walks through memory with a smaller stride in one of the loops.
+  struct Footprint {
+    uint64_t Unit;
+    unsigned Dims;
+  };
+  const DataLayout &DL = F->getParent()->getDataLayout();
+  uint64_t LineSize = TTI->getCacheLineSize();
+  uint64_t MaxElemSize = 1;
+  SmallPtrSet<const SCEV *, 8> Seen;
+  SmallVector<Footprint, 8> Footprints;
+  for (Instruction *I : MemInsts) {
+    uint64_t ElemSize = DL.getTypeStoreSize(getAccessType(I));
+    MaxElemSize = std::max(MaxElemSize, ElemSize);
+    const SCEV *Ptr = SE->getSCEV(getPointerOperand(I));
+    if (!Seen.insert(Ptr).second)
+      continue;
+    Footprint FP = {std::max(LineSize, ElemSize), 0};
+    for (const TiledLoop &TL : Tiled) {
+      const SCEV *Stride = getStride(Ptr, TL.L, *SE);
+      if (Stride && Stride->isZero())
+        continue;
+      ++FP.Dims;
+      if (auto *C = dyn_cast_or_null<SCEVConstant>(Stride))
+        FP.Unit = std::min(FP.Unit,
+                           std::max(C->getAPInt().abs().getLimitedValue(),
+                                    ElemSize));
+    }
+    Footprints.push_back(FP);
+  }
+
+  // Start from the number of elements in a cache line and double the tile
+  // size while the data still fits.
+  uint64_t TileSize =
+      std::max<uint64_t>(PowerOf2Floor(LineSize / MaxElemSize), 1);
+  for (;;) {
+    uint64_t Size = 0;
+    for (const Footprint &FP : Footprints) {
+      uint64_t Locations = 1;
+      for (unsigned I = 0; I != FP.Dims; ++I)
+        Locations *= TileSize * 2;
+      Size += FP.Unit * Locations;
+    }
+    if (Size > Budget)
+      break;
+    TileSize *= 2;
+  }
+  return TileSize;
+}
+
+void LoopTiling::tileNest(Loop *Outer, ArrayRef<TiledLoop> Tiled,
+                          unsigned TileSize) {
+  BasicBlock *Preheader = Outer->getLoopPreheader();
+  BasicBlock *Header = Outer->getHeader();
+  BasicBlock *Latch = Outer->getLoopLatch();
+  BasicBlock *Exit = Outer->getExitBlock();
+  LLVMContext &Ctx = F->getContext();
+
+  // The bounds of the tiled loops do not change in the nest: compute them
+  // once before it.
+  SCEVExpander Expander(*SE, F->getParent()->getDataLayout(), "tile");
+  SmallVector<Value *, 4> Starts, Ends;
+  for (const TiledLoop &TL : Tiled) {
+    Type *Ty = TL.IV->getType();
+    Starts.push_back(
+        Expander.expandCodeFor(TL.Start, Ty, Preheader->getTerminator()));
+    Ends.push_back(
+        Expander.expandCodeFor(TL.End, Ty, Preheader->getTerminator()));
+  }
+
+  SE->forgetLoop(Outer);
+
+  // Build a loop over the tiles of every tiled loop around the nest.  The
+  // header of a tile loop computes the end of the current tile, its latch
+  // moves on to the next tile.
+  SmallVector<BasicBlock *, 4> TileHeaders, TileLatches;
+  SmallVector<PHINode *, 4> TileStarts;
+  SmallVector<Value *, 4> TileEnds;
+  BasicBlock *PrevBlock = Preheader;
+  for (unsigned K = 0, E = Tiled.size(); K != E; ++K) {
+    const TiledLoop &TL = Tiled[K];
+    Type *Ty = TL.IV->getType();
+    StringRef Name = TL.L->getHeader()->getName();
+    BasicBlock *TileHeader =
+        BasicBlock::Create(Ctx, Name + ".tile", F, Header);
+    BasicBlock *TileLatch = BasicBlock::Create(
+        Ctx, Name + ".tile.latch", F, K == 0 ? Exit : TileLatches.back());
+
+    IRBuilder<> B(TileHeader);
+    PHINode *TileStart = B.CreatePHI(Ty, 2, Name + ".tile.start");
+    TileStart->addIncoming(Starts[K], PrevBlock);
+    // The end of the tile is TileStart + TileSize, unless that goes past the
+    // end of the loop. Compare the remaining iterations rather than the
+    // sum, which may overflow.
+    Value *Size = ConstantInt::get(Ty, TileSize);
+    Value *Remaining = B.CreateNSWSub(Ends[K], TileStart);
+    Value *IsFull = B.CreateICmpSGT(Remaining, Size);
+    Value *Next = B.CreateNSWAdd(TileStart, Size);
+    Value *TileEnd = B.CreateSelect(IsFull, Next, Ends[K], Name + ".tile.end");
+    TileStart->addIncoming(TileEnd, TileLatch);
+
+    B.SetInsertPoint(TileLatch);
+    Value *More = B.CreateICmpSLT(TileEnd, Ends[K]);
+    B.CreateCondBr(More, TileHeader,
+                   K == 0 ? Exit : TileLatches.back());
+
+    if (K == 0)
+      Preheader->getTerminator()->replaceUsesOfWith(Header, TileHeader);
+    else
+      BranchInst::Create(TileHeader, TileHeaders.back());
+
+    TileHeaders.push_back(TileHeader);
+    TileLatches.push_back(TileLatch);
+    TileStarts.push_back(TileStart);
+    TileEnds.push_back(TileEnd);
+    PrevBlock = TileHeader;
+  }
+  BranchInst::Create(Header, TileHeaders.back());
+  Latch->getTerminator()->replaceUsesOfWith(Exit, TileLatches.back());
+  for (Instruction &I : *Header) {
+    auto *PN = dyn_cast<PHINode>(&I);
+    if (!PN)
+      break;
+    PN->setIncomingBlock(PN->getBasicBlockIndex(Preheader),
+                         TileHeaders.back());
+  }
+
+  // Restrict every tiled loop to the current tile.
+  for (unsigned K = 0, E = Tiled.size(); K != E; ++K) {
+    const TiledLoop &TL = Tiled[K];
+    BasicBlock *LoopHeader = TL.L->getHeader();
+    TL.IV->setIncomingValue(
+        TL.IV->getBasicBlockIndex(TL.L->getLoopPreheader()),
+        TileStarts[K]);
+
+    auto *BI = cast<BranchInst>(TL.L->getLoopLatch()->getTerminator());
+    Value *OldCond = BI->getCondition();
+    ICmpInst::Predicate P = BI->getSuccessor(0) == LoopHeader
+                                ? ICmpInst::ICMP_SLT
+                                : ICmpInst::ICMP_SGE;
+    BI->setCondition(new ICmpInst(BI, P, TL.IVNext, TileEnds[K], "tile.cond"));
+    RecursivelyDeleteTriviallyDeadInstructions(OldCond);
+  }
+
+  // Put the tile loops into the loop forest, between the nest and its parent.
+  SmallVector<Loop *, 4> TileLoops;
+  for (unsigned K = 0, E = Tiled.size(); K != E; ++K) {
+    Loop *TileLoop = new Loop();
+    if (K != 0)
+      TileLoops.back()->addChildLoop(TileLoop);
+    else if (Loop *Parent = Outer->getParentLoop())
+      Parent->replaceChildLoopWith(Outer, TileLoop);
+    else
+      LI->changeTopLevelLoop(Outer, TileLoop);
+    TileLoops.push_back(TileLoop);
+  }
+  TileLoops.back()->addChildLoop(Outer);
+  for (unsigned K = 0, E = Tiled.size(); K != E; ++K)
+    TileLoops[K]->addBasicBlockToLoop(TileHeaders[K], *LI);
+  for (Loop *TileLoop : TileLoops)
+    for (BasicBlock *BB : Outer->blocks())
+      TileLoop->addBlockEntry(BB);
+  for (unsigned K = 0, E = Tiled.size(); K != E; ++K)
+    TileLoops[K]->addBasicBlockToLoop(TileLatches[K], *LI);
+
+  DT->recalculate(*F);
+  ++NumNestsTiled;
+  NumLoopsTiled += Tiled.size();
+}
+
+/// Tile the perfect nest rooted at \p Outer if there is one, and look for
+/// one in the loops inside \p Outer otherwise.
+bool LoopTiling::visitLoop(Loop *Outer) {
+  SmallVector<Loop *, 4> Nest;
+  if (!getPerfectNest(Outer, Nest)) {
+    bool Changed = false;
+    SmallVector<Loop *, 4> SubLoops(Outer->begin(), Outer->end());
+    for (Loop *L : SubLoops)
+      Changed |= visitLoop(L);
+    return Changed;
+  }
+
+  // Only simple loads and stores, all in the innermost loop, can be moved
+  // between tiles.
+  SmallVector<Instruction *, 16> MemInsts;
+  for (BasicBlock *BB : Nest.back()->blocks())
+    for (Instruction &I : *BB) {
+      if (isa<DbgInfoIntrinsic>(I))
+        continue;
+      if (!I.mayReadOrWriteMemory() && !I.mayHaveSideEffects())
+        continue;
+      auto *LD = dyn_cast<LoadInst>(&I);
+      auto *ST = dyn_cast<StoreInst>(&I);
+      if ((!LD || !LD->isSimple()) && (!ST || !ST->isSimple()))
+        return false;
+      MemInsts.push_back(&I);
+    }
+  if (MemInsts.empty() || !isFullyPermutable(Outer, MemInsts))
+    return false;
+
+  SmallVector<TiledLoop, 4> Tiled;
+  for (Loop *L : makeArrayRef(Nest).slice(1)) {
+    TiledLoop TL;
+    if (!analyzeTiledLoop(L, Outer, TL))
+      return false;
+    Tiled.push_back(TL);
+  }
+  if (!hasReuseAcrossOuterLoop(Outer, Tiled, MemInsts))
+    return false;
+
+  unsigned TileSize = getTileSize(Tiled, MemInsts);
+  if (!TileSize)
+    return false;
+
+  // Loops that never run more than a tile are left alone.
+  auto FitsInTile = [&](const TiledLoop &TL) {
+    auto *Max = dyn_cast<SCEVConstant>(SE->getMaxBackedgeTakenCount(TL.L));
+    return Max && Max->getAPInt().ult(TileSize);
+  };
+  auto TypeTooNarrow = [&](const TiledLoop &TL) {
+    return !isUIntN(TL.IV->getType()->getIntegerBitWidth() - 1, TileSize);
+  };
+  Tiled.erase(std::remove_if(Tiled.begin(), Tiled.end(),
+                             [&](const TiledLoop &TL) {
+                               return FitsInTile(TL) || TypeTooNarrow(TL);
+                             }),
+              Tiled.end());
+  if (Tiled.empty())
+    return false;
+
+  DEBUG(dbgs() << "LT: Tiling " << Tiled.size() << " loops of the nest at "
+               << Outer->getHeader()->getName() << " in " << F->getName()
+               << " by " << TileSize << "\n");
+  tileNest(Outer, Tiled, TileSize);
+  return true;
+}
+
+bool LoopTiling::runOnFunction(Function &Fn) {
+  if (skipFunction(Fn))
+    return false;
+
+  F = &Fn;
+  DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+  LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+  DI = &getAnalysis<DependenceAnalysisWrapperPass>().getDI();
+  TTI = &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(Fn);
+
+  bool Changed = false;
+  SmallVector<Loop *, 8> TopLevelLoops(LI->begin(), LI->end());
+  for (Loop *L : TopLevelLoops)
+    Changed |= visitLoop(L);
+  return Changed;
+}
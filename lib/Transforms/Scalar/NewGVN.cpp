@@ -0,0 +1,956 @@
+//===---- NewGVN.cpp - Global Value Numbering Pass --------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements a sparse, optimistic global value numbering pass.
+///
+/// Unlike the classic GVN pass, which assigns value numbers during a single
+/// walk of the dominator tree, this pass partitions the values of the function
+/// into congruence classes. Every instruction starts out in the TOP class
+/// ("not yet known"), and the instructions are evaluated symbolically in
+/// reverse post order: the expression of an instruction is built from the
+/// leaders of the classes of its operands, simplified, and looked up in a
+/// table of expressions to find the class the instruction belongs to. When
+/// the class of a value changes, only its users are re-evaluated, so the
+/// numbering is updated incrementally until it reaches a fixed point.
+///
+/// Because PHI nodes ignore operands that are still TOP or flow in along
+/// edges not (yet) known to be executable, values that are equal around a
+/// loop backedge end up in the same class after a single run of the pass.
+/// Loads and readonly calls are numbered through MemorySSA: their memory state
+/// is the leader of their clobbering access, and memory phis whose reachable
+/// incoming accesses are all equivalent are treated as that access.
+///
+/// Finally, the congruence classes are used to replace every use of a member
+/// by a dominating member of the same class, or by the class's constant.
+///
+/// The algorithm follows "A Sparse Algorithm for Predicated Global Value
+/// Numbering" by Karthik Gargi and "Value-Driven Redundancy Elimination" by
+/// Loren Taylor Simpson.
+///
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/NewGVN.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/ConstantFolding.h"
+#include "llvm/Analysis/GlobalsModRef.h"
+#include "llvm/Analysis/InstructionSimplify.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+using namespace llvm;
+
+#define DEBUG_TYPE "newgvn"
+
+STATISTIC(NumGVNInstrDeleted, "Number of instructions deleted");
+STATISTIC(NumGVNUsesReplaced, "Number of uses replaced by a congruent value");
+STATISTIC(NumGVNPhisAllSame, "Number of PHIs whose arguments are all the same");
+STATISTIC(NumGVNLoadsForwarded,
+          "Number of loads numbered as the value of a store");
+STATISTIC(NumGVNMaxIterations,
+          "Maximum number of iterations it took to converge GVN");
+STATISTIC(NumGVNGaveUp, "Number of functions GVN gave up on");
+
+static cl::opt<unsigned> MaxIterations(
+    "newgvn-max-iterations", cl::init(100), cl::Hidden,
+    cl::desc("The maximum number of times the touched instructions are "
+             "re-evaluated before NewGVN gives up on a function"));
+
+namespace {
+
+/// The symbolic value an instruction computes, in terms of the leaders of the
+/// congruence classes of its operands.
+struct Expression {
+  enum ExpressionKind { Constant, Variable, Basic, Phi, Load, Call };
+
+  ExpressionKind Kind;
+  /// The opcode of the instruction; comparisons also encode the predicate.
+  unsigned Opcode = 0;
+  Type *Ty = nullptr;
+  /// Whatever else distinguishes otherwise identical expressions: the block of
+  /// a PHI, the memory state of a load or call, or the source element type of
+  /// a GEP.
+  const void *Extra = nullptr;
+  SmallVector<Value *, 4> Operands;
+
+  explicit Expression(ExpressionKind Kind) : Kind(Kind) {}
+
+  bool operator==(const Expression &Other) const {
+    return Kind == Other.Kind && Opcode == Other.Opcode && Ty == Other.Ty &&
+           Extra == Other.Extra && Operands == Other.Operands;
+  }
+
+  hash_code getHashValue() const {
+    return hash_combine(Kind, Opcode, Ty, Extra,
+                        hash_combine_range(Operands.begin(), Operands.end()));
+  }
+
+  void print(raw_ostream &OS) const {
+    static const char *const Names[] = {"constant", "variable", "basic",
+                                        "phi",      "load",     "call"};
+    OS << "{" << Names[Kind] << " opcode = " << Opcode << " ops = [";
+    for (Value *Op : Operands) {
+      OS << " ";
+      Op->printAsOperand(OS, false);
+    }
+    OS << " ]}";
+  }
+};
+
+/// Hashes expressions by content, so that structurally identical expressions
+/// map to the same congruence class.
+struct ExpressionKeyInfo {
+  static const Expression *getEmptyKey() {
+    return DenseMapInfo<const Expression *>::getEmptyKey();
+  }
+  static const Expression *getTombstoneKey() {
+    return DenseMapInfo<const Expression *>::getTombstoneKey();
+  }
+  static unsigned getHashValue(const Expression *E) {
+    return E->getHashValue();
+  }
+  static bool isEqual(const Expression *LHS, const Expression *RHS) {
+    if (LHS == RHS)
+      return true;
+    if (LHS == getEmptyKey() || RHS == getEmptyKey() ||
+        LHS == getTombstoneKey() || RHS == getTombstoneKey())
+      return false;
+    return *LHS == *RHS;
+  }
+};
+
+/// A set of values that are known to compute the same value wherever they are
+/// all available.
+struct CongruenceClass {
+  unsigned ID;
+  /// The value that stands for the class in the expressions of its users.
+  Value *Leader;
+  /// The expression every member computes, if the class was created for one.
+  const Expression *Expr;
+  SmallPtrSet<Value *, 4> Members;
+
+  CongruenceClass(unsigned ID, Value *Leader, const Expression *Expr)
+      : ID(ID), Leader(Leader), Expr(Expr) {}
+};
+
+class NewGVN {
+  Function &F;
+  DominatorTree *DT;
+  AssumptionCache *AC;
+  const TargetLibraryInfo *TLI;
+  MemorySSA *MSSA;
+  MemorySSAWalker *MSSAWalker;
+  const DataLayout &DL;
+
+  SpecificBumpPtrAllocator<Expression> ExpressionAllocator;
+  /// Returned by the symbolic evaluation of a value that is not known yet.
+  const Expression *TopExpression;
+
+  std::vector<std::unique_ptr<CongruenceClass>> CongruenceClasses;
+  CongruenceClass *InitialClass;
+  DenseMap<Value *, CongruenceClass *> ValueToClass;
+  DenseMap<const Expression *, CongruenceClass *, ExpressionKeyInfo>
+      ExpressionToClass;
+
+  /// Memory phis known to be equivalent to another memory access, and memory
+  /// phis whose equivalence is not known yet.
+  DenseMap<const MemoryAccess *, MemoryAccess *> MemoryAccessEquiv;
+  SmallPtrSet<const MemoryAccess *, 8> TopMemoryPhis;
+  /// The loads and calls whose expression depends on a memory access.
+  DenseMap<const MemoryAccess *, SmallPtrSet<Instruction *, 2>> MemoryUsers;
+
+  SmallPtrSet<const BasicBlock *, 16> ReachableBlocks;
+  DenseSet<std::pair<const BasicBlock *, const BasicBlock *>> ReachableEdges;
+
+  /// Instructions and memory phis in reverse post order, and the range of
+  /// indices each block occupies.
+  std::vector<Value *> DFSToInstr;
+  DenseMap<const Value *, unsigned> InstrDFS;
+  DenseMap<const BasicBlock *, std::pair<unsigned, unsigned>> BlockInstrRange;
+  BitVector TouchedInstructions;
+
+public:
+  NewGVN(Function &F, DominatorTree *DT, AssumptionCache *AC,
+         const TargetLibraryInfo *TLI, MemorySSA *MSSA)
+      : F(F), DT(DT), AC(AC), TLI(TLI), MSSA(MSSA),
+        MSSAWalker(MSSA->getWalker()), DL(F.getParent()->getDataLayout()) {}
+
+  bool run();
+
+private:
+  // Expression construction.
+  Expression *newExpression(Expression::ExpressionKind Kind) {
+    return new (ExpressionAllocator.Allocate()) Expression(Kind);
+  }
+  const Expression *createConstantOrVariable(Value *V,
+                                             const Expression *Fallback);
+  const Expression *createBasicExpression(Instruction *I);
+  const Expression *createPHIExpression(PHINode *PN);
+  const Expression *createLoadExpression(LoadInst *LI);
+  const Expression *createCallExpression(CallInst *CI);
+  const Expression *performSymbolicEvaluation(Instruction *I);
+
+  // Congruence finding.
+  CongruenceClass *createClass(Value *Leader, const Expression *E) {
+    CongruenceClasses.emplace_back(
+        new CongruenceClass(CongruenceClasses.size(), Leader, E));
+    return CongruenceClasses.back().get();
+  }
+  bool isTop(Value *V) const {
+    return isa<Instruction>(V) && ValueToClass.lookup(V) == InitialClass;
+  }
+  Value *lookupOperandLeader(Value *V) const;
+  MemoryAccess *lookupMemoryLeader(MemoryAccess *MA) const;
+  void performCongruenceFinding(Instruction *I, const Expression *E);
+  void moveValueToNewClass(Instruction *I, CongruenceClass *OldClass,
+                           CongruenceClass *NewClass);
+  void processMemoryPhi(MemoryPhi *MP);
+  void processOutgoingEdges(TerminatorInst *TI);
+  void updateReachableEdge(BasicBlock *From, BasicBlock *To);
+
+  // Worklist handling.
+  void touch(const Value *V);
+  void touchUsers(Value *V);
+  void touchMemoryUsers(const MemoryAccess *MA);
+  void addMemoryUser(const MemoryAccess *MA, Instruction *I) {
+    MemoryUsers[MA].insert(I);
+  }
+
+  // Elimination.
+  bool eliminateInstructions();
+};
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// Expression construction
+//===----------------------------------------------------------------------===//
+
+/// Return the expression for an instruction known to be equal to \p V. If
+/// \p V has not been numbered yet, the instruction cannot join its class and
+/// \p Fallback is returned instead.
+const Expression *
+NewGVN::createConstantOrVariable(Value *V, const Expression *Fallback) {
+  if (isa<Constant>(V)) {
+    Expression *E = newExpression(Expression::Constant);
+    E->Ty = V->getType();
+    E->Operands.push_back(V);
+    return E;
+  }
+  if (isTop(V))
+    return Fallback;
+  Expression *E = newExpression(Expression::Variable);
+  E->Ty = V->getType();
+  E->Operands.push_back(V);
+  return E;
+}
+
+const Expression *NewGVN::createBasicExpression(Instruction *I) {
+  Expression *E = newExpression(Expression::Basic);
+  E->Opcode = I->getOpcode();
+  E->Ty = I->getType();
+  for (Value *Op : I->operands())
+    E->Operands.push_back(lookupOperandLeader(Op));
+
+  // Sort the operands of commutative operations, so that a + b and b + a
+  // land in the same class.
+  if (auto *CI = dyn_cast<CmpInst>(I)) {
+    CmpInst::Predicate Pred = CI->getPredicate();
+    if (E->Operands[0] > E->Operands[1]) {
+      std::swap(E->Operands[0], E->Operands[1]);
+      Pred = CI->getSwappedPredicate();
+    }
+    E->Opcode = (E->Opcode << 8) | Pred;
+    if (Value *V = SimplifyCmpInst(Pred, E->Operands[0], E->Operands[1], DL,
+                                   TLI, DT, AC))
+      return createConstantOrVariable(V, E);
+    return E;
+  }
+  if (I->isCommutative() && E->Operands[0] > E->Operands[1])
+    std::swap(E->Operands[0], E->Operands[1]);
+
+  Value *V = nullptr;
+  if (isa<BinaryOperator>(I)) {
+    V = SimplifyBinOp(E->Opcode, E->Operands[0], E->Operands[1], DL, TLI, DT,
+                      AC);
+  } else if (isa<SelectInst>(I)) {
+    V = SimplifySelectInst(E->Operands[0], E->Operands[1], E->Operands[2], DL,
+                           TLI, DT, AC);
+  } else if (auto *GEP = dyn_cast<GetElementPtrInst>(I)) {
+    E->Extra = GEP->getSourceElementType();
+    V = SimplifyGEPInst(GEP->getSourceElementType(), E->Operands, DL, TLI, DT,
+                        AC);
+  } else if (auto *CI = dyn_cast<CastInst>(I)) {
+    // Only take casts that fold away; constant expressions are left to the
+    // instruction.
+    if (auto *C = dyn_cast<Constant>(E->Operands[0])) {
+      V = ConstantFoldCastOperand(CI->getOpcode(), C, CI->getType(), DL);
+      if (V && isa<ConstantExpr>(V))
+        V = nullptr;
+    }
+  } else if (isa<ExtractElementInst>(I)) {
+    V = SimplifyExtractElementInst(E->Operands[0], E->Operands[1], DL, TLI, DT,
+                                   AC);
+  } else if (auto *EVI = dyn_cast<ExtractValueInst>(I)) {
+    V = SimplifyExtractValueInst(E->Operands[0], EVI->getIndices(), DL, TLI,
+                                 DT, AC);
+  } else if (auto *IVI = dyn_cast<InsertValueInst>(I)) {
+    V = SimplifyInsertValueInst(E->Operands[0], E->Operands[1],
+                                IVI->getIndices(), DL, TLI, DT, AC);
+  }
+
+  // The indices of aggregate operations are not operands; add them so that
+  // extracts of different fields stay apart.
+  if (auto *EVI = dyn_cast<ExtractValueInst>(I))
+    for (unsigned Idx : EVI->indices())
+      E->Operands.push_back(ConstantInt::get(Type::getInt32Ty(I->getContext()),
+                                             Idx));
+  else if (auto *IVI = dyn_cast<InsertValueInst>(I))
+    for (unsigned Idx : IVI->indices())
+      E->Operands.push_back(ConstantInt::get(Type::getInt32Ty(I->getContext()),
+                                             Idx));
+
+  if (V && V->getType() == I->getType())
+    return createConstantOrVariable(V, E);
+  return E;
+}
+
+/// Build the expression of a PHI node from the leaders of the operands that
+/// flow in along reachable edges. Operands that are still TOP are ignored, so
+/// that values which are equal around a backedge are found to be congruent.
+const Expression *NewGVN::createPHIExpression(PHINode *PN) {
+  BasicBlock *BB = PN->getParent();
+  SmallVector<std::pair<BasicBlock *, Value *>, 4> Incoming;
+  Value *AllSameValue = nullptr;
+  bool HasTop = false, HasUndef = false, AllSame = true;
+  for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i) {
+    BasicBlock *Pred = PN->getIncomingBlock(i);
+    if (!ReachableEdges.count({Pred, BB}))
+      continue;
+    Value *In = PN->getIncomingValue(i);
+    if (isTop(In)) {
+      HasTop = true;
+      Incoming.push_back({Pred, In});
+      continue;
+    }
+    Value *Leader = lookupOperandLeader(In);
+    Incoming.push_back({Pred, Leader});
+    if (isa<UndefValue>(Leader)) {
+      HasUndef = true;
+      continue;
+    }
+    if (Leader == PN)
+      continue;
+    if (!AllSameValue)
+      AllSameValue = Leader;
+    else if (AllSameValue != Leader)
+      AllSame = false;
+  }
+
+  if (!AllSameValue) {
+    if (HasTop)
+      return TopExpression;
+    return createConstantOrVariable(UndefValue::get(PN->getType()), nullptr);
+  }
+
+  Expression *E = newExpression(Expression::Phi);
+  E->Ty = PN->getType();
+  E->Extra = BB;
+  std::sort(Incoming.begin(), Incoming.end(),
+            [](const std::pair<BasicBlock *, Value *> &A,
+               const std::pair<BasicBlock *, Value *> &B) {
+              return A.first < B.first;
+            });
+  for (auto &In : Incoming)
+    E->Operands.push_back(In.second);
+
+  if (!AllSame)
+    return E;
+
+  // The PHI only merges a single value and possibly undef. Treat it as that
+  // value, unless the undef would have to stand in for a value that is not
+  // available on that edge.
+  if (HasUndef)
+    if (auto *AllSameInst = dyn_cast<Instruction>(AllSameValue))
+      if (!DT->dominates(AllSameInst, PN))
+        return E;
+  ++NumGVNPhisAllSame;
+  return createConstantOrVariable(AllSameValue, E);
+}
+
+const Expression *NewGVN::createLoadExpression(LoadInst *LI) {
+  // Ordered and volatile loads are left alone.
+  if (!LI->isSimple())
+    return nullptr;
+
+  Value *Ptr = lookupOperandLeader(LI->getPointerOperand());
+  MemoryAccess *Clobber = MSSAWalker->getClobberingMemoryAccess(LI);
+  addMemoryUser(Clobber, LI);
+
+  // A load that is clobbered by a store to the same address has the value of
+  // the store.
+  if (auto *MD = dyn_cast<MemoryDef>(Clobber))
+    if (auto *SI = dyn_cast_or_null<StoreInst>(MD->getMemoryInst()))
+      if (SI->isSimple() &&
+          lookupOperandLeader(SI->getPointerOperand()) == Ptr &&
+          SI->getValueOperand()->getType() == LI->getType() &&
+          !isTop(SI->getValueOperand())) {
+        ++NumGVNLoadsForwarded;
+        return createConstantOrVariable(
+            lookupOperandLeader(SI->getValueOperand()), nullptr);
+      }
+
+  Expression *E = newExpression(Expression::Load);
+  E->Ty = LI->getType();
+  E->Extra = lookupMemoryLeader(Clobber);
+  E->Operands.push_back(Ptr);
+  return E;
+}
+
+const Expression *NewGVN::createCallExpression(CallInst *CI) {
+  if (CI->isConvergent() || CI->hasOperandBundles() ||
+      isa<InlineAsm>(CI->getCalledValue()))
+    return nullptr;
+
+  Expression *E = newExpression(Expression::Call);
+  E->Ty = CI->getType();
+  if (CI->doesNotAccessMemory()) {
+    // Nothing to add; the call only depends on its operands.
+  } else if (CI->onlyReadsMemory()) {
+    MemoryAccess *Clobber = MSSAWalker->getClobberingMemoryAccess(CI);
+    addMemoryUser(Clobber, CI);
+    E->Extra = lookupMemoryLeader(Clobber);
+  } else {
+    return nullptr;
+  }
+  for (Value *Op : CI->operands())
+    E->Operands.push_back(lookupOperandLeader(Op));
+  return E;
+}
+
+/// Evaluate \p I symbolically. Returns null if \p I can only be congruent to
+/// itself.
+const Expression *NewGVN::performSymbolicEvaluation(Instruction *I) {
+  if (I->getType()->isTokenTy())
+    return nullptr;
+
+  switch (I->getOpcode()) {
+  case Instruction::PHI:
+    return createPHIExpression(cast<PHINode>(I));
+  case Instruction::Load:
+    return createLoadExpression(cast<LoadInst>(I));
+  case Instruction::Call:
+    return createCallExpression(cast<CallInst>(I));
+  case Instruction::ICmp:
+  case Instruction::FCmp:
+  case Instruction::Select:
+  case Instruction::GetElementPtr:
+  case Instruction::ExtractElement:
+  case Instruction::InsertElement:
+  case Instruction::ShuffleVector:
+  case Instruction::ExtractValue:
+  case Instruction::InsertValue:
+    return createBasicExpression(I);
+  default:
+    if (isa<BinaryOperator>(I) || isa<CastInst>(I))
+      return createBasicExpression(I);
+    return nullptr;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Congruence finding
+//===----------------------------------------------------------------------===//
+
+Value *NewGVN::lookupOperandLeader(Value *V) const {
+  CongruenceClass *CC = ValueToClass.lookup(V);
+  if (CC && CC != InitialClass)
+    return CC->Leader;
+  return V;
+}
+
+MemoryAccess *NewGVN::lookupMemoryLeader(MemoryAccess *MA) const {
+  auto It = MemoryAccessEquiv.find(MA);
+  return It == MemoryAccessEquiv.end() ? MA : It->second;
+}
+
+void NewGVN::touch(const Value *V) {
+  auto It = InstrDFS.find(V);
+  if (It != InstrDFS.end())
+    TouchedInstructions.set(It->second);
+}
+
+void NewGVN::touchUsers(Value *V) {
+  for (User *U : V->users()) {
+    touch(U);
+    // Loads may have been numbered as the value of this store.
+    if (isa<StoreInst>(U))
+      if (MemoryAccess *MA = MSSA->getMemoryAccess(U))
+        touchMemoryUsers(MA);
+  }
+}
+
+void NewGVN::touchMemoryUsers(const MemoryAccess *MA) {
+  for (const User *U : MA->users())
+    if (isa<MemoryPhi>(U))
+      touch(U);
+  auto It = MemoryUsers.find(MA);
+  if (It != MemoryUsers.end())
+    for (Instruction *I : It->second)
+      touch(I);
+}
+
+void NewGVN::performCongruenceFinding(Instruction *I, const Expression *E) {
+  CongruenceClass *IClass = ValueToClass.lookup(I);
+  CongruenceClass *EClass;
+
+  if (E == TopExpression) {
+    EClass = InitialClass;
+  } else if (!E) {
+    // The value is only congruent to itself.
+    if (IClass != InitialClass && IClass->Leader == I && !IClass->Expr &&
+        IClass->Members.size() == 1)
+      return;
+    EClass = createClass(I, nullptr);
+  } else if (E->Kind == Expression::Variable) {
+    Value *V = E->Operands[0];
+    EClass = ValueToClass.lookup(V);
+    if (!EClass) {
+      // Arguments get a class of their own the first time something is found
+      // to be equal to them.
+      EClass = createClass(V, nullptr);
+      EClass->Members.insert(V);
+      ValueToClass[V] = EClass;
+    }
+  } else {
+    auto Ins = ExpressionToClass.insert({E, nullptr});
+    if (Ins.second)
+      Ins.first->second = createClass(
+          E->Kind == Expression::Constant ? E->Operands[0] : I, E);
+    EClass = Ins.first->second;
+    // A class that lost all its members is revived with a new leader.
+    if (EClass->Members.empty() && E->Kind != Expression::Constant)
+      EClass->Leader = I;
+  }
+
+  if (EClass == IClass)
+    return;
+  DEBUG({
+    dbgs() << "NewGVN: moving " << *I << " to class " << EClass->ID;
+    if (E && E != TopExpression) {
+      dbgs() << " for ";
+      E->print(dbgs());
+    }
+    dbgs() << '\n';
+  });
+  moveValueToNewClass(I, IClass, EClass);
+}
+
+void NewGVN::moveValueToNewClass(Instruction *I, CongruenceClass *OldClass,
+                                 CongruenceClass *NewClass) {
+  if (OldClass != InitialClass) {
+    OldClass->Members.erase(I);
+    // The remaining members were congruent to a value that changed; some of
+    // them may have joined through I rather than through the class's
+    // expression, so they need to be re-evaluated. If I was the leader, the
+    // users of all members see a new leader.
+    for (Value *M : OldClass->Members)
+      touch(M);
+    if (OldClass->Leader == I && !OldClass->Members.empty()) {
+      OldClass->Leader = *OldClass->Members.begin();
+      for (Value *M : OldClass->Members)
+        touchUsers(M);
+    }
+  }
+  if (NewClass != InitialClass)
+    NewClass->Members.insert(I);
+  ValueToClass[I] = NewClass;
+  touchUsers(I);
+}
+
+/// A memory phi is equivalent to an access if all the accesses that flow in
+/// along reachable edges are; accesses not known yet are ignored.
+void NewGVN::processMemoryPhi(MemoryPhi *MP) {
+  MemoryAccess *AllSameValue = nullptr;
+  bool AllSame = true;
+  for (unsigned i = 0, e = MP->getNumIncomingValues(); i != e; ++i) {
+    if (!ReachableEdges.count({MP->getIncomingBlock(i), MP->getBlock()}))
+      continue;
+    MemoryAccess *In = MP->getIncomingValue(i);
+    if (TopMemoryPhis.count(In))
+      continue;
+    MemoryAccess *Leader = lookupMemoryLeader(In);
+    if (Leader == MP)
+      continue;
+    if (!AllSameValue)
+      AllSameValue = Leader;
+    else if (AllSameValue != Leader)
+      AllSame = false;
+  }
+  if (!AllSameValue)
+    return;
+
+  MemoryAccess *NewLeader = AllSame ? AllSameValue : MP;
+  if (!TopMemoryPhis.erase(MP) && lookupMemoryLeader(MP) == NewLeader)
+    return;
+  if (NewLeader == MP)
+    MemoryAccessEquiv.erase(MP);
+  else
+    MemoryAccessEquiv[MP] = NewLeader;
+  touchMemoryUsers(MP);
+}
+
+void NewGVN::updateReachableEdge(BasicBlock *From, BasicBlock *To) {
+  if (!ReachableEdges.insert({From, To}).second)
+    return;
+  if (ReachableBlocks.insert(To).second) {
+    auto Range = BlockInstrRange.lookup(To);
+    TouchedInstructions.set(Range.first, Range.second);
+    return;
+  }
+  // The block was reachable already; only its PHIs see a new operand.
+  if (MemoryPhi *MP = MSSA->getMemoryAccess(To))
+    touch(MP);
+  for (Instruction &I : *To) {
+    if (!isa<PHINode>(I))
+      break;
+    touch(&I);
+  }
+}
+
+/// Mark the successors of \p TI reachable, skipping the ones that a constant
+/// condition rules out.
+void NewGVN::processOutgoingEdges(TerminatorInst *TI) {
+  BasicBlock *BB = TI->getParent();
+  if (auto *BR = dyn_cast<BranchInst>(TI)) {
+    if (BR->isConditional())
+      if (auto *CI = dyn_cast<ConstantInt>(
+              lookupOperandLeader(BR->getCondition()))) {
+        updateReachableEdge(BB, BR->getSuccessor(CI->isZero() ? 1 : 0));
+        return;
+      }
+  } else if (auto *SI = dyn_cast<SwitchInst>(TI)) {
+    if (auto *CI =
+            dyn_cast<ConstantInt>(lookupOperandLeader(SI->getCondition()))) {
+      updateReachableEdge(BB, SI->findCaseValue(CI).getCaseSuccessor());
+      return;
+    }
+  }
+  for (BasicBlock *Succ : TI->successors())
+    updateReachableEdge(BB, Succ);
+}
+
+//===----------------------------------------------------------------------===//
+// Elimination
+//===----------------------------------------------------------------------===//
+
+static void patchReplacementInstruction(Instruction *I, Value *Repl) {
+  auto *ReplInst = dyn_cast<Instruction>(Repl);
+  if (!ReplInst)
+    return;
+
+  // Patch the replacement so that it is not more restrictive than the value
+  // being replaced.
+  ReplInst->andIRFlags(I);
+  static const unsigned KnownIDs[] = {
+      LLVMContext::MD_tbaa,           LLVMContext::MD_alias_scope,
+      LLVMContext::MD_noalias,        LLVMContext::MD_range,
+      LLVMContext::MD_fpmath,         LLVMContext::MD_invariant_load,
+      LLVMContext::MD_invariant_group};
+  combineMetadata(ReplInst, I, KnownIDs);
+}
+
+namespace {
+/// A definition or use of a member of a congruence class, positioned by the
+/// dominator tree DFS numbers of its block and its place within the block.
+struct ValueDFS {
+  unsigned DFSIn;
+  unsigned DFSOut;
+  unsigned LocalNum;
+  Value *Def;
+  Use *U;
+
+  bool operator<(const ValueDFS &Other) const {
+    return std::tie(DFSIn, LocalNum, U) <
+           std::tie(Other.DFSIn, Other.LocalNum, Other.U);
+  }
+};
+} // end anonymous namespace
+
+/// Replace every use of a congruence class member by the closest member that
+/// dominates it, and constant classes by their constant.
+bool NewGVN::eliminateInstructions() {
+  bool Changed = false;
+  SmallVector<Instruction *, 16> ToErase;
+  SmallPtrSet<Instruction *, 16> Patched;
+  DT->updateDFSNumbers();
+
+  auto MaybeErase = [&](Instruction *I) {
+    if (I->use_empty() && isInstructionTriviallyDead(I, TLI))
+      ToErase.push_back(I);
+  };
+
+  for (auto &CC : CongruenceClasses) {
+    if (CC.get() == InitialClass || CC->Members.empty())
+      continue;
+
+    if (isa<Constant>(CC->Leader)) {
+      for (Value *M : CC->Members) {
+        auto *I = cast<Instruction>(M);
+        if (!I->use_empty()) {
+          DEBUG(dbgs() << "NewGVN: replacing " << *I << " with "
+                       << *CC->Leader << '\n');
+          NumGVNUsesReplaced += I->getNumUses();
+          I->replaceAllUsesWith(CC->Leader);
+          Changed = true;
+        }
+        MaybeErase(I);
+      }
+      continue;
+    }
+
+    if (CC->Members.size() == 1)
+      continue;
+
+    SmallVector<ValueDFS, 16> DFSOrdered;
+    for (Value *M : CC->Members) {
+      if (auto *I = dyn_cast<Instruction>(M)) {
+        DomTreeNode *Node = DT->getNode(I->getParent());
+        DFSOrdered.push_back({Node->getDFSNumIn(), Node->getDFSNumOut(),
+                              InstrDFS.lookup(I) + 1, M, nullptr});
+      } else {
+        DomTreeNode *Node = DT->getRootNode();
+        DFSOrdered.push_back(
+            {Node->getDFSNumIn(), Node->getDFSNumOut(), 0, M, nullptr});
+      }
+
+      for (Use &U : M->uses()) {
+        auto *UI = dyn_cast<Instruction>(U.getUser());
+        if (!UI)
+          continue;
+        BasicBlock *UseBB;
+        unsigned LocalNum;
+        if (auto *PN = dyn_cast<PHINode>(UI)) {
+          // A PHI operand is used at the end of the incoming block.
+          UseBB = PN->getIncomingBlock(U);
+          auto It = BlockInstrRange.find(UseBB);
+          if (It == BlockInstrRange.end())
+            continue;
+          LocalNum = It->second.second + 1;
+        } else {
+          UseBB = UI->getParent();
+          auto It = InstrDFS.find(UI);
+          if (It == InstrDFS.end())
+            continue;
+          LocalNum = It->second + 1;
+        }
+        if (!ReachableBlocks.count(UseBB))
+          continue;
+        DomTreeNode *Node = DT->getNode(UseBB);
+        DFSOrdered.push_back({Node->getDFSNumIn(), Node->getDFSNumOut(),
+                              LocalNum, nullptr, &U});
+      }
+    }
+    std::sort(DFSOrdered.begin(), DFSOrdered.end());
+
+    // Walk the definitions and uses in dominator tree order, keeping a stack
+    // of the members that dominate the current position.
+    SmallVector<const ValueDFS *, 8> Stack;
+    for (const ValueDFS &VD : DFSOrdered) {
+      while (!Stack.empty() && !(Stack.back()->DFSIn <= VD.DFSIn &&
+                                 VD.DFSOut <= Stack.back()->DFSOut))
+        Stack.pop_back();
+
+      if (VD.Def) {
+        // Members dominated by another member are replaced, not pushed.
+        if (Stack.empty())
+          Stack.push_back(&VD);
+        continue;
+      }
+      if (Stack.empty())
+        continue;
+
+      Value *Repl = Stack.back()->Def;
+      Value *Old = VD.U->get();
+      if (Old == Repl)
+        continue;
+      auto *OldInst = cast<Instruction>(Old);
+      if (Patched.insert(OldInst).second)
+        patchReplacementInstruction(OldInst, Repl);
+      DEBUG(dbgs() << "NewGVN: replacing use of " << *OldInst << " with "
+                   << *Repl << '\n');
+      VD.U->set(Repl);
+      ++NumGVNUsesReplaced;
+      Changed = true;
+      if (OldInst->use_empty())
+        MaybeErase(OldInst);
+    }
+  }
+
+  for (Instruction *I : ToErase) {
+    if (MemoryAccess *MA = MSSA->getMemoryAccess(I))
+      MSSA->removeMemoryAccess(MA);
+    I->dropAllReferences();
+  }
+  for (Instruction *I : ToErase) {
+    I->eraseFromParent();
+    ++NumGVNInstrDeleted;
+    Changed = true;
+  }
+  return Changed;
+}
+
+//===----------------------------------------------------------------------===//
+// Driver
+//===----------------------------------------------------------------------===//
+
+bool NewGVN::run() {
+  TopExpression = newExpression(Expression::Constant);
+  InitialClass = createClass(nullptr, nullptr);
+
+  // Number the instructions and memory phis in reverse post order; blocks not
+  // reachable from the entry are never visited.
+  ReversePostOrderTraversal<Function *> RPOT(&F);
+  for (BasicBlock *BB : RPOT) {
+    unsigned Start = DFSToInstr.size();
+    if (MemoryPhi *MP = MSSA->getMemoryAccess(BB)) {
+      InstrDFS[MP] = DFSToInstr.size();
+      DFSToInstr.push_back(MP);
+      TopMemoryPhis.insert(MP);
+    }
+    for (Instruction &I : *BB) {
+      InstrDFS[&I] = DFSToInstr.size();
+      DFSToInstr.push_back(&I);
+      if (!I.getType()->isVoidTy())
+        ValueToClass[&I] = InitialClass;
+    }
+    BlockInstrRange[BB] = {Start, DFSToInstr.size()};
+  }
+  TouchedInstructions.resize(DFSToInstr.size());
+
+  BasicBlock *Entry = &F.getEntryBlock();
+  ReachableBlocks.insert(Entry);
+  auto EntryRange = BlockInstrRange.lookup(Entry);
+  TouchedInstructions.set(EntryRange.first, EntryRange.second);
+
+  unsigned Iterations = 0;
+  while (TouchedInstructions.any()) {
+    if (++Iterations > MaxIterations) {
+      DEBUG(dbgs() << "NewGVN: giving up on " << F.getName() << " after "
+                   << MaxIterations << " iterations\n");
+      ++NumGVNGaveUp;
+      return false;
+    }
+    for (int Idx = TouchedInstructions.find_first(); Idx != -1;
+         Idx = TouchedInstructions.find_next(Idx)) {
+      TouchedInstructions.reset(Idx);
+      Value *V = DFSToInstr[Idx];
+      if (auto *MP = dyn_cast<MemoryPhi>(V)) {
+        if (ReachableBlocks.count(MP->getBlock()))
+          processMemoryPhi(MP);
+        continue;
+      }
+      auto *I = cast<Instruction>(V);
+      if (!ReachableBlocks.count(I->getParent()))
+        continue;
+      if (!I->getType()->isVoidTy())
+        performCongruenceFinding(I, isa<TerminatorInst>(I)
+                                        ? nullptr
+                                        : performSymbolicEvaluation(I));
+      if (auto *TI = dyn_cast<TerminatorInst>(I))
+        processOutgoingEdges(TI);
+    }
+  }
+  if (Iterations > NumGVNMaxIterations)
+    NumGVNMaxIterations = Iterations;
+
+  return eliminateInstructions();
+}
+
+PreservedAnalyses NewGVNPass::run(Function &F, AnalysisManager<Function> &AM) {
+  auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
+  auto &AC = AM.getResult<AssumptionAnalysis>(F);
+  auto &TLI = AM.getResult<TargetLibraryAnalysis>(F);
+  auto &MSSA = AM.getResult<MemorySSAAnalysis>(F);
+  if (!NewGVN(F, &DT, &AC, &TLI, &MSSA).run())
+    return PreservedAnalyses::all();
+
+  PreservedAnalyses PA;
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<GlobalsAA>();
+  return PA;
+}
+
+namespace {
+class NewGVNLegacyPass : public FunctionPass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+
+  NewGVNLegacyPass() : FunctionPass(ID) {
+    initializeNewGVNLegacyPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override {
+    if (skipFunction(F))
+      return false;
+
+    return NewGVN(F, &getAnalysis<DominatorTreeWrapperPass>().getDomTree(),
+                  &getAnalysis<AssumptionCacheTracker>().getAssumptionCache(F),
+                  &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(),
+                  &getAnalysis<MemorySSAWrapperPass>().getMSSA())
+        .run();
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<AssumptionCacheTracker>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addRequired<TargetLibraryInfoWrapperPass>();
+    AU.addRequired<MemorySSAWrapperPass>();
+    AU.addRequired<AAResultsWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addPreserved<GlobalsAAWrapperPass>();
+  }
+};
+} // end anonymous namespace
+
+char NewGVNLegacyPass::ID = 0;
+
+FunctionPass *llvm::createNewGVNPass() { return new NewGVNLegacyPass(); }
+
+INITIALIZE_PASS_BEGIN(NewGVNLegacyPass, "newgvn", "Global Value Numbering",
+                      false, false)
+INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
+INITIALIZE_PASS_END(NewGVNLegacyPass, "newgvn", "Global Value Numbering",
+                    false, false)
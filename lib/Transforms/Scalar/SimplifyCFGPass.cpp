@@ -50,6 +50,7 @@ UserBonusInstThreshold("bonus-inst-threshold", cl::Hidden, cl::init(1),
    cl::desc("Control the number of bonus instructions (default = 1)"));
 
 STATISTIC(NumSimpl, "Number of blocks simplified");
+STATISTIC(NumOperandsReleased, "Number of reserved operand slots released");
 
 /// If we have more than one empty (other than phi node) return blocks,
 /// merge them together to promote recursive block merging.
@@ -169,14 +170,16 @@ static bool simplifyFunctionCFG(Function &F, const TargetTransformInfo &TTI,
   // iterate between the two optimizations.  We structure the code like this to
   // avoid rerunning iterativelySimplifyCFG if the second pass of
   // removeUnreachableBlocks doesn't do anything.
-  if (!removeUnreachableBlocks(F))
-    return true;
-
-  do {
-    EverChanged = iterativelySimplifyCFG(F, TTI, AC, BonusInstThreshold);
-    EverChanged |= removeUnreachableBlocks(F);
-  } while (EverChanged);
+  if (removeUnreachableBlocks(F)) {
+    do {
+      EverChanged = iterativelySimplifyCFG(F, TTI, AC, BonusInstThreshold);
+      EverChanged |= removeUnreachableBlocks(F);
+    } while (EverChanged);
+  }
 
+  // Removing predecessors and cases leaves PHI nodes and switches with operand
+  // space they are unlikely to grow back into; give it back.
+  NumOperandsReleased += shrinkHungoffOperandLists(F);
   return true;
 }
 
@@ -19,6 +19,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/CaptureTracking.h"
 #include "llvm/Analysis/EHPersonalities.h"
@@ -1339,6 +1340,37 @@ static void fixupLineNumbers(Function *Fn, Function::iterator FI,
   }
 }
 
+/// Give the blocks cloned from the callee a frequency in the caller, so that
+/// the caller's block frequencies stay usable without being recomputed.
+static void updateCallerBFI(BasicBlock *CallSiteBlock,
+                            const ValueToValueMapTy &VMap,
+                            BlockFrequencyInfo *CallerBFI,
+                            BlockFrequencyInfo *CalleeBFI) {
+  uint64_t CallSiteFreq =
+      CallerBFI->getBlockFreq(CallSiteBlock).getFrequency();
+  uint64_t CalleeEntryFreq = CalleeBFI ? CalleeBFI->getEntryFreq() : 0;
+  SmallPtrSet<BasicBlock *, 16> ClonedBBs;
+  for (auto const &Entry : VMap) {
+    if (!isa<BasicBlock>(Entry.first) || !Entry.second)
+      continue;
+    auto *OrigBB = cast<BasicBlock>(Entry.first);
+    auto *ClonedBB = cast<BasicBlock>(Entry.second);
+    uint64_t Freq = CallSiteFreq;
+    if (CalleeEntryFreq) {
+      APInt Scaled(128, CalleeBFI->getBlockFreq(OrigBB).getFrequency());
+      Scaled *= APInt(128, CallSiteFreq);
+      Freq = std::max<uint64_t>(
+          1, Scaled.udiv(APInt(128, CalleeEntryFreq)).getLimitedValue());
+    }
+    // Pruning while cloning can map several callee blocks to one clone. Use
+    // the largest of their frequencies.
+    if (!ClonedBBs.insert(ClonedBB).second)
+      Freq = std::max(Freq,
+                      CallerBFI->getBlockFreq(ClonedBB).getFrequency());
+    CallerBFI->setBlockFreq(ClonedBB, Freq);
+  }
+}
+
 /// This function inlines the called function into the basic block of the
 /// caller. This returns false if it is not possible to inline this call.
 /// The program is still in a well defined state if this occurs though.
@@ -1527,6 +1559,9 @@ bool llvm::InlineFunction(CallSite CS, InlineFunctionInfo &IFI,
     // Remember the first block that is newly cloned over.
     FirstNewBlock = LastBlock; ++FirstNewBlock;
 
+    if (IFI.CallerBFI)
+      updateCallerBFI(OrigBB, VMap, IFI.CallerBFI, IFI.CalleeBFI);
+
     // Inject byval arguments initialization.
     for (std::pair<Value*, Value*> &Init : ByValInit)
       HandleByValArgumentInit(Init.first, Init.second, Caller->getParent(),
@@ -2007,6 +2042,11 @@ bool llvm::InlineFunction(CallSite CS, InlineFunctionInfo &IFI,
                                           CalledFunc->getName() + ".exit");
   }
 
+  // The rest of the call site's block runs as often as it did before.
+  if (IFI.CallerBFI)
+    IFI.CallerBFI->setBlockFreq(
+        AfterCallBB, IFI.CallerBFI->getBlockFreq(OrigBB).getFrequency());
+
   // Change the branch that used to go to AfterCallBB to branch to the first
   // basic block of the inlined function.
   //
@@ -1581,6 +1581,24 @@ bool llvm::removeUnreachableBlocks(Function &F, LazyValueInfo *LVI) {
   return true;
 }
 
+unsigned llvm::shrinkHungoffOperandLists(Function &F) {
+  unsigned NumReleased = 0;
+  for (BasicBlock &BB : F) {
+    for (Instruction &I : BB) {
+      auto *PN = dyn_cast<PHINode>(&I);
+      if (!PN)
+        break;
+      NumReleased += PN->getNumReservedOperands() - PN->getNumOperands();
+      PN->shrinkToFit();
+    }
+    if (auto *SI = dyn_cast<SwitchInst>(BB.getTerminator())) {
+      NumReleased += SI->getNumReservedOperands() - SI->getNumOperands();
+      SI->shrinkToFit();
+    }
+  }
+  return NumReleased;
+}
+
 void llvm::combineMetadata(Instruction *K, const Instruction *J,
                            ArrayRef<unsigned> KnownIDs) {
   SmallVector<std::pair<unsigned, MDNode *>, 4> Metadata;
@@ -73,12 +73,23 @@ static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
   }
 }
 
+// Returns the weight of GV for balancing partitions by size.
+static unsigned getSizeWeight(const GlobalValue *GV) {
+  const Function *F = dyn_cast<Function>(GV);
+  if (!F)
+    return 1;
+  unsigned NumInsts = 0;
+  for (const BasicBlock &BB : *F)
+    NumInsts += BB.size();
+  return std::max(NumInsts, 1u);
+}
+
 // Find partitions for module in the way that no locals need to be
 // globalized.
 // Try to balance pack those partitions into N files since this roughly equals
 // thread balancing for the backend codegen step.
 static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
-                           unsigned N) {
+                           unsigned N, bool BalanceBySize) {
   // At this point module should have the proper mix of globals and locals.
   // As we attempt to partition this module, we must not change any
   // locals to globals.
@@ -86,13 +97,19 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   ClusterMapType GVtoClusterMap;
   ComdatMembersType ComdatMembers;
 
-  auto recordGVSet = [&GVtoClusterMap, &ComdatMembers](GlobalValue &GV) {
+  auto recordGVSet = [&GVtoClusterMap, &ComdatMembers,
+                      BalanceBySize](GlobalValue &GV) {
     if (GV.isDeclaration())
       return;
 
     if (!GV.hasName())
       GV.setName("__llvmsplit_unnamed");
 
+    // When balancing by size every definition gets a cluster, so that none
+    // of them is left to the MD5-based partitioning.
+    if (BalanceBySize)
+      GVtoClusterMap.insert(&GV);
+
     // Comdat groups must not be partitioned. For comdat groups that contain
     // locals, record all their members here so we can keep them together.
     // Comdat groups that only contain external globals are already handled by
@@ -154,11 +171,16 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   // To guarantee determinism, we have to sort SCC according to size.
   // When size is the same, use leader's name.
   for (ClusterMapType::iterator I = GVtoClusterMap.begin(),
-                                E = GVtoClusterMap.end(); I != E; ++I)
-    if (I->isLeader())
-      Sets.push_back(
-          std::make_pair(std::distance(GVtoClusterMap.member_begin(I),
-                                       GVtoClusterMap.member_end()), I));
+                                E = GVtoClusterMap.end(); I != E; ++I) {
+    if (!I->isLeader())
+      continue;
+    unsigned Size = 0;
+    for (ClusterMapType::member_iterator MI = GVtoClusterMap.member_begin(I),
+                                         ME = GVtoClusterMap.member_end();
+         MI != ME; ++MI)
+      Size += BalanceBySize ? getSizeWeight(*MI) : 1;
+    Sets.push_back(std::make_pair(Size, I));
+  }
 
   std::sort(Sets.begin(), Sets.end(), [](const SortType &a, const SortType &b) {
     if (a.first == b.first)
@@ -184,7 +206,7 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
                    << ((*MI)->hasLocalLinkage() ? " l " : " e ") << "\n");
       Visited.insert(*MI);
       ClusterIDMap[*MI] = CurrentClusterID;
-      CurrentClusterSize++;
+      CurrentClusterSize += BalanceBySize ? getSizeWeight(*MI) : 1;
     }
     // Add this set size to the number of entries in this cluster.
     BalancinQueue.push(std::make_pair(CurrentClusterID, CurrentClusterSize));
@@ -228,7 +250,7 @@ static bool isInPartition(const GlobalValue *GV, unsigned I, unsigned N) {
 void llvm::SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals) {
+    bool PreserveLocals, bool BalanceBySize) {
   if (!PreserveLocals) {
     for (Function &F : *M)
       externalize(&F);
@@ -243,7 +265,7 @@ void llvm::SplitModule(
   // This performs splitting without a need for externalization, which might not
   // always be possible.
   ClusterIDMapType ClusterIDMap;
-  findPartitions(M.get(), ClusterIDMap, N);
+  findPartitions(M.get(), ClusterIDMap, N, BalanceBySize);
 
   // FIXME: We should be able to reuse M as the last partition instead of
   // cloning it.
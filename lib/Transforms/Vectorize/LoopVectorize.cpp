@@ -57,6 +57,7 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/CodeMetrics.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
 #include "llvm/Analysis/GlobalsModRef.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/LoopIterator.h"
@@ -105,6 +106,12 @@ using namespace llvm::PatternMatch;
 
 STATISTIC(LoopsVectorized, "Number of loops vectorized");
 STATISTIC(LoopsAnalyzed, "Number of loops analyzed for vectorization");
+STATISTIC(OuterLoopsVectorized, "Number of outer loops vectorized");
+STATISTIC(EpilogueLoopsVectorized, "Number of remainder loops vectorized");
+STATISTIC(RemainderIterations,
+          "Sum of the maximum remainder iterations of vectorized loops");
+STATISTIC(RemainderIterationsVectorized,
+          "Sum of the maximum remainder iterations run by vector epilogues");
 
 static cl::opt<bool>
     EnableIfConversion("enable-if-conversion", cl::init(true), cl::Hidden,
@@ -117,6 +124,16 @@ static cl::opt<unsigned> TinyTripCountVectorThreshold(
              "trip count that is smaller than this "
              "value."));
 
+static cl::opt<bool> EnableEpilogueVectorization(
+    "enable-epilogue-vectorization", cl::init(false), cl::Hidden,
+    cl::desc("Vectorize the remainder loop of a vectorized loop with a "
+             "narrower vectorization factor."));
+
+static cl::opt<bool> EnableOuterLoopVectorization(
+    "enable-outer-loop-vectorization", cl::init(false), cl::Hidden,
+    cl::desc("Vectorize loop nests along the outer loop when the inner loop "
+             "does not depend on the outer induction variable."));
+
 static cl::opt<bool> MaximizeBandwidth(
     "vectorizer-maximize-bandwidth", cl::init(false), cl::Hidden,
     cl::desc("Maximize bandwidth when selecting vectorization factor which "
@@ -1599,8 +1616,10 @@ public:
   /// \return The most profitable vectorization factor and the cost of that VF.
   /// This method checks every power of two up to VF. If UserVF is not ZERO
   /// then this vectorization factor will be selected if vectorization is
-  /// possible.
-  VectorizationFactor selectVectorizationFactor(bool OptForSize);
+  /// possible. If \p MaxVF is not zero, the factors are limited to \p MaxVF
+  /// and the hints are ignored, which is used for remainder loops.
+  VectorizationFactor selectVectorizationFactor(bool OptForSize,
+                                                unsigned MaxVF = 0);
 
   /// \return The size (in bits) of the smallest and widest types in the code
   /// that needs to be vectorized. We ignore values that remain scalar such as
@@ -1773,6 +1792,14 @@ static void addInnerLoop(Loop &L, SmallVectorImpl<Loop *> &V) {
     addInnerLoop(*InnerL, V);
 }
 
+static void addOuterLoop(Loop &L, SmallVectorImpl<Loop *> &V) {
+  if (L.getSubLoops().size() == 1 && L.getSubLoops().front()->empty())
+    return V.push_back(&L);
+
+  for (Loop *InnerL : L)
+    addOuterLoop(*InnerL, V);
+}
+
 /// The LoopVectorize Pass.
 struct LoopVectorize : public FunctionPass {
   /// Pass identification, replacement for typeid
@@ -5170,7 +5197,8 @@ void InterleavedAccessInfo::analyzeInterleaving(
 }
 
 LoopVectorizationCostModel::VectorizationFactor
-LoopVectorizationCostModel::selectVectorizationFactor(bool OptForSize) {
+LoopVectorizationCostModel::selectVectorizationFactor(bool OptForSize,
+                                                      unsigned MaxVF) {
   // Width 1 means no vectorize
   VectorizationFactor Factor = {1U, 0U};
   if (OptForSize && Legal->getRuntimePointerChecking()->Need) {
@@ -5280,7 +5308,10 @@ LoopVectorizationCostModel::selectVectorizationFactor(bool OptForSize) {
     }
   }
 
-  int UserVF = Hints->getWidth();
+  if (MaxVF)
+    VF = std::min(VF, MaxVF);
+
+  int UserVF = MaxVF ? 0 : Hints->getWidth();
   if (UserVF != 0) {
     assert(isPowerOf2_32(UserVF) && "VF needs to be a power of two");
     DEBUG(dbgs() << "LV: Using user VF " << UserVF << ".\n");
@@ -5296,7 +5327,8 @@ LoopVectorizationCostModel::selectVectorizationFactor(bool OptForSize) {
   unsigned Width = 1;
   DEBUG(dbgs() << "LV: Scalar loop costs: " << (int)ScalarCost << ".\n");
 
-  bool ForceVectorization = Hints->getForce() == LoopVectorizeHints::FK_Enabled;
+  bool ForceVectorization =
+      !MaxVF && Hints->getForce() == LoopVectorizeHints::FK_Enabled;
   // Ignore scalar width, because the user explicitly wants vectorization.
   if (ForceVectorization && VF > 1) {
     Width = 2;
@@ -6388,6 +6420,538 @@ static void AddRuntimeUnrollDisableMetaData(Loop *L) {
   }
 }
 
+namespace {
+/// Vectorizes an outer loop whose only sub-loop is an innermost loop made of
+/// a single block, the way a stencil or a small matrix kernel is written. The
+/// outer induction variable is widened so that each vector lane runs one
+/// outer iteration, while the inner loop stays a uniform loop whose body
+/// operates on vectors: its control flow must not depend on the outer
+/// induction variable. Memory accesses that vary across the lanes must be
+/// consecutive in the outer induction variable, and DependenceAnalysis must
+/// show that no dependence is carried by the outer loop. The original nest
+/// runs the remaining iterations.
+class OuterLoopVectorizer {
+public:
+  OuterLoopVectorizer(Loop *OuterLoop, ScalarEvolution *SE, LoopInfo *LI,
+                      DominatorTree *DT, AliasAnalysis *AA,
+                      const TargetTransformInfo *TTI)
+      : OuterLoop(OuterLoop), InnerLoop(nullptr), SE(SE), LI(LI), DT(DT),
+        AA(AA), TTI(TTI), IV(nullptr), Step(nullptr), VF(0),
+        Builder(OuterLoop->getHeader()->getContext()),
+        DL(OuterLoop->getHeader()->getModule()->getDataLayout()) {}
+
+  /// Return true if the nest can be vectorized, and select the width.
+  bool canVectorize();
+
+  /// Create the vector nest, and make the original nest run the remaining
+  /// iterations.
+  void vectorize();
+
+  unsigned getWidth() const { return VF; }
+
+private:
+  /// Return true if the value of \p V differs between the lanes.
+  bool isVarying(const Value *V) const { return Varying.count(V); }
+
+  /// Return true if \p Ptr advances by one element of \p Ty per iteration of
+  /// the outer loop.
+  bool isConsecutivePtr(Value *Ptr, Type *Ty) const;
+
+  bool canVectorizeInstruction(Instruction &I);
+  bool canVectorizeMemory();
+
+  /// Return the value of \p V in the first lane.
+  Value *getScalarValue(Value *V);
+  /// Return the value of \p V in all lanes.
+  Value *getVectorValue(Value *V);
+
+  void widenInstruction(Instruction &I);
+
+  Loop *OuterLoop;
+  Loop *InnerLoop;
+  ScalarEvolution *SE;
+  LoopInfo *LI;
+  DominatorTree *DT;
+  AliasAnalysis *AA;
+  const TargetTransformInfo *TTI;
+
+  /// The induction variable of the outer loop and its step.
+  PHINode *IV;
+  ConstantInt *Step;
+  unsigned VF;
+
+  SmallPtrSet<const Value *, 32> Varying;
+  DenseMap<Value *, Value *> ScalarMap;
+  DenseMap<Value *, Value *> VectorMap;
+  DenseMap<BasicBlock *, BasicBlock *> BlockMap;
+  IRBuilder<> Builder;
+  const DataLayout &DL;
+};
+} // end anonymous namespace
+
+bool OuterLoopVectorizer::isConsecutivePtr(Value *Ptr, Type *Ty) const {
+  if (!VectorType::isValidElementType(Ty) ||
+      DL.getTypeSizeInBits(Ty) != DL.getTypeAllocSizeInBits(Ty))
+    return false;
+  // Look through the recurrences of the inner loop for the one of the outer
+  // loop.
+  const SCEV *S = SE->getSCEV(Ptr);
+  while (auto *AR = dyn_cast<SCEVAddRecExpr>(S)) {
+    if (AR->getLoop() == OuterLoop) {
+      auto *C = dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+      return C && C->getAPInt() == DL.getTypeAllocSize(Ty);
+    }
+    if (!OuterLoop->contains(AR->getLoop()) ||
+        !SE->isLoopInvariant(AR->getStepRecurrence(*SE), OuterLoop))
+      return false;
+    S = AR->getStart();
+  }
+  return false;
+}
+
+bool OuterLoopVectorizer::canVectorizeInstruction(Instruction &I) {
+  for (User *U : I.users())
+    if (!OuterLoop->contains(cast<Instruction>(U)))
+      return false;
+
+  if (auto *Br = dyn_cast<BranchInst>(&I))
+    return Br->isUnconditional() || I.getParent() == OuterLoop->getLoopLatch() ||
+           !isVarying(Br->getCondition());
+  if (isa<TerminatorInst>(I))
+    return false;
+
+  if (auto *Phi = dyn_cast<PHINode>(&I)) {
+    BasicBlock *BB = Phi->getParent();
+    if (BB == OuterLoop->getHeader())
+      return Phi == IV;
+    if (BB != InnerLoop->getHeader() && Phi->getNumIncomingValues() != 1)
+      return false;
+    return !isVarying(Phi) || (VectorType::isValidElementType(Phi->getType()) &&
+                               !Phi->getType()->isPointerTy());
+  }
+
+  if (auto *Load = dyn_cast<LoadInst>(&I))
+    return Load->isSimple() &&
+           (!isVarying(Load) ||
+            isConsecutivePtr(Load->getPointerOperand(), Load->getType()));
+  if (auto *Store = dyn_cast<StoreInst>(&I))
+    return Store->isSimple() && isVarying(Store->getPointerOperand()) &&
+           isConsecutivePtr(Store->getPointerOperand(),
+                            Store->getValueOperand()->getType());
+
+  if (!isa<BinaryOperator>(I) && !isa<CmpInst>(I) && !isa<CastInst>(I) &&
+      !isa<SelectInst>(I) && !isa<GetElementPtrInst>(I))
+    return false;
+  if (!isVarying(&I))
+    return true;
+  if (isa<PtrToIntInst>(I) || isa<IntToPtrInst>(I))
+    return false;
+  // A varying address is only computed for the first lane, so it can only be
+  // used to compute other addresses or to access memory.
+  if (I.getType()->isPointerTy()) {
+    for (User *U : I.users()) {
+      if (isa<GetElementPtrInst>(U) || isa<BitCastInst>(U))
+        continue;
+      if (auto *Load = dyn_cast<LoadInst>(U))
+        if (Load->getPointerOperand() == &I)
+          continue;
+      if (auto *Store = dyn_cast<StoreInst>(U))
+        if (Store->getPointerOperand() == &I)
+          continue;
+      return false;
+    }
+    return true;
+  }
+  return VectorType::isValidElementType(I.getType());
+}
+
+bool OuterLoopVectorizer::canVectorizeMemory() {
+  SmallVector<Instruction *, 16> MemInsts;
+  for (BasicBlock *BB : OuterLoop->blocks())
+    for (Instruction &I : *BB)
+      if (isa<LoadInst>(I) || isa<StoreInst>(I))
+        MemInsts.push_back(&I);
+
+  // The lanes run different outer iterations in lock step, which is only
+  // legal if every dependence stays within one outer iteration.
+  Function *F = OuterLoop->getHeader()->getParent();
+  DependenceInfo DI(F, AA, SE, LI);
+  unsigned Level = OuterLoop->getLoopDepth();
+  for (unsigned I = 0, E = MemInsts.size(); I != E; ++I)
+    for (unsigned J = I; J != E; ++J) {
+      Instruction *Src = MemInsts[I], *Dst = MemInsts[J];
+      if (!Src->mayWriteToMemory() && !Dst->mayWriteToMemory())
+        continue;
+      auto D = DI.depends(Src, Dst, true);
+      if (!D)
+        continue;
+      if (D->isConfused() || D->getLevels() < Level ||
+          D->getDirection(Level) != Dependence::DVEntry::EQ) {
+        DEBUG(dbgs() << "LV: Outer loop carries a dependence from " << *Src
+                     << " to " << *Dst << ".\n");
+        return false;
+      }
+    }
+  return true;
+}
+
+bool OuterLoopVectorizer::canVectorize() {
+  if (OuterLoop->getSubLoops().size() != 1)
+    return false;
+  InnerLoop = OuterLoop->getSubLoops().front();
+  if (!InnerLoop->empty() || InnerLoop->getNumBlocks() != 1)
+    return false;
+
+  BasicBlock *Header = OuterLoop->getHeader();
+  BasicBlock *Latch = OuterLoop->getLoopLatch();
+  BasicBlock *ExitBB = OuterLoop->getExitBlock();
+  if (!OuterLoop->getLoopPreheader() || !Latch || Latch == Header ||
+      OuterLoop->getExitingBlock() != Latch || !ExitBB ||
+      isa<PHINode>(ExitBB->begin()) || !InnerLoop->getLoopPreheader() ||
+      !InnerLoop->getExitBlock())
+    return false;
+
+  // The nest may only branch to form the two loops.
+  for (BasicBlock *BB : OuterLoop->blocks()) {
+    auto *Br = dyn_cast<BranchInst>(BB->getTerminator());
+    if (!Br || Br->isConditional() != (BB == Latch || InnerLoop->contains(BB)))
+      return false;
+  }
+
+  // The outer loop must be counted by its only header phi.
+  for (Instruction &I : *Header) {
+    auto *Phi = dyn_cast<PHINode>(&I);
+    if (!Phi)
+      break;
+    if (IV)
+      return false;
+    IV = Phi;
+  }
+  InductionDescriptor ID;
+  if (!IV || !InductionDescriptor::isInductionPHI(IV, SE, ID) ||
+      ID.getKind() != InductionDescriptor::IK_IntInduction ||
+      !ID.getConstIntStepValue())
+    return false;
+  Step = ID.getConstIntStepValue();
+  if (isa<SCEVCouldNotCompute>(SE->getBackedgeTakenCount(OuterLoop)))
+    return false;
+
+  // Everything computed from the outer induction variable varies across the
+  // lanes.
+  Varying.insert(IV);
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (BasicBlock *BB : OuterLoop->blocks())
+      for (Instruction &I : *BB)
+        if (!isVarying(&I) && any_of(I.operands(), [&](Value *Op) {
+              return isVarying(Op);
+            }))
+          Changed |= Varying.insert(&I).second;
+  }
+
+  unsigned WidestType = 8;
+  for (BasicBlock *BB : OuterLoop->blocks())
+    for (Instruction &I : *BB) {
+      if (isa<DbgInfoIntrinsic>(I))
+        continue;
+      if (!canVectorizeInstruction(I)) {
+        DEBUG(dbgs() << "LV: Cannot vectorize the outer loop with " << I
+                     << ".\n");
+        return false;
+      }
+      Type *Ty = I.getType();
+      if (auto *Store = dyn_cast<StoreInst>(&I))
+        Ty = Store->getValueOperand()->getType();
+      if (isVarying(&I) && Ty->isSized() && !Ty->isPointerTy())
+        WidestType =
+            std::max<unsigned>(WidestType, DL.getTypeSizeInBits(Ty));
+    }
+
+  if (!canVectorizeMemory())
+    return false;
+
+  VF = VectorizerParams::VectorizationFactor;
+  if (!VF)
+    VF = PowerOf2Floor(TTI->getRegisterBitWidth(true) / WidestType);
+  return VF > 1;
+}
+
+Value *OuterLoopVectorizer::getScalarValue(Value *V) {
+  auto *I = dyn_cast<Instruction>(V);
+  if (!I || !OuterLoop->contains(I))
+    return V;
+  auto It = ScalarMap.find(V);
+  if (It != ScalarMap.end())
+    return It->second;
+  return Builder.CreateExtractElement(getVectorValue(V), Builder.getInt32(0));
+}
+
+Value *OuterLoopVectorizer::getVectorValue(Value *V) {
+  auto It = VectorMap.find(V);
+  if (It != VectorMap.end())
+    return It->second;
+  assert(!isVarying(V) && "Varying value was not widened");
+  return Builder.CreateVectorSplat(VF, getScalarValue(V), "broadcast");
+}
+
+void OuterLoopVectorizer::widenInstruction(Instruction &I) {
+  auto *Load = dyn_cast<LoadInst>(&I);
+  if (Load && isVarying(Load)) {
+    unsigned AS = Load->getPointerAddressSpace();
+    Type *VecTy = VectorType::get(Load->getType(), VF);
+    unsigned Align = Load->getAlignment();
+    if (!Align)
+      Align = DL.getABITypeAlignment(Load->getType());
+    Value *Ptr = Builder.CreateBitCast(
+        getScalarValue(Load->getPointerOperand()), VecTy->getPointerTo(AS));
+    VectorMap[Load] = Builder.CreateAlignedLoad(Ptr, Align, "wide.load");
+    return;
+  }
+
+  if (auto *Store = dyn_cast<StoreInst>(&I)) {
+    Value *Val = Store->getValueOperand();
+    unsigned Align = Store->getAlignment();
+    if (!Align)
+      Align = DL.getABITypeAlignment(Val->getType());
+    Value *Vec = getVectorValue(Val);
+    Value *Ptr =
+        Builder.CreateBitCast(getScalarValue(Store->getPointerOperand()),
+                              Vec->getType()->getPointerTo(
+                                  Store->getPointerAddressSpace()));
+    Builder.CreateAlignedStore(Vec, Ptr, Align);
+    return;
+  }
+
+  if (isVarying(&I) && !I.getType()->isPointerTy()) {
+    Value *V;
+    if (auto *BO = dyn_cast<BinaryOperator>(&I)) {
+      V = Builder.CreateBinOp(BO->getOpcode(), getVectorValue(BO->getOperand(0)),
+                              getVectorValue(BO->getOperand(1)));
+      if (auto *VecOp = dyn_cast<Instruction>(V))
+        VecOp->copyIRFlags(BO);
+    } else if (auto *Cmp = dyn_cast<CmpInst>(&I)) {
+      Value *A = getVectorValue(Cmp->getOperand(0));
+      Value *B = getVectorValue(Cmp->getOperand(1));
+      V = isa<FCmpInst>(Cmp) ? Builder.CreateFCmp(Cmp->getPredicate(), A, B)
+                             : Builder.CreateICmp(Cmp->getPredicate(), A, B);
+    } else if (auto *Cast = dyn_cast<CastInst>(&I)) {
+      V = Builder.CreateCast(Cast->getOpcode(),
+                             getVectorValue(Cast->getOperand(0)),
+                             VectorType::get(Cast->getType(), VF));
+    } else {
+      auto *Sel = cast<SelectInst>(&I);
+      Value *Cond = Sel->getCondition();
+      V = Builder.CreateSelect(
+          isVarying(Cond) ? getVectorValue(Cond) : getScalarValue(Cond),
+          getVectorValue(Sel->getTrueValue()),
+          getVectorValue(Sel->getFalseValue()));
+    }
+    VectorMap[&I] = V;
+    // Floating point values are never needed for a single lane; integers may
+    // be used to compute the address of the first lane.
+    if (!I.getType()->isIntegerTy())
+      return;
+  }
+
+  Instruction *Clone = I.clone();
+  for (unsigned Op = 0, E = I.getNumOperands(); Op != E; ++Op)
+    Clone->setOperand(Op, getScalarValue(I.getOperand(Op)));
+  if (I.hasName())
+    Clone->setName(I.getName() + ".vec");
+  Builder.Insert(Clone);
+  ScalarMap[&I] = Clone;
+}
+
+void OuterLoopVectorizer::vectorize() {
+  BasicBlock *Header = OuterLoop->getHeader();
+  BasicBlock *Latch = OuterLoop->getLoopLatch();
+  BasicBlock *InnerHeader = InnerLoop->getHeader();
+  BasicBlock *Preheader = OuterLoop->getLoopPreheader();
+  BasicBlock *ExitBB = OuterLoop->getExitBlock();
+  Function *F = Header->getParent();
+  LLVMContext &Context = F->getContext();
+  Loop *ParentLoop = OuterLoop->getParentLoop();
+
+  // Snapshot the nest before adding blocks to the function.
+  LoopBlocksDFS DFS(OuterLoop);
+  DFS.perform(LI);
+  SmallVector<BasicBlock *, 8> Blocks(DFS.beginRPO(), DFS.endRPO());
+
+  // The original nest is now reached through a new preheader, either when
+  // there are too few iterations or to run the remaining ones.
+  BasicBlock *ScalarPH = SplitBlock(Preheader, Preheader->getTerminator(), DT,
+                                    LI);
+  ScalarPH->setName("outer.scalar.ph");
+  BasicBlock *VectorPH =
+      BasicBlock::Create(Context, "outer.vector.ph", F, ScalarPH);
+  for (BasicBlock *BB : Blocks)
+    BlockMap[BB] = BasicBlock::Create(Context, BB->getName() + ".vec", F,
+                                      ScalarPH);
+  BasicBlock *MiddleBlock =
+      BasicBlock::Create(Context, "outer.middle.block", F, ScalarPH);
+
+  const SCEV *BackedgeTakenCount = SE->getBackedgeTakenCount(OuterLoop);
+  Type *IdxTy = BackedgeTakenCount->getType();
+  SCEVExpander Exp(*SE, DL, "outer.vec");
+  Value *BTC = Exp.expandCodeFor(BackedgeTakenCount, IdxTy,
+                                 Preheader->getTerminator());
+  Builder.SetInsertPoint(Preheader->getTerminator());
+  // The trip count wraps to zero if the backedge-taken count is the largest
+  // value of its type; the nest is then left scalar.
+  Value *Count = Builder.CreateAdd(BTC, ConstantInt::get(IdxTy, 1),
+                                   "outer.count");
+  Value *TooFew = Builder.CreateICmpULT(Count, ConstantInt::get(IdxTy, VF),
+                                        "outer.min.iters");
+  ReplaceInstWithInst(Preheader->getTerminator(),
+                      BranchInst::Create(ScalarPH, VectorPH, TooFew));
+
+  Builder.SetInsertPoint(VectorPH);
+  Value *VectorCount = Builder.CreateSub(
+      Count, Builder.CreateURem(Count, ConstantInt::get(IdxTy, VF)),
+      "outer.n.vec");
+  Builder.CreateBr(BlockMap[Header]);
+
+  // Lane K runs the iteration IV + K * Step.
+  Type *IVTy = IV->getType();
+  Value *Start = IV->getIncomingValueForBlock(ScalarPH);
+  Builder.SetInsertPoint(BlockMap[Header]);
+  PHINode *Index = Builder.CreatePHI(IdxTy, 2, "outer.index");
+  Index->addIncoming(ConstantInt::get(IdxTy, 0), VectorPH);
+  Value *FirstIV = Builder.CreateAdd(
+      Start, Builder.CreateMul(Builder.CreateZExtOrTrunc(Index, IVTy), Step),
+      "outer.iv");
+  SmallVector<Constant *, 8> Offsets;
+  for (unsigned Lane = 0; Lane != VF; ++Lane)
+    Offsets.push_back(
+        ConstantInt::getSigned(IVTy, Step->getSExtValue() * int64_t(Lane)));
+  ScalarMap[IV] = FirstIV;
+  VectorMap[IV] =
+      Builder.CreateAdd(Builder.CreateVectorSplat(VF, FirstIV),
+                        ConstantVector::get(Offsets), "outer.vec.iv");
+
+  SmallVector<std::pair<PHINode *, PHINode *>, 4> InnerPhis;
+  for (BasicBlock *BB : Blocks) {
+    Builder.SetInsertPoint(BlockMap[BB]);
+    for (Instruction &I : *BB) {
+      if (&I == IV || isa<DbgInfoIntrinsic>(I))
+        continue;
+
+      if (auto *Phi = dyn_cast<PHINode>(&I)) {
+        if (BB == InnerHeader) {
+          Type *Ty = isVarying(Phi) ? VectorType::get(Phi->getType(), VF)
+                                    : Phi->getType();
+          PHINode *NewPhi = Builder.CreatePHI(Ty, 2, Phi->getName() + ".vec");
+          (isVarying(Phi) ? VectorMap : ScalarMap)[Phi] = NewPhi;
+          InnerPhis.push_back(std::make_pair(Phi, NewPhi));
+        } else {
+          Value *In = Phi->getIncomingValue(0);
+          if (isVarying(Phi))
+            VectorMap[Phi] = getVectorValue(In);
+          if (!isVarying(Phi) || Phi->getType()->isIntegerTy())
+            ScalarMap[Phi] = getScalarValue(In);
+        }
+        continue;
+      }
+
+      if (auto *Br = dyn_cast<BranchInst>(&I)) {
+        if (BB == Latch) {
+          Value *Next = Builder.CreateAdd(Index, ConstantInt::get(IdxTy, VF),
+                                          "outer.index.next");
+          Index->addIncoming(Next, BlockMap[Latch]);
+          Builder.CreateCondBr(Builder.CreateICmpEQ(Next, VectorCount),
+                               MiddleBlock, BlockMap[Header]);
+        } else if (Br->isUnconditional()) {
+          Builder.CreateBr(BlockMap[Br->getSuccessor(0)]);
+        } else {
+          Builder.CreateCondBr(getScalarValue(Br->getCondition()),
+                               BlockMap[Br->getSuccessor(0)],
+                               BlockMap[Br->getSuccessor(1)]);
+        }
+        continue;
+      }
+
+      widenInstruction(I);
+    }
+  }
+
+  // Now that all the values are available, complete the phis of the inner
+  // loop.
+  for (auto &P : InnerPhis) {
+    PHINode *Phi = P.first;
+    for (unsigned In = 0, E = Phi->getNumIncomingValues(); In != E; ++In) {
+      BasicBlock *InBB = BlockMap[Phi->getIncomingBlock(In)];
+      Builder.SetInsertPoint(InBB->getTerminator());
+      Value *V = Phi->getIncomingValue(In);
+      P.second->addIncoming(
+          isVarying(Phi) ? getVectorValue(V) : getScalarValue(V), InBB);
+    }
+  }
+
+  // Leave the vector nest for the exit, or for the original nest to run the
+  // remaining iterations.
+  Builder.SetInsertPoint(MiddleBlock);
+  Value *ResumeIV = Builder.CreateAdd(
+      Start,
+      Builder.CreateMul(Builder.CreateZExtOrTrunc(VectorCount, IVTy), Step),
+      "outer.ind.end");
+  Builder.CreateCondBr(Builder.CreateICmpEQ(VectorCount, Count, "outer.cmp.n"),
+                       ExitBB, ScalarPH);
+  PHINode *Resume = PHINode::Create(IVTy, 2, "outer.resume.val",
+                                    &ScalarPH->front());
+  Resume->addIncoming(Start, Preheader);
+  Resume->addIncoming(ResumeIV, MiddleBlock);
+  IV->setIncomingValue(IV->getBasicBlockIndex(ScalarPH), Resume);
+
+  // Register the new loops.
+  Loop *VecOuterLoop = new Loop();
+  Loop *VecInnerLoop = new Loop();
+  if (ParentLoop) {
+    ParentLoop->addChildLoop(VecOuterLoop);
+    ParentLoop->addBasicBlockToLoop(VectorPH, *LI);
+    ParentLoop->addBasicBlockToLoop(MiddleBlock, *LI);
+  } else {
+    LI->addTopLevelLoop(VecOuterLoop);
+  }
+  VecOuterLoop->addChildLoop(VecInnerLoop);
+  VecOuterLoop->addBasicBlockToLoop(BlockMap[Header], *LI);
+  VecInnerLoop->addBasicBlockToLoop(BlockMap[InnerHeader], *LI);
+  for (BasicBlock *BB : Blocks)
+    if (BB != Header && BB != InnerHeader)
+      VecOuterLoop->addBasicBlockToLoop(BlockMap[BB], *LI);
+
+  // Neither loop of the new nest should be vectorized again.
+  LoopVectorizeHints InnerHints(VecInnerLoop, true);
+  InnerHints.setAlreadyVectorized();
+  LoopVectorizeHints OuterHints(VecOuterLoop, true);
+  OuterHints.setAlreadyVectorized();
+
+  SE->forgetLoop(OuterLoop);
+  DT->recalculate(*F);
+}
+
+bool LoopVectorizePass::processOuterLoop(Loop *L) {
+  LoopVectorizeHints Hints(L, true);
+  if (Hints.getForce() == LoopVectorizeHints::FK_Disabled ||
+      (Hints.getWidth() == 1 && Hints.getInterleave() == 1))
+    return false;
+  Function *F = L->getHeader()->getParent();
+  if (F->optForSize() || F->hasFnAttribute(Attribute::NoImplicitFloat))
+    return false;
+
+  OuterLoopVectorizer OLV(L, SE, LI, DT, AA, TTI);
+  if (!OLV.canVectorize())
+    return false;
+  DEBUG(dbgs() << "LV: Vectorizing the outer loop in \"" << F->getName()
+               << "\" with width " << OLV.getWidth() << ".\n");
+  OLV.vectorize();
+  ++OuterLoopsVectorized;
+  emitOptimizationRemark(F->getContext(), LV_NAME, *F, L->getStartLoc(),
+                         Twine("vectorized outer loop (vectorization width: ") +
+                             Twine(OLV.getWidth()) + ")");
+  return true;
+}
+
 bool LoopVectorizePass::processLoop(Loop *L) {
   assert(L->empty() && "Only process inner loops.");
 
@@ -6607,6 +7171,20 @@ bool LoopVectorizePass::processLoop(Loop *L) {
                            Twine("vectorized loop (vectorization width: ") +
                                Twine(VF.Width) + ", interleaved count: " +
                                Twine(IC) + ")");
+
+    // The remainder loop runs fewer than VF * IC iterations. Vectorize it
+    // again if a factor of at most half of that is profitable.
+    unsigned MainVF = VF.Width * IC;
+    RemainderIterations += MainVF - 1;
+    if (EnableEpilogueVectorization && !OptForSize && MainVF >= 4)
+      if (unsigned EpilogueVF = vectorizeEpilogue(L, MainVF / 2)) {
+        ++EpilogueLoopsVectorized;
+        RemainderIterationsVectorized += MainVF - EpilogueVF;
+        emitOptimizationRemark(
+            F->getContext(), LV_NAME, *F, L->getStartLoc(),
+            Twine("vectorized epilogue loop (vectorization width: ") +
+                Twine(EpilogueVF) + ")");
+      }
   }
 
   // Mark the loop as already vectorized to avoid vectorizing again.
@@ -6616,6 +7194,49 @@ bool LoopVectorizePass::processLoop(Loop *L) {
   return true;
 }
 
+unsigned LoopVectorizePass::vectorizeEpilogue(Loop *L, unsigned MaxVF) {
+  DEBUG(dbgs() << "LV: Checking the remainder loop for a factor of at most "
+               << MaxVF << ".\n");
+  Function *F = L->getHeader()->getParent();
+
+  // The exit block of the remainder loop is also reached from the middle block
+  // of the vector loop. Give the remainder loop an exit block of its own, so
+  // that its preheader dominates its exit.
+  BasicBlock *ExitBlock = L->getExitBlock();
+  BasicBlock *ExitingBlock = L->getExitingBlock();
+  if (!ExitBlock || !ExitingBlock)
+    return 0;
+  if (!DT->dominates(L->getLoopPreheader(), ExitBlock))
+    SplitBlockPredecessors(ExitBlock, ExitingBlock, ".epil", DT, LI,
+                           /*PreserveLCSSA=*/true);
+
+  LoopVectorizeHints Hints(L, true);
+  PredicatedScalarEvolution PSE(*SE, *L);
+
+  // The checks made for the main loop hold for the remainder loop as well, so
+  // this is not expected to fail. The runtime checks are emitted again; they
+  // only fail when the checks of the main loop did.
+  LoopVectorizationRequirements Requirements;
+  LoopVectorizationLegality LVL(L, PSE, DT, TLI, AA, F, TTI, GetLAA, LI,
+                                &Requirements, &Hints);
+  if (!LVL.canVectorize() || Requirements.doesNotMeet(F, L, Hints))
+    return 0;
+
+  LoopVectorizationCostModel CM(L, PSE, LI, &LVL, *TTI, TLI, DB, AC, F,
+                                &Hints);
+  CM.collectValuesToIgnore();
+  const LoopVectorizationCostModel::VectorizationFactor VF =
+      CM.selectVectorizationFactor(false, MaxVF);
+  if (VF.Width == 1)
+    return 0;
+
+  DEBUG(dbgs() << "LV: Vectorizing the remainder loop (" << VF.Width
+               << ").\n");
+  InnerLoopVectorizer LB(L, PSE, LI, DT, TLI, TTI, AC, VF.Width, 1);
+  LB.vectorize(&LVL, CM.MinBWs, CM.VecValuesToIgnore);
+  return VF.Width;
+}
+
 bool LoopVectorizePass::runImpl(
     Function &F, ScalarEvolution &SE_, LoopInfo &LI_, TargetTransformInfo &TTI_,
     DominatorTree &DT_, BlockFrequencyInfo &BFI_, TargetLibraryInfo *TLI_,
@@ -6648,6 +7269,18 @@ bool LoopVectorizePass::runImpl(
   if (!TTI->getNumberOfRegisters(true) && TTI->getMaxInterleaveFactor(1) < 2)
     return false;
 
+  bool Changed = false;
+
+  // Vectorize the candidate loop nests along their outer loop first. The
+  // inner loops of the original nests are then considered as usual.
+  if (EnableOuterLoopVectorization) {
+    SmallVector<Loop *, 8> OuterLoops;
+    for (Loop *L : *LI)
+      addOuterLoop(*L, OuterLoops);
+    for (Loop *L : OuterLoops)
+      Changed |= processOuterLoop(L);
+  }
+
   // Build up a worklist of inner-loops to vectorize. This is necessary as
   // the act of vectorizing or partially unrolling a loop creates new loops
   // and can invalidate iterators across the loops.
@@ -6659,7 +7292,6 @@ bool LoopVectorizePass::runImpl(
   LoopsAnalyzed += Worklist.size();
 
   // Now walk the identified inner loops.
-  bool Changed = false;
   while (!Worklist.empty())
     Changed |= processLoop(Worklist.pop_back_val());
 
@@ -16,6 +16,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "llvm/Transforms/Vectorize/SLPVectorizer.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SetVector.h"
@@ -66,6 +67,11 @@ static cl::opt<bool> ShouldStartVectorizeHorAtStore(
     cl::desc(
         "Attempt to vectorize horizontal reductions feeding into a store"));
 
+static cl::opt<unsigned> LookAheadMaxDepth(
+    "slp-look-ahead-depth", cl::init(2), cl::Hidden,
+    cl::desc("The number of levels of operands the reordering of commutative "
+             "operands looks through when comparing candidates (0 disables)"));
+
 static cl::opt<int>
 MaxVectorRegSizeOption("slp-max-reg-size", cl::init(128), cl::Hidden,
     cl::desc("Attempt to vectorize for this register size in bits"));
@@ -441,6 +447,10 @@ private:
   void reorderInputsAccordingToOpcode(ArrayRef<Value *> VL,
                                       SmallVectorImpl<Value *> &Left,
                                       SmallVectorImpl<Value *> &Right);
+  /// \returns a score of how well \p V1 and \p V2, which are the same
+  /// operand of two neighbouring lanes, would vectorize together, looking
+  /// through \p Depth levels of their operands.
+  int getLookAheadScore(Value *V1, Value *V2, unsigned Depth);
   struct TreeEntry {
     TreeEntry() : Scalars(), VectorizedValue(nullptr),
     NeedToGather(0) {}
@@ -2087,6 +2097,25 @@ void BoUpSLP::reorderInputsAccordingToOpcode(ArrayRef<Value *> VL,
   if (SplatRight || SplatLeft)
     return;
 
+  // The heuristics above only look at the operands themselves. Look further
+  // down to commute the lanes whose operands only match those of the previous
+  // lane crosswise, e.g. the multiplies in
+  //   (a[0] * b[0]) + (c[0] * d[0])
+  //   (c[1] * d[1]) + (a[1] * b[1])
+  // all have the same opcode but only the crossed pairing makes their loads
+  // consecutive.
+  if (LookAheadMaxDepth)
+    for (unsigned i = 1, e = VL.size(); i != e; ++i) {
+      int Straight =
+          getLookAheadScore(Left[i - 1], Left[i], LookAheadMaxDepth) +
+          getLookAheadScore(Right[i - 1], Right[i], LookAheadMaxDepth);
+      int Crossed =
+          getLookAheadScore(Left[i - 1], Right[i], LookAheadMaxDepth) +
+          getLookAheadScore(Right[i - 1], Left[i], LookAheadMaxDepth);
+      if (Crossed > Straight)
+        std::swap(Left[i], Right[i]);
+    }
+
   // Finally check if we can get longer vectorizable chain by reordering
   // without breaking the good operand order detected above.
   // E.g. If we have something like-
@@ -2123,6 +2152,37 @@ void BoUpSLP::reorderInputsAccordingToOpcode(ArrayRef<Value *> VL,
   }
 }
 
+int BoUpSLP::getLookAheadScore(Value *V1, Value *V2, unsigned Depth) {
+  // A broadcast or a vector of constants needs no extra work.
+  if (V1 == V2 || (isa<Constant>(V1) && isa<Constant>(V2)))
+    return 2;
+
+  LoadInst *L1 = dyn_cast<LoadInst>(V1);
+  LoadInst *L2 = dyn_cast<LoadInst>(V2);
+  if (L1 && L2)
+    return isConsecutiveAccess(L1, L2, *DL, *SE) ? 4 : 1;
+
+  Instruction *I1 = dyn_cast<Instruction>(V1);
+  Instruction *I2 = dyn_cast<Instruction>(V2);
+  if (!I1 || !I2 || I1->getOpcode() != I2->getOpcode() ||
+      I1->getParent() != I2->getParent())
+    return 0;
+  if (!Depth || !(isa<BinaryOperator>(I1) || isa<CastInst>(I1) ||
+                  isa<CmpInst>(I1)))
+    return 1;
+
+  int Straight = 0;
+  for (unsigned i = 0, e = I1->getNumOperands(); i != e; ++i)
+    Straight +=
+        getLookAheadScore(I1->getOperand(i), I2->getOperand(i), Depth - 1);
+  if (!I1->isCommutative())
+    return 1 + Straight;
+  int Crossed =
+      getLookAheadScore(I1->getOperand(0), I2->getOperand(1), Depth - 1) +
+      getLookAheadScore(I1->getOperand(1), I2->getOperand(0), Depth - 1);
+  return 1 + std::max(Straight, Crossed);
+}
+
 void BoUpSLP::setInsertPointAfterBundle(ArrayRef<Value *> VL) {
   Instruction *VL0 = cast<Instruction>(VL[0]);
   BasicBlock::iterator NextInst(VL0);
@@ -3911,8 +3971,9 @@ static Value *createRdxShuffleMask(unsigned VecLen, unsigned NumEltsToRdx,
 
 /// Model horizontal reductions.
 ///
-/// A horizontal reduction is a tree of reduction operations (currently add and
-/// fadd) that has operations that can be put into a vector as its leaf.
+/// A horizontal reduction is a tree of reduction operations (currently add,
+/// fadd and integer min/max) that has operations that can be put into a vector
+/// as its leaf.
 /// For example, this tree:
 ///
 /// mul mul mul mul
@@ -3936,15 +3997,24 @@ static Value *createRdxShuffleMask(unsigned VecLen, unsigned NumEltsToRdx,
 ///     |
 ///   *p =
 ///
+/// The operations of a min/max reduction are compare and select pairs like
+///   %c = icmp sgt i32 %a, %b
+///   %m = select i1 %c, i32 %a, i32 %b
+///
+/// The reduction operations have to be in one block but the reduced values may
+/// be defined in other blocks; the values of each block are vectorized
+/// separately.
 class HorizontalReduction {
   SmallVector<Value *, 16> ReductionOps;
   SmallVector<Value *, 32> ReducedVals;
 
-  BinaryOperator *ReductionRoot;
+  Instruction *ReductionRoot;
   PHINode *ReductionPHI;
 
-  /// The opcode of the reduction.
+  /// The opcode of the reduction, Instruction::Select for min/max.
   unsigned ReductionOpcode;
+  /// The predicate of the compares of a min/max reduction.
+  CmpInst::Predicate MinMaxPredicate;
   /// The opcode of the values we perform a reduction on.
   unsigned ReducedValueOpcode;
   /// Should we model this reduction as a pairwise reduction tree or a tree that
@@ -3961,11 +4031,12 @@ public:
 
   HorizontalReduction(unsigned MinVecRegSize)
       : ReductionRoot(nullptr), ReductionPHI(nullptr), ReductionOpcode(0),
-        ReducedValueOpcode(0), IsPairwiseReduction(false), ReduxWidth(0),
+        MinMaxPredicate(CmpInst::BAD_ICMP_PREDICATE), ReducedValueOpcode(0),
+        IsPairwiseReduction(false), ReduxWidth(0),
         MinVecRegSize(MinVecRegSize) {}
 
   /// \brief Try to find a reduction tree.
-  bool matchAssociativeReduction(PHINode *Phi, BinaryOperator *B) {
+  bool matchAssociativeReduction(PHINode *Phi, Instruction *B) {
     assert((!Phi ||
             std::find(Phi->op_begin(), Phi->op_end(), B) != Phi->op_end()) &&
            "Thi phi needs to use the binary operator");
@@ -4002,9 +4073,12 @@ public:
     if (ReduxWidth < 4)
       return false;
 
-    // We currently only support adds.
-    if (ReductionOpcode != Instruction::Add &&
-        ReductionOpcode != Instruction::FAdd)
+    // We currently only support adds and integer min/max.
+    if (ReductionOpcode == Instruction::Select) {
+      if (Phi || !Ty->isIntegerTy() || !matchMinMax(B, MinMaxPredicate))
+        return false;
+    } else if (ReductionOpcode != Instruction::Add &&
+               ReductionOpcode != Instruction::FAdd)
       return false;
 
     // Post order traverse the reduction tree starting at B. We only handle true
@@ -4014,15 +4088,16 @@ public:
     while (!Stack.empty()) {
       Instruction *TreeN = Stack.back().first;
       unsigned EdgeToVist = Stack.back().second++;
-      bool IsReducedValue = TreeN->getOpcode() != ReductionOpcode;
-
-      // Only handle trees in the current basic block.
-      if (TreeN->getParent() != B->getParent())
-        return false;
+      // Only the nodes in the current basic block are reduction operations,
+      // the values reduced may come from other blocks.
+      bool IsReducedValue =
+          TreeN->getParent() != B->getParent() || !isReductionOp(TreeN);
 
       // Each tree node needs to have one user except for the ultimate
-      // reduction.
-      if (!TreeN->hasOneUse() && TreeN != B)
+      // reduction. The nodes of a min/max reduction are used by both the
+      // compare and the select of their parent.
+      if (TreeN != B &&
+          !TreeN->hasNUses(ReductionOpcode == Instruction::Select ? 2 : 1))
         return false;
 
       // Postorder vist.
@@ -4035,6 +4110,9 @@ public:
           else if (ReducedValueOpcode != TreeN->getOpcode())
             return false;
           ReducedVals.push_back(TreeN);
+        } else if (ReductionOpcode == Instruction::Select) {
+          ReductionOps.push_back(TreeN);
+          ReductionOps.push_back(cast<SelectInst>(TreeN)->getCondition());
         } else {
           // We need to be able to reassociate the adds.
           if (!TreeN->isAssociative())
@@ -4046,8 +4124,10 @@ public:
         continue;
       }
 
-      // Visit left or right.
-      Value *NextV = TreeN->getOperand(EdgeToVist);
+      // Visit left or right. The operands of a min/max are the values of its
+      // select.
+      Value *NextV = TreeN->getOperand(
+          ReductionOpcode == Instruction::Select ? EdgeToVist + 1 : EdgeToVist);
       // We currently only allow BinaryOperator's and SelectInst's as reduction
       // values in our tree.
       if (isa<BinaryOperator>(NextV) || isa<SelectInst>(NextV))
@@ -4068,46 +4148,57 @@ public:
     if (NumReducedVals < ReduxWidth)
       return false;
 
+    // The scalars of a tree must all be in one block, group the reduced values
+    // by the block defining them.
+    MapVector<BasicBlock *, SmallVector<Value *, 16>> ReducedValsByBlock;
+    for (Value *RdxVal : ReducedVals)
+      ReducedValsByBlock[cast<Instruction>(RdxVal)->getParent()].push_back(
+          RdxVal);
+
     Value *VectorizedTree = nullptr;
     IRBuilder<> Builder(ReductionRoot);
     FastMathFlags Unsafe;
     Unsafe.setUnsafeAlgebra();
     Builder.setFastMathFlags(Unsafe);
-    unsigned i = 0;
-
-    for (; i < NumReducedVals - ReduxWidth + 1; i += ReduxWidth) {
-      V.buildTree(makeArrayRef(&ReducedVals[i], ReduxWidth), ReductionOps);
-      V.computeMinimumValueSizes();
-
-      // Estimate cost.
-      int Cost = V.getTreeCost() + getReductionCost(TTI, ReducedVals[i]);
-      if (Cost >= -SLPCostThreshold)
-        break;
-
-      DEBUG(dbgs() << "SLP: Vectorizing horizontal reduction at cost:" << Cost
-                   << ". (HorRdx)\n");
-
-      // Vectorize a tree.
-      DebugLoc Loc = cast<Instruction>(ReducedVals[i])->getDebugLoc();
-      Value *VectorizedRoot = V.vectorizeTree();
+    SmallVector<Value *, 16> ScalarVals;
+
+    for (auto &Entry : ReducedValsByBlock) {
+      ArrayRef<Value *> Vals = Entry.second;
+      unsigned i = 0;
+      for (; i + ReduxWidth <= Vals.size(); i += ReduxWidth) {
+        V.buildTree(Vals.slice(i, ReduxWidth), ReductionOps);
+        V.computeMinimumValueSizes();
+
+        // Estimate cost.
+        int Cost = V.getTreeCost() + getReductionCost(TTI, Vals[i]);
+        if (Cost >= -SLPCostThreshold)
+          break;
 
-      // Emit a reduction.
-      Value *ReducedSubTree = emitReduction(VectorizedRoot, Builder);
-      if (VectorizedTree) {
-        Builder.SetCurrentDebugLocation(Loc);
-        VectorizedTree = createBinOp(Builder, ReductionOpcode, VectorizedTree,
-                                     ReducedSubTree, "bin.rdx");
-      } else
-        VectorizedTree = ReducedSubTree;
+        DEBUG(dbgs() << "SLP: Vectorizing horizontal reduction at cost:"
+                     << Cost << ". (HorRdx)\n");
+
+        // Vectorize a tree.
+        DebugLoc Loc = cast<Instruction>(Vals[i])->getDebugLoc();
+        Value *VectorizedRoot = V.vectorizeTree();
+
+        // Emit a reduction.
+        Value *ReducedSubTree = emitReduction(VectorizedRoot, Builder);
+        if (VectorizedTree) {
+          Builder.SetCurrentDebugLocation(Loc);
+          VectorizedTree =
+              createOp(Builder, VectorizedTree, ReducedSubTree, "bin.rdx");
+        } else
+          VectorizedTree = ReducedSubTree;
+      }
+      ScalarVals.append(Vals.begin() + i, Vals.end());
     }
 
     if (VectorizedTree) {
       // Finish the reduction.
-      for (; i < NumReducedVals; ++i) {
+      for (Value *RdxVal : ScalarVals) {
         Builder.SetCurrentDebugLocation(
-          cast<Instruction>(ReducedVals[i])->getDebugLoc());
-        VectorizedTree = createBinOp(Builder, ReductionOpcode, VectorizedTree,
-                                     ReducedVals[i]);
+          cast<Instruction>(RdxVal)->getDebugLoc());
+        VectorizedTree = createOp(Builder, VectorizedTree, RdxVal);
       }
       // Update users.
       if (ReductionPHI) {
@@ -4125,20 +4216,68 @@ public:
   }
 
 private:
+  /// \returns true if \p V is an integer min/max, a select of the operands of
+  /// its compare that has no other user, and sets \p Pred to the predicate of
+  /// the compare.
+  static bool matchMinMax(Value *V, CmpInst::Predicate &Pred) {
+    SelectInst *Select = dyn_cast<SelectInst>(V);
+    if (!Select)
+      return false;
+    ICmpInst *Cmp = dyn_cast<ICmpInst>(Select->getCondition());
+    if (!Cmp || Cmp->isEquality() || !Cmp->hasOneUse() ||
+        Cmp->getParent() != Select->getParent() ||
+        Cmp->getOperand(0) != Select->getTrueValue() ||
+        Cmp->getOperand(1) != Select->getFalseValue())
+      return false;
+    Pred = Cmp->getPredicate();
+    return true;
+  }
+
+  /// \returns true if \p I is an operation of this reduction.
+  bool isReductionOp(Instruction *I) const {
+    if (ReductionOpcode != Instruction::Select)
+      return I->getOpcode() == ReductionOpcode;
+    CmpInst::Predicate Pred;
+    return matchMinMax(I, Pred) && Pred == MinMaxPredicate;
+  }
+
   /// \brief Calculate the cost of a reduction.
   int getReductionCost(TargetTransformInfo *TTI, Value *FirstReducedVal) {
     Type *ScalarTy = FirstReducedVal->getType();
     Type *VecTy = VectorType::get(ScalarTy, ReduxWidth);
 
-    int PairwiseRdxCost = TTI->getReductionCost(ReductionOpcode, VecTy, true);
-    int SplittingRdxCost = TTI->getReductionCost(ReductionOpcode, VecTy, false);
+    int PairwiseRdxCost, SplittingRdxCost, ScalarReduxCost;
+    if (ReductionOpcode == Instruction::Select) {
+      // There is no target hook for min/max reductions, add up the shuffles
+      // and the compares and selects of every level.
+      Type *CondTy = CmpInst::makeCmpResultType(VecTy);
+      int LevelCost =
+          TTI->getCmpSelInstrCost(Instruction::ICmp, VecTy) +
+          TTI->getCmpSelInstrCost(Instruction::Select, VecTy, CondTy);
+      int ShuffleCost = TTI->getShuffleCost(
+          TargetTransformInfo::SK_ExtractSubvector, VecTy, ReduxWidth / 2,
+          VecTy);
+      int NumLevels = Log2_32(ReduxWidth);
+      int ExtractCost =
+          TTI->getVectorInstrCost(Instruction::ExtractElement, VecTy, 0);
+      PairwiseRdxCost =
+          NumLevels * (LevelCost + 2 * ShuffleCost) + ExtractCost;
+      SplittingRdxCost = NumLevels * (LevelCost + ShuffleCost) + ExtractCost;
+      ScalarReduxCost =
+          ReduxWidth *
+          (TTI->getCmpSelInstrCost(Instruction::ICmp, ScalarTy) +
+           TTI->getCmpSelInstrCost(Instruction::Select, ScalarTy,
+                                   CmpInst::makeCmpResultType(ScalarTy)));
+    } else {
+      PairwiseRdxCost = TTI->getReductionCost(ReductionOpcode, VecTy, true);
+      SplittingRdxCost = TTI->getReductionCost(ReductionOpcode, VecTy, false);
+      ScalarReduxCost =
+          ReduxWidth * TTI->getArithmeticInstrCost(ReductionOpcode, VecTy);
+    }
 
     IsPairwiseReduction = PairwiseRdxCost < SplittingRdxCost;
     int VecReduxCost = IsPairwiseReduction ? PairwiseRdxCost : SplittingRdxCost;
 
-    int ScalarReduxCost =
-        ReduxWidth * TTI->getArithmeticInstrCost(ReductionOpcode, VecTy);
-
     DEBUG(dbgs() << "SLP: Adding cost " << VecReduxCost - ScalarReduxCost
                  << " for reduction that starts with " << *FirstReducedVal
                  << " (It is a "
@@ -4148,11 +4287,16 @@ private:
     return VecReduxCost - ScalarReduxCost;
   }
 
-  static Value *createBinOp(IRBuilder<> &Builder, unsigned Opcode, Value *L,
-                            Value *R, const Twine &Name = "") {
-    if (Opcode == Instruction::FAdd)
+  /// \brief Emit one operation of the reduction combining \p L and \p R.
+  Value *createOp(IRBuilder<> &Builder, Value *L, Value *R,
+                  const Twine &Name = "") {
+    if (ReductionOpcode == Instruction::Select)
+      return Builder.CreateSelect(Builder.CreateICmp(MinMaxPredicate, L, R), L,
+                                  R, Name);
+    if (ReductionOpcode == Instruction::FAdd)
       return Builder.CreateFAdd(L, R, Name);
-    return Builder.CreateBinOp((Instruction::BinaryOps)Opcode, L, R, Name);
+    return Builder.CreateBinOp((Instruction::BinaryOps)ReductionOpcode, L, R,
+                               Name);
   }
 
   /// \brief Emit a horizontal reduction of the vectorized value.
@@ -4174,14 +4318,13 @@ private:
         Value *RightShuf = Builder.CreateShuffleVector(
           TmpVec, UndefValue::get(TmpVec->getType()), (RightMask),
           "rdx.shuf.r");
-        TmpVec = createBinOp(Builder, ReductionOpcode, LeftShuf, RightShuf,
-                             "bin.rdx");
+        TmpVec = createOp(Builder, LeftShuf, RightShuf, "bin.rdx");
       } else {
         Value *UpperHalf =
           createRdxShuffleMask(ReduxWidth, i, false, false, Builder);
         Value *Shuf = Builder.CreateShuffleVector(
           TmpVec, UndefValue::get(TmpVec->getType()), UpperHalf, "rdx.shuf");
-        TmpVec = createBinOp(Builder, ReductionOpcode, TmpVec, Shuf, "bin.rdx");
+        TmpVec = createOp(Builder, TmpVec, Shuf, "bin.rdx");
       }
     }
 
@@ -4304,18 +4447,18 @@ static Value *getReductionValue(const DominatorTree *DT, PHINode *P,
 
 /// \brief Attempt to reduce a horizontal reduction.
 /// If it is legal to match a horizontal reduction feeding
-/// the phi node P with reduction operators BI, then check if it
+/// the phi node P (if any) with reduction operators Root, then check if it
 /// can be done.
 /// \returns true if a horizontal reduction was matched and reduced.
 /// \returns false if a horizontal reduction was not matched.
-static bool canMatchHorizontalReduction(PHINode *P, BinaryOperator *BI,
+static bool canMatchHorizontalReduction(PHINode *P, Instruction *Root,
                                         BoUpSLP &R, TargetTransformInfo *TTI,
                                         unsigned MinRegSize) {
   if (!ShouldVectorizeHor)
     return false;
 
   HorizontalReduction HorRdx(MinRegSize);
-  if (!HorRdx.matchAssociativeReduction(P, BI))
+  if (!HorRdx.matchAssociativeReduction(P, Root))
     return false;
 
   // If there is a sufficient number of reduction values, reduce
@@ -4327,6 +4470,34 @@ static bool canMatchHorizontalReduction(PHINode *P, BinaryOperator *BI,
   return HorRdx.tryToReduce(R, TTI);
 }
 
+/// \brief Return the last select of the min/max chain that \p CI is the
+/// condition of a link of, or null if \p CI is not used by a select.
+static SelectInst *getMinMaxChainRoot(CmpInst *CI) {
+  SelectInst *Root = nullptr;
+  for (User *U : CI->users())
+    if (SelectInst *Select = dyn_cast<SelectInst>(U))
+      if (Select->getCondition() == CI) {
+        Root = Select;
+        break;
+      }
+
+  // Follow the chain to the select that the next link compares against.
+  while (Root) {
+    SelectInst *Next = nullptr;
+    for (User *U : Root->users())
+      if (SelectInst *Select = dyn_cast<SelectInst>(U))
+        if (CmpInst *Cmp = dyn_cast<CmpInst>(Select->getCondition()))
+          if (is_contained(Cmp->operands(), Root)) {
+            Next = Select;
+            break;
+          }
+    if (!Next)
+      break;
+    Root = Next;
+  }
+  return Root;
+}
+
 bool SLPVectorizerPass::vectorizeChainsInBlock(BasicBlock *BB, BoUpSLP &R) {
   bool Changed = false;
   SmallVector<Value *, 4> Incoming;
@@ -4427,11 +4598,12 @@ bool SLPVectorizerPass::vectorizeChainsInBlock(BasicBlock *BB, BoUpSLP &R) {
 
     if (ShouldStartVectorizeHorAtStore)
       if (StoreInst *SI = dyn_cast<StoreInst>(it))
-        if (BinaryOperator *BinOp =
-                dyn_cast<BinaryOperator>(SI->getValueOperand())) {
-          if (canMatchHorizontalReduction(nullptr, BinOp, R, TTI,
+        if (isa<BinaryOperator>(SI->getValueOperand()) ||
+            isa<SelectInst>(SI->getValueOperand())) {
+          Instruction *Rdx = cast<Instruction>(SI->getValueOperand());
+          if (canMatchHorizontalReduction(nullptr, Rdx, R, TTI,
                                           R.getMinVecRegSize()) ||
-              tryToVectorize(BinOp, R)) {
+              tryToVectorize(dyn_cast<BinaryOperator>(Rdx), R)) {
             Changed = true;
             it = BB->begin();
             e = BB->end();
@@ -4441,7 +4613,16 @@ bool SLPVectorizerPass::vectorizeChainsInBlock(BasicBlock *BB, BoUpSLP &R) {
 
     // Try to vectorize horizontal reductions feeding into a return.
     if (ReturnInst *RI = dyn_cast<ReturnInst>(it))
-      if (RI->getNumOperands() != 0)
+      if (RI->getNumOperands() != 0) {
+        // A min/max chain only vectorizes as a reduction.
+        if (SelectInst *Select = dyn_cast<SelectInst>(RI->getOperand(0)))
+          if (canMatchHorizontalReduction(nullptr, Select, R, TTI,
+                                          R.getMinVecRegSize())) {
+            Changed = true;
+            it = BB->begin();
+            e = BB->end();
+            continue;
+          }
         if (BinaryOperator *BinOp =
                 dyn_cast<BinaryOperator>(RI->getOperand(0))) {
           DEBUG(dbgs() << "SLP: Found a return to vectorize.\n");
@@ -4453,9 +4634,21 @@ bool SLPVectorizerPass::vectorizeChainsInBlock(BasicBlock *BB, BoUpSLP &R) {
             continue;
           }
         }
+      }
 
     // Try to vectorize trees that start at compare instructions.
     if (CmpInst *CI = dyn_cast<CmpInst>(it)) {
+      // The compares of a min/max chain are vectorized with the reduction, if
+      // the chain forms one; pairing their operands first would split it.
+      if (SelectInst *Root = getMinMaxChainRoot(CI))
+        if (canMatchHorizontalReduction(nullptr, Root, R, TTI,
+                                        R.getMinVecRegSize())) {
+          Changed = true;
+          it = BB->begin();
+          e = BB->end();
+          continue;
+        }
+
       if (tryToVectorizePair(CI->getOperand(0), CI->getOperand(1), R)) {
         Changed = true;
         // We would like to start over since some instructions are deleted
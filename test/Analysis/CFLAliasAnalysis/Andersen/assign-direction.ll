@@ -0,0 +1,61 @@
+; This testcase ensures that CFLAndersAA keeps track of the direction of
+; assignments, where CFLSteensAA merges everything that flows together.
+
+; RUN: opt < %s -disable-basicaa -cfl-anders-aa -aa-eval -print-all-alias-modref-info -disable-output 2>&1 | FileCheck %s
+; RUN: opt < %s -aa-pipeline=cfl-anders-aa -passes=aa-eval -print-all-alias-modref-info -disable-output 2>&1 | FileCheck %s
+
+; CHECK-LABEL: Function: test_select
+; CHECK-DAG: NoAlias: i32* %a, i32* %b
+; CHECK-DAG: MayAlias: i32* %a, i32* %s
+; CHECK-DAG: MayAlias: i32* %b, i32* %s
+define void @test_select(i1 %c) {
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %s = select i1 %c, i32* %a, i32* %b
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %s
+  ret void
+}
+
+; CHECK-LABEL: Function: test_memory
+; CHECK-DAG: NoAlias: i32* %a, i32* %b
+; CHECK-DAG: MayAlias: i32* %a, i32* %la
+; CHECK-DAG: NoAlias: i32* %b, i32* %la
+; CHECK-DAG: MayAlias: i32* %b, i32* %lb
+; CHECK-DAG: NoAlias: i32* %a, i32* %lb
+define void @test_memory() {
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %pa = alloca i32*, align 8
+  %pb = alloca i32*, align 8
+  store i32* %a, i32** %pa
+  store i32* %b, i32** %pb
+  %la = load i32*, i32** %pa
+  %lb = load i32*, i32** %pb
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %la
+  store i32 0, i32* %lb
+  ret void
+}
+
+declare void @opaque(i32*)
+declare i32* @get()
+
+; CHECK-LABEL: Function: test_escape
+; CHECK-DAG: MayAlias: i32* %escapes, i32* %got
+; CHECK-DAG: NoAlias: i32* %got, i32* %local
+; CHECK-DAG: MayAlias: i32* %arg, i32* %got
+; CHECK-DAG: NoAlias: i32* %arg, i32* %local
+define void @test_escape(i32* %arg) {
+  %local = alloca i32, align 4
+  %escapes = alloca i32, align 4
+  call void @opaque(i32* %escapes)
+  %got = call i32* @get()
+  store i32 0, i32* %local
+  store i32 0, i32* %escapes
+  store i32 0, i32* %got
+  store i32 0, i32* %arg
+  ret void
+}
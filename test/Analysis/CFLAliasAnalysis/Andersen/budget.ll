@@ -0,0 +1,14 @@
+; This testcase ensures that CFLAndersAA gives up on functions that take it
+; more than its budget.
+
+; RUN: opt < %s -disable-basicaa -cfl-anders-aa -cfl-anders-max-work=1 -aa-eval -print-all-alias-modref-info -disable-output 2>&1 | FileCheck %s
+
+; CHECK-LABEL: Function: test
+; CHECK: MayAlias: i32* %a, i32* %b
+define void @test() {
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  ret void
+}
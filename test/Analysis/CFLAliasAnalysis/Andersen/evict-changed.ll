@@ -0,0 +1,24 @@
+; This testcase ensures that CFLAndersAA analyzes a function again after a pass
+; changed it, instead of answering queries from its stale summary.
+
+; RUN: opt < %s -disable-basicaa -cfl-anders-aa -aa-eval -dce -aa-eval -stats -disable-output 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+; Both functions are solved by the first -aa-eval. The alias analysis results
+; do not survive -dce, so both are solved again for the second one.
+; CHECK: 4 cfl-anders-aa {{.*}}Number of functions solved by CFL-Anders
+
+define i32* @select_first(i32* %x, i32* %y) {
+  ret i32* %x
+}
+
+define void @test() {
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %c = call i32* @select_first(i32* %a, i32* %b)
+  %dead = add i32 1, 2
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %c
+  ret void
+}
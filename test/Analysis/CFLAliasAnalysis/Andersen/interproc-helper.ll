@@ -0,0 +1,49 @@
+; This testcase ensures that CFLAndersAA sees through pointers passed to and
+; returned from helper functions, by the summaries of the helpers.
+
+; RUN: opt < %s -disable-basicaa -cfl-anders-aa -aa-eval -print-all-alias-modref-info -disable-output 2>&1 | FileCheck %s
+; RUN: opt < %s -aa-pipeline=cfl-anders-aa -passes=aa-eval -print-all-alias-modref-info -disable-output 2>&1 | FileCheck %s
+
+define i32* @select_first(i32* %x, i32* %y) {
+  ret i32* %x
+}
+
+define void @store_into(i32** %to, i32* %val) {
+  store i32* %val, i32** %to
+  ret void
+}
+
+define i32* @deref(i32** %p) {
+  %v = load i32*, i32** %p
+  ret i32* %v
+}
+
+; CHECK-LABEL: Function: test_return_arg
+; CHECK-DAG: NoAlias: i32* %a, i32* %b
+; CHECK-DAG: MayAlias: i32* %a, i32* %c
+; CHECK-DAG: NoAlias: i32* %b, i32* %c
+define void @test_return_arg() {
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %c = call i32* @select_first(i32* %a, i32* %b)
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %c
+  ret void
+}
+
+; CHECK-LABEL: Function: test_store_arg
+; CHECK-DAG: NoAlias: i32* %a, i32* %b
+; CHECK-DAG: MayAlias: i32* %a, i32* %l
+; CHECK-DAG: NoAlias: i32* %b, i32* %l
+define void @test_store_arg() {
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %p = alloca i32*, align 8
+  call void @store_into(i32** %p, i32* %a)
+  %l = call i32* @deref(i32** %p)
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %l
+  ret void
+}
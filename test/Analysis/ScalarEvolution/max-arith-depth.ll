@@ -0,0 +1,77 @@
+; RUN: opt < %s -analyze -scalar-evolution | FileCheck %s
+; RUN: opt < %s -analyze -scalar-evolution -scalar-evolution-max-arith-depth=0 | FileCheck %s --check-prefix=DEPTH0
+; RUN: opt < %s -analyze -scalar-evolution -scalar-evolution-max-arith-depth=1 | FileCheck %s --check-prefix=DEPTH1
+; RUN: opt < %s -analyze -scalar-evolution -scev-addops-inline-threshold=1 | FileCheck %s --check-prefix=ADDOPS
+; RUN: opt < %s -analyze -scalar-evolution -scev-mulops-inline-threshold=1 | FileCheck %s --check-prefix=MULOPS
+
+; Past the arithmetic depth budget, nested adds and multiplies are created
+; without looking for further simplifications. Past the inline thresholds,
+; nested adds and multiplies are kept nested instead of being flattened.
+
+; CHECK-LABEL: Classifying expressions for: @cancel
+; CHECK: %n = sub i32 %s, %a
+; CHECK-NEXT: -->  %b
+; DEPTH0-LABEL: Classifying expressions for: @cancel
+; DEPTH0: %n = sub i32 %s, %a
+; DEPTH0-NEXT: -->  ((-1 * %a) + %a + %b)
+; DEPTH1-LABEL: Classifying expressions for: @cancel
+; DEPTH1: %n = sub i32 %s, %a
+; DEPTH1-NEXT: -->  %b
+
+define i32 @cancel(i32 %a, i32 %b) {
+  %s = add i32 %a, %b
+  %n = sub i32 %s, %a
+  ret i32 %n
+}
+
+; CHECK-LABEL: Classifying expressions for: @factor
+; CHECK: %n = sub i32 %m, %t
+; CHECK-NEXT: -->  (%b * %c)
+; DEPTH0-LABEL: Classifying expressions for: @factor
+; DEPTH0: %n = sub i32 %m, %t
+; DEPTH0-NEXT: -->  (((%a + %b) + (-1 * %a)) * %c)
+; DEPTH1-LABEL: Classifying expressions for: @factor
+; DEPTH1: %n = sub i32 %m, %t
+; DEPTH1-NEXT: -->  (((-1 * %a) + %a + %b) * %c)
+
+define i32 @factor(i32 %a, i32 %b, i32 %c) {
+  %s = add i32 %a, %b
+  %m = mul i32 %s, %c
+  %t = mul i32 %a, %c
+  %n = sub i32 %m, %t
+  ret i32 %n
+}
+
+; CHECK-LABEL: Classifying expressions for: @add_chain
+; CHECK: %x3 = add i32 %x2, %d
+; CHECK-NEXT: -->  (%a + %b + %c + %d)
+; ADDOPS-LABEL: Classifying expressions for: @add_chain
+; ADDOPS: %x3 = add i32 %x2, %d
+; ADDOPS-NEXT: -->  (((%a + %b) + %c) + %d)
+; MULOPS-LABEL: Classifying expressions for: @add_chain
+; MULOPS: %x3 = add i32 %x2, %d
+; MULOPS-NEXT: -->  (%a + %b + %c + %d)
+
+define i32 @add_chain(i32 %a, i32 %b, i32 %c, i32 %d) {
+  %x1 = add i32 %a, %b
+  %x2 = add i32 %x1, %c
+  %x3 = add i32 %x2, %d
+  ret i32 %x3
+}
+
+; CHECK-LABEL: Classifying expressions for: @mul_chain
+; CHECK: %x3 = mul i32 %x2, %d
+; CHECK-NEXT: -->  (%a * %b * %c * %d)
+; ADDOPS-LABEL: Classifying expressions for: @mul_chain
+; ADDOPS: %x3 = mul i32 %x2, %d
+; ADDOPS-NEXT: -->  (%a * %b * %c * %d)
+; MULOPS-LABEL: Classifying expressions for: @mul_chain
+; MULOPS: %x3 = mul i32 %x2, %d
+; MULOPS-NEXT: -->  (((%a * %b) * %c) * %d)
+
+define i32 @mul_chain(i32 %a, i32 %b, i32 %c, i32 %d) {
+  %x1 = mul i32 %a, %b
+  %x2 = mul i32 %x1, %c
+  %x3 = mul i32 %x2, %d
+  ret i32 %x3
+}
@@ -0,0 +1,30 @@
+; RUN: opt < %s -analyze -scalar-evolution | FileCheck %s
+; RUN: opt < %s -analyze -scalar-evolution -scalar-evolution-max-creation-depth=3 | FileCheck %s --check-prefix=LIMIT
+
+; The block using the end of the chain is laid out first, so the SCEV of %r is
+; created before the ones of the chain and the analysis recurses all the way
+; down. Past the budget, the values are left as unknowns.
+
+; CHECK-LABEL: Classifying expressions for: @udiv_chain
+; CHECK: %r = udiv i32 %x4, %b
+; CHECK-NEXT: -->  (((((%a /u %b) /u %b) /u %b) /u %b) /u %b)
+
+; LIMIT-LABEL: Classifying expressions for: @udiv_chain
+; LIMIT: %r = udiv i32 %x4, %b
+; LIMIT-NEXT: -->  (((%x2 /u %b) /u %b) /u %b)
+
+define i32 @udiv_chain(i32 %a, i32 %b) {
+entry:
+  br label %chain
+
+use:
+  %r = udiv i32 %x4, %b
+  ret i32 %r
+
+chain:
+  %x1 = udiv i32 %a, %b
+  %x2 = udiv i32 %x1, %b
+  %x3 = udiv i32 %x2, %b
+  %x4 = udiv i32 %x3, %b
+  br label %use
+}
@@ -0,0 +1,60 @@
+; RUN: llvm-as < %s > %t.bc
+; RUN: opt -S -bitcode-decode-threads=2 %t.bc -o %t.threads.ll
+; RUN: opt -S %t.bc -o %t.serial.ll
+; RUN: diff %t.serial.ll %t.threads.ll
+; RUN: FileCheck %s < %t.threads.ll
+
+; Check that function blocks decoded ahead of time on worker threads are
+; materialized exactly like the ones read serially.
+
+@g = global i32 0
+
+; CHECK-LABEL: define i32 @f(i32 %x)
+; CHECK: %cmp = icmp sgt i32 %x, 42
+; CHECK: %r = phi i32 [ %x, %then ], [ 7, %entry ]
+; CHECK: store i32 %r, i32* @g, !tbaa !0
+define i32 @f(i32 %x) {
+entry:
+  %cmp = icmp sgt i32 %x, 42
+  br i1 %cmp, label %then, label %exit
+
+then:
+  br label %exit
+
+exit:
+  %r = phi i32 [ %x, %then ], [ 7, %entry ]
+  store i32 %r, i32* @g, !tbaa !0
+  ret i32 %r
+}
+
+; CHECK-LABEL: define i8* @blockaddr()
+; CHECK: ret i8* blockaddress(@target, %bb)
+define i8* @blockaddr() {
+  ret i8* blockaddress(@target, %bb)
+}
+
+declare void @decl()
+
+; CHECK-LABEL: define void @target()
+; CHECK: call void @decl()
+define void @target() {
+entry:
+  br label %bb
+
+bb:
+  call void @decl()
+  ret void
+}
+
+; CHECK-LABEL: define float @constants()
+; CHECK: fadd float 1.500000e+00, %v
+define float @constants() {
+  %v = load float, float* bitcast (i32* @g to float*)
+  %s = fadd float 1.5, %v
+  ret float %s
+}
+
+; CHECK: !0 = !{!1, !1, i64 0}
+!0 = !{!1, !1, i64 0}
+!1 = !{!"int", !2}
+!2 = !{!"tbaa root"}
@@ -0,0 +1,32 @@
+; REQUIRES: asserts
+; Check that opt flushes the bitcode to a seekable output file while it is
+; being written, with both pass managers, and that the result is the same as
+; when all of it is buffered.
+; RUN: llvm-as %s -o %t.buffered.bc
+; RUN: opt -bitcode-flush-threshold=0 -stats %s -o %t.legacy.bc 2>&1 \
+; RUN:   | FileCheck --check-prefix=FLUSH %s
+; RUN: cmp %t.legacy.bc %t.buffered.bc
+; RUN: opt -passes=verify -bitcode-flush-threshold=0 -stats %s -o %t.newpm.bc \
+; RUN:   2>&1 | FileCheck --check-prefix=FLUSH %s
+; RUN: cmp %t.newpm.bc %t.buffered.bc
+
+; Pipes are not seekable, so the bitcode written to one is buffered.
+; RUN: opt -bitcode-flush-threshold=0 -stats %s -o - 2> %t.pipe.stats | cat \
+; RUN:   > %t.pipe.bc
+; RUN: not grep bitcode-writer %t.pipe.stats
+; RUN: cmp %t.pipe.bc %t.buffered.bc
+
+; FLUSH: 3 bitcode-writer - Number of times bitcode was flushed to the output file
+
+@g = global i32 42
+
+define i32 @f(i32 %x) {
+  %v = load i32, i32* @g
+  %r = add i32 %v, %x
+  ret i32 %r
+}
+
+define i32 @h() {
+  %r = call i32 @f(i32 1)
+  ret i32 %r
+}
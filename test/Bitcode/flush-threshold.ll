@@ -0,0 +1,26 @@
+; Check that flushing the bitcode to the output file while it is being written
+; produces the same file as buffering all of it.
+; RUN: llvm-as -bitcode-flush-threshold=0 %s -o %t.flushed.bc
+; RUN: llvm-as %s -o %t.buffered.bc
+; RUN: cmp %t.flushed.bc %t.buffered.bc
+; RUN: llvm-dis %t.flushed.bc -o - | FileCheck %s
+
+; CHECK: @g = global i32 42
+@g = global i32 42
+
+; CHECK: define i32 @f(i32 %x)
+define i32 @f(i32 %x) {
+  %v = load i32, i32* @g, !tbaa !0
+  %r = add i32 %v, %x
+  ret i32 %r
+}
+
+; CHECK: define i32 @h()
+define i32 @h() {
+  %r = call i32 @f(i32 1)
+  ret i32 %r
+}
+
+!0 = !{!1, !1, i64 0}
+!1 = !{!"int", !2}
+!2 = !{!"root"}
@@ -0,0 +1,44 @@
+; RUN: llc -O0 -global-isel %s -o - | FileCheck %s
+; REQUIRES: global-isel
+; This file checks that functions go all the way from LLVM IR to assembly
+; through the IRTranslator, the legalizer, RegBankSelect and the instruction
+; selector.
+target datalayout = "e-m:o-i64:64-i128:128-n32:64-S128"
+target triple = "aarch64-apple-ios"
+
+; CHECK-LABEL: addi32:
+; CHECK: add w0, w0, w1
+; CHECK-NEXT: ret
+define i32 @addi32(i32 %arg1, i32 %arg2) {
+  %res = add i32 %arg1, %arg2
+  ret i32 %res
+}
+
+; CHECK-LABEL: addi64:
+; CHECK: add x0, x0, x1
+; CHECK-NEXT: ret
+define i64 @addi64(i64 %arg1, i64 %arg2) {
+  %res = add i64 %arg1, %arg2
+  ret i64 %res
+}
+
+; CHECK-LABEL: ori64:
+; CHECK: orr x0, x0, x1
+; CHECK-NEXT: ret
+define i64 @ori64(i64 %arg1, i64 %arg2) {
+  %res = or i64 %arg1, %arg2
+  ret i64 %res
+}
+
+; CHECK-LABEL: uncondbr:
+; CHECK: b [[END:LBB[0-9_]+]]
+; CHECK: [[END]]:
+; CHECK: orr w0, w{{[0-9]+}}, w{{[0-9]+}}
+; CHECK: ret
+define i32 @uncondbr(i32 %arg1, i32 %arg2) {
+entry:
+  br label %end
+end:
+  %res = or i32 %arg1, %arg2
+  ret i32 %res
+}
@@ -0,0 +1,37 @@
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu < %s | FileCheck %s
+
+declare void @b()
+
+define void @a() {
+  call void @b()
+  ret void
+}
+
+define void @freq(i1 %cond) {
+  br i1 %cond, label %A, label %B
+A:
+  call void @a();
+  ret void
+B:
+  call void @b();
+  ret void
+}
+
+!llvm.module.flags = !{!0}
+
+!0 = !{i32 5, !"CG Profile", !1}
+!1 = !{!2, !3, !4}
+!2 = !{void ()* @a, void ()* @b, i64 32}
+!3 = !{void (i1)* @freq, void ()* @a, i64 11}
+!4 = !{void (i1)* @freq, void ()* @b, i64 20}
+
+; CHECK: .section ".llvm.call-graph-profile","e",@progbits
+; CHECK-NEXT: .asciz "a"
+; CHECK-NEXT: .asciz "b"
+; CHECK-NEXT: .quad 32
+; CHECK-NEXT: .asciz "freq"
+; CHECK-NEXT: .asciz "a"
+; CHECK-NEXT: .quad 11
+; CHECK-NEXT: .asciz "freq"
+; CHECK-NEXT: .asciz "b"
+; CHECK-NEXT: .quad 20
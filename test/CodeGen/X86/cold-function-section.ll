@@ -0,0 +1,39 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-linux -function-sections | FileCheck %s --check-prefix=SECTIONS
+
+; Functions with the .unlikely section prefix, like the cold regions split out
+; by -hotcoldsplit, are kept out of the hot text. The cold attribute alone does
+; not move a function.
+
+; CHECK: .text
+; CHECK-LABEL: hot:
+; CHECK-NOT: .section
+; CHECK-LABEL: cold:
+; CHECK: .section .text.unlikely,"ax",@progbits
+; CHECK-LABEL: split:
+
+; SECTIONS: .section .text.hot,"ax",@progbits
+; SECTIONS-LABEL: hot:
+; SECTIONS: .section .text.cold,"ax",@progbits
+; SECTIONS-LABEL: cold:
+; SECTIONS: .section .text.unlikely.split,"ax",@progbits
+; SECTIONS-LABEL: split:
+
+define void @hot() {
+  ret void
+}
+
+define void @cold() cold {
+  ret void
+}
+
+define internal void @split() cold !section_prefix !0 {
+  ret void
+}
+
+define void @use() {
+  call void @split()
+  ret void
+}
+
+!0 = !{!"function_section_prefix", !".unlikely"}
@@ -0,0 +1,184 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux -enable-machine-outliner -verify-machineinstrs | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-linux -verify-machineinstrs | FileCheck %s --check-prefix=NOOUTLINE
+
+@x = global i32 0
+@y = global i32 0
+@z = global i32 0
+
+declare void @f()
+
+; The three stores are repeated between the calls, so they are outlined into
+; a block at the end of the function. Without a frame pointer, the outlined
+; block redefines the CFA offset to account for the pushed return address.
+; CHECK-LABEL: repeated:
+; CHECK: .cfi_def_cfa_offset 16
+; CHECK: callq f
+; CHECK-NEXT: callq [[OUTLINED:.LBB[0-9_]+]]
+; CHECK-NEXT: callq f
+; CHECK-NEXT: callq [[OUTLINED]]
+; CHECK-NEXT: callq f
+; CHECK-NEXT: callq [[OUTLINED]]
+; CHECK: retq
+; CHECK: [[OUTLINED]]:
+; CHECK-NEXT: .Ltmp{{[0-9]+}}:
+; CHECK-NEXT: .cfi_def_cfa_offset 24
+; CHECK-NEXT: movl $1, x(%rip)
+; CHECK-NEXT: movl $2, y(%rip)
+; CHECK-NEXT: movl $3, z(%rip)
+; CHECK-NEXT: retq
+
+; NOOUTLINE-LABEL: repeated:
+; NOOUTLINE-NOT: callq .LBB
+define void @repeated() {
+entry:
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  ret void
+}
+
+; Leaf functions may use the red zone, which a call would clobber.
+; CHECK-LABEL: leaf:
+; CHECK-NOT: callq
+; CHECK: retq
+define void @leaf() {
+entry:
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  store volatile i32 4, i32* @x
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  store volatile i32 4, i32* @x
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  ret void
+}
+
+; Code in loops is never outlined.
+; CHECK-LABEL: loop:
+; CHECK-NOT: callq .LBB
+; CHECK: retq
+define void @loop(i32 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret void
+}
+
+; With a frame pointer the CFA doesn't move, so no CFI is needed.
+; CHECK-LABEL: frame_pointer:
+; CHECK: callq [[OUTLINED:.LBB[0-9_]+]]
+; CHECK: retq
+; CHECK: [[OUTLINED]]:
+; CHECK-NEXT: movl $1, x(%rip)
+; CHECK-NEXT: movl $2, y(%rip)
+; CHECK-NEXT: movl $3, z(%rip)
+; CHECK-NEXT: retq
+define void @frame_pointer() #0 {
+entry:
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  ret void
+}
+
+; With profile data, hot code is that with a hot count in the profile summary.
+; CHECK-LABEL: hot_profile:
+; CHECK-NOT: callq .LBB
+; CHECK: retq
+define void @hot_profile() !prof !15 {
+entry:
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  ret void
+}
+
+; CHECK-LABEL: warm_profile:
+; CHECK: callq [[OUTLINED:.LBB[0-9_]+]]
+; CHECK: [[OUTLINED]]:
+define void @warm_profile() !prof !16 {
+entry:
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  call void @f()
+  store volatile i32 1, i32* @x
+  store volatile i32 2, i32* @y
+  store volatile i32 3, i32* @z
+  ret void
+}
+
+attributes #0 = { "no-frame-pointer-elim"="true" }
+
+!llvm.module.flags = !{!0}
+!0 = !{i32 1, !"ProfileSummary", !1}
+!1 = !{!2, !3, !4, !5, !6, !7, !8, !9}
+!2 = !{!"ProfileFormat", !"InstrProf"}
+!3 = !{!"TotalCount", i64 10000}
+!4 = !{!"MaxCount", i64 1000}
+!5 = !{!"MaxInternalCount", i64 1}
+!6 = !{!"MaxFunctionCount", i64 1000}
+!7 = !{!"NumCounts", i64 3}
+!8 = !{!"NumFunctions", i64 3}
+!9 = !{!"DetailedSummary", !10}
+!10 = !{!11, !12, !13}
+!11 = !{i32 10000, i64 100, i32 1}
+!12 = !{i32 999000, i64 100, i32 1}
+!13 = !{i32 999999, i64 1, i32 2}
+!15 = !{!"function_entry_count", i64 1000}
+!16 = !{!"function_entry_count", i64 10}
@@ -0,0 +1,28 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -debug-only=misched \
+; RUN:   -dag-maps-max-fan-in=2 -o /dev/null 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+; All six loads share an underlying object, more than the fan-in limit. Only
+; the lists of stores are shortened, so the loads stay unordered and none of
+; them gets a chain edge.
+
+@g = global [6 x i32] zeroinitializer
+
+; CHECK-LABEL: ********** MI Scheduling **********
+; CHECK: SU(0): {{.*}} = MOV32rm
+; CHECK-NOT: ch  SU({{[0-9]}})
+; CHECK: = COPY
+define i32 @f() {
+  %a = load i32, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 0)
+  %b = load i32, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 1)
+  %c = load i32, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 2)
+  %d = load i32, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 3)
+  %e = load i32, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 4)
+  %f = load i32, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 5)
+  %s1 = mul i32 %a, %b
+  %s2 = mul i32 %c, %d
+  %s3 = mul i32 %e, %f
+  %s4 = xor i32 %s1, %s2
+  %s5 = xor i32 %s4, %s3
+  ret i32 %s5
+}
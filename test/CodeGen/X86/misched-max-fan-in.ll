@@ -0,0 +1,29 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -debug-only=misched \
+; RUN:   -dag-maps-max-fan-in=2 -o /dev/null 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+; All six stores share an underlying object. Without a limit the first store
+; gets a chain edge to each of the five stores below it. With the limit, it
+; gets edges only to the two newest stores mapped to @g and to the chain
+; that the older stores are ordered after.
+
+@g = global [6 x i32] zeroinitializer
+
+; CHECK-LABEL: ********** MI Scheduling **********
+; CHECK: MOV32mr
+; CHECK: # succs left : 3
+; CHECK: Successors:
+; CHECK-NEXT: ch SU
+; CHECK-NEXT: ch SU
+; CHECK-NEXT: ch SU
+; CHECK-NOT: ch SU
+; CHECK: MOV32mr
+define void @f(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e, i32 %f) {
+  store i32 %a, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 0)
+  store i32 %b, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 1)
+  store i32 %c, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 2)
+  store i32 %d, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 3)
+  store i32 %e, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 4)
+  store i32 %f, i32* getelementptr ([6 x i32], [6 x i32]* @g, i64 0, i64 5)
+  ret void
+}
@@ -0,0 +1,60 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -regalloc=greedy -stats 2>&1 | FileCheck %s --check-prefix=UNLIMITED
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -regalloc=greedy -stats -regalloc-work-budget=1 2>&1 | FileCheck %s --check-prefix=FUNCTION
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -regalloc=greedy -stats -regalloc-live-range-work-budget=1 2>&1 | FileCheck %s --check-prefix=RANGE
+; REQUIRES: asserts
+
+; Check that the greedy allocator stops splitting live ranges once it has
+; spent its work budget, and spills them instead.
+
+; UNLIMITED-NOT: exhausted the allocation work budget
+; UNLIMITED-NOT: spilled without splitting to stay in budget
+; UNLIMITED: Number of split global live ranges
+
+; FUNCTION-DAG: 1 regalloc {{.*}} Number of functions that exhausted the allocation work budget
+; FUNCTION-DAG: regalloc {{.*}} Number of live ranges spilled without splitting to stay in budget
+
+; RANGE-NOT: exhausted the allocation work budget
+; RANGE: regalloc {{.*}} Number of live ranges spilled without splitting to stay in budget
+
+declare void @clobber()
+
+define void @pressure(i64* %p, i32 %n) {
+entry:
+  %a0 = load volatile i64, i64* %p
+  %a1 = load volatile i64, i64* %p
+  %a2 = load volatile i64, i64* %p
+  %a3 = load volatile i64, i64* %p
+  %a4 = load volatile i64, i64* %p
+  %a5 = load volatile i64, i64* %p
+  %a6 = load volatile i64, i64* %p
+  %a7 = load volatile i64, i64* %p
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %s0 = add i64 %a0, %a1
+  %s1 = add i64 %a2, %a3
+  store volatile i64 %s0, i64* %p
+  store volatile i64 %s1, i64* %p
+  %odd = and i32 %i, 1
+  %c = icmp eq i32 %odd, 0
+  br i1 %c, label %call, label %latch
+
+call:
+  call void @clobber()
+  br label %latch
+
+latch:
+  %s2 = add i64 %a4, %a5
+  %s3 = add i64 %a6, %a7
+  store volatile i64 %s2, i64* %p
+  store volatile i64 %s3, i64* %p
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  store volatile i64 %a0, i64* %p
+  store volatile i64 %a7, i64* %p
+  ret void
+}
@@ -0,0 +1,85 @@
+; REQUIRES: object-emission
+
+; RUN: llc -split-dwarf=Enable -filetype=obj -O0 -generate-type-units -mtriple=x86_64-unknown-linux-gnu < %s \
+; RUN:     | llvm-dwarfdump - > %t.tu
+; RUN: FileCheck --check-prefix=S1 < %t.tu %s
+; RUN: FileCheck --check-prefix=S2 < %t.tu %s
+; RUN: FileCheck --check-prefix=S3 < %t.tu %s
+
+; RUN: llc -split-dwarf=Enable -filetype=obj -O0 -mtriple=x86_64-unknown-linux-gnu < %s \
+; RUN:     | llvm-dwarfdump - > %t.notu
+; RUN: FileCheck --check-prefix=S1 < %t.notu %s
+; RUN: FileCheck --check-prefix=S2 < %t.notu %s
+; RUN: FileCheck --check-prefix=S3 < %t.notu %s
+
+; A type that cannot be placed in a type unit because it refers to an address,
+; directly or through a member, is emitted exactly once in the compile unit no
+; matter how often it is referenced.
+
+; Test case built from:
+;int i;
+;
+;template <int *I>
+;struct S1 {};
+;
+;struct S2 {
+;  S1<&i> s1;
+;};
+;
+;struct S3 {
+;  S2 s2;
+;};
+;
+;S2 a;
+;S2 b;
+;S3 c;
+
+; S1-NOT: DW_AT_name {{.*}}"S1<&i>"
+; S1: .debug_info.dwo contents:
+; S1: DW_AT_name {{.*}}"S1<&i>"
+; S1-NOT: DW_AT_name {{.*}}"S1<&i>"
+
+; S2-NOT: DW_AT_name {{.*}}"S2"
+; S2: .debug_info.dwo contents:
+; S2: DW_AT_name {{.*}}"S2"
+; S2-NOT: DW_AT_name {{.*}}"S2"
+
+; S3-NOT: DW_AT_name {{.*}}"S3"
+; S3: .debug_info.dwo contents:
+; S3: DW_AT_name {{.*}}"S3"
+; S3-NOT: DW_AT_name {{.*}}"S3"
+
+%struct.S2 = type { %struct.S1 }
+%struct.S1 = type { i8 }
+%struct.S3 = type { %struct.S2 }
+
+@i = global i32 0, align 4
+@a = global %struct.S2 zeroinitializer, align 1
+@b = global %struct.S2 zeroinitializer, align 1
+@c = global %struct.S3 zeroinitializer, align 1
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!20, !21}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus, producer: "clang version 3.9.0 ", isOptimized: false, splitDebugFilename: "tu.dwo", emissionKind: FullDebug, file: !1, enums: !2, retainedTypes: !3, globals: !14)
+!1 = !DIFile(filename: "tu.cpp", directory: "/tmp/dbginfo")
+!2 = !{}
+!3 = !{!4, !9, !11}
+!4 = !DICompositeType(tag: DW_TAG_structure_type, name: "S1<&i>", line: 4, size: 8, align: 8, file: !1, elements: !2, templateParams: !5, identifier: "_ZTS2S1IXadL_Z1iEEE")
+!5 = !{!6}
+!6 = !DITemplateValueParameter(tag: DW_TAG_template_value_parameter, name: "I", type: !7, value: i32* @i)
+!7 = !DIDerivedType(tag: DW_TAG_pointer_type, size: 64, align: 64, baseType: !8)
+!8 = !DIBasicType(tag: DW_TAG_base_type, name: "int", size: 32, align: 32, encoding: DW_ATE_signed)
+!9 = !DICompositeType(tag: DW_TAG_structure_type, name: "S2", line: 6, size: 8, align: 8, file: !1, elements: !10, identifier: "_ZTS2S2")
+!10 = !{!12}
+!11 = !DICompositeType(tag: DW_TAG_structure_type, name: "S3", line: 10, size: 8, align: 8, file: !1, elements: !13, identifier: "_ZTS2S3")
+!12 = !DIDerivedType(tag: DW_TAG_member, name: "s1", line: 7, size: 8, align: 8, file: !1, scope: !9, baseType: !4)
+!13 = !{!19}
+!14 = !{!15, !16, !17, !18}
+!15 = !DIGlobalVariable(name: "i", line: 1, isLocal: false, isDefinition: true, scope: null, file: !1, type: !8, variable: i32* @i)
+!16 = !DIGlobalVariable(name: "a", line: 14, isLocal: false, isDefinition: true, scope: null, file: !1, type: !9, variable: %struct.S2* @a)
+!17 = !DIGlobalVariable(name: "b", line: 15, isLocal: false, isDefinition: true, scope: null, file: !1, type: !9, variable: %struct.S2* @b)
+!18 = !DIGlobalVariable(name: "c", line: 16, isLocal: false, isDefinition: true, scope: null, file: !1, type: !11, variable: %struct.S3* @c)
+!19 = !DIDerivedType(tag: DW_TAG_member, name: "s2", line: 11, size: 8, align: 8, file: !1, scope: !11, baseType: !9)
+!20 = !{i32 2, !"Dwarf Version", i32 4}
+!21 = !{i32 1, !"Debug Info Version", i32 3}
@@ -0,0 +1,44 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=main -enable-call-graph-profile -o %t.o %t.bc \
+; RUN:   -function-order-file=%t.order
+; RUN: FileCheck %s < %t.order
+
+; The hot call chain is laid out together, in call order, and the function
+; called from the cold path comes after it.
+; CHECK: main
+; CHECK-NEXT: hot1
+; CHECK-NEXT: hot2
+; CHECK-NEXT: cold
+
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @main(i32 %n) noinline !prof !0 {
+entry:
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %rare, label %common, !prof !2
+rare:
+  call void @cold()
+  ret i32 1
+common:
+  call void @hot1()
+  ret i32 0
+}
+
+define internal void @hot1() noinline !prof !0 {
+  call void @hot2()
+  ret void
+}
+
+define internal void @hot2() noinline !prof !0 {
+  call void asm sideeffect "", ""()
+  ret void
+}
+
+define internal void @cold() noinline !prof !1 {
+  call void asm sideeffect "", ""()
+  ret void
+}
+
+!0 = !{!"function_entry_count", i64 1000}
+!1 = !{!"function_entry_count", i64 1}
+!2 = !{!"branch_weights", i32 10, i32 1000}
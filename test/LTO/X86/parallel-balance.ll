@@ -0,0 +1,52 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=big -exported-symbol=small1 \
+; RUN:   -exported-symbol=small2 -exported-symbol=small3 -j2 \
+; RUN:   -lto-balance-partitions -o %t.o %t.bc
+; RUN: llvm-nm %t.o.0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-nm %t.o.1 | FileCheck --check-prefix=CHECK1 %s
+
+; With -lto-balance-partitions, parallel code generation balances the
+; partitions by size: the large function gets a partition of its own, and the
+; small ones are packed into the other.
+
+; FIXME: Investigate test failures on these architecures.
+; UNSUPPORTED: mips, mipsel, aarch64, powerpc64
+
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK0: T big
+; CHECK0-NOT: T small
+
+; CHECK1-NOT: T big
+; CHECK1: T small1
+; CHECK1: T small2
+; CHECK1: T small3
+
+declare void @ext(i32)
+
+define void @big() {
+  call void @ext(i32 0)
+  call void @ext(i32 1)
+  call void @ext(i32 2)
+  call void @ext(i32 3)
+  call void @ext(i32 4)
+  call void @ext(i32 5)
+  call void @ext(i32 6)
+  call void @ext(i32 7)
+  ret void
+}
+
+define void @small1() {
+  call void @ext(i32 8)
+  ret void
+}
+
+define void @small2() {
+  call void @ext(i32 9)
+  ret void
+}
+
+define void @small3() {
+  call void @ext(i32 10)
+  ret void
+}
@@ -0,0 +1,21 @@
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o - | llvm-readobj -s -sd | FileCheck %s
+
+// Test that a section is laid out again when relaxation changes the size of
+// a section its fragments refer to, even if that section comes later.
+
+        .data
+        .uleb128 end - start
+
+        .section .text.foo,"ax",@progbits
+start:
+        jmp end
+        .space 128
+end:
+        ret
+
+// CHECK:        Name: .data
+// CHECK:          SectionData (
+// CHECK-NEXT:       0000: 8501
+// CHECK-NEXT:     )
+// CHECK:        Name: .text.foo
+// CHECK:          Size: 134
@@ -0,0 +1,42 @@
+; RUN: opt -ir-memory-usage -disable-output %s 2>&1 | FileCheck %s
+; RUN: llvm-as < %s | opt -ir-memory-usage -disable-output 2>&1 | FileCheck %s
+; RUN: opt -ir-memory-usage -simplifycfg -disable-output %s 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=SIMPLIFY
+
+; CHECK: ir-memory-usage: after loading: 9 instructions, {{[0-9]+}} bytes, {{.*}}, 0 unused operand slots
+; CHECK: ir-memory-usage: after passes: 9 instructions, {{[0-9]+}} bytes, {{.*}}, 0 unused operand slots
+
+; SimplifyCFG drops the incoming values of the phi and the case of the switch
+; that come from the blocks it folds away, and must not keep the operand
+; space they occupied.
+; SIMPLIFY: ir-memory-usage: after loading: 9 instructions, {{.*}}, 0 unused operand slots
+; SIMPLIFY: ir-memory-usage: after passes: 8 instructions, {{.*}}, 0 unused operand slots
+
+define i32 @f(i32 %a, i32 %b) {
+  %x = add i32 %a, %b
+  %y = mul i32 %x, %a
+  ret i32 %y
+}
+
+define i32 @g(i32 %c, i32 %v) {
+entry:
+  switch i32 %c, label %exit [
+    i32 0, label %a
+    i32 1, label %b
+    i32 2, label %b
+    i32 3, label %dead
+  ]
+
+a:
+  br label %exit
+
+b:
+  br label %exit
+
+dead:
+  br i1 false, label %exit, label %b
+
+exit:
+  %p = phi i32 [ %v, %entry ], [ 1, %a ], [ 2, %b ], [ 3, %dead ]
+  ret i32 %p
+}
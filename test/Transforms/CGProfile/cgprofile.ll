@@ -0,0 +1,49 @@
+; RUN: opt < %s -cg-profile -S | FileCheck %s
+
+@foo = common global i32 ()* null, align 8
+declare i32 @func1()
+declare i32 @func2()
+declare i32 @func3()
+declare i32 @func4()
+declare void @llvm.donothing()
+
+define void @a() !prof !1 {
+  call void @b()
+  ret void
+}
+
+define void @b() {
+  ret void
+}
+
+define void @freq(i1 %cond) !prof !1 {
+  %tmp = load i32 ()*, i32 ()** @foo, align 8
+  br i1 %cond, label %A, label %B, !prof !2
+A:
+  call void @a();
+  ret void
+B:
+  call void @b();
+  %call = call i32 %tmp(), !prof !3
+  call void @llvm.donothing()
+  ret void
+}
+
+; A function without an entry count contributes no edges.
+define void @noprof() {
+  call void @a()
+  ret void
+}
+
+!1 = !{!"function_entry_count", i64 32}
+!2 = !{!"branch_weights", i32 5, i32 10}
+!3 = !{!"VP", i32 0, i64 1600, i64 7651369219802541373, i64 1030, i64 -4377547752858689819, i64 410}
+
+; CHECK: !llvm.module.flags = !{[[FLAG:![0-9]+]]}
+; CHECK: [[FLAG]] = !{i32 5, !"CG Profile", [[PROF:![0-9]+]]}
+; CHECK: [[PROF]] = !{[[E0:![0-9]+]], [[E1:![0-9]+]], [[E2:![0-9]+]], [[E3:![0-9]+]], [[E4:![0-9]+]]}
+; CHECK: [[E0]] = !{void ()* @a, void ()* @b, i64 32}
+; CHECK: [[E1]] = !{void (i1)* @freq, void ()* @a, i64 11}
+; CHECK: [[E2]] = !{void (i1)* @freq, void ()* @b, i64 20}
+; CHECK: [[E3]] = !{void (i1)* @freq, i32 ()* @func4, i64 1030}
+; CHECK: [[E4]] = !{void (i1)* @freq, i32 ()* @func2, i64 410}
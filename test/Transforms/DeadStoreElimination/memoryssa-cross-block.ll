@@ -0,0 +1,161 @@
+; RUN: opt < %s -basicaa -dse -enable-dse-memoryssa -S | FileCheck %s
+; RUN: opt < %s -aa-pipeline=basic-aa -passes=dse -enable-dse-memoryssa -S | FileCheck %s
+
+declare void @f() nounwind
+
+; The first store is overwritten on both sides of the diamond.
+define void @diamond(i32* noalias %p, i32* noalias %q, i1 %c) {
+; CHECK-LABEL: @diamond(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: br i1 %c
+entry:
+  store i32 1, i32* %p
+  br i1 %c, label %then, label %else
+
+then:
+  store i32 2, i32* %q
+  br label %exit
+
+else:
+  %v = load i32, i32* %q
+  br label %exit
+
+exit:
+; CHECK: exit:
+; CHECK-NEXT: store i32 3, i32* %p
+  store i32 3, i32* %p
+  ret void
+}
+
+; A call that does not access memory may still never return, after which the
+; first store to the global stays visible.
+@g = global i32 0
+
+define void @readnone_call(i1 %c) {
+; CHECK-LABEL: @readnone_call(
+; CHECK: store i32 1, i32* @g
+; CHECK: store i32 3, i32* @g
+entry:
+  store i32 1, i32* @g
+  br i1 %c, label %then, label %exit
+
+then:
+  call void @f() readnone
+  br label %exit
+
+exit:
+  store i32 3, i32* @g
+  ret void
+}
+
+define void @readnone_call_same_block(i1 %c) {
+; CHECK-LABEL: @readnone_call_same_block(
+; CHECK: store i32 1, i32* @g
+; CHECK: store i32 3, i32* @g
+entry:
+  store i32 1, i32* @g
+  call void @f() readnone
+  br i1 %c, label %then, label %exit
+
+then:
+  br label %exit
+
+exit:
+  store i32 3, i32* @g
+  ret void
+}
+
+; Nothing can see the store to a local object that does not escape.
+define i32 @readnone_call_local(i1 %c) {
+; CHECK-LABEL: @readnone_call_local(
+; CHECK-NOT: store i32 1
+; CHECK: store i32 3, i32* %a
+entry:
+  %a = alloca i32
+  store i32 1, i32* %a
+  br i1 %c, label %then, label %exit
+
+then:
+  call void @f() readnone
+  br label %exit
+
+exit:
+  store i32 3, i32* %a
+  %v = load i32, i32* %a
+  ret i32 %v
+}
+
+; The store is read on one side of the diamond.
+define i32 @read_in_branch(i32* noalias %p, i1 %c) {
+; CHECK-LABEL: @read_in_branch(
+; CHECK: store i32 1, i32* %p
+; CHECK: store i32 3, i32* %p
+entry:
+  store i32 1, i32* %p
+  br i1 %c, label %then, label %exit
+
+then:
+  %v = load i32, i32* %p
+  br label %exit
+
+exit:
+  %r = phi i32 [ %v, %then ], [ 0, %entry ]
+  store i32 3, i32* %p
+  ret i32 %r
+}
+
+; The later store does not post-dominate the first one.
+define void @not_post_dominated(i32* %p, i1 %c) {
+; CHECK-LABEL: @not_post_dominated(
+; CHECK: store i32 1, i32* %p
+; CHECK: store i32 3, i32* %p
+entry:
+  store i32 1, i32* %p
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 3, i32* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A call that may read the location keeps the store alive.
+define void @call_in_between(i32* %p, i1 %c) {
+; CHECK-LABEL: @call_in_between(
+; CHECK: store i32 1, i32* %p
+; CHECK: store i32 3, i32* %p
+entry:
+  store i32 1, i32* %p
+  br i1 %c, label %then, label %exit
+
+then:
+  call void @f()
+  br label %exit
+
+exit:
+  store i32 3, i32* %p
+  ret void
+}
+
+; A store in a loop may write a different address on every iteration.
+define void @loop(i32* %p, i64 %n) {
+; CHECK-LABEL: @loop(
+; CHECK: store i32 1, i32* %gep
+; CHECK: store i32 3, i32* %gep
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %gep = getelementptr i32, i32* %p, i64 %i
+  store i32 1, i32* %gep
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  store i32 3, i32* %gep
+  ret void
+}
@@ -0,0 +1,78 @@
+; RUN: opt -hotcoldsplit -S < %s | FileCheck %s
+
+; The error path of @foo never runs according to the profile, so it is moved
+; to a separate cold function.
+
+; CHECK-LABEL: define void @foo(
+; CHECK: br i1 %cmp, label %[[COLD:.*]], label %hot
+; CHECK: [[COLD]]:
+; CHECK-NEXT: call void @foo_error(
+; CHECK-NOT: call void @report
+
+declare void @report(i32)
+declare void @work(i32)
+
+define void @foo(i32 %x, i32 %y) #0 !prof !20 {
+entry:
+  %cmp = icmp eq i32 %x, 0
+  br i1 %cmp, label %error, label %hot, !prof !21
+
+error:
+  %z = add i32 %x, %y
+  call void @report(i32 %x)
+  call void @report(i32 %y)
+  call void @report(i32 %z)
+  br label %hot
+
+hot:
+  call void @work(i32 %y)
+  ret void
+}
+
+; A function without profile data is left alone.
+; CHECK-LABEL: define void @noprofile(
+; CHECK: call void @report(i32 %x)
+define void @noprofile(i32 %x, i32 %y) {
+entry:
+  %cmp = icmp eq i32 %x, 0
+  br i1 %cmp, label %error, label %hot
+
+error:
+  call void @report(i32 %x)
+  call void @report(i32 %y)
+  call void @report(i32 %x)
+  br label %hot
+
+hot:
+  ret void
+}
+
+; The outlined function is added at the end of the module.
+; CHECK-LABEL: define internal void @foo_error(
+; CHECK-SAME: !section_prefix ![[PREFIX:[0-9]+]]
+; CHECK: call void @report(i32 %x)
+; CHECK: call void @report(i32 %y)
+; CHECK: call void @report(i32 %z)
+; CHECK: attributes #{{[0-9]+}} = { cold noinline {{.*}}"target-cpu"="x86-64"
+; CHECK: ![[PREFIX]] = !{!"function_section_prefix", !".unlikely"}
+
+attributes #0 = { "target-cpu"="x86-64" }
+
+!llvm.module.flags = !{!1}
+!20 = !{!"function_entry_count", i64 1000}
+!21 = !{!"branch_weights", i32 0, i32 1000}
+
+!1 = !{i32 1, !"ProfileSummary", !2}
+!2 = !{!3, !4, !5, !6, !7, !8, !9, !10}
+!3 = !{!"ProfileFormat", !"InstrProf"}
+!4 = !{!"TotalCount", i64 10000}
+!5 = !{!"MaxCount", i64 1000}
+!6 = !{!"MaxInternalCount", i64 1}
+!7 = !{!"MaxFunctionCount", i64 1000}
+!8 = !{!"NumCounts", i64 3}
+!9 = !{!"NumFunctions", i64 3}
+!10 = !{!"DetailedSummary", !11}
+!11 = !{!12, !13, !14}
+!12 = !{i32 10000, i64 100, i32 1}
+!13 = !{i32 999000, i64 100, i32 1}
+!14 = !{i32 999999, i64 1, i32 2}
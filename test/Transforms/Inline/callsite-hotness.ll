@@ -0,0 +1,120 @@
+; RUN: opt < %s -inline -inline-threshold=20 -hot-callsite-threshold=3000 -S \
+; RUN:   | FileCheck %s
+; RUN: opt < %s -inline -inline-threshold=20 -S \
+; RUN:   | FileCheck --check-prefix=EXPLICIT %s
+; RUN: opt < %s -inline -inline-threshold=1000 \
+; RUN:   -inline-cold-callsite-threshold=10 -S | FileCheck --check-prefix=COLD %s
+; RUN: opt < %s -inline -inline-threshold=1000 -S \
+; RUN:   | FileCheck --check-prefix=EXPLICIT-COLD %s
+; Call sites are given a threshold from their profile: one in a hot loop gets
+; a bonus in proportion to its trip count, and a cold one gets the cold
+; callsite threshold. Like the cold callee threshold, an explicit
+; -inline-threshold overrides these unless they are given explicitly too.
+
+define i32 @callee(i32 %x) {
+  %a1 = add i32 %x, 1
+  %a2 = mul i32 %a1, %x
+  %a3 = xor i32 %a2, 7
+  %a4 = add i32 %a3, %a1
+  %a5 = mul i32 %a4, %a2
+  %a6 = xor i32 %a5, %a3
+  %a7 = add i32 %a6, %a4
+  %a8 = mul i32 %a7, %a5
+  ret i32 %a8
+}
+
+; CHECK-LABEL: @hot_loop(
+; CHECK: call i32 @callee(i32 %n)
+; CHECK: loop:
+; CHECK-NOT: call i32 @callee
+; CHECK: exit:
+; EXPLICIT-LABEL: @hot_loop(
+; EXPLICIT: loop:
+; EXPLICIT: call i32 @callee(i32 %i)
+; COLD-LABEL: @hot_loop(
+; COLD-NOT: call i32 @callee
+; COLD: ret i32
+define i32 @hot_loop(i32 %n) !prof !0 {
+entry:
+  %c0 = call i32 @callee(i32 %n)
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ %c0, %entry ], [ %s.next, %loop ]
+  %c = call i32 @callee(i32 %i)
+  %s.next = add i32 %s, %c
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit, !prof !1
+
+exit:
+  ret i32 %s.next
+}
+
+; CHECK-LABEL: @cold_branch(
+; CHECK: cold:
+; CHECK-NEXT: call i32 @callee(i32 %n)
+; COLD-LABEL: @cold_branch(
+; COLD: cold:
+; COLD-NEXT: call i32 @callee(i32 %n)
+; EXPLICIT-COLD-LABEL: @cold_branch(
+; EXPLICIT-COLD-NOT: call i32 @callee
+; EXPLICIT-COLD: ret i32
+define i32 @cold_branch(i32 %n) !prof !0 {
+entry:
+  %cmp = icmp eq i32 %n, 0
+  br i1 %cmp, label %cold, label %exit, !prof !2
+
+cold:
+  %c = call i32 @callee(i32 %n)
+  br label %exit
+
+exit:
+  %r = phi i32 [ %c, %cold ], [ 0, %entry ]
+  ret i32 %r
+}
+
+; The blocks inlined into a profiled caller take the frequency of the call site,
+; so the call inlined along with @wrapper still runs in the hot loop.
+; CHECK-LABEL: @hot_loop_wrapper(
+; CHECK: loop:
+; CHECK-NOT: call i32 @
+; CHECK: exit:
+define i32 @hot_loop_wrapper(i32 %n) !prof !0 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop.latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop.latch ]
+  %c = call i32 @wrapper(i32 %i)
+  br label %loop.latch
+
+loop.latch:
+  %s.next = add i32 %s, %c
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit, !prof !1
+
+exit:
+  ret i32 %s.next
+}
+
+define i32 @wrapper(i32 %x) {
+entry:
+  %pos = icmp sgt i32 %x, 0
+  br i1 %pos, label %call, label %done
+
+call:
+  %r = call i32 @callee(i32 %x)
+  br label %done
+
+done:
+  %p = phi i32 [ %r, %call ], [ 0, %entry ]
+  ret i32 %p
+}
+
+!0 = !{!"function_entry_count", i64 1000}
+!1 = !{!"branch_weights", i32 1000, i32 1}
+!2 = !{!"branch_weights", i32 1, i32 1000}
@@ -0,0 +1,277 @@
+; RUN: opt -S -loop-fusion < %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; for (i = 0; i < 100; ++i) A[i] = B[i] + 1;
+; for (i = 0; i < 100; ++i) C[i] = A[i] * 2;
+; The second loop reads what the first one stored in the same iteration.
+
+; CHECK-LABEL: @fuse_same_iteration(
+; CHECK: loop1:
+; CHECK: store i32 %add, i32* %arrayidx.a
+; CHECK: br label %loop2
+; CHECK-NOT: exit1:
+; CHECK: loop2:
+; CHECK: store i32 %mul, i32* %arrayidx.c
+; CHECK: br i1 %cond2, label %loop1, label %exit2
+
+define void @fuse_same_iteration(i32* noalias %A, i32* noalias %B,
+                                 i32* noalias %C) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %arrayidx.b = getelementptr inbounds i32, i32* %B, i64 %i
+  %b = load i32, i32* %arrayidx.b, align 4
+  %add = add nsw i32 %b, 1
+  %arrayidx.a = getelementptr inbounds i32, i32* %A, i64 %i
+  store i32 %add, i32* %arrayidx.a, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp ne i64 %i.next, 100
+  br i1 %cond1, label %loop1, label %exit1
+
+exit1:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %exit1 ], [ %j.next, %loop2 ]
+  %arrayidx.a2 = getelementptr inbounds i32, i32* %A, i64 %j
+  %a = load i32, i32* %arrayidx.a2, align 4
+  %mul = shl nsw i32 %a, 1
+  %arrayidx.c = getelementptr inbounds i32, i32* %C, i64 %j
+  store i32 %mul, i32* %arrayidx.c, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp ne i64 %j.next, 100
+  br i1 %cond2, label %loop2, label %exit2
+
+exit2:
+  ret void
+}
+
+; The second loop reads A[j + 1], which the first loop only stores in a later
+; iteration.
+
+; CHECK-LABEL: @backward_dependence(
+; CHECK: br i1 %cond1, label %loop1, label %exit1
+
+define void @backward_dependence(i32* noalias %A, i32* noalias %B,
+                                 i32* noalias %C) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %arrayidx.b = getelementptr inbounds i32, i32* %B, i64 %i
+  %b = load i32, i32* %arrayidx.b, align 4
+  %arrayidx.a = getelementptr inbounds i32, i32* %A, i64 %i
+  store i32 %b, i32* %arrayidx.a, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp ne i64 %i.next, 100
+  br i1 %cond1, label %loop1, label %exit1
+
+exit1:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %exit1 ], [ %j.next, %loop2 ]
+  %j.next = add nuw nsw i64 %j, 1
+  %arrayidx.a2 = getelementptr inbounds i32, i32* %A, i64 %j.next
+  %a = load i32, i32* %arrayidx.a2, align 4
+  %arrayidx.c = getelementptr inbounds i32, i32* %C, i64 %j
+  store i32 %a, i32* %arrayidx.c, align 4
+  %cond2 = icmp ne i64 %j.next, 100
+  br i1 %cond2, label %loop2, label %exit2
+
+exit2:
+  ret void
+}
+
+; The loops run a different number of iterations.
+
+; CHECK-LABEL: @different_trip_counts(
+; CHECK: br i1 %cond1, label %loop1, label %exit1
+
+define void @different_trip_counts(i32* noalias %A, i32* noalias %C) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %arrayidx.a = getelementptr inbounds i32, i32* %A, i64 %i
+  store i32 0, i32* %arrayidx.a, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp ne i64 %i.next, 100
+  br i1 %cond1, label %loop1, label %exit1
+
+exit1:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %exit1 ], [ %j.next, %loop2 ]
+  %arrayidx.c = getelementptr inbounds i32, i32* %C, i64 %j
+  store i32 1, i32* %arrayidx.c, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp ne i64 %j.next, 200
+  br i1 %cond2, label %loop2, label %exit2
+
+exit2:
+  ret void
+}
+
+; The second loop starts from the value the first one ends with.
+
+; CHECK-LABEL: @uses_result_of_first_loop(
+; CHECK: br i1 %cond1, label %loop1, label %exit1
+
+define i64 @uses_result_of_first_loop(i64 %n) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %s = phi i64 [ 0, %entry ], [ %s.next, %loop1 ]
+  %s.next = add i64 %s, %i
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp ne i64 %i.next, 100
+  br i1 %cond1, label %loop1, label %exit1
+
+exit1:
+  %s.lcssa = phi i64 [ %s.next, %loop1 ]
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %exit1 ], [ %j.next, %loop2 ]
+  %t = phi i64 [ %s.lcssa, %exit1 ], [ %t.next, %loop2 ]
+  %t.next = mul i64 %t, 3
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp ne i64 %j.next, 100
+  br i1 %cond2, label %loop2, label %exit2
+
+exit2:
+  %t.lcssa = phi i64 [ %t.next, %loop2 ]
+  ret i64 %t.lcssa
+}
+
+; A value of the first loop is used after the second one, so it leaves the
+; fused loop through a new LCSSA PHI in the exit of the second loop.
+
+; CHECK-LABEL: @value_used_after_loops(
+; CHECK: loop1:
+; CHECK: %s.next = add i64 %s, %i
+; CHECK: br label %loop2
+; CHECK: br i1 %cond2, label %loop1, label %exit2
+; CHECK: exit2:
+; CHECK-NEXT: %[[S:.*]] = phi i64 [ %s.next, %loop2 ]
+; CHECK-NEXT: ret i64 %[[S]]
+
+define i64 @value_used_after_loops(i32* noalias %A, i32* noalias %C) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %s = phi i64 [ 0, %entry ], [ %s.next, %loop1 ]
+  %arrayidx.a = getelementptr inbounds i32, i32* %A, i64 %i
+  store i32 0, i32* %arrayidx.a, align 4
+  %s.next = add i64 %s, %i
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp ne i64 %i.next, 100
+  br i1 %cond1, label %loop1, label %exit1
+
+exit1:
+  %s.lcssa = phi i64 [ %s.next, %loop1 ]
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %exit1 ], [ %j.next, %loop2 ]
+  %arrayidx.c = getelementptr inbounds i32, i32* %C, i64 %j
+  store i32 1, i32* %arrayidx.c, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp ne i64 %j.next, 100
+  br i1 %cond2, label %loop2, label %exit2
+
+exit2:
+  ret i64 %s.lcssa
+}
+
+; The preheader of the second loop is a separate empty block after the exit of
+; the first one. Both blocks are deleted.
+
+; CHECK-LABEL: @separate_preheader(
+; CHECK: loop1:
+; CHECK: %j = phi i64 [ 0, %entry ], [ %j.next, %loop2 ]
+; CHECK: br label %loop2
+; CHECK-NOT: exit1:
+; CHECK-NOT: preheader2:
+; CHECK: loop2:
+; CHECK: br i1 %cond2, label %loop1, label %exit2
+
+define void @separate_preheader(i32* noalias %A, i32* noalias %C) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %arrayidx.a = getelementptr inbounds i32, i32* %A, i64 %i
+  store i32 0, i32* %arrayidx.a, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp ne i64 %i.next, 100
+  br i1 %cond1, label %loop1, label %exit1
+
+exit1:
+  br label %preheader2
+
+preheader2:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %preheader2 ], [ %j.next, %loop2 ]
+  %arrayidx.c = getelementptr inbounds i32, i32* %C, i64 %j
+  store i32 1, i32* %arrayidx.c, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp ne i64 %j.next, 100
+  br i1 %cond2, label %loop2, label %exit2
+
+exit2:
+  ret void
+}
+
+; The fused loop would keep the two recurrences and eight arguments live, more
+; than the 8 registers the target-independent cost model assumes.
+
+; CHECK-LABEL: @register_pressure(
+; CHECK: br i1 %cond1, label %loop1, label %exit1
+
+define void @register_pressure(i32* noalias %A, i32* noalias %B,
+                               i32* noalias %C, i32* noalias %D,
+                               i32 %x1, i32 %x2, i32 %x3, i32 %x4) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %arrayidx.a = getelementptr inbounds i32, i32* %A, i64 %i
+  store i32 %x1, i32* %arrayidx.a, align 4
+  %arrayidx.b = getelementptr inbounds i32, i32* %B, i64 %i
+  store i32 %x2, i32* %arrayidx.b, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp ne i64 %i.next, 100
+  br i1 %cond1, label %loop1, label %exit1
+
+exit1:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %exit1 ], [ %j.next, %loop2 ]
+  %arrayidx.c = getelementptr inbounds i32, i32* %C, i64 %j
+  store i32 %x3, i32* %arrayidx.c, align 4
+  %arrayidx.d = getelementptr inbounds i32, i32* %D, i64 %j
+  store i32 %x4, i32* %arrayidx.d, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp ne i64 %j.next, 100
+  br i1 %cond2, label %loop2, label %exit2
+
+exit2:
+  ret void
+}
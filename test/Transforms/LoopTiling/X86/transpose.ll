@@ -0,0 +1,82 @@
+; RUN: opt -S -loop-tiling < %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; for (i = 0; i < 1024; ++i)
+;   for (j = 0; j < 1024; ++j)
+;     B[j][i] = A[i][j];
+; A tile of the j loop touches 256 lines of B and 16 lines of A, which fit in
+; the 32KB level 1 data cache.
+
+; CHECK-LABEL: @transpose(
+; CHECK: j.loop.tile:
+; CHECK-NEXT: %j.loop.tile.start = phi i64 [ 0, %entry ], [ %j.loop.tile.end, %j.loop.tile.latch ]
+; CHECK-NEXT: [[REMAINING:%.*]] = sub nsw i64 1024, %j.loop.tile.start
+; CHECK-NEXT: [[FULL:%.*]] = icmp sgt i64 [[REMAINING]], 256
+; CHECK-NEXT: [[NEXT:%.*]] = add nsw i64 %j.loop.tile.start, 256
+; CHECK-NEXT: %j.loop.tile.end = select i1 [[FULL]], i64 [[NEXT]], i64 1024
+; CHECK-NEXT: br label %i.loop
+; CHECK: j.loop:
+; CHECK-NEXT: %j = phi i64 [ %j.loop.tile.start, %i.loop ], [ %j.next, %j.loop ]
+; CHECK: icmp slt i64 %j.next, %j.loop.tile.end
+
+define void @transpose([1024 x i32]* noalias %A, [1024 x i32]* noalias %B) {
+entry:
+  br label %i.loop
+
+i.loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %i.latch ]
+  br label %j.loop
+
+j.loop:
+  %j = phi i64 [ 0, %i.loop ], [ %j.next, %j.loop ]
+  %src = getelementptr inbounds [1024 x i32], [1024 x i32]* %A, i64 %i, i64 %j
+  %v = load i32, i32* %src, align 4
+  %dst = getelementptr inbounds [1024 x i32], [1024 x i32]* %B, i64 %j, i64 %i
+  store i32 %v, i32* %dst, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %j.cond = icmp ne i64 %j.next, 1024
+  br i1 %j.cond, label %j.loop, label %i.latch
+
+i.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %i.cond = icmp ne i64 %i.next, 1024
+  br i1 %i.cond, label %i.loop, label %exit
+
+exit:
+  ret void
+}
+
+; Copying a matrix row by row reuses nothing across the rows.
+
+; CHECK-LABEL: @copy(
+; CHECK-NOT: .tile
+; CHECK: ret void
+
+define void @copy([1024 x i32]* noalias %A, [1024 x i32]* noalias %B) {
+entry:
+  br label %i.loop
+
+i.loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %i.latch ]
+  br label %j.loop
+
+j.loop:
+  %j = phi i64 [ 0, %i.loop ], [ %j.next, %j.loop ]
+  %src = getelementptr inbounds [1024 x i32], [1024 x i32]* %A, i64 %i, i64 %j
+  %v = load i32, i32* %src, align 4
+  %dst = getelementptr inbounds [1024 x i32], [1024 x i32]* %B, i64 %i, i64 %j
+  store i32 %v, i32* %dst, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %j.cond = icmp ne i64 %j.next, 1024
+  br i1 %j.cond, label %j.loop, label %i.latch
+
+i.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %i.cond = icmp ne i64 %i.next, 1024
+  br i1 %i.cond, label %i.loop, label %exit
+
+exit:
+  ret void
+}
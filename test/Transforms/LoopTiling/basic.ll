@@ -0,0 +1,155 @@
+; RUN: opt -S -loop-tiling -loop-tile-size=32 < %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; for (i = 0; i < 256; ++i)
+;   for (j = 0; j < 256; ++j)
+;     for (k = 0; k < 256; ++k)
+;       C[i][j] += A[i][k] * B[k][j];
+; The j and k loops are tiled, so that a tile of B is reused by every i.
+
+; CHECK-LABEL: @matmul(
+; CHECK: entry:
+; CHECK-NEXT: br label %j.loop.tile
+; CHECK: j.loop.tile:
+; CHECK-NEXT: %j.loop.tile.start = phi i64 [ 0, %entry ], [ %j.loop.tile.end, %j.loop.tile.latch ]
+; CHECK: %j.loop.tile.end = select i1 %{{.*}}, i64 %{{.*}}, i64 256
+; CHECK-NEXT: br label %k.loop.tile
+; CHECK: k.loop.tile:
+; CHECK-NEXT: %k.loop.tile.start = phi i64 [ 0, %j.loop.tile ], [ %k.loop.tile.end, %k.loop.tile.latch ]
+; CHECK: %k.loop.tile.end = select
+; CHECK-NEXT: br label %i.loop
+; CHECK: i.loop:
+; CHECK-NEXT: %i = phi i64 [ 0, %k.loop.tile ], [ %i.next, %i.latch ]
+; CHECK: j.loop:
+; CHECK-NEXT: %j = phi i64 [ %j.loop.tile.start, %i.loop ], [ %j.next, %j.latch ]
+; CHECK: k.loop:
+; CHECK-NEXT: %k = phi i64 [ %k.loop.tile.start, %j.loop ], [ %k.next, %k.loop ]
+; CHECK: [[KCOND:%.*]] = icmp slt i64 %k.next, %k.loop.tile.end
+; CHECK-NEXT: br i1 [[KCOND]], label %k.loop, label %j.latch
+; CHECK: j.latch:
+; CHECK: [[JCOND:%.*]] = icmp slt i64 %j.next, %j.loop.tile.end
+; CHECK-NEXT: br i1 [[JCOND]], label %j.loop, label %i.latch
+; CHECK: i.latch:
+; CHECK: br i1 %i.cond, label %i.loop, label %k.loop.tile.latch
+; CHECK: k.loop.tile.latch:
+; CHECK-NEXT: [[KMORE:%.*]] = icmp slt i64 %k.loop.tile.end, 256
+; CHECK-NEXT: br i1 [[KMORE]], label %k.loop.tile, label %j.loop.tile.latch
+; CHECK: j.loop.tile.latch:
+; CHECK-NEXT: [[JMORE:%.*]] = icmp slt i64 %j.loop.tile.end, 256
+; CHECK-NEXT: br i1 [[JMORE]], label %j.loop.tile, label %exit
+
+define void @matmul([256 x double]* noalias %A, [256 x double]* noalias %B,
+                    [256 x double]* noalias %C) {
+entry:
+  br label %i.loop
+
+i.loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %i.latch ]
+  br label %j.loop
+
+j.loop:
+  %j = phi i64 [ 0, %i.loop ], [ %j.next, %j.latch ]
+  br label %k.loop
+
+k.loop:
+  %k = phi i64 [ 0, %j.loop ], [ %k.next, %k.loop ]
+  %a.addr = getelementptr inbounds [256 x double], [256 x double]* %A, i64 %i, i64 %k
+  %a = load double, double* %a.addr, align 8
+  %b.addr = getelementptr inbounds [256 x double], [256 x double]* %B, i64 %k, i64 %j
+  %b = load double, double* %b.addr, align 8
+  %c.addr = getelementptr inbounds [256 x double], [256 x double]* %C, i64 %i, i64 %j
+  %c = load double, double* %c.addr, align 8
+  %mul = fmul double %a, %b
+  %add = fadd double %c, %mul
+  store double %add, double* %c.addr, align 8
+  %k.next = add nuw nsw i64 %k, 1
+  %k.cond = icmp ne i64 %k.next, 256
+  br i1 %k.cond, label %k.loop, label %j.latch
+
+j.latch:
+  %j.next = add nuw nsw i64 %j, 1
+  %j.cond = icmp ne i64 %j.next, 256
+  br i1 %j.cond, label %j.loop, label %i.latch
+
+i.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %i.cond = icmp ne i64 %i.next, 256
+  br i1 %i.cond, label %i.loop, label %exit
+
+exit:
+  ret void
+}
+
+; for (i = 0; i < 255; ++i)
+;   for (j = 0; j < 255; ++j)
+;     A[i + 1][j] = A[i][j + 1];
+; The dependence goes forwards in i and backwards in j: the nest cannot be
+; tiled.
+
+; CHECK-LABEL: @skewed_dependence(
+; CHECK-NOT: .tile
+; CHECK: ret void
+
+define void @skewed_dependence([256 x i32]* %A) {
+entry:
+  br label %i.loop
+
+i.loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %i.latch ]
+  %i.next = add nuw nsw i64 %i, 1
+  br label %j.loop
+
+j.loop:
+  %j = phi i64 [ 0, %i.loop ], [ %j.next, %j.loop ]
+  %j.next = add nuw nsw i64 %j, 1
+  %src = getelementptr inbounds [256 x i32], [256 x i32]* %A, i64 %i, i64 %j.next
+  %v = load i32, i32* %src, align 4
+  %dst = getelementptr inbounds [256 x i32], [256 x i32]* %A, i64 %i.next, i64 %j
+  store i32 %v, i32* %dst, align 4
+  %j.cond = icmp ne i64 %j.next, 255
+  br i1 %j.cond, label %j.loop, label %i.latch
+
+i.latch:
+  %i.cond = icmp ne i64 %i.next, 255
+  br i1 %i.cond, label %i.loop, label %exit
+
+exit:
+  ret void
+}
+
+; The i loop stores to memory outside of the j loop: the nest is not perfect.
+
+; CHECK-LABEL: @imperfect_nest(
+; CHECK-NOT: .tile
+; CHECK: ret void
+
+define void @imperfect_nest([256 x double]* noalias %A, double* noalias %B,
+                            double* noalias %C) {
+entry:
+  br label %i.loop
+
+i.loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %i.latch ]
+  %c.addr = getelementptr inbounds double, double* %C, i64 %i
+  store double 0.0, double* %c.addr, align 8
+  br label %j.loop
+
+j.loop:
+  %j = phi i64 [ 0, %i.loop ], [ %j.next, %j.loop ]
+  %b.addr = getelementptr inbounds double, double* %B, i64 %j
+  %b = load double, double* %b.addr, align 8
+  %a.addr = getelementptr inbounds [256 x double], [256 x double]* %A, i64 %j, i64 %i
+  store double %b, double* %a.addr, align 8
+  %j.next = add nuw nsw i64 %j, 1
+  %j.cond = icmp ne i64 %j.next, 256
+  br i1 %j.cond, label %j.loop, label %i.latch
+
+i.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %i.cond = icmp ne i64 %i.next, 256
+  br i1 %i.cond, label %i.loop, label %exit
+
+exit:
+  ret void
+}
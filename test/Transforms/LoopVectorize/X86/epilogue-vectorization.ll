@@ -0,0 +1,43 @@
+; RUN: opt < %s -loop-vectorize -enable-epilogue-vectorization -force-vector-width=8 -force-vector-interleave=1 -S | FileCheck %s
+; RUN: opt < %s -loop-vectorize -force-vector-width=8 -force-vector-interleave=1 -S | FileCheck %s --check-prefix=NOEPI
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The remainder of the loop vectorized by 8 is vectorized again with a
+; narrower factor, and a scalar loop is still left for the last iterations.
+
+; CHECK-LABEL: @add_one(
+; CHECK: vector.body:
+; CHECK: load <8 x i32>
+; CHECK: store <8 x i32>
+; CHECK: vector.body{{[0-9]+}}:
+; CHECK: load <{{[24]}} x i32>
+; CHECK: store <{{[24]}} x i32>
+; CHECK: for.body:
+; CHECK: load i32
+; CHECK: ret void
+
+; NOEPI-LABEL: @add_one(
+; NOEPI: vector.body:
+; NOEPI-NOT: vector.body{{[0-9]+}}:
+; NOEPI: ret void
+define void @add_one(i32* noalias nocapture %a, i32* noalias nocapture readonly %b, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.body, label %exit
+
+for.body:
+  %i = phi i64 [ %i.next, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32, i32* %b, i64 %i
+  %0 = load i32, i32* %arrayidx, align 4
+  %add = add nsw i32 %0, 1
+  %arrayidx2 = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %add, i32* %arrayidx2, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %for.body
+
+exit:
+  ret void
+}
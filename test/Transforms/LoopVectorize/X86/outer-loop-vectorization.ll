@@ -0,0 +1,88 @@
+; RUN: opt < %s -loop-vectorize -enable-outer-loop-vectorization -S | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The inner loop has an unknown trip count that does not depend on the outer
+; induction variable, and the accesses are consecutive along the outer loop.
+;
+;   for (i = 0; i < 1024; ++i)
+;     for (j = 0; j < m; ++j)
+;       a[j][i] += b[j][i];
+
+; CHECK-LABEL: @column_add(
+; CHECK: outer.vector.ph:
+; CHECK: inner.vec:
+; CHECK: phi i64
+; CHECK: load <[[VF:[0-9]+]] x float>
+; CHECK: load <[[VF]] x float>
+; CHECK: fadd <[[VF]] x float>
+; CHECK: store <[[VF]] x float>
+; CHECK: outer.middle.block:
+; CHECK: outer.scalar.ph:
+; CHECK-NEXT: %outer.resume.val = phi i64
+; CHECK: ret void
+define void @column_add([1024 x float]* noalias %a, [1024 x float]* noalias %b, i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %pb = getelementptr inbounds [1024 x float], [1024 x float]* %b, i64 %j, i64 %i
+  %vb = load float, float* %pb, align 4
+  %pa = getelementptr inbounds [1024 x float], [1024 x float]* %a, i64 %j, i64 %i
+  %va = load float, float* %pa, align 4
+  %add = fadd float %va, %vb
+  store float %add, float* %pa, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.done = icmp eq i64 %j.next, %m
+  br i1 %inner.done, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.done = icmp eq i64 %i.next, 1024
+  br i1 %outer.done, label %exit, label %outer
+
+exit:
+  ret void
+}
+
+; Each outer iteration reads what the previous one stored.
+;
+;   for (i = 0; i < 1023; ++i)
+;     for (j = 0; j < m; ++j)
+;       a[j][i + 1] = a[j][i];
+
+; CHECK-LABEL: @carried_dependence(
+; CHECK-NOT: outer.vector.ph:
+; CHECK: ret void
+define void @carried_dependence([1024 x float]* noalias %a, i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %i.next = add nuw nsw i64 %i, 1
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %src = getelementptr inbounds [1024 x float], [1024 x float]* %a, i64 %j, i64 %i
+  %v = load float, float* %src, align 4
+  %dst = getelementptr inbounds [1024 x float], [1024 x float]* %a, i64 %j, i64 %i.next
+  store float %v, float* %dst, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.done = icmp eq i64 %j.next, %m
+  br i1 %inner.done, label %outer.latch, label %inner
+
+outer.latch:
+  %outer.done = icmp eq i64 %i.next, 1023
+  br i1 %outer.done, label %exit, label %outer
+
+exit:
+  ret void
+}
@@ -0,0 +1,62 @@
+; RUN: opt < %s -newgvn -S | FileCheck %s
+; RUN: opt < %s -passes=newgvn -S | FileCheck %s
+
+define i32 @commuted(i32 %a, i32 %b) {
+; CHECK-LABEL: @commuted(
+; CHECK-NEXT: %x = add i32 %a, %b
+; CHECK-NEXT: %r = mul i32 %x, %x
+; CHECK-NEXT: ret i32 %r
+  %x = add i32 %a, %b
+  %y = add i32 %b, %a
+  %r = mul i32 %x, %y
+  ret i32 %r
+}
+
+; The value computed in %then is available from %entry; the PHI merges the
+; same value on both edges.
+define i32 @diamond(i32 %a, i32 %b, i1 %c) {
+; CHECK-LABEL: @diamond(
+; CHECK-NOT: %y
+; CHECK-NOT: phi
+; CHECK: ret i32 %x
+entry:
+  %x = add i32 %a, %b
+  br i1 %c, label %then, label %join
+
+then:
+  %y = add i32 %a, %b
+  br label %join
+
+join:
+  %p = phi i32 [ %y, %then ], [ %x, %entry ]
+  ret i32 %p
+}
+
+; The branch condition folds, so only one edge into %join is executable.
+define i32 @unreachable_edge(i32 %a) {
+; CHECK-LABEL: @unreachable_edge(
+; CHECK: br i1 true
+; CHECK: ret i32 1
+entry:
+  %c = icmp eq i32 %a, %a
+  br i1 %c, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  %p = phi i32 [ 1, %then ], [ 2, %else ]
+  ret i32 %p
+}
+
+define i32 @forward(i32* %p, i32 %v) {
+; CHECK-LABEL: @forward(
+; CHECK: store i32 %v, i32* %p
+; CHECK-NEXT: ret i32 %v
+  store i32 %v, i32* %p
+  %l = load i32, i32* %p
+  ret i32 %l
+}
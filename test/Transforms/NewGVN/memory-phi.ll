@@ -0,0 +1,36 @@
+; RUN: opt < %s -newgvn -S | FileCheck %s
+; RUN: opt < %s -passes=newgvn -S | FileCheck %s
+
+; The store in %clobber is guarded by a comparison of two congruent induction
+; variables, so it never executes. The memory phis in the loop are then
+; equivalent to the state on entry, and the load after the loop is the same
+; as the load before it.
+define i32 @load_across_loop(i32* %p, i32 %n) {
+; CHECK-LABEL: @load_across_loop(
+; CHECK: br i1 false, label %clobber, label %latch
+; CHECK: ret i32 0
+entry:
+  %a = load i32, i32* %p
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %j = phi i32 [ 0, %entry ], [ %j.next, %latch ]
+  %ne = icmp ne i32 %i, %j
+  br i1 %ne, label %clobber, label %latch
+
+clobber:
+  store i32 0, i32* %p
+  br label %latch
+
+latch:
+  %i.next = add i32 %i, 1
+  %j.next = add i32 %j, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %b = load i32, i32* %p
+  %r = sub i32 %a, %b
+  ret i32 %r
+}
@@ -0,0 +1,30 @@
+; RUN: opt < %s -newgvn -S | FileCheck %s
+; RUN: opt < %s -passes=newgvn -S | FileCheck %s
+
+; %i and %j are only equal if the backedge is assumed to carry equal values;
+; the optimistic numbering proves it in one run.
+define void @congruent_ivs(i32 %n, i32* %p, i32* %q) {
+; CHECK-LABEL: @congruent_ivs(
+; CHECK: loop:
+; CHECK-NEXT: %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+; CHECK-NEXT: store i32 %i, i32* %p
+; CHECK-NEXT: store i32 %i, i32* %q
+; CHECK-NEXT: %i.next = add i32 %i, 1
+; CHECK-NOT: %j
+; CHECK: ret void
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %j = phi i32 [ 0, %entry ], [ %j.next, %loop ]
+  store i32 %i, i32* %p
+  store i32 %j, i32* %q
+  %i.next = add i32 %i, 1
+  %j.next = add i32 %j, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
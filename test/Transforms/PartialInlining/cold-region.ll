@@ -0,0 +1,42 @@
+; RUN: opt < %s -partial-inliner -S | FileCheck %s
+; The cold region of @f is outlined into a cold function, and the rest of @f
+; is inlined into its caller.
+
+declare void @report(i32)
+
+define i32 @f(i32 %x) !prof !0 {
+entry:
+  %cmp = icmp slt i32 %x, 0
+  br i1 %cmp, label %error, label %hot, !prof !1
+
+hot:
+  %h = shl i32 %x, 1
+  br label %exit
+
+error:
+  %neg = sub i32 0, %x
+  %m = mul i32 %neg, 3
+  call void @report(i32 %m)
+  call void @report(i32 %neg)
+  br label %exit
+
+exit:
+  %p = phi i32 [ %h, %hot ], [ %m, %error ]
+  %r = add i32 %p, 1
+  ret i32 %r
+}
+
+; CHECK-LABEL: define i32 @caller(
+; CHECK-NOT: call i32 @f(
+; CHECK: call void @[[OUTLINED:[a-z0-9_.]+error]](
+; CHECK: ret i32
+define i32 @caller(i32 %y) {
+  %r = call i32 @f(i32 %y)
+  ret i32 %r
+}
+
+; CHECK: define internal void @[[OUTLINED]]({{.*}}) [[COLD:#[0-9]+]]
+; CHECK: attributes [[COLD]] = { {{.*}}cold{{.*}} }
+
+!0 = !{!"function_entry_count", i64 10000}
+!1 = !{!"branch_weights", i32 1, i32 10000}
@@ -0,0 +1,121 @@
+; RUN: opt -slp-vectorizer -slp-vectorize-hor -slp-vectorize-hor-store -S < %s -mtriple=x86_64-unknown-linux -mcpu=corei7-avx | FileCheck %s
+
+; The maximum of a[i] - b[i] over four lanes, returned.
+
+; CHECK-LABEL: @smax_of_differences(
+; CHECK: sub nsw <4 x i32>
+; CHECK: icmp sgt <4 x i32>
+; CHECK: select <4 x i1>
+; CHECK: extractelement <4 x i32>
+; CHECK-NOT: icmp sgt i32
+; CHECK: ret i32
+
+define i32 @smax_of_differences(i32* %a, i32* %b) {
+entry:
+  %a1p = getelementptr inbounds i32, i32* %a, i64 1
+  %a2p = getelementptr inbounds i32, i32* %a, i64 2
+  %a3p = getelementptr inbounds i32, i32* %a, i64 3
+  %b1p = getelementptr inbounds i32, i32* %b, i64 1
+  %b2p = getelementptr inbounds i32, i32* %b, i64 2
+  %b3p = getelementptr inbounds i32, i32* %b, i64 3
+  %a0 = load i32, i32* %a, align 4
+  %a1 = load i32, i32* %a1p, align 4
+  %a2 = load i32, i32* %a2p, align 4
+  %a3 = load i32, i32* %a3p, align 4
+  %b0 = load i32, i32* %b, align 4
+  %b1 = load i32, i32* %b1p, align 4
+  %b2 = load i32, i32* %b2p, align 4
+  %b3 = load i32, i32* %b3p, align 4
+  %d0 = sub nsw i32 %a0, %b0
+  %d1 = sub nsw i32 %a1, %b1
+  %d2 = sub nsw i32 %a2, %b2
+  %d3 = sub nsw i32 %a3, %b3
+  %c01 = icmp sgt i32 %d0, %d1
+  %m01 = select i1 %c01, i32 %d0, i32 %d1
+  %c012 = icmp sgt i32 %m01, %d2
+  %m012 = select i1 %c012, i32 %m01, i32 %d2
+  %c0123 = icmp sgt i32 %m012, %d3
+  %m0123 = select i1 %c0123, i32 %m012, i32 %d3
+  ret i32 %m0123
+}
+
+; The compares of a min/max reduction must all use the same predicate.
+
+; CHECK-LABEL: @mixed_predicates(
+; CHECK-NOT: <4 x i32>
+; CHECK: ret i32
+
+define i32 @mixed_predicates(i32* %a, i32* %b) {
+entry:
+  %a1p = getelementptr inbounds i32, i32* %a, i64 1
+  %a2p = getelementptr inbounds i32, i32* %a, i64 2
+  %a3p = getelementptr inbounds i32, i32* %a, i64 3
+  %b1p = getelementptr inbounds i32, i32* %b, i64 1
+  %b2p = getelementptr inbounds i32, i32* %b, i64 2
+  %b3p = getelementptr inbounds i32, i32* %b, i64 3
+  %a0 = load i32, i32* %a, align 4
+  %a1 = load i32, i32* %a1p, align 4
+  %a2 = load i32, i32* %a2p, align 4
+  %a3 = load i32, i32* %a3p, align 4
+  %b0 = load i32, i32* %b, align 4
+  %b1 = load i32, i32* %b1p, align 4
+  %b2 = load i32, i32* %b2p, align 4
+  %b3 = load i32, i32* %b3p, align 4
+  %d0 = sub nsw i32 %a0, %b0
+  %d1 = sub nsw i32 %a1, %b1
+  %d2 = sub nsw i32 %a2, %b2
+  %d3 = sub nsw i32 %a3, %b3
+  %c01 = icmp sgt i32 %d0, %d1
+  %m01 = select i1 %c01, i32 %d0, i32 %d1
+  %c012 = icmp slt i32 %m01, %d2
+  %m012 = select i1 %c012, i32 %m01, i32 %d2
+  %c0123 = icmp sgt i32 %m012, %d3
+  %m0123 = select i1 %c0123, i32 %m012, i32 %d3
+  ret i32 %m0123
+}
+
+; The values reduced are computed in the entry block and added up in another
+; block.
+
+; CHECK-LABEL: @cross_block_add(
+; CHECK: entry:
+; CHECK: mul <4 x i32>
+; CHECK: exit:
+; CHECK: shufflevector <4 x i32>
+; CHECK: add <4 x i32>
+; CHECK: extractelement <4 x i32>
+; CHECK: store i32
+
+define void @cross_block_add(i32* %a, i32* %b, i32* %out, i1 %c) {
+entry:
+  %a1p = getelementptr inbounds i32, i32* %a, i64 1
+  %a2p = getelementptr inbounds i32, i32* %a, i64 2
+  %a3p = getelementptr inbounds i32, i32* %a, i64 3
+  %b1p = getelementptr inbounds i32, i32* %b, i64 1
+  %b2p = getelementptr inbounds i32, i32* %b, i64 2
+  %b3p = getelementptr inbounds i32, i32* %b, i64 3
+  %a0 = load i32, i32* %a, align 4
+  %a1 = load i32, i32* %a1p, align 4
+  %a2 = load i32, i32* %a2p, align 4
+  %a3 = load i32, i32* %a3p, align 4
+  %b0 = load i32, i32* %b, align 4
+  %b1 = load i32, i32* %b1p, align 4
+  %b2 = load i32, i32* %b2p, align 4
+  %b3 = load i32, i32* %b3p, align 4
+  %p0 = mul i32 %a0, %b0
+  %p1 = mul i32 %a1, %b1
+  %p2 = mul i32 %a2, %b2
+  %p3 = mul i32 %a3, %b3
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 0, i32* %out, align 4
+  br label %exit
+
+exit:
+  %s01 = add i32 %p0, %p1
+  %s012 = add i32 %s01, %p2
+  %s0123 = add i32 %s012, %p3
+  store i32 %s0123, i32* %out, align 4
+  ret void
+}
@@ -0,0 +1,73 @@
+; RUN: opt -slp-vectorizer -S < %s -mtriple=x86_64-unknown-linux -mcpu=corei7-avx | FileCheck %s
+; RUN: opt -slp-vectorizer -slp-look-ahead-depth=0 -S < %s -mtriple=x86_64-unknown-linux -mcpu=corei7-avx | FileCheck %s --check-prefix=NOLOOKAHEAD
+
+; out[i] = a[i] * b[i] + c[i] * d[i], with the operands of the adds of the odd
+; lanes commuted. Both operands of every add are multiplies, only looking at
+; the loads feeding them tells which pairing makes the loads consecutive.
+
+; CHECK-LABEL: @dot2(
+; CHECK: load <4 x i32>
+; CHECK: load <4 x i32>
+; CHECK: load <4 x i32>
+; CHECK: load <4 x i32>
+; CHECK: mul <4 x i32>
+; CHECK: mul <4 x i32>
+; CHECK: add <4 x i32>
+; CHECK: store <4 x i32>
+
+; NOLOOKAHEAD-LABEL: @dot2(
+; NOLOOKAHEAD-NOT: load <4 x i32>
+; NOLOOKAHEAD: ret void
+
+define void @dot2(i32* noalias %a, i32* noalias %b, i32* noalias %c,
+                  i32* noalias %d, i32* noalias %out) {
+entry:
+  %a1p = getelementptr inbounds i32, i32* %a, i64 1
+  %a2p = getelementptr inbounds i32, i32* %a, i64 2
+  %a3p = getelementptr inbounds i32, i32* %a, i64 3
+  %b1p = getelementptr inbounds i32, i32* %b, i64 1
+  %b2p = getelementptr inbounds i32, i32* %b, i64 2
+  %b3p = getelementptr inbounds i32, i32* %b, i64 3
+  %c1p = getelementptr inbounds i32, i32* %c, i64 1
+  %c2p = getelementptr inbounds i32, i32* %c, i64 2
+  %c3p = getelementptr inbounds i32, i32* %c, i64 3
+  %d1p = getelementptr inbounds i32, i32* %d, i64 1
+  %d2p = getelementptr inbounds i32, i32* %d, i64 2
+  %d3p = getelementptr inbounds i32, i32* %d, i64 3
+  %o1p = getelementptr inbounds i32, i32* %out, i64 1
+  %o2p = getelementptr inbounds i32, i32* %out, i64 2
+  %o3p = getelementptr inbounds i32, i32* %out, i64 3
+  %a0 = load i32, i32* %a, align 4
+  %a1 = load i32, i32* %a1p, align 4
+  %a2 = load i32, i32* %a2p, align 4
+  %a3 = load i32, i32* %a3p, align 4
+  %b0 = load i32, i32* %b, align 4
+  %b1 = load i32, i32* %b1p, align 4
+  %b2 = load i32, i32* %b2p, align 4
+  %b3 = load i32, i32* %b3p, align 4
+  %c0 = load i32, i32* %c, align 4
+  %c1 = load i32, i32* %c1p, align 4
+  %c2 = load i32, i32* %c2p, align 4
+  %c3 = load i32, i32* %c3p, align 4
+  %d0 = load i32, i32* %d, align 4
+  %d1 = load i32, i32* %d1p, align 4
+  %d2 = load i32, i32* %d2p, align 4
+  %d3 = load i32, i32* %d3p, align 4
+  %ab0 = mul i32 %a0, %b0
+  %cd0 = mul i32 %c0, %d0
+  %s0 = add i32 %ab0, %cd0
+  %ab1 = mul i32 %a1, %b1
+  %cd1 = mul i32 %c1, %d1
+  %s1 = add i32 %cd1, %ab1
+  %ab2 = mul i32 %a2, %b2
+  %cd2 = mul i32 %c2, %d2
+  %s2 = add i32 %ab2, %cd2
+  %ab3 = mul i32 %a3, %b3
+  %cd3 = mul i32 %c3, %d3
+  %s3 = add i32 %cd3, %ab3
+  store i32 %s0, i32* %out, align 4
+  store i32 %s1, i32* %o1p, align 4
+  store i32 %s2, i32* %o2p, align 4
+  store i32 %s3, i32* %o3p, align 4
+  ret void
+}
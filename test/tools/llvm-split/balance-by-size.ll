@@ -0,0 +1,39 @@
+; RUN: llvm-split -balance-by-size -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; The large function gets a partition of its own, and the small ones are
+; packed together in the other partition.
+
+; CHECK0: define i32 @big
+; CHECK0: declare i32 @small1
+; CHECK0: declare i32 @small2
+; CHECK0: declare i32 @small3
+
+; CHECK1: declare i32 @big
+; CHECK1: define i32 @small1
+; CHECK1: define i32 @small2
+; CHECK1: define i32 @small3
+
+define i32 @big(i32 %x) {
+  %a = add i32 %x, 1
+  %b = mul i32 %a, %x
+  %c = sub i32 %b, %a
+  %d = xor i32 %c, %b
+  %e = shl i32 %d, 3
+  %f = or i32 %e, %c
+  ret i32 %f
+}
+
+define i32 @small1(i32 %x) {
+  %r = call i32 @big(i32 %x)
+  ret i32 %r
+}
+
+define i32 @small2(i32 %x) {
+  ret i32 %x
+}
+
+define i32 @small3(i32 %x) {
+  ret i32 %x
+}
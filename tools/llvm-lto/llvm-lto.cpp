@@ -124,6 +124,12 @@ static cl::opt<bool>
     SaveModuleFile("save-merged-module", cl::init(false),
                    cl::desc("Write merged LTO module to file before CodeGen"));
 
+static cl::opt<std::string> FunctionOrderFile(
+    "function-order-file", cl::init(""),
+    cl::desc("Write the function order computed from the call graph profile "
+             "to file (requires -o)"),
+    cl::value_desc("filename"));
+
 static cl::list<std::string> InputFilenames(cl::Positional, cl::OneOrMore,
                                             cl::desc("<input bitcode files>"));
 
@@ -820,6 +826,10 @@ int main(int argc, char **argv) {
         error("writing merged module failed.");
     }
 
+    if (!FunctionOrderFile.empty() &&
+        !CodeGen.writeFunctionOrderFile(FunctionOrderFile.c_str()))
+      error("writing function order file failed.");
+
     std::list<tool_output_file> OSs;
     std::vector<raw_pwrite_stream *> OSPtrs;
     for (unsigned I = 0; I != Parallelism; ++I) {
@@ -846,6 +856,9 @@ int main(int argc, char **argv) {
     if (SaveModuleFile)
       error(": -save-merged-module must be specified with -o");
 
+    if (!FunctionOrderFile.empty())
+      error(": -function-order-file must be specified with -o");
+
     const char *OutputName = nullptr;
     if (!CodeGen.compile_to_file(&OutputName, DisableVerify, DisableInline,
                                  DisableGVNLoadPRE, DisableLTOVectorization))
@@ -27,6 +27,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/IRPrintingPasses.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/LegacyPassNameParser.h"
@@ -40,9 +41,11 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/PluginLoader.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/SystemUtils.h"
@@ -215,6 +218,39 @@ static cl::opt<bool> DiscardValueNames(
     cl::desc("Discard names from Value (other than GlobalValue)."),
     cl::init(false), cl::Hidden);
 
+static cl::opt<bool> PrintIRMemoryUsage(
+    "ir-memory-usage",
+    cl::desc("Report the heap memory used by the module and the resulting "
+             "bytes per instruction, after loading it and after running the "
+             "passes."),
+    cl::init(false), cl::Hidden);
+
+static void printIRMemoryUsage(const Module &M, StringRef When,
+                               size_t MallocUsageBefore) {
+  size_t MallocUsage = sys::Process::GetMallocUsage();
+  size_t Bytes =
+      MallocUsage > MallocUsageBefore ? MallocUsage - MallocUsageBefore : 0;
+  uint64_t NumInsts = 0;
+  uint64_t NumUnusedOperands = 0;
+  for (const Function &F : M)
+    for (const BasicBlock &BB : F)
+      for (const Instruction &I : BB) {
+        ++NumInsts;
+        if (auto *PN = dyn_cast<PHINode>(&I))
+          NumUnusedOperands +=
+              PN->getNumReservedOperands() - PN->getNumOperands();
+        else if (auto *SI = dyn_cast<SwitchInst>(&I))
+          NumUnusedOperands +=
+              SI->getNumReservedOperands() - SI->getNumOperands();
+      }
+  errs() << "ir-memory-usage: " << When << ": " << NumInsts
+         << " instructions, " << Bytes << " bytes";
+  if (NumInsts)
+    errs() << ", " << format("%.1f", double(Bytes) / NumInsts)
+           << " bytes per instruction";
+  errs() << ", " << NumUnusedOperands << " unused operand slots\n";
+}
+
 static inline void addPass(legacy::PassManagerBase &PM, Pass *P) {
   // Add the pass to the pass manager...
   PM.add(P);
@@ -385,6 +421,7 @@ int main(int argc, char **argv) {
     Context.enableDebugTypeODRUniquing();
 
   // Load the input module...
+  size_t MallocUsageBeforeLoad = sys::Process::GetMallocUsage();
   std::unique_ptr<Module> M = parseIRFile(InputFilename, Err, Context);
 
   if (!M) {
@@ -392,6 +429,9 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  if (PrintIRMemoryUsage)
+    printIRMemoryUsage(*M, "after loading", MallocUsageBeforeLoad);
+
   // Strip debug info before running the verifier.
   if (StripDebug)
     StripDebugInfo(*M);
@@ -650,9 +690,12 @@ int main(int argc, char **argv) {
       if (EmitModuleHash)
         report_fatal_error("Text output is incompatible with -module-hash");
       Passes.add(createPrintModulePass(*OS, "", PreserveAssemblyUseListOrder));
-    } else
+    } else if (RunTwice)
       Passes.add(createBitcodeWriterPass(*OS, PreserveBitcodeUseListOrder,
                                          EmitSummaryIndex, EmitModuleHash));
+    else
+      Passes.add(createBitcodeWriterPass(Out->os(), PreserveBitcodeUseListOrder,
+                                         EmitSummaryIndex, EmitModuleHash));
   }
 
   // Before executing passes, print the final values of the LLVM options.
@@ -670,6 +713,9 @@ int main(int argc, char **argv) {
   // Now that we have all of the passes ready, run them.
   Passes.run(*M);
 
+  if (PrintIRMemoryUsage)
+    printIRMemoryUsage(*M, "after passes", MallocUsageBeforeLoad);
+
   // Compare the two outputs and make sure they're the same
   if (RunTwice) {
     assert(Out);
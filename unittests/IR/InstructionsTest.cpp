@@ -579,5 +579,66 @@ TEST(InstructionsTest, AlterInvokeBundles) {
   EXPECT_TRUE(Clone->getOperandBundle("after").hasValue());
 }
 
+TEST(InstructionsTest, PHINodeShrinkToFit) {
+  LLVMContext C;
+  Type *Int32Ty = Type::getInt32Ty(C);
+  std::unique_ptr<BasicBlock> BB0(BasicBlock::Create(C));
+  std::unique_ptr<BasicBlock> BB1(BasicBlock::Create(C));
+  std::unique_ptr<BasicBlock> BB2(BasicBlock::Create(C));
+  Constant *C0 = ConstantInt::get(Int32Ty, 0);
+  Constant *C1 = ConstantInt::get(Int32Ty, 1);
+  Constant *C2 = ConstantInt::get(Int32Ty, 2);
+
+  // Reserve a single slot so that addIncoming has to grow the operand list.
+  std::unique_ptr<PHINode> PN(PHINode::Create(Int32Ty, 1));
+  PN->addIncoming(C0, BB0.get());
+  PN->addIncoming(C1, BB1.get());
+  PN->addIncoming(C2, BB2.get());
+  PN->removeIncomingValue(1, /*DeletePHIIfEmpty=*/false);
+
+  PN->shrinkToFit();
+  ASSERT_EQ(2u, PN->getNumIncomingValues());
+  EXPECT_EQ(C0, PN->getIncomingValue(0));
+  EXPECT_EQ(BB0.get(), PN->getIncomingBlock(0));
+  EXPECT_EQ(C2, PN->getIncomingValue(1));
+  EXPECT_EQ(BB2.get(), PN->getIncomingBlock(1));
+  EXPECT_EQ(PN.get(), PN->getOperandUse(1).getUser());
+  EXPECT_TRUE(C0->hasOneUse());
+  EXPECT_FALSE(C1->hasNUsesOrMore(1));
+  EXPECT_TRUE(C2->hasOneUse());
+
+  // The node must still be able to grow afterwards.
+  PN->addIncoming(C1, BB1.get());
+  EXPECT_EQ(C1, PN->getIncomingValueForBlock(BB1.get()));
+  EXPECT_EQ(BB2.get(), PN->getIncomingBlock(1));
+  PN->dropAllReferences();
+}
+
+TEST(InstructionsTest, SwitchInstShrinkToFit) {
+  LLVMContext C;
+  IntegerType *Int32Ty = Type::getInt32Ty(C);
+  std::unique_ptr<BasicBlock> Default(BasicBlock::Create(C));
+  std::unique_ptr<BasicBlock> BB0(BasicBlock::Create(C));
+  std::unique_ptr<BasicBlock> BB1(BasicBlock::Create(C));
+  Value *Cond = UndefValue::get(Int32Ty);
+
+  std::unique_ptr<SwitchInst> SI(SwitchInst::Create(Cond, Default.get(), 0));
+  SI->addCase(ConstantInt::get(Int32Ty, 0), BB0.get());
+  SI->addCase(ConstantInt::get(Int32Ty, 1), BB1.get());
+
+  SI->shrinkToFit();
+  ASSERT_EQ(2u, SI->getNumCases());
+  EXPECT_EQ(Default.get(), SI->getDefaultDest());
+  EXPECT_EQ(BB0.get(), SI->findCaseValue(ConstantInt::get(Int32Ty, 0))
+                           .getCaseSuccessor());
+  EXPECT_EQ(BB1.get(), SI->findCaseValue(ConstantInt::get(Int32Ty, 1))
+                           .getCaseSuccessor());
+  EXPECT_EQ(SI.get(), SI->getOperandUse(3).getUser());
+
+  SI->addCase(ConstantInt::get(Int32Ty, 2), BB0.get());
+  EXPECT_EQ(3u, SI->getNumCases());
+  SI->dropAllReferences();
+}
+
 } // end anonymous namespace
 } // end namespace llvm
@@ -17,10 +17,12 @@
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/ModuleSlotTracker.h"
+#include "llvm/IR/SharedMDStringPool.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <thread>
 using namespace llvm;
 
 namespace {
@@ -167,6 +169,52 @@ TEST_F(MDStringTest, PrintingComplex) {
   EXPECT_STREQ("!\"\\00\\0A\\22\\5C\\FF\"", oss.str().c_str());
 }
 
+// Test that contexts using the same SharedMDStringPool get the same MDString.
+TEST(SharedMDStringPoolTest, SharedBetweenContexts) {
+  SharedMDStringPool Pool;
+  LLVMContext C1, C2, C3;
+  C1.setSharedMDStringPool(&Pool);
+  C2.setSharedMDStringPool(&Pool);
+
+  MDString *S1 = MDString::get(C1, "shared");
+  MDString *S2 = MDString::get(C2, "shared");
+  MDString *S3 = MDString::get(C3, "shared");
+  EXPECT_EQ(S1, S2);
+  EXPECT_NE(S1, S3);
+  EXPECT_EQ("shared", S2->getString());
+  EXPECT_NE(S1, MDString::get(C2, "other"));
+  EXPECT_EQ(2u, Pool.size());
+
+  // Nodes referring to a shared string still belong to their own context.
+  MDNode *N1 = MDNode::get(C1, S1);
+  MDNode *N2 = MDNode::get(C2, S2);
+  EXPECT_NE(N1, N2);
+  EXPECT_EQ(&C2, &N2->getContext());
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(SharedMDStringPoolTest, ConcurrentContexts) {
+  SharedMDStringPool Pool;
+  const unsigned NumThreads = 4;
+  const unsigned NumStrings = 1000;
+  std::vector<std::vector<MDString *>> Results(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != NumThreads; ++T)
+    Threads.emplace_back([&, T] {
+      LLVMContext C;
+      C.setSharedMDStringPool(&Pool);
+      for (unsigned I = 0; I != NumStrings; ++I)
+        Results[T].push_back(MDString::get(C, "str" + std::to_string(I)));
+    });
+  for (std::thread &T : Threads)
+    T.join();
+
+  EXPECT_EQ(NumStrings, Pool.size());
+  for (unsigned T = 1; T != NumThreads; ++T)
+    EXPECT_EQ(Results[0], Results[T]);
+}
+#endif
+
 typedef MetadataTest MDNodeTest;
 
 // Test the two constructors, and containing other Constants.
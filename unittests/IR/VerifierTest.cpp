@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DIBuilder.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -18,6 +19,8 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
 
 namespace llvm {
@@ -220,5 +223,136 @@ TEST(VerifierTest, StripInvalidDebugInfoLegacy) {
   EXPECT_FALSE(verifyModule(M));
 }
 
+TEST(VerifierTest, VerifiedFunctionCache) {
+  LLVMContext C;
+  Module M("M", C);
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), /*isVarArg=*/false);
+  Function *F = cast<Function>(M.getOrInsertFunction("foo", FTy));
+  BasicBlock *Entry = BasicBlock::Create(C, "entry", F);
+  ReturnInst::Create(C, Entry);
+  EXPECT_FALSE(F->isVerified());
+
+  legacy::PassManager Passes;
+  Passes.add(createVerifierPass(false));
+  Passes.run(M);
+  EXPECT_TRUE(F->isVerified());
+
+  // Adding a block without a terminator breaks the function and must drop the
+  // cached result.
+  BasicBlock *Exit = BasicBlock::Create(C, "exit", F);
+  EXPECT_FALSE(F->isVerified());
+  EXPECT_TRUE(verifyFunction(*F));
+
+  legacy::PassManager Passes2;
+  Passes2.add(createVerifierPass(false));
+  Passes2.run(M);
+  EXPECT_FALSE(F->isVerified());
+
+  ReturnInst::Create(C, Exit);
+  legacy::PassManager Passes3;
+  Passes3.add(createVerifierPass(false));
+  Passes3.run(M);
+  EXPECT_TRUE(F->isVerified());
+
+  // Changing the attributes invalidates the cached result as well.
+  F->addFnAttr(Attribute::NoUnwind);
+  EXPECT_FALSE(F->isVerified());
+}
+
+static bool runVerifierPass(Module &M, Function &F) {
+  legacy::PassManager Passes;
+  Passes.add(createVerifierPass(false));
+  Passes.run(M);
+  return F.isVerified();
+}
+
+TEST(VerifierTest, VerifiedFunctionCacheMutations) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define i32 @foo(i32 %x) {\n"
+      "entry:\n"
+      "  %a = add i32 %x, 1\n"
+      "  %b = add i32 %a, 2\n"
+      "  ret i32 %b\n"
+      "}\n",
+      Err, C);
+  ASSERT_TRUE(M != nullptr);
+  Function *F = M->getFunction("foo");
+  auto I = F->getEntryBlock().begin();
+  Instruction *A = &*I++;
+  Instruction *B = &*I++;
+  ReturnInst *Ret = cast<ReturnInst>(&*I);
+  ASSERT_TRUE(runVerifierPass(*M, *F));
+
+  // Replacing operands, directly or through RAUW.
+  Ret->setOperand(0, A);
+  EXPECT_FALSE(F->isVerified());
+  ASSERT_TRUE(runVerifierPass(*M, *F));
+  A->replaceAllUsesWith(B);
+  EXPECT_FALSE(F->isVerified());
+  EXPECT_TRUE(verifyFunction(*F));
+  Ret->setOperand(0, A);
+  B->setOperand(0, &*F->arg_begin());
+  ASSERT_TRUE(runVerifierPass(*M, *F));
+  cast<BinaryOperator>(B)->swapOperands();
+  EXPECT_FALSE(F->isVerified());
+  ASSERT_TRUE(runVerifierPass(*M, *F));
+
+  // Instruction flags and metadata.
+  B->setHasNoSignedWrap(true);
+  EXPECT_FALSE(F->isVerified());
+  ASSERT_TRUE(runVerifierPass(*M, *F));
+  B->setMetadata("foo", MDNode::get(C, None));
+  EXPECT_FALSE(F->isVerified());
+  ASSERT_TRUE(runVerifierPass(*M, *F));
+
+  // Properties of the function itself.
+  F->setLinkage(GlobalValue::InternalLinkage);
+  EXPECT_FALSE(F->isVerified());
+  ASSERT_TRUE(runVerifierPass(*M, *F));
+  F->setCallingConv(CallingConv::Fast);
+  EXPECT_FALSE(F->isVerified());
+  ASSERT_TRUE(runVerifierPass(*M, *F));
+}
+
+#ifdef GTEST_HAS_DEATH_TEST
+/// Makes every function return an i64 undef while reporting that nothing
+/// changed.
+struct SilentlyBreakReturnsPass : public FunctionPass {
+  static char ID;
+  SilentlyBreakReturnsPass() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &F) override {
+    for (BasicBlock &BB : F)
+      if (auto *RI = dyn_cast<ReturnInst>(BB.getTerminator()))
+        if (RI->getNumOperands())
+          RI->setOperand(0, UndefValue::get(Type::getInt64Ty(F.getContext())));
+    return false;
+  }
+};
+char SilentlyBreakReturnsPass::ID = 0;
+
+TEST(VerifierTest, VerifiedFunctionCacheUnreportedChange) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define i32 @foo(i32 %x) {\n"
+      "  ret i32 %x\n"
+      "}\n",
+      Err, C);
+  ASSERT_TRUE(M != nullptr);
+
+  // The first verifier run caches the result for @foo.  The pass breaks the
+  // function without reporting a change, which the second run must still
+  // catch.
+  legacy::PassManager Passes;
+  Passes.add(createVerifierPass());
+  Passes.add(new SilentlyBreakReturnsPass());
+  Passes.add(createVerifierPass());
+  EXPECT_DEATH(Passes.run(*M), "Broken function found");
+}
+#endif
+
 } // end anonymous namespace
 } // end namespace llvm